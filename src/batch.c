@@ -0,0 +1,409 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "batch.h"
+
+#include "streams.h"
+#include "trace.h"
+#include "tree_hash.h"
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BATCH_VERSION 1
+#define BATCH_MD_LEN 32
+#define BATCH_ROOT_HEADER_LEN 24
+#define BATCH_PROOF_HEADER_LEN 32
+/* A tree of 2^64 leafs has 64 levels above the leafs */
+#define BATCH_MAX_LEVELS 64
+#define BATCH_READ_BUF_SIZE 65536
+
+typedef struct batch_tree {
+    size_t num_items;
+    unsigned char * p_nodes;   /* all levels, starting with the leafs */
+    size_t num_levels;
+    size_t level_offset[BATCH_MAX_LEVELS + 1]; /* index of the first node of a level in p_nodes */
+    size_t level_len[BATCH_MAX_LEVELS + 1];    /* number of nodes of a level */
+} batch_tree_t;
+
+static void put_u64(char * p_buf, uint64_t value)
+{
+    for (size_t i = 0; i < 8; ++i) {
+        p_buf[i] = (char)((value >> (8 * i)) & 0xff);
+    }
+}
+
+static void put_u32(char * p_buf, uint32_t value)
+{
+    for (size_t i = 0; i < 4; ++i) {
+        p_buf[i] = (char)((value >> (8 * i)) & 0xff);
+    }
+}
+
+static uint64_t get_u64(const char * p_buf)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        value |= (uint64_t)(unsigned char)p_buf[i] << (8 * i);
+    }
+    return value;
+}
+
+static uint32_t get_u32(const char * p_buf)
+{
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        value |= (uint32_t)(unsigned char)p_buf[i] << (8 * i);
+    }
+    return value;
+}
+
+/* Computes H(0x00 || content of the file) */
+static int hash_leaf(EVP_MD_CTX * p_ctx, const char * p_path, unsigned char * p_leaf)
+{
+    unsigned char prefix = TREE_HASH_LEAF_PREFIX;
+    char buf[BATCH_READ_BUF_SIZE];
+    size_t len = 0;
+    int ret = EXIT_FAILURE;
+    FILE * p_file = fopen(p_path, "rb");
+
+    if (NULL == p_file) {
+        fprintf(stderr, "Cannot open file %s\n", p_path);
+        return EXIT_FAILURE;
+    }
+    if ((1 != EVP_DigestInit_ex(p_ctx, EVP_sha256(), NULL)) || (1 != EVP_DigestUpdate(p_ctx, &prefix, 1))) {
+        goto cleanup;
+    }
+    while (0 < (len = fread(buf, 1, sizeof(buf), p_file))) {
+        if (1 != EVP_DigestUpdate(p_ctx, buf, len)) {
+            goto cleanup;
+        }
+    }
+    if (ferror(p_file)) {
+        fprintf(stderr, "Cannot read file %s\n", p_path);
+        goto cleanup;
+    }
+    if (1 == EVP_DigestFinal_ex(p_ctx, p_leaf, NULL)) {
+        ret = EXIT_SUCCESS;
+    }
+
+cleanup:
+    fclose(p_file);
+    return ret;
+}
+
+/* Reads the list of items, one path per line, empty lines are skipped */
+static int read_list(const char * p_list, char *** ppp_items, size_t * p_num_items)
+{
+    FILE * p_file = (NULL == p_list) ? stdin : fopen(p_list, "r");
+    char * p_line = NULL;
+    size_t line_size = 0;
+    ssize_t len = 0;
+    char ** pp_items = NULL;
+    size_t num_items = 0;
+    size_t items_size = 0;
+    int ret = EXIT_FAILURE;
+
+    if (NULL == p_file) {
+        fprintf(stderr, "Cannot open file %s\n", p_list);
+        return EXIT_FAILURE;
+    }
+    while (0 <= (len = getline(&p_line, &line_size, p_file))) {
+        while ((0 < len) && (('\n' == p_line[len - 1]) || ('\r' == p_line[len - 1]))) {
+            p_line[--len] = '\0';
+        }
+        if (0 == len) {
+            continue;
+        }
+        if (num_items == items_size) {
+            size_t new_size = (0 == items_size) ? 64 : (2 * items_size);
+            char ** pp_new = realloc(pp_items, new_size * sizeof(char *));
+            if (NULL == pp_new) {
+                fprintf(stderr, "Memory allocation error\n");
+                goto cleanup;
+            }
+            pp_items = pp_new;
+            items_size = new_size;
+        }
+        pp_items[num_items] = strdup(p_line);
+        if (NULL == pp_items[num_items]) {
+            fprintf(stderr, "Memory allocation error\n");
+            goto cleanup;
+        }
+        ++num_items;
+    }
+    if (0 == num_items) {
+        fprintf(stderr, "No items to be authenticated\n");
+        goto cleanup;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    if (EXIT_SUCCESS != ret) {
+        for (size_t i = 0; i < num_items; ++i) {
+            free(pp_items[i]);
+        }
+        free(pp_items);
+        pp_items = NULL;
+        num_items = 0;
+    }
+    free(p_line);
+    if (stdin != p_file) {
+        fclose(p_file);
+    }
+    *ppp_items = pp_items;
+    *p_num_items = num_items;
+    return ret;
+}
+
+/* Builds all levels of the tree above the leafs */
+static int build_tree(batch_tree_t * p_tree, EVP_MD_CTX * p_ctx)
+{
+    size_t level = 0;
+
+    while (1 < p_tree->level_len[level]) {
+        size_t len = p_tree->level_len[level];
+        const unsigned char * p_level = &p_tree->p_nodes[p_tree->level_offset[level] * BATCH_MD_LEN];
+        size_t parent_offset = p_tree->level_offset[level] + len;
+
+        for (size_t i = 0; i < len; i += 2) {
+            unsigned char * p_parent = &p_tree->p_nodes[(parent_offset + (i / 2)) * BATCH_MD_LEN];
+            if (i + 1 == len) {
+                /* an unpaired node is moved up unchanged */
+                memcpy(p_parent, &p_level[i * BATCH_MD_LEN], BATCH_MD_LEN);
+            } else if (!tree_hash_node(
+                           EVP_sha256(),
+                           p_ctx,
+                           TREE_HASH_NODE_PREFIX,
+                           &p_level[i * BATCH_MD_LEN],
+                           BATCH_MD_LEN,
+                           &p_level[(i + 1) * BATCH_MD_LEN],
+                           BATCH_MD_LEN,
+                           p_parent)) {
+                return EXIT_FAILURE;
+            }
+        }
+        ++level;
+        p_tree->level_offset[level] = parent_offset;
+        p_tree->level_len[level] = (len + 1) / 2;
+    }
+    p_tree->num_levels = level + 1;
+    return EXIT_SUCCESS;
+}
+
+static size_t encode_root(char * p_buf, uint64_t num_items, const unsigned char * p_root)
+{
+    memcpy(p_buf, BATCH_ROOT_MAGIC, 8);
+    put_u32(&p_buf[8], BATCH_VERSION);
+    put_u32(&p_buf[12], BATCH_MD_LEN);
+    put_u64(&p_buf[16], num_items);
+    memcpy(&p_buf[BATCH_ROOT_HEADER_LEN], p_root, BATCH_MD_LEN);
+    return BATCH_ROOT_HEADER_LEN + BATCH_MD_LEN;
+}
+
+static int write_proof(const batch_tree_t * p_tree, size_t index, const char * p_item)
+{
+    char path[PATH_MAX] = {0};
+    char header[BATCH_PROOF_HEADER_LEN] = {0};
+    int ret = EXIT_FAILURE;
+
+    if (sizeof(path) <= (size_t)snprintf(path, sizeof(path), "%s%s", p_item, BATCH_PROOF_SUFFIX)) {
+        fprintf(stderr, "Path too long: %s\n", p_item);
+        return EXIT_FAILURE;
+    }
+    FILE * p_file = fopen(path, "wb");
+    if (NULL == p_file) {
+        fprintf(stderr, "Cannot create file %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    memcpy(header, BATCH_PROOF_MAGIC, 8);
+    put_u32(&header[8], BATCH_VERSION);
+    put_u32(&header[12], BATCH_MD_LEN);
+    put_u64(&header[16], index);
+    put_u64(&header[24], p_tree->num_items);
+    if (1 != fwrite(header, sizeof(header), 1, p_file)) {
+        goto cleanup;
+    }
+    for (size_t level = 0; level + 1 < p_tree->num_levels; ++level) {
+        size_t sibling = index ^ 1;
+        if (sibling < p_tree->level_len[level]) {
+            const unsigned char * p_sibling =
+                &p_tree->p_nodes[(p_tree->level_offset[level] + sibling) * BATCH_MD_LEN];
+            if (1 != fwrite(p_sibling, BATCH_MD_LEN, 1, p_file)) {
+                goto cleanup;
+            }
+        }
+        index /= 2;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    if ((0 != fclose(p_file)) || (EXIT_SUCCESS != ret)) {
+        fprintf(stderr, "Cannot write file %s\n", path);
+        ret = EXIT_FAILURE;
+    }
+    return ret;
+}
+
+int batch_authenticate(
+    gta_context_handle_t h_ctx,
+    const char * p_list,
+    gtaio_ostream_t * p_seal,
+    gta_errinfo_t * p_errinfo)
+{
+    int ret = EXIT_FAILURE;
+    char ** pp_items = NULL;
+    batch_tree_t tree = {0};
+    EVP_MD_CTX * p_ctx = NULL;
+    char root[BATCH_ROOT_HEADER_LEN + BATCH_MD_LEN] = {0};
+    istream_from_buf_t istream_root = {0};
+
+    if (EXIT_SUCCESS != read_list(p_list, &pp_items, &tree.num_items)) {
+        return EXIT_FAILURE;
+    }
+
+    /* The levels of a tree with n leafs have at most n / 2^level + 1 nodes each, less than 2n + levels in total */
+    p_ctx = EVP_MD_CTX_new();
+    tree.p_nodes = malloc(((2 * tree.num_items) + BATCH_MAX_LEVELS) * BATCH_MD_LEN);
+    if ((NULL == p_ctx) || (NULL == tree.p_nodes)) {
+        fprintf(stderr, "Memory allocation error\n");
+        goto cleanup;
+    }
+    tree.level_len[0] = tree.num_items;
+    for (size_t i = 0; i < tree.num_items; ++i) {
+        if (EXIT_SUCCESS != hash_leaf(p_ctx, pp_items[i], &tree.p_nodes[i * BATCH_MD_LEN])) {
+            goto cleanup;
+        }
+    }
+    if (EXIT_SUCCESS != build_tree(&tree, p_ctx)) {
+        fprintf(stderr, "Computation of the Merkle tree failed\n");
+        goto cleanup;
+    }
+
+    /* The root is authenticated once for all items */
+    const unsigned char * p_root = &tree.p_nodes[tree.level_offset[tree.num_levels - 1] * BATCH_MD_LEN];
+    istream_from_buf_init(&istream_root, root, encode_root(root, tree.num_items, p_root));
+    if (!TRACE_BOOL(
+            gta_authenticate_data_detached, (h_ctx, (gtaio_istream_t *)&istream_root, p_seal, p_errinfo), p_errinfo)) {
+        fprintf(stderr, "gta_authenticate_data_detached failed with ERROR_CODE %ld\n", *p_errinfo);
+        goto cleanup;
+    }
+
+    for (size_t i = 0; i < tree.num_items; ++i) {
+        if (EXIT_SUCCESS != write_proof(&tree, i, pp_items[i])) {
+            goto cleanup;
+        }
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    for (size_t i = 0; i < tree.num_items; ++i) {
+        free(pp_items[i]);
+    }
+    free(pp_items);
+    free(tree.p_nodes);
+    EVP_MD_CTX_free(p_ctx);
+    return ret;
+}
+
+int batch_verify(
+    gta_context_handle_t h_ctx,
+    const char * p_data,
+    const char * p_proof,
+    gtaio_istream_t * p_seal,
+    gta_errinfo_t * p_errinfo)
+{
+    int ret = EXIT_FAILURE;
+    char proof_path[PATH_MAX] = {0};
+    char proof[BATCH_PROOF_HEADER_LEN + (BATCH_MAX_LEVELS * BATCH_MD_LEN) + 1] = {0};
+    size_t proof_len = 0;
+    unsigned char node[BATCH_MD_LEN] = {0};
+    char root[BATCH_ROOT_HEADER_LEN + BATCH_MD_LEN] = {0};
+    istream_from_buf_t istream_root = {0};
+    FILE * p_file = NULL;
+    EVP_MD_CTX * p_ctx = EVP_MD_CTX_new();
+
+    if (NULL == p_ctx) {
+        fprintf(stderr, "Memory allocation error\n");
+        return EXIT_FAILURE;
+    }
+    if (NULL == p_proof) {
+        size_t len = (size_t)snprintf(proof_path, sizeof(proof_path), "%s%s", p_data, BATCH_PROOF_SUFFIX);
+        if (sizeof(proof_path) <= len) {
+            fprintf(stderr, "Path too long: %s\n", p_data);
+            goto cleanup;
+        }
+        p_proof = proof_path;
+    }
+    p_file = fopen(p_proof, "rb");
+    if (NULL == p_file) {
+        fprintf(stderr, "Cannot open file %s\n", p_proof);
+        goto cleanup;
+    }
+    proof_len = fread(proof, 1, sizeof(proof), p_file);
+    fclose(p_file);
+
+    uint64_t index = get_u64(&proof[16]);
+    uint64_t num_items = get_u64(&proof[24]);
+    if ((BATCH_PROOF_HEADER_LEN > proof_len) || (0 != memcmp(proof, BATCH_PROOF_MAGIC, 8)) ||
+        (BATCH_VERSION != get_u32(&proof[8])) || (BATCH_MD_LEN != get_u32(&proof[12])) || (index >= num_items)) {
+        fprintf(stderr, "%s is not a valid inclusion proof\n", p_proof);
+        goto cleanup;
+    }
+
+    if (EXIT_SUCCESS != hash_leaf(p_ctx, p_data, node)) {
+        goto cleanup;
+    }
+
+    /* Walk up to the root, the siblings follow the positions of the nodes */
+    size_t pos = BATCH_PROOF_HEADER_LEN;
+    for (uint64_t len = num_items; 1 < len; len = (len + 1) / 2, index /= 2) {
+        uint64_t sibling = index ^ 1;
+        if (sibling >= len) {
+            continue;
+        }
+        if (pos + BATCH_MD_LEN > proof_len) {
+            fprintf(stderr, "%s is not a valid inclusion proof\n", p_proof);
+            goto cleanup;
+        }
+        const char * p_sibling = &proof[pos];
+        bool b_left = (0 == (index & 1));
+        if (!tree_hash_node(
+                EVP_sha256(),
+                p_ctx,
+                TREE_HASH_NODE_PREFIX,
+                b_left ? (const void *)node : (const void *)p_sibling,
+                BATCH_MD_LEN,
+                b_left ? (const void *)p_sibling : (const void *)node,
+                BATCH_MD_LEN,
+                node)) {
+            goto cleanup;
+        }
+        pos += BATCH_MD_LEN;
+    }
+    if (pos != proof_len) {
+        fprintf(stderr, "%s is not a valid inclusion proof\n", p_proof);
+        goto cleanup;
+    }
+
+    istream_from_buf_init(&istream_root, root, encode_root(root, num_items, node));
+    if (!TRACE_BOOL(
+            gta_verify_data_detached, (h_ctx, (gtaio_istream_t *)&istream_root, p_seal, p_errinfo), p_errinfo)) {
+        fprintf(stderr, "gta_verify_data_detached failed with ERROR_CODE %ld\n", *p_errinfo);
+        goto cleanup;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    EVP_MD_CTX_free(p_ctx);
+    return ret;
+}
+
+/*** end of file ***/
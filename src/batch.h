@@ -0,0 +1,64 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef GTA_CLI_BATCH_H
+#define GTA_CLI_BATCH_H
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+extern "C" {
+/* *INDENT-ON* */
+#endif
+
+/*---------------------------------------------------------------------*/
+
+#include <gta_api/gta_api.h>
+
+/*
+ * Batch authentication: the items are hashed with SHA-256 as leafs of a
+ * Merkle tree (same node hashing as the tree hash) and only the root is
+ * authenticated with gta_authenticate_data_detached. Integers are stored
+ * little-endian.
+ *
+ *   authenticated root: magic "GTABATCH", u32 version, u32 length of the
+ *                       root hash, u64 number of items, root hash
+ *   inclusion proof:    magic "GTAPROOF", u32 version, u32 length of the
+ *                       hashes, u64 index of the item, u64 number of items,
+ *                       sibling hashes from the leaf up to the root
+ *
+ * The proof of an item is written to the file "<item>.proof".
+ */
+
+#define BATCH_ROOT_MAGIC "GTABATCH"
+#define BATCH_PROOF_MAGIC "GTAPROOF"
+#define BATCH_PROOF_SUFFIX ".proof"
+
+/* Authenticates the files listed line by line in p_list (stdin if NULL), writes the seal of the root to ostream */
+int batch_authenticate(
+    gta_context_handle_t h_ctx,
+    const char * p_list,
+    gtaio_ostream_t * p_seal,
+    gta_errinfo_t * p_errinfo);
+
+/* Verifies the file p_data with its inclusion proof p_proof ("<data>.proof" if NULL) and the seal of the root */
+int batch_verify(
+    gta_context_handle_t h_ctx,
+    const char * p_data,
+    const char * p_proof,
+    gtaio_istream_t * p_seal,
+    gta_errinfo_t * p_errinfo);
+
+/*---------------------------------------------------------------------*/
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+}
+/* *INDENT-ON* */
+#endif
+
+#endif /* GTA_CLI_BATCH_H */
+
+/*** end of file ***/
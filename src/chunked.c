@@ -0,0 +1,875 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "chunked.h"
+
+#include "streams.h"
+#include "trace.h"
+#include <fcntl.h>
+#include <gta_api/util/gta_memset.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/random.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CHUNKED_VERSION 2
+#define CHUNKED_INDEX_MAGIC "GTACIDX1"
+
+/* Sequence number, chunk flags, container id and header flags in front of the data of each sealed chunk */
+#define CHUNK_PREFIX_LEN 21
+#define CHUNK_FLAG_LAST 0x01
+/* Upper bound for the overhead of sealing a chunk, longer records are rejected */
+#define CHUNK_MAX_SEAL_OVERHEAD (64 * 1024)
+/* Upper bound for the number of worker threads */
+#define CHUNKED_MAX_THREADS 256
+
+/*
+ * The main thread reads chunks into a ring of slots, worker threads seal or
+ * unseal the slots, and a writer thread writes the processed slots in order.
+ * A slot is reused once it has been written (reorder buffer).
+ */
+enum slot_state {
+    SLOT_EMPTY,  /* can be filled by the reader */
+    SLOT_FILLED, /* waiting for a worker */
+    SLOT_BUSY,   /* processed by a worker */
+    SLOT_DONE,   /* waiting for the writer */
+};
+
+typedef struct chunk_slot {
+    enum slot_state state;
+    uint64_t seq;            /* sequence number of the chunk */
+    bool b_last;             /* seal: last chunk of the input */
+    char * p_in;             /* seal: prefix and data, unseal: sealed chunk */
+    size_t in_size;          /* allocated size of p_in */
+    size_t in_len;           /* number of valid bytes in p_in */
+    ostream_to_dynbuf_t out; /* seal: sealed chunk, unseal: prefix and data */
+} chunk_slot_t;
+
+typedef struct chunk_pipeline {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond; /* signalled on every state change */
+    chunk_slot_t * p_slots;
+    size_t num_slots;
+    uint64_t next_read;    /* sequence number of the next chunk to be read */
+    uint64_t next_process; /* sequence number of the next chunk to be processed */
+    uint64_t next_write;   /* sequence number of the next chunk to be written */
+    bool b_input_done;     /* no more chunks will be read */
+    bool b_error;          /* stops all threads */
+    gta_errinfo_t errinfo; /* errinfo of the first error */
+
+    bool b_seal;
+    gta_instance_handle_t h_inst;
+    const char * p_pers;
+    const char * p_prof;
+    size_t chunk_size;
+    uint64_t container_id; /* random id of the container, sealed into every chunk */
+    uint32_t flags;        /* flags of the header, sealed into every chunk */
+    gtaio_ostream_t * p_ostream;
+
+    /* state of the writer */
+    uint64_t out_offset; /* seal: offset of the next record in the output */
+    uint64_t * p_index;  /* seal: record offset and data length per chunk */
+    size_t index_size;   /* seal: number of allocated chunks in p_index */
+    bool b_last_seen;    /* unseal: the last chunk has been written */
+} chunk_pipeline_t;
+
+static void put_u64(char * p_buf, uint64_t value)
+{
+    for (size_t i = 0; i < 8; ++i) {
+        p_buf[i] = (char)((value >> (8 * i)) & 0xff);
+    }
+}
+
+static void put_u32(char * p_buf, uint32_t value)
+{
+    for (size_t i = 0; i < 4; ++i) {
+        p_buf[i] = (char)((value >> (8 * i)) & 0xff);
+    }
+}
+
+static uint64_t get_u64(const char * p_buf)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        value |= (uint64_t)(unsigned char)p_buf[i] << (8 * i);
+    }
+    return value;
+}
+
+static uint32_t get_u32(const char * p_buf)
+{
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        value |= (uint32_t)(unsigned char)p_buf[i] << (8 * i);
+    }
+    return value;
+}
+
+/* Reads until len bytes are read or the end of data is reached */
+static size_t read_full(gtaio_istream_t * p_istream, char * p_buf, size_t len, gta_errinfo_t * p_errinfo)
+{
+    size_t total = 0;
+    while ((total < len) && !p_istream->eof(p_istream, p_errinfo)) {
+        size_t read = p_istream->read(p_istream, &p_buf[total], len - total, p_errinfo);
+        if (0 == read) {
+            break;
+        }
+        total += read;
+    }
+    return total;
+}
+
+static bool write_full(gtaio_ostream_t * p_ostream, const char * p_buf, size_t len, gta_errinfo_t * p_errinfo)
+{
+    size_t total = 0;
+    while (total < len) {
+        size_t written = p_ostream->write(p_ostream, &p_buf[total], len - total, p_errinfo);
+        if (0 == written) {
+            return false;
+        }
+        total += written;
+    }
+    return true;
+}
+
+/* Parses a number with optional suffix K, M or G, returns the first character after it in pp_end */
+static bool parse_size_suffix(const char * p_spec, uint64_t * p_value, const char ** pp_end)
+{
+    char * p_endptr = NULL;
+    unsigned long long value = strtoull(p_spec, &p_endptr, 10);
+    unsigned long long factor = 1;
+
+    if ((p_endptr == p_spec) || ('-' == p_spec[0])) {
+        return false;
+    }
+    if (('K' == *p_endptr) || ('k' == *p_endptr)) {
+        factor = 1024;
+    } else if (('M' == *p_endptr) || ('m' == *p_endptr)) {
+        factor = 1024 * 1024;
+    } else if (('G' == *p_endptr) || ('g' == *p_endptr)) {
+        factor = 1024 * 1024 * 1024;
+    }
+    if (value > (UINT64_MAX / factor)) {
+        return false;
+    }
+    *p_value = value * factor;
+    *pp_end = (1 == factor) ? p_endptr : (p_endptr + 1);
+    return true;
+}
+
+int chunked_parse_size(const char * p_spec, size_t * p_chunk_size)
+{
+    const char * p_end = NULL;
+    uint64_t size = 0;
+
+    if (!parse_size_suffix(p_spec, &size, &p_end) || ('\0' != *p_end) || (CHUNKED_MIN_CHUNK_SIZE > size) ||
+        (CHUNKED_MAX_CHUNK_SIZE < size)) {
+        fprintf(
+            stderr,
+            "Invalid input: '%s' is not a valid chunk size (%d to %d bytes)\n",
+            p_spec,
+            CHUNKED_MIN_CHUNK_SIZE,
+            CHUNKED_MAX_CHUNK_SIZE);
+        return EXIT_FAILURE;
+    }
+    *p_chunk_size = (size_t)size;
+    return EXIT_SUCCESS;
+}
+
+int chunked_parse_range(const char * p_spec, uint64_t * p_offset, uint64_t * p_len)
+{
+    const char * p_end = NULL;
+
+    if (!parse_size_suffix(p_spec, p_offset, &p_end) || (':' != *p_end) ||
+        !parse_size_suffix(p_end + 1, p_len, &p_end) || ('\0' != *p_end) || (*p_offset > (UINT64_MAX - *p_len))) {
+        fprintf(stderr, "Invalid input: '%s' is not a valid range, expected OFFSET:LEN\n", p_spec);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+int chunked_parse_threads(const char * p_spec, unsigned int * p_threads)
+{
+    char * p_endptr = NULL;
+    unsigned long threads = strtoul(p_spec, &p_endptr, 10);
+
+    if (('\0' == *p_spec) || ('\0' != *p_endptr) || ('-' == p_spec[0]) || (CHUNKED_MAX_THREADS < threads)) {
+        fprintf(stderr, "Invalid input: '%s' is not a valid number of threads\n", p_spec);
+        return EXIT_FAILURE;
+    }
+    *p_threads = (unsigned int)threads;
+    return EXIT_SUCCESS;
+}
+
+bool chunked_is_container(const char * p_data, size_t len)
+{
+    return (CHUNKED_MAGIC_LEN <= len) && (0 == memcmp(p_data, CHUNKED_MAGIC, CHUNKED_MAGIC_LEN));
+}
+
+bool chunked_is_compressed(const char * p_data, size_t len)
+{
+    return chunked_is_container(p_data, len) && (16 <= len) && (0 != (CHUNKED_FLAG_COMPRESSED & get_u32(&p_data[12])));
+}
+
+/* Records the first error and stops all threads, the mutex must be held */
+static void set_error_locked(chunk_pipeline_t * p_pipeline, gta_errinfo_t errinfo)
+{
+    if (!p_pipeline->b_error) {
+        p_pipeline->b_error = true;
+        p_pipeline->errinfo = errinfo;
+    }
+    pthread_cond_broadcast(&p_pipeline->cond);
+}
+
+static void set_error(chunk_pipeline_t * p_pipeline, gta_errinfo_t errinfo)
+{
+    pthread_mutex_lock(&p_pipeline->mutex);
+    set_error_locked(p_pipeline, errinfo);
+    pthread_mutex_unlock(&p_pipeline->mutex);
+}
+
+/* Checks the prefix of an unsealed chunk against the header of its container and its position */
+static bool check_chunk_prefix(const ostream_to_dynbuf_t * p_out, uint64_t container_id, uint32_t flags, uint64_t seq)
+{
+    if ((CHUNK_PREFIX_LEN > p_out->buf_pos) || (container_id != get_u64(&p_out->buf[9])) ||
+        (flags != get_u32(&p_out->buf[17]))) {
+        fprintf(
+            stderr, "Chunked container is corrupted: chunk %llu does not match the header\n", (unsigned long long)seq);
+        return false;
+    }
+    if (seq != get_u64(p_out->buf)) {
+        fprintf(stderr, "Chunked container is corrupted: chunk %llu out of order\n", (unsigned long long)seq);
+        return false;
+    }
+    return true;
+}
+
+static bool process_chunk(
+    chunk_pipeline_t * p_pipeline,
+    gta_context_handle_t h_ctx,
+    chunk_slot_t * p_slot,
+    gta_errinfo_t * p_errinfo)
+{
+    istream_from_buf_t istream = {0};
+    bool b_ok = false;
+
+    p_slot->out.buf_pos = 0;
+    if (p_pipeline->b_seal) {
+        put_u64(p_slot->p_in, p_slot->seq);
+        p_slot->p_in[8] = p_slot->b_last ? CHUNK_FLAG_LAST : 0;
+        put_u64(&p_slot->p_in[9], p_pipeline->container_id);
+        put_u32(&p_slot->p_in[17], p_pipeline->flags);
+        istream_from_buf_init(&istream, p_slot->p_in, p_slot->in_len);
+        b_ok = TRACE_BOOL(
+            gta_seal_data, (h_ctx, (gtaio_istream_t *)&istream, (gtaio_ostream_t *)&p_slot->out, p_errinfo), p_errinfo);
+        if (!b_ok) {
+            fprintf(stderr, "gta_seal_data failed with ERROR_CODE %ld\n", *p_errinfo);
+        }
+    } else {
+        istream_from_buf_init(&istream, p_slot->p_in, p_slot->in_len);
+        b_ok = TRACE_BOOL(
+            gta_unseal_data,
+            (h_ctx, (gtaio_istream_t *)&istream, (gtaio_ostream_t *)&p_slot->out, p_errinfo),
+            p_errinfo);
+        if (!b_ok) {
+            fprintf(stderr, "gta_unseal_data failed with ERROR_CODE %ld\n", *p_errinfo);
+        } else {
+            b_ok = check_chunk_prefix(&p_slot->out, p_pipeline->container_id, p_pipeline->flags, p_slot->seq);
+        }
+    }
+    return b_ok;
+}
+
+static void * worker_main(void * p_arg)
+{
+    chunk_pipeline_t * p_pipeline = (chunk_pipeline_t *)p_arg;
+    gta_errinfo_t errinfo = 0;
+
+    /* Contexts are not shared between threads */
+    gta_context_handle_t h_ctx = TRACE_PTR(
+        gta_context_open, (p_pipeline->h_inst, p_pipeline->p_pers, p_pipeline->p_prof, &errinfo), &errinfo);
+    if (NULL == h_ctx) {
+        fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", errinfo);
+        set_error(p_pipeline, errinfo);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&p_pipeline->mutex);
+    for (;;) {
+        while (!p_pipeline->b_error && (p_pipeline->next_process == p_pipeline->next_read) &&
+               !p_pipeline->b_input_done) {
+            pthread_cond_wait(&p_pipeline->cond, &p_pipeline->mutex);
+        }
+        if (p_pipeline->b_error || (p_pipeline->next_process == p_pipeline->next_read)) {
+            break;
+        }
+        chunk_slot_t * p_slot = &p_pipeline->p_slots[p_pipeline->next_process % p_pipeline->num_slots];
+        p_pipeline->next_process++;
+        p_slot->state = SLOT_BUSY;
+        pthread_mutex_unlock(&p_pipeline->mutex);
+
+        bool b_ok = process_chunk(p_pipeline, h_ctx, p_slot, &errinfo);
+
+        pthread_mutex_lock(&p_pipeline->mutex);
+        if (b_ok) {
+            p_slot->state = SLOT_DONE;
+            pthread_cond_broadcast(&p_pipeline->cond);
+        } else {
+            set_error_locked(p_pipeline, errinfo);
+        }
+    }
+    pthread_mutex_unlock(&p_pipeline->mutex);
+
+    TRACE_BOOL(gta_context_close, (h_ctx, &errinfo), &errinfo);
+    return NULL;
+}
+
+static bool write_sealed_chunk(chunk_pipeline_t * p_pipeline, chunk_slot_t * p_slot, gta_errinfo_t * p_errinfo)
+{
+    char len[8] = {0};
+
+    if (p_slot->seq == p_pipeline->index_size) {
+        size_t new_size = (0 == p_pipeline->index_size) ? 256 : 2 * p_pipeline->index_size;
+        uint64_t * p_new_index = realloc(p_pipeline->p_index, new_size * 2 * sizeof(uint64_t));
+        if (NULL == p_new_index) {
+            fprintf(stderr, "Memory allocation error\n");
+            return false;
+        }
+        p_pipeline->p_index = p_new_index;
+        p_pipeline->index_size = new_size;
+    }
+    p_pipeline->p_index[2 * p_slot->seq] = p_pipeline->out_offset;
+    p_pipeline->p_index[(2 * p_slot->seq) + 1] = p_slot->in_len - CHUNK_PREFIX_LEN;
+
+    put_u64(len, p_slot->out.buf_pos);
+    if (!write_full(p_pipeline->p_ostream, len, sizeof(len), p_errinfo) ||
+        !write_full(p_pipeline->p_ostream, p_slot->out.buf, p_slot->out.buf_pos, p_errinfo)) {
+        return false;
+    }
+    p_pipeline->out_offset += sizeof(len) + p_slot->out.buf_pos;
+    return true;
+}
+
+static bool write_unsealed_chunk(chunk_pipeline_t * p_pipeline, chunk_slot_t * p_slot, gta_errinfo_t * p_errinfo)
+{
+    /* The prefix has been checked by the worker */
+    if (p_pipeline->b_last_seen) {
+        fprintf(stderr, "Chunked container is corrupted: chunk %llu out of order\n", (unsigned long long)p_slot->seq);
+        return false;
+    }
+    if (CHUNK_FLAG_LAST & p_slot->out.buf[8]) {
+        p_pipeline->b_last_seen = true;
+    }
+    return write_full(
+        p_pipeline->p_ostream, &p_slot->out.buf[CHUNK_PREFIX_LEN], p_slot->out.buf_pos - CHUNK_PREFIX_LEN, p_errinfo);
+}
+
+static void * writer_main(void * p_arg)
+{
+    chunk_pipeline_t * p_pipeline = (chunk_pipeline_t *)p_arg;
+    gta_errinfo_t errinfo = 0;
+
+    pthread_mutex_lock(&p_pipeline->mutex);
+    for (;;) {
+        chunk_slot_t * p_slot = &p_pipeline->p_slots[p_pipeline->next_write % p_pipeline->num_slots];
+        while (!p_pipeline->b_error &&
+               !((p_pipeline->next_write < p_pipeline->next_read) && (SLOT_DONE == p_slot->state)) &&
+               !(p_pipeline->b_input_done && (p_pipeline->next_write == p_pipeline->next_read))) {
+            pthread_cond_wait(&p_pipeline->cond, &p_pipeline->mutex);
+        }
+        if (p_pipeline->b_error || (p_pipeline->next_write == p_pipeline->next_read)) {
+            break;
+        }
+        pthread_mutex_unlock(&p_pipeline->mutex);
+
+        bool b_ok = p_pipeline->b_seal ? write_sealed_chunk(p_pipeline, p_slot, &errinfo)
+                                       : write_unsealed_chunk(p_pipeline, p_slot, &errinfo);
+
+        pthread_mutex_lock(&p_pipeline->mutex);
+        if (b_ok) {
+            p_slot->state = SLOT_EMPTY;
+            p_pipeline->next_write++;
+            pthread_cond_broadcast(&p_pipeline->cond);
+        } else {
+            set_error_locked(p_pipeline, errinfo);
+        }
+    }
+    pthread_mutex_unlock(&p_pipeline->mutex);
+
+    return NULL;
+}
+
+/* Waits until the slot for the next chunk can be filled, returns NULL on error */
+static chunk_slot_t * wait_for_empty_slot(chunk_pipeline_t * p_pipeline)
+{
+    chunk_slot_t * p_slot = NULL;
+
+    pthread_mutex_lock(&p_pipeline->mutex);
+    p_slot = &p_pipeline->p_slots[p_pipeline->next_read % p_pipeline->num_slots];
+    while (!p_pipeline->b_error && (SLOT_EMPTY != p_slot->state)) {
+        pthread_cond_wait(&p_pipeline->cond, &p_pipeline->mutex);
+    }
+    if (p_pipeline->b_error) {
+        p_slot = NULL;
+    }
+    pthread_mutex_unlock(&p_pipeline->mutex);
+
+    return p_slot;
+}
+
+/* Hands a filled slot over to the workers */
+static void submit_slot(chunk_pipeline_t * p_pipeline, chunk_slot_t * p_slot, bool b_last)
+{
+    pthread_mutex_lock(&p_pipeline->mutex);
+    p_slot->seq = p_pipeline->next_read;
+    p_slot->b_last = b_last;
+    p_slot->state = SLOT_FILLED;
+    p_pipeline->next_read++;
+    p_pipeline->b_input_done = b_last;
+    pthread_cond_broadcast(&p_pipeline->cond);
+    pthread_mutex_unlock(&p_pipeline->mutex);
+}
+
+static void end_of_input(chunk_pipeline_t * p_pipeline)
+{
+    pthread_mutex_lock(&p_pipeline->mutex);
+    p_pipeline->b_input_done = true;
+    pthread_cond_broadcast(&p_pipeline->cond);
+    pthread_mutex_unlock(&p_pipeline->mutex);
+}
+
+/* Reads the chunks of the input, runs in the calling thread */
+static void read_chunks(chunk_pipeline_t * p_pipeline, gtaio_istream_t * p_istream)
+{
+    gta_errinfo_t errinfo = 0;
+    chunk_slot_t * p_slot = NULL;
+    char len_buf[8] = {0};
+
+    while (NULL != (p_slot = wait_for_empty_slot(p_pipeline))) {
+        if (p_pipeline->b_seal) {
+            size_t len = read_full(p_istream, &p_slot->p_in[CHUNK_PREFIX_LEN], p_pipeline->chunk_size, &errinfo);
+            p_slot->in_len = CHUNK_PREFIX_LEN + len;
+            /* An input with a multiple of the chunk size ends with an empty chunk */
+            bool b_last = (len < p_pipeline->chunk_size) || p_istream->eof(p_istream, &errinfo);
+            submit_slot(p_pipeline, p_slot, b_last);
+            if (b_last) {
+                return;
+            }
+            continue;
+        }
+
+        if (sizeof(len_buf) != read_full(p_istream, len_buf, sizeof(len_buf), &errinfo)) {
+            fprintf(stderr, "Chunked container is truncated\n");
+            set_error(p_pipeline, errinfo);
+            return;
+        }
+        uint64_t len = get_u64(len_buf);
+        if (0 == len) {
+            /* the index follows, it is not needed for sequential unsealing */
+            end_of_input(p_pipeline);
+            return;
+        }
+        if (len > p_pipeline->chunk_size + CHUNK_PREFIX_LEN + CHUNK_MAX_SEAL_OVERHEAD) {
+            fprintf(stderr, "Chunked container is corrupted: invalid chunk length\n");
+            set_error(p_pipeline, 0);
+            return;
+        }
+        if (len > p_slot->in_size) {
+            char * p_new = realloc(p_slot->p_in, (size_t)len);
+            if (NULL == p_new) {
+                fprintf(stderr, "Memory allocation error\n");
+                set_error(p_pipeline, 0);
+                return;
+            }
+            p_slot->p_in = p_new;
+            p_slot->in_size = (size_t)len;
+        }
+        p_slot->in_len = read_full(p_istream, p_slot->p_in, (size_t)len, &errinfo);
+        if (p_slot->in_len != len) {
+            fprintf(stderr, "Chunked container is truncated\n");
+            set_error(p_pipeline, errinfo);
+            return;
+        }
+        submit_slot(p_pipeline, p_slot, false);
+    }
+}
+
+static bool write_index(chunk_pipeline_t * p_pipeline, gta_errinfo_t * p_errinfo)
+{
+    char buf[CHUNKED_TRAILER_LEN] = {0};
+    uint64_t num_chunks = p_pipeline->next_write;
+
+    /* A record length of 0 marks the end of the records */
+    put_u64(buf, 0);
+    if (!write_full(p_pipeline->p_ostream, buf, 8, p_errinfo)) {
+        return false;
+    }
+    uint64_t index_offset = p_pipeline->out_offset + 8;
+
+    for (uint64_t i = 0; i < num_chunks; ++i) {
+        put_u64(buf, p_pipeline->p_index[2 * i]);
+        put_u64(&buf[8], p_pipeline->p_index[(2 * i) + 1]);
+        if (!write_full(p_pipeline->p_ostream, buf, CHUNKED_INDEX_ENTRY_LEN, p_errinfo)) {
+            return false;
+        }
+    }
+
+    put_u64(buf, index_offset);
+    put_u64(&buf[8], num_chunks);
+    memcpy(&buf[16], CHUNKED_INDEX_MAGIC, CHUNKED_MAGIC_LEN);
+    return write_full(p_pipeline->p_ostream, buf, CHUNKED_TRAILER_LEN, p_errinfo);
+}
+
+static int run_pipeline(
+    chunk_pipeline_t * p_pipeline,
+    gtaio_istream_t * p_istream,
+    unsigned int threads,
+    gta_errinfo_t * p_errinfo)
+{
+    int ret = EXIT_FAILURE;
+    pthread_t * p_workers = NULL;
+    pthread_t writer = {0};
+    unsigned int num_workers = 0;
+    bool b_writer = false;
+
+    if (0 == threads) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (1 > cpus) ? 1 : ((CHUNKED_MAX_THREADS < cpus) ? CHUNKED_MAX_THREADS : (unsigned int)cpus);
+    }
+
+    /* Two additional slots keep the workers busy while the reader and the writer are working */
+    p_pipeline->num_slots = threads + 2;
+    p_pipeline->p_slots = calloc(p_pipeline->num_slots, sizeof(chunk_slot_t));
+    p_workers = calloc(threads, sizeof(pthread_t));
+    if ((NULL == p_pipeline->p_slots) || (NULL == p_workers)) {
+        fprintf(stderr, "Memory allocation error\n");
+        goto cleanup;
+    }
+    for (size_t i = 0; i < p_pipeline->num_slots; ++i) {
+        chunk_slot_t * p_slot = &p_pipeline->p_slots[i];
+        ostream_to_dynbuf_init(&p_slot->out);
+        if (p_pipeline->b_seal) {
+            p_slot->in_size = CHUNK_PREFIX_LEN + p_pipeline->chunk_size;
+            p_slot->p_in = malloc(p_slot->in_size);
+            if (NULL == p_slot->p_in) {
+                fprintf(stderr, "Memory allocation error\n");
+                goto cleanup;
+            }
+        }
+    }
+
+    pthread_mutex_init(&p_pipeline->mutex, NULL);
+    pthread_cond_init(&p_pipeline->cond, NULL);
+    for (; num_workers < threads; ++num_workers) {
+        if (0 != pthread_create(&p_workers[num_workers], NULL, worker_main, p_pipeline)) {
+            set_error(p_pipeline, 0);
+            break;
+        }
+    }
+    if (0 == pthread_create(&writer, NULL, writer_main, p_pipeline)) {
+        b_writer = true;
+    } else {
+        set_error(p_pipeline, 0);
+    }
+
+    read_chunks(p_pipeline, p_istream);
+
+    if (b_writer) {
+        pthread_join(writer, NULL);
+    }
+    /* Workers stop as soon as all chunks have been processed */
+    end_of_input(p_pipeline);
+    for (unsigned int i = 0; i < num_workers; ++i) {
+        pthread_join(p_workers[i], NULL);
+    }
+    pthread_cond_destroy(&p_pipeline->cond);
+    pthread_mutex_destroy(&p_pipeline->mutex);
+
+    if (p_pipeline->b_error) {
+        *p_errinfo = p_pipeline->errinfo;
+        goto cleanup;
+    }
+    if (p_pipeline->b_seal) {
+        if (!write_index(p_pipeline, p_errinfo)) {
+            goto cleanup;
+        }
+    } else if (!p_pipeline->b_last_seen) {
+        fprintf(stderr, "Chunked container is truncated\n");
+        goto cleanup;
+    }
+    if (!p_pipeline->p_ostream->finish(p_pipeline->p_ostream, 0, p_errinfo)) {
+        goto cleanup;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    if (NULL != p_pipeline->p_slots) {
+        for (size_t i = 0; i < p_pipeline->num_slots; ++i) {
+            chunk_slot_t * p_slot = &p_pipeline->p_slots[i];
+            ostream_to_dynbuf_free(&p_slot->out);
+            if (NULL != p_slot->p_in) {
+                gta_memset(p_slot->p_in, p_slot->in_size, 0, p_slot->in_size);
+                free(p_slot->p_in);
+            }
+        }
+    }
+    free(p_pipeline->p_slots);
+    free(p_pipeline->p_index);
+    free(p_workers);
+    return ret;
+}
+
+int chunked_seal(
+    gta_instance_handle_t h_inst,
+    const char * p_pers,
+    const char * p_prof,
+    gtaio_istream_t * p_istream,
+    gtaio_ostream_t * p_ostream,
+    size_t chunk_size,
+    uint32_t flags,
+    unsigned int threads,
+    gta_errinfo_t * p_errinfo)
+{
+    chunk_pipeline_t pipeline = {0};
+    char header[CHUNKED_HEADER_LEN] = {0};
+
+    pipeline.b_seal = true;
+    pipeline.h_inst = h_inst;
+    pipeline.p_pers = p_pers;
+    pipeline.p_prof = p_prof;
+    pipeline.chunk_size = chunk_size;
+    pipeline.flags = flags;
+    pipeline.p_ostream = p_ostream;
+
+    if (sizeof(pipeline.container_id) != getrandom(&pipeline.container_id, sizeof(pipeline.container_id), 0)) {
+        fprintf(stderr, "Cannot create container id: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    memcpy(header, CHUNKED_MAGIC, CHUNKED_MAGIC_LEN);
+    put_u32(&header[8], CHUNKED_VERSION);
+    put_u32(&header[12], flags);
+    put_u64(&header[16], chunk_size);
+    put_u64(&header[24], pipeline.container_id);
+    if (!write_full(p_ostream, header, sizeof(header), p_errinfo)) {
+        return EXIT_FAILURE;
+    }
+    pipeline.out_offset = sizeof(header);
+
+    return run_pipeline(&pipeline, p_istream, threads, p_errinfo);
+}
+
+int chunked_unseal(
+    gta_instance_handle_t h_inst,
+    const char * p_pers,
+    const char * p_prof,
+    gtaio_istream_t * p_istream,
+    gtaio_ostream_t * p_ostream,
+    unsigned int threads,
+    gta_errinfo_t * p_errinfo)
+{
+    chunk_pipeline_t pipeline = {0};
+    char header[CHUNKED_HEADER_LEN] = {0};
+
+    if ((sizeof(header) != read_full(p_istream, header, sizeof(header), p_errinfo)) ||
+        !chunked_is_container(header, sizeof(header)) || (CHUNKED_VERSION != get_u32(&header[8])) ||
+        (CHUNKED_MIN_CHUNK_SIZE > get_u64(&header[16])) || (CHUNKED_MAX_CHUNK_SIZE < get_u64(&header[16]))) {
+        fprintf(stderr, "Invalid chunked container header\n");
+        return EXIT_FAILURE;
+    }
+
+    pipeline.b_seal = false;
+    pipeline.h_inst = h_inst;
+    pipeline.p_pers = p_pers;
+    pipeline.p_prof = p_prof;
+    pipeline.chunk_size = (size_t)get_u64(&header[16]);
+    pipeline.flags = get_u32(&header[12]);
+    pipeline.container_id = get_u64(&header[24]);
+    pipeline.p_ostream = p_ostream;
+
+    return run_pipeline(&pipeline, p_istream, threads, p_errinfo);
+}
+
+/* Unseals the chunk with the given sequence number and checks its prefix, out contains the prefix and the data */
+static bool unseal_chunk_at(
+    gta_context_handle_t h_ctx,
+    const char * p_map,
+    uint64_t container_id,
+    uint32_t flags,
+    uint64_t record_offset,
+    uint64_t index_offset,
+    uint64_t seq,
+    ostream_to_dynbuf_t * p_out,
+    gta_errinfo_t * p_errinfo)
+{
+    istream_from_buf_t istream = {0};
+
+    /* The record must be located in front of the end marker */
+    if ((CHUNKED_HEADER_LEN > record_offset) || (index_offset - 8 < record_offset) ||
+        (index_offset - 8 - record_offset < 8)) {
+        fprintf(stderr, "Chunked container is corrupted: invalid index\n");
+        return false;
+    }
+    uint64_t len = get_u64(&p_map[record_offset]);
+    if ((0 == len) || (index_offset - 8 - record_offset - 8 < len)) {
+        fprintf(stderr, "Chunked container is corrupted: invalid chunk length\n");
+        return false;
+    }
+
+    p_out->buf_pos = 0;
+    istream_from_buf_init(&istream, &p_map[record_offset + 8], (size_t)len);
+    if (!TRACE_BOOL(
+            gta_unseal_data, (h_ctx, (gtaio_istream_t *)&istream, (gtaio_ostream_t *)p_out, p_errinfo), p_errinfo)) {
+        fprintf(stderr, "gta_unseal_data failed with ERROR_CODE %ld\n", *p_errinfo);
+        return false;
+    }
+    return check_chunk_prefix(p_out, container_id, flags, seq);
+}
+
+int chunked_unseal_range(
+    gta_instance_handle_t h_inst,
+    const char * p_pers,
+    const char * p_prof,
+    const char * p_path,
+    uint64_t offset,
+    uint64_t len,
+    gtaio_ostream_t * p_ostream,
+    gta_errinfo_t * p_errinfo)
+{
+    int ret = EXIT_FAILURE;
+    int fd = -1;
+    struct stat st = {0};
+    char * p_map = NULL;
+    size_t map_len = 0;
+    gta_context_handle_t h_ctx = GTA_HANDLE_INVALID;
+    ostream_to_dynbuf_t out = {0};
+
+    ostream_to_dynbuf_init(&out);
+
+    fd = open(p_path, O_RDONLY | O_CLOEXEC);
+    if ((0 > fd) || (0 != fstat(fd, &st))) {
+        fprintf(stderr, "Cannot open file %s\n", p_path);
+        goto cleanup;
+    }
+    if (!S_ISREG(st.st_mode) || ((off_t)(CHUNKED_HEADER_LEN + 8 + CHUNKED_TRAILER_LEN) > st.st_size)) {
+        fprintf(stderr, "%s is not a chunked container file\n", p_path);
+        goto cleanup;
+    }
+    map_len = (size_t)st.st_size;
+    p_map = mmap(NULL, map_len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (MAP_FAILED == p_map) {
+        p_map = NULL;
+        fprintf(stderr, "Cannot map file %s\n", p_path);
+        goto cleanup;
+    }
+    /* Only a few records are touched */
+    madvise(p_map, map_len, MADV_RANDOM);
+
+    /* Header and trailer */
+    const char * p_trailer = &p_map[map_len - CHUNKED_TRAILER_LEN];
+    uint64_t chunk_size = get_u64(&p_map[16]);
+    uint32_t flags = get_u32(&p_map[12]);
+    uint64_t container_id = get_u64(&p_map[24]);
+    uint64_t index_offset = get_u64(p_trailer);
+    uint64_t num_chunks = get_u64(&p_trailer[8]);
+    if (!chunked_is_container(p_map, map_len) || (CHUNKED_VERSION != get_u32(&p_map[8])) ||
+        (CHUNKED_MIN_CHUNK_SIZE > chunk_size) || (CHUNKED_MAX_CHUNK_SIZE < chunk_size) ||
+        (0 != memcmp(&p_trailer[16], CHUNKED_INDEX_MAGIC, CHUNKED_MAGIC_LEN)) || (0 == num_chunks) ||
+        (CHUNKED_HEADER_LEN + 8 > index_offset) ||
+        (num_chunks > (map_len - CHUNKED_TRAILER_LEN - index_offset) / CHUNKED_INDEX_ENTRY_LEN) ||
+        (map_len - CHUNKED_TRAILER_LEN - index_offset != num_chunks * CHUNKED_INDEX_ENTRY_LEN)) {
+        fprintf(stderr, "%s is not a chunked container file with index\n", p_path);
+        goto cleanup;
+    }
+    if (CHUNKED_FLAG_COMPRESSED & flags) {
+        fprintf(stderr, "Ranges are not supported for compressed data\n");
+        goto cleanup;
+    }
+
+    /* All chunks except the last one are full */
+    const char * p_index = &p_map[index_offset];
+    uint64_t last_len = get_u64(&p_index[((num_chunks - 1) * CHUNKED_INDEX_ENTRY_LEN) + 8]);
+    if ((chunk_size < last_len) || ((num_chunks - 1) > (UINT64_MAX - last_len) / chunk_size)) {
+        fprintf(stderr, "Chunked container is corrupted: invalid index\n");
+        goto cleanup;
+    }
+    uint64_t data_len = ((num_chunks - 1) * chunk_size) + last_len;
+    if (offset > data_len) {
+        fprintf(stderr, "Range exceeds the data of %llu bytes\n", (unsigned long long)data_len);
+        goto cleanup;
+    }
+    if (len > data_len - offset) {
+        len = data_len - offset;
+    }
+
+    h_ctx = TRACE_PTR(gta_context_open, (h_inst, p_pers, p_prof, p_errinfo), p_errinfo);
+    if (NULL == h_ctx) {
+        fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", *p_errinfo);
+        goto cleanup;
+    }
+
+    /*
+     * Chunks covering the range. If the range reaches the end of the data,
+     * the last chunk is unsealed to check that the index has not been cut.
+     */
+    uint64_t first = offset / chunk_size;
+    uint64_t last = (0 == len) ? first : ((offset + len - 1) / chunk_size);
+    if (offset + len == data_len) {
+        last = num_chunks - 1;
+    }
+    if (first > last) {
+        first = last;
+    }
+    for (uint64_t seq = first; seq <= last; ++seq) {
+        const char * p_entry = &p_index[seq * CHUNKED_INDEX_ENTRY_LEN];
+        uint64_t chunk_len = (seq == num_chunks - 1) ? last_len : chunk_size;
+
+        if (!unseal_chunk_at(
+                h_ctx, p_map, container_id, flags, get_u64(p_entry), index_offset, seq, &out, p_errinfo)) {
+            goto cleanup;
+        }
+        bool b_last = (0 != (CHUNK_FLAG_LAST & out.buf[8]));
+        if ((CHUNK_PREFIX_LEN + chunk_len != out.buf_pos) || (b_last != (seq == num_chunks - 1))) {
+            fprintf(
+                stderr, "Chunked container is corrupted: index does not match chunk %llu\n", (unsigned long long)seq);
+            goto cleanup;
+        }
+
+        /* Part of the chunk within the range */
+        uint64_t chunk_start = seq * chunk_size;
+        uint64_t begin = (offset > chunk_start) ? (offset - chunk_start) : 0;
+        uint64_t end = (offset + len < chunk_start + chunk_len) ? (offset + len - chunk_start) : chunk_len;
+        if ((begin < end) &&
+            !write_full(p_ostream, &out.buf[CHUNK_PREFIX_LEN + begin], (size_t)(end - begin), p_errinfo)) {
+            goto cleanup;
+        }
+    }
+
+    if (!p_ostream->finish(p_ostream, 0, p_errinfo)) {
+        goto cleanup;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    if (GTA_HANDLE_INVALID != h_ctx) {
+        TRACE_BOOL(gta_context_close, (h_ctx, p_errinfo), p_errinfo);
+    }
+    ostream_to_dynbuf_free(&out);
+    if (NULL != p_map) {
+        munmap(p_map, map_len);
+    }
+    if (0 <= fd) {
+        close(fd);
+    }
+    return ret;
+}
+
+/*** end of file ***/
@@ -0,0 +1,118 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef GTA_CLI_CHUNKED_H
+#define GTA_CLI_CHUNKED_H
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+extern "C" {
+/* *INDENT-ON* */
+#endif
+
+/*---------------------------------------------------------------------*/
+
+#include <gta_api/gta_api.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Chunked sealed container. The input is split into chunks of a fixed size
+ * which are sealed independently, so chunks can be sealed and unsealed in
+ * parallel. All integers are stored little-endian.
+ *
+ *   header:  magic "GTACHNK1", u32 version, u32 flags, u64 chunk size, u64 container id
+ *   records: u64 length of the sealed chunk, sealed chunk
+ *   end:     u64 0
+ *   index:   per chunk u64 offset of its record, u64 length of its data
+ *   trailer: u64 offset of the index, u64 number of chunks, magic "GTACIDX1"
+ *
+ * The sealed data of a chunk starts with its sequence number (u64), a flag
+ * byte marking the last chunk, the random container id (u64) and the flags
+ * of the header (u32), so chunks cannot be reordered, dropped, appended or
+ * mixed between containers and the header flags cannot be changed without
+ * detection. All chunks except the last one contain
+ * exactly chunk size bytes of data, so the chunk covering an offset of the
+ * data is found without reading the records in front of it.
+ */
+
+#define CHUNKED_MAGIC "GTACHNK1"
+#define CHUNKED_MAGIC_LEN 8
+#define CHUNKED_HEADER_LEN 32
+#define CHUNKED_INDEX_ENTRY_LEN 16
+#define CHUNKED_TRAILER_LEN 24
+
+/* Flag in the header: the data has been compressed before it was split into chunks */
+#define CHUNKED_FLAG_COMPRESSED 0x00000001
+
+#define CHUNKED_MIN_CHUNK_SIZE 4096
+#define CHUNKED_MAX_CHUNK_SIZE (1024 * 1024 * 1024)
+
+/* Parses a chunk size with optional suffix K, M or G (e.g. "4M") */
+int chunked_parse_size(const char * p_spec, size_t * p_chunk_size);
+
+/* Parses a number of worker threads, 0 selects the number of online CPUs */
+int chunked_parse_threads(const char * p_spec, unsigned int * p_threads);
+
+/* Parses "OFFSET:LEN" of the data to be unsealed, both with optional suffix K, M or G */
+int chunked_parse_range(const char * p_spec, uint64_t * p_offset, uint64_t * p_len);
+
+/* Returns true if the data starts with the magic of a chunked container */
+bool chunked_is_container(const char * p_data, size_t len);
+
+/* Returns true if the data starts with the header of a chunked container of compressed data (magic, version, flags) */
+bool chunked_is_compressed(const char * p_data, size_t len);
+
+/* Seals the data of istream as chunked container to ostream using the given number of worker threads */
+int chunked_seal(
+    gta_instance_handle_t h_inst,
+    const char * p_pers,
+    const char * p_prof,
+    gtaio_istream_t * p_istream,
+    gtaio_ostream_t * p_ostream,
+    size_t chunk_size,
+    uint32_t flags,
+    unsigned int threads,
+    gta_errinfo_t * p_errinfo);
+
+/* Unseals a chunked container read from istream and writes the data in order to ostream */
+int chunked_unseal(
+    gta_instance_handle_t h_inst,
+    const char * p_pers,
+    const char * p_prof,
+    gtaio_istream_t * p_istream,
+    gtaio_ostream_t * p_ostream,
+    unsigned int threads,
+    gta_errinfo_t * p_errinfo);
+
+/*
+ * Unseals len bytes at offset of the data in the chunked container file
+ * p_path. The file is mapped and only the chunks covering the range are
+ * unsealed, located through the trailing index. A range exceeding the data
+ * is cut at the end of the data.
+ */
+int chunked_unseal_range(
+    gta_instance_handle_t h_inst,
+    const char * p_pers,
+    const char * p_prof,
+    const char * p_path,
+    uint64_t offset,
+    uint64_t len,
+    gtaio_ostream_t * p_ostream,
+    gta_errinfo_t * p_errinfo);
+
+/*---------------------------------------------------------------------*/
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+}
+/* *INDENT-ON* */
+#endif
+
+#endif /* GTA_CLI_CHUNKED_H */
+
+/*** end of file ***/
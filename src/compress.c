@@ -0,0 +1,373 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "compress.h"
+
+#include <gta_api/util/gta_memset.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Magic at the start of compressed data, chosen to be unlikely at the start of other data */
+static const char compress_magic[COMPRESS_HEADER_LEN - 1] = {'\x89', 'G', 'T', 'A', 'Z', '\r', '\n', '\x1a'};
+
+int compress_parse(const char * p_spec, enum compress_alg * p_alg, int * p_level)
+{
+    const char * p_level_str = NULL;
+    char * p_endptr = NULL;
+
+    if (0 == strncmp(p_spec, "zlib", 4)) {
+        *p_alg = COMPRESS_ZLIB;
+        p_level_str = p_spec + 4;
+    } else if (0 == strncmp(p_spec, "zstd", 4)) {
+        *p_alg = COMPRESS_ZSTD;
+        p_level_str = p_spec + 4;
+    } else {
+        fprintf(stderr, "Invalid compression algorithm: %s\n", p_spec);
+        return EXIT_FAILURE;
+    }
+
+#if !defined(HAVE_ZLIB)
+    if (COMPRESS_ZLIB == *p_alg) {
+        fprintf(stderr, "Compression with zlib is not supported by this build\n");
+        return EXIT_FAILURE;
+    }
+#endif
+#if !defined(HAVE_ZSTD)
+    if (COMPRESS_ZSTD == *p_alg) {
+        fprintf(stderr, "Compression with zstd is not supported by this build\n");
+        return EXIT_FAILURE;
+    }
+#endif
+
+    /* 0 selects the default level of the algorithm */
+    *p_level = 0;
+    if (':' == *p_level_str) {
+        long level = strtol(p_level_str + 1, &p_endptr, 10);
+        if (('\0' == p_level_str[1]) || ('\0' != *p_endptr) || (1 > level) || (22 < level) ||
+            ((COMPRESS_ZLIB == *p_alg) && (9 < level))) {
+            fprintf(stderr, "Invalid input: '%s' is not a valid compression level\n", p_level_str + 1);
+            return EXIT_FAILURE;
+        }
+        *p_level = (int)level;
+    } else if ('\0' != *p_level_str) {
+        fprintf(stderr, "Invalid compression algorithm: %s\n", p_spec);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * compress_istream
+ */
+
+/* Compresses the buffered input into data, returns the number of bytes produced */
+static size_t compress_step(compress_istream_t * istream, char * data, size_t len, bool * p_error)
+{
+    size_t produced = 0;
+
+#if defined(HAVE_ZLIB)
+    if (COMPRESS_ZLIB == istream->alg) {
+        istream->zs.next_in = (Bytef *)&istream->in_buf[istream->in_pos];
+        istream->zs.avail_in = (uInt)(istream->in_len - istream->in_pos);
+        istream->zs.next_out = (Bytef *)data;
+        istream->zs.avail_out = (uInt)((UINT32_MAX < len) ? UINT32_MAX : len);
+        int rc = deflate(&istream->zs, istream->b_inner_eof ? Z_FINISH : Z_NO_FLUSH);
+        istream->in_pos = istream->in_len - istream->zs.avail_in;
+        produced = (size_t)((Bytef *)istream->zs.next_out - (Bytef *)data);
+        if (Z_STREAM_END == rc) {
+            istream->b_finished = true;
+        } else if ((Z_OK != rc) && (Z_BUF_ERROR != rc)) {
+            *p_error = true;
+        }
+    }
+#endif
+#if defined(HAVE_ZSTD)
+    if (COMPRESS_ZSTD == istream->alg) {
+        ZSTD_inBuffer in = {&istream->in_buf[istream->in_pos], istream->in_len - istream->in_pos, 0};
+        ZSTD_outBuffer out = {data, len, 0};
+        size_t rc =
+            ZSTD_compressStream2(istream->p_zstd, &out, &in, istream->b_inner_eof ? ZSTD_e_end : ZSTD_e_continue);
+        istream->in_pos += in.pos;
+        produced = out.pos;
+        if (ZSTD_isError(rc)) {
+            *p_error = true;
+        } else if (istream->b_inner_eof && (0 == rc)) {
+            istream->b_finished = true;
+        }
+    }
+#endif
+
+    return produced;
+}
+
+size_t compress_istream_read(compress_istream_t * istream, char * data, size_t len, gta_errinfo_t * p_errinfo)
+{
+    size_t produced = 0;
+    bool b_error = false;
+
+    while ((produced < len) && (COMPRESS_HEADER_LEN > istream->header_pos)) {
+        data[produced++] = istream->header[istream->header_pos++];
+    }
+
+    while ((produced < len) && !istream->b_finished) {
+        if ((istream->in_pos == istream->in_len) && !istream->b_inner_eof) {
+            istream->in_pos = 0;
+            istream->in_len = 0;
+            if (istream->inner->eof(istream->inner, p_errinfo)) {
+                istream->b_inner_eof = true;
+            } else {
+                istream->in_len = istream->inner->read(istream->inner, istream->in_buf, COMPRESS_BUF_SIZE, p_errinfo);
+                if ((0 == istream->in_len) && !istream->inner->eof(istream->inner, p_errinfo)) {
+                    /* no progress without end of data */
+                    return 0;
+                }
+            }
+        }
+        produced += compress_step(istream, &data[produced], len - produced, &b_error);
+        if (b_error) {
+            *p_errinfo = GTA_ERROR_INTERNAL_ERROR;
+            return 0;
+        }
+    }
+
+    return produced;
+}
+
+bool compress_istream_eof(compress_istream_t * istream, gta_errinfo_t * p_errinfo)
+{
+    return istream->b_finished;
+}
+
+int compress_istream_init(compress_istream_t * istream, gtaio_istream_t * inner, enum compress_alg alg, int level)
+{
+    memset(istream, 0, sizeof(compress_istream_t));
+    istream->read = (gtaio_stream_read_t)compress_istream_read;
+    istream->eof = (gtaio_stream_eof_t)compress_istream_eof;
+    istream->inner = inner;
+    istream->alg = alg;
+    memcpy(istream->header, compress_magic, sizeof(compress_magic));
+    istream->header[COMPRESS_HEADER_LEN - 1] = (char)alg;
+
+#if defined(HAVE_ZLIB)
+    if (COMPRESS_ZLIB == alg) {
+        if (Z_OK != deflateInit(&istream->zs, (0 == level) ? Z_DEFAULT_COMPRESSION : level)) {
+            return EXIT_FAILURE;
+        }
+        istream->b_zs_init = true;
+        return EXIT_SUCCESS;
+    }
+#endif
+#if defined(HAVE_ZSTD)
+    if (COMPRESS_ZSTD == alg) {
+        istream->p_zstd = ZSTD_createCCtx();
+        if ((NULL == istream->p_zstd) ||
+            ((0 != level) && ZSTD_isError(ZSTD_CCtx_setParameter(istream->p_zstd, ZSTD_c_compressionLevel, level)))) {
+            compress_istream_free(istream);
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+#endif
+
+    return EXIT_FAILURE;
+}
+
+void compress_istream_free(compress_istream_t * istream)
+{
+#if defined(HAVE_ZLIB)
+    if (istream->b_zs_init) {
+        deflateEnd(&istream->zs);
+        istream->b_zs_init = false;
+    }
+#endif
+#if defined(HAVE_ZSTD)
+    ZSTD_freeCCtx(istream->p_zstd);
+    istream->p_zstd = NULL;
+#endif
+}
+
+/*
+ * decompress_ostream
+ */
+
+/* Evaluates the header and prepares decompression */
+static bool detect_header(decompress_ostream_t * ostream)
+{
+    ostream->b_detected = true;
+
+    if ((COMPRESS_HEADER_LEN != ostream->header_len) ||
+        (0 != memcmp(ostream->header, compress_magic, sizeof(compress_magic)))) {
+        fprintf(stderr, "Data is not compressed\n");
+        return false;
+    }
+
+    ostream->alg = (enum compress_alg)ostream->header[COMPRESS_HEADER_LEN - 1];
+#if defined(HAVE_ZLIB)
+    if (COMPRESS_ZLIB == ostream->alg) {
+        if (Z_OK != inflateInit(&ostream->zs)) {
+            return false;
+        }
+        ostream->b_zs_init = true;
+        return true;
+    }
+#endif
+#if defined(HAVE_ZSTD)
+    if (COMPRESS_ZSTD == ostream->alg) {
+        ostream->p_zstd = ZSTD_createDCtx();
+        return (NULL != ostream->p_zstd);
+    }
+#endif
+
+    fprintf(stderr, "Data is compressed with an algorithm not supported by this build\n");
+    return false;
+}
+
+/* Decompresses data and writes the result to the wrapped ostream */
+static bool decompress_data(decompress_ostream_t * ostream, const char * data, size_t len, gta_errinfo_t * p_errinfo)
+{
+    size_t consumed = 0;
+
+    while ((consumed < len) && !ostream->b_stream_end) {
+        size_t produced = 0;
+
+#if defined(HAVE_ZLIB)
+        if (COMPRESS_ZLIB == ostream->alg) {
+            size_t in_len = len - consumed;
+            ostream->zs.next_in = (Bytef *)&data[consumed];
+            ostream->zs.avail_in = (uInt)((UINT32_MAX < in_len) ? UINT32_MAX : in_len);
+            ostream->zs.next_out = (Bytef *)ostream->out_buf;
+            ostream->zs.avail_out = COMPRESS_BUF_SIZE;
+            uInt avail_in = ostream->zs.avail_in;
+            int rc = inflate(&ostream->zs, Z_NO_FLUSH);
+            if ((Z_OK != rc) && (Z_STREAM_END != rc) && (Z_BUF_ERROR != rc)) {
+                return false;
+            }
+            consumed += avail_in - ostream->zs.avail_in;
+            produced = COMPRESS_BUF_SIZE - ostream->zs.avail_out;
+            ostream->b_stream_end = (Z_STREAM_END == rc);
+        }
+#endif
+#if defined(HAVE_ZSTD)
+        if (COMPRESS_ZSTD == ostream->alg) {
+            ZSTD_inBuffer in = {&data[consumed], len - consumed, 0};
+            ZSTD_outBuffer out = {ostream->out_buf, COMPRESS_BUF_SIZE, 0};
+            size_t rc = ZSTD_decompressStream(ostream->p_zstd, &out, &in);
+            if (ZSTD_isError(rc)) {
+                return false;
+            }
+            consumed += in.pos;
+            produced = out.pos;
+            ostream->b_stream_end = (0 == rc);
+        }
+#endif
+
+        if ((0 < produced) &&
+            (produced != ostream->inner->write(ostream->inner, ostream->out_buf, produced, p_errinfo))) {
+            return false;
+        }
+    }
+
+    /* The compressed stream must be the last thing in the data */
+    if (consumed < len) {
+        fprintf(stderr, "Compressed data is followed by unexpected data\n");
+        ostream->b_trailing_data = true;
+        return false;
+    }
+
+    return true;
+}
+
+size_t decompress_ostream_write(
+    decompress_ostream_t * ostream,
+    const char * data,
+    size_t len,
+    gta_errinfo_t * p_errinfo)
+{
+    size_t consumed = 0;
+    bool b_ok = true;
+
+    if (!ostream->b_detected) {
+        while ((consumed < len) && (COMPRESS_HEADER_LEN > ostream->header_len)) {
+            ostream->header[ostream->header_len++] = data[consumed++];
+        }
+        if (COMPRESS_HEADER_LEN > ostream->header_len) {
+            return len;
+        }
+        if (!detect_header(ostream)) {
+            *p_errinfo = GTA_ERROR_INTERNAL_ERROR;
+            return 0;
+        }
+    }
+
+    if (consumed < len) {
+        if (COMPRESS_NONE == ostream->alg) {
+            b_ok =
+                ((len - consumed) == ostream->inner->write(ostream->inner, &data[consumed], len - consumed, p_errinfo));
+        } else {
+            b_ok = decompress_data(ostream, &data[consumed], len - consumed, p_errinfo);
+        }
+    }
+    if (!b_ok) {
+        *p_errinfo = GTA_ERROR_INTERNAL_ERROR;
+        return 0;
+    }
+
+    return len;
+}
+
+bool decompress_ostream_finish(decompress_ostream_t * ostream, gta_errinfo_t errinfo, gta_errinfo_t * p_errinfo)
+{
+    bool b_ok = true;
+
+    if (0 == errinfo) {
+        if (!ostream->b_detected) {
+            /* less data than the header */
+            b_ok = detect_header(ostream);
+        } else if ((COMPRESS_NONE != ostream->alg) && !ostream->b_stream_end) {
+            fprintf(stderr, "Compressed data is truncated\n");
+            b_ok = false;
+        } else if (ostream->b_trailing_data) {
+            b_ok = false;
+        }
+        if (!b_ok) {
+            errinfo = GTA_ERROR_INTERNAL_ERROR;
+        }
+    }
+
+    return ostream->inner->finish(ostream->inner, errinfo, p_errinfo) && b_ok;
+}
+
+void decompress_ostream_init(decompress_ostream_t * ostream, gtaio_ostream_t * inner, bool b_compressed)
+{
+    memset(ostream, 0, sizeof(decompress_ostream_t));
+    ostream->write = (gtaio_stream_write_t)decompress_ostream_write;
+    ostream->finish = (gtaio_stream_finish_t)decompress_ostream_finish;
+    ostream->inner = inner;
+    ostream->alg = COMPRESS_NONE;
+    /* Without compression there is no header to be detected */
+    ostream->b_detected = !b_compressed;
+}
+
+void decompress_ostream_free(decompress_ostream_t * ostream)
+{
+#if defined(HAVE_ZLIB)
+    if (ostream->b_zs_init) {
+        inflateEnd(&ostream->zs);
+        ostream->b_zs_init = false;
+    }
+#endif
+#if defined(HAVE_ZSTD)
+    ZSTD_freeDCtx(ostream->p_zstd);
+    ostream->p_zstd = NULL;
+#endif
+    /* the buffer may contain unsealed data */
+    gta_memset(ostream->out_buf, sizeof(ostream->out_buf), 0, sizeof(ostream->out_buf));
+}
+
+/*** end of file ***/
@@ -0,0 +1,137 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef GTA_CLI_COMPRESS_H
+#define GTA_CLI_COMPRESS_H
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+extern "C" {
+/* *INDENT-ON* */
+#endif
+
+/*---------------------------------------------------------------------*/
+
+#include <gta_api/gta_api.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#if defined(HAVE_ZLIB)
+#include <zlib.h>
+#endif
+#if defined(HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+/*
+ * Streaming compression in front of gta_seal_data and decompression behind
+ * gta_unseal_data. Compressed data starts with a header (magic and
+ * algorithm). Whether the data is compressed is not derived from the
+ * plaintext, as uncompressed data may start with the magic as well: the
+ * decompression stage is only enabled by the caller (unseal_data
+ * --decompress or the flag of a chunked container), and then requires the
+ * header. Both stages use fixed-size buffers.
+ */
+
+/* Length of the header: 8 bytes magic, 1 byte algorithm */
+#define COMPRESS_HEADER_LEN 9
+/* Size of the internal buffers of the stages */
+#define COMPRESS_BUF_SIZE 16384
+
+enum compress_alg {
+    COMPRESS_NONE = 0,
+    COMPRESS_ZLIB = 1,
+    COMPRESS_ZSTD = 2,
+};
+
+/* Parses "zlib[:LEVEL]" or "zstd[:LEVEL]", fails if the algorithm is not supported by this build */
+int compress_parse(const char * p_spec, enum compress_alg * p_alg, int * p_level);
+
+/* gtaio_istream compressing the data read from the wrapped istream */
+typedef struct compress_istream {
+    /* public interface as defined for gtaio_istream */
+    gtaio_stream_read_t read;
+    gtaio_stream_eof_t eof;
+    void * p_reserved2;
+    void * p_reserved3;
+
+    /* private implementation details */
+    gtaio_istream_t * inner; /* wrapped istream */
+    enum compress_alg alg;
+    char header[COMPRESS_HEADER_LEN];
+    size_t header_pos;              /* number of header bytes already returned */
+    char in_buf[COMPRESS_BUF_SIZE]; /* uncompressed data read from inner */
+    size_t in_len;
+    size_t in_pos;
+    bool b_inner_eof;
+    bool b_finished; /* all compressed data has been returned */
+#if defined(HAVE_ZLIB)
+    z_stream zs;
+    bool b_zs_init;
+#endif
+#if defined(HAVE_ZSTD)
+    ZSTD_CCtx * p_zstd;
+#endif
+} compress_istream_t;
+
+size_t compress_istream_read(compress_istream_t * istream, char * data, size_t len, gta_errinfo_t * p_errinfo);
+
+bool compress_istream_eof(compress_istream_t * istream, gta_errinfo_t * p_errinfo);
+
+int compress_istream_init(compress_istream_t * istream, gtaio_istream_t * inner, enum compress_alg alg, int level);
+
+void compress_istream_free(compress_istream_t * istream);
+
+/* gtaio_ostream decompressing the data written to it, or passing it through unchanged if not enabled */
+typedef struct decompress_ostream {
+    /* public interface as defined for gtaio_ostream */
+    void * p_reserved0;
+    void * p_reserved1;
+    gtaio_stream_write_t write;
+    gtaio_stream_finish_t finish;
+
+    /* private implementation details */
+    gtaio_ostream_t * inner; /* wrapped ostream */
+    enum compress_alg alg;   /* COMPRESS_NONE if the data is passed through */
+    bool b_detected;         /* header has been evaluated */
+    bool b_stream_end;       /* end of the compressed stream has been reached */
+    bool b_trailing_data;    /* data has been written after the end of the compressed stream */
+    char header[COMPRESS_HEADER_LEN];
+    size_t header_len;
+    char out_buf[COMPRESS_BUF_SIZE]; /* decompressed data to be written to inner */
+#if defined(HAVE_ZLIB)
+    z_stream zs;
+    bool b_zs_init;
+#endif
+#if defined(HAVE_ZSTD)
+    ZSTD_DCtx * p_zstd;
+#endif
+} decompress_ostream_t;
+
+size_t decompress_ostream_write(
+    decompress_ostream_t * ostream,
+    const char * data,
+    size_t len,
+    gta_errinfo_t * p_errinfo);
+
+bool decompress_ostream_finish(decompress_ostream_t * ostream, gta_errinfo_t errinfo, gta_errinfo_t * p_errinfo);
+
+/* With b_compressed the data must start with the compression header, otherwise all data is passed through */
+void decompress_ostream_init(decompress_ostream_t * ostream, gtaio_ostream_t * inner, bool b_compressed);
+
+void decompress_ostream_free(decompress_ostream_t * ostream);
+
+/*---------------------------------------------------------------------*/
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+}
+/* *INDENT-ON* */
+#endif
+
+#endif /* GTA_CLI_COMPRESS_H */
+
+/*** end of file ***/
@@ -0,0 +1,169 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* memfd_create and the file sealing constants */
+#define _GNU_SOURCE
+
+#include "exec_secrets.h"
+
+#include "streams.h"
+#include "trace.h"
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* Seals applied to a memfd after the plaintext has been written */
+#define MEMFD_SEALS (F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL)
+
+/* gtaio_ostream writing to a file descriptor, used by gta_unseal_data */
+typedef struct fd_ostream {
+    /* public interface as defined for gtaio_ostream */
+    void * p_reserved0;
+    void * p_reserved1;
+    gtaio_stream_write_t write;
+    gtaio_stream_finish_t finish;
+
+    /* private implementation details */
+    int fd;
+} fd_ostream_t;
+
+static size_t fd_ostream_write(fd_ostream_t * ostream, const char * data, size_t len, gta_errinfo_t * p_errinfo)
+{
+    size_t written = 0;
+
+    while (written < len) {
+        ssize_t ret = write(ostream->fd, &data[written], len - written);
+        if (0 > ret) {
+            if (EINTR == errno) {
+                continue;
+            }
+            *p_errinfo = GTA_ERROR_INTERNAL_ERROR;
+            break;
+        }
+        written += (size_t)ret;
+    }
+    return written;
+}
+
+static bool fd_ostream_finish(fd_ostream_t * ostream, gta_errinfo_t errinfo, gta_errinfo_t * p_errinfo)
+{
+    return true;
+}
+
+bool exec_secret_check_name(const char * p_name)
+{
+    if (('\0' == *p_name) || isdigit((unsigned char)*p_name)) {
+        return false;
+    }
+    for (const char * p = p_name; '\0' != *p; ++p) {
+        if (!isalnum((unsigned char)*p) && ('_' != *p)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Unseals the file p_sealed to ostream */
+static int unseal_file(
+    gta_context_handle_t h_ctx,
+    const char * p_sealed,
+    gtaio_ostream_t * p_ostream,
+    gta_errinfo_t * p_errinfo)
+{
+    myio_ifilestream_t istream = {0};
+    gta_errinfo_t errinfo = 0;
+    int ret = EXIT_FAILURE;
+
+    if (!myio_open_ifilestream(&istream, p_sealed, &errinfo)) {
+        fprintf(stderr, "Cannot open file %s\n", p_sealed);
+        return EXIT_FAILURE;
+    }
+    if (!TRACE_BOOL(gta_unseal_data, (h_ctx, (gtaio_istream_t *)&istream, p_ostream, p_errinfo), p_errinfo)) {
+        fprintf(stderr, "gta_unseal_data failed for %s with ERROR_CODE %ld\n", p_sealed, *p_errinfo);
+    } else {
+        ret = EXIT_SUCCESS;
+    }
+    myio_close_ifilestream(&istream, &errinfo);
+    return ret;
+}
+
+int exec_secret_to_memfd(
+    gta_context_handle_t h_ctx,
+    const char * p_name,
+    const char * p_sealed,
+    gta_errinfo_t * p_errinfo)
+{
+    fd_ostream_t ostream = {
+        .write = (gtaio_stream_write_t)fd_ostream_write,
+        .finish = (gtaio_stream_finish_t)fd_ostream_finish,
+        .fd = -1,
+    };
+    char path[32] = {0};
+
+    /* Without MFD_CLOEXEC the memfd is inherited by the child */
+    ostream.fd = memfd_create(p_name, MFD_ALLOW_SEALING);
+    if (0 > ostream.fd) {
+        fprintf(stderr, "Cannot create memfd for secret %s: %s\n", p_name, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (EXIT_SUCCESS != unseal_file(h_ctx, p_sealed, (gtaio_ostream_t *)&ostream, p_errinfo)) {
+        goto err;
+    }
+    if ((0 != fcntl(ostream.fd, F_ADD_SEALS, MEMFD_SEALS)) || (0 != lseek(ostream.fd, 0, SEEK_SET))) {
+        fprintf(stderr, "Cannot seal memfd for secret %s: %s\n", p_name, strerror(errno));
+        goto err;
+    }
+    snprintf(path, sizeof(path), "/dev/fd/%d", ostream.fd);
+    if (0 != setenv(p_name, path, 1)) {
+        fprintf(stderr, "Cannot set environment variable %s: %s\n", p_name, strerror(errno));
+        goto err;
+    }
+    return EXIT_SUCCESS;
+
+err:
+    close(ostream.fd);
+    return EXIT_FAILURE;
+}
+
+int exec_secret_to_env(
+    gta_context_handle_t h_ctx,
+    const char * p_name,
+    const char * p_sealed,
+    gta_errinfo_t * p_errinfo)
+{
+    ostream_to_dynbuf_t ostream = {0};
+    int ret = EXIT_FAILURE;
+
+    ostream_to_dynbuf_init(&ostream);
+    if (EXIT_SUCCESS != unseal_file(h_ctx, p_sealed, (gtaio_ostream_t *)&ostream, p_errinfo)) {
+        goto cleanup;
+    }
+    /* The terminating NUL is written with the data, the buffer is zeroed when it is freed */
+    char nul = '\0';
+    if (1 != ostream_to_dynbuf_write(&ostream, &nul, 1, p_errinfo)) {
+        goto cleanup;
+    }
+    if (strlen(ostream.buf) != (ostream.buf_pos - 1)) {
+        fprintf(stderr, "Secret %s contains a NUL character, use --secret instead\n", p_name);
+        goto cleanup;
+    }
+    if (0 != setenv(p_name, ostream.buf, 1)) {
+        fprintf(stderr, "Cannot set environment variable %s: %s\n", p_name, strerror(errno));
+        goto cleanup;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    ostream_to_dynbuf_free(&ostream);
+    return ret;
+}
+
+/*** end of file ***/
@@ -0,0 +1,56 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef GTA_CLI_EXEC_SECRETS_H
+#define GTA_CLI_EXEC_SECRETS_H
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+extern "C" {
+/* *INDENT-ON* */
+#endif
+
+/*---------------------------------------------------------------------*/
+
+#include <gta_api/gta_api.h>
+#include <stdbool.h>
+
+/*
+ * Secrets for a child process started with execvp. The sealed data is
+ * unsealed in memory, either into an anonymous file created with
+ * memfd_create or into an environment variable, and is never written to
+ * the file system. A memfd is sealed against modification, inherited by
+ * the child and announced as NAME=/dev/fd/N in the environment.
+ */
+
+/* Returns true if p_name can be used as name of an environment variable */
+bool exec_secret_check_name(const char * p_name);
+
+/* Unseals the file p_sealed into a sealed memfd and sets NAME=/dev/fd/N */
+int exec_secret_to_memfd(
+    gta_context_handle_t h_ctx,
+    const char * p_name,
+    const char * p_sealed,
+    gta_errinfo_t * p_errinfo);
+
+/* Unseals the file p_sealed and sets NAME to the plaintext, which must not contain a NUL character */
+int exec_secret_to_env(
+    gta_context_handle_t h_ctx,
+    const char * p_name,
+    const char * p_sealed,
+    gta_errinfo_t * p_errinfo);
+
+/*---------------------------------------------------------------------*/
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+}
+/* *INDENT-ON* */
+#endif
+
+#endif /* GTA_CLI_EXEC_SECRETS_H */
+
+/*** end of file ***/
@@ -0,0 +1,515 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "incremental.h"
+
+#include "streams.h"
+#include "trace.h"
+#include <dirent.h>
+#include <errno.h>
+#include <openssl/evp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define INCREMENTAL_MAGIC "GTAINCR1"
+#define INCREMENTAL_VERSION 1
+#define INCREMENTAL_HEADER_LEN 40
+#define INCREMENTAL_ENTRY_LEN 56
+#define INCREMENTAL_MD_LEN 32
+#define INCREMENTAL_READ_BUF_SIZE 65536
+#define INCREMENTAL_TMP_SUFFIX ".tmp"
+
+typedef struct incremental_entry {
+    char * p_path;       /* relative to the directory */
+    uint64_t size;
+    uint64_t mtime_ns;
+    unsigned char hash[INCREMENTAL_MD_LEN];
+} incremental_entry_t;
+
+typedef struct incremental_index {
+    uint64_t run_ns; /* start of the run which has written the index */
+    char * p_pers;
+    char * p_prof;
+    incremental_entry_t * p_entries; /* sorted by path */
+    size_t num_entries;
+    size_t entries_size;
+} incremental_index_t;
+
+static void put_u64(char * p_buf, uint64_t value)
+{
+    for (size_t i = 0; i < 8; ++i) {
+        p_buf[i] = (char)((value >> (8 * i)) & 0xff);
+    }
+}
+
+static void put_u32(char * p_buf, uint32_t value)
+{
+    for (size_t i = 0; i < 4; ++i) {
+        p_buf[i] = (char)((value >> (8 * i)) & 0xff);
+    }
+}
+
+static uint64_t get_u64(const char * p_buf)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        value |= (uint64_t)(unsigned char)p_buf[i] << (8 * i);
+    }
+    return value;
+}
+
+static uint32_t get_u32(const char * p_buf)
+{
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        value |= (uint32_t)(unsigned char)p_buf[i] << (8 * i);
+    }
+    return value;
+}
+
+static char * join_path(const char * p_dir, const char * p_name, const char * p_suffix)
+{
+    size_t len = strlen(p_dir) + 1 + strlen(p_name) + strlen(p_suffix) + 1;
+    char * p_path = malloc(len);
+
+    if (NULL != p_path) {
+        snprintf(p_path, len, "%s/%s%s", p_dir, p_name, p_suffix);
+    }
+    return p_path;
+}
+
+static bool has_suffix(const char * p_name, const char * p_suffix)
+{
+    size_t len = strlen(p_name);
+    size_t suffix_len = strlen(p_suffix);
+    return (len >= suffix_len) && (0 == strcmp(&p_name[len - suffix_len], p_suffix));
+}
+
+static int compare_entries(const void * p_a, const void * p_b)
+{
+    return strcmp(((const incremental_entry_t *)p_a)->p_path, ((const incremental_entry_t *)p_b)->p_path);
+}
+
+/* Appends an entry, the index takes the ownership of p_path */
+static incremental_entry_t * add_entry(incremental_index_t * p_index, char * p_path)
+{
+    if (p_index->num_entries == p_index->entries_size) {
+        size_t new_size = (0 == p_index->entries_size) ? 64 : (2 * p_index->entries_size);
+        incremental_entry_t * p_new = realloc(p_index->p_entries, new_size * sizeof(incremental_entry_t));
+        if (NULL == p_new) {
+            free(p_path);
+            return NULL;
+        }
+        p_index->p_entries = p_new;
+        p_index->entries_size = new_size;
+    }
+    incremental_entry_t * p_entry = &p_index->p_entries[p_index->num_entries++];
+    memset(p_entry, 0, sizeof(*p_entry));
+    p_entry->p_path = p_path;
+    return p_entry;
+}
+
+static void free_index(incremental_index_t * p_index)
+{
+    for (size_t i = 0; i < p_index->num_entries; ++i) {
+        free(p_index->p_entries[i].p_path);
+    }
+    free(p_index->p_entries);
+    free(p_index->p_pers);
+    free(p_index->p_prof);
+    memset(p_index, 0, sizeof(*p_index));
+}
+
+/* Parses the content of an index file, returns false if it is invalid */
+static bool parse_index(const char * p_buf, size_t len, incremental_index_t * p_index)
+{
+    if ((INCREMENTAL_HEADER_LEN > len) || (0 != memcmp(p_buf, INCREMENTAL_MAGIC, 8)) ||
+        (INCREMENTAL_VERSION != get_u32(&p_buf[8]))) {
+        return false;
+    }
+    p_index->run_ns = get_u64(&p_buf[16]);
+    uint64_t num_entries = get_u64(&p_buf[24]);
+    size_t pers_len = get_u32(&p_buf[32]);
+    size_t prof_len = get_u32(&p_buf[36]);
+    size_t pos = INCREMENTAL_HEADER_LEN;
+
+    if ((pers_len + prof_len) > (len - pos)) {
+        return false;
+    }
+    p_index->p_pers = strndup(&p_buf[pos], pers_len);
+    p_index->p_prof = strndup(&p_buf[pos + pers_len], prof_len);
+    if ((NULL == p_index->p_pers) || (NULL == p_index->p_prof)) {
+        return false;
+    }
+    pos += pers_len + prof_len;
+
+    for (uint64_t i = 0; i < num_entries; ++i) {
+        if (INCREMENTAL_ENTRY_LEN > (len - pos)) {
+            return false;
+        }
+        const char * p_raw = &p_buf[pos];
+        size_t path_len = get_u32(p_raw);
+        pos += INCREMENTAL_ENTRY_LEN;
+        if ((0 == path_len) || (path_len > (len - pos))) {
+            return false;
+        }
+        char * p_path = strndup(&p_buf[pos], path_len);
+        incremental_entry_t * p_entry = (NULL == p_path) ? NULL : add_entry(p_index, p_path);
+        if (NULL == p_entry) {
+            return false;
+        }
+        p_entry->size = get_u64(&p_raw[8]);
+        p_entry->mtime_ns = get_u64(&p_raw[16]);
+        memcpy(p_entry->hash, &p_raw[24], INCREMENTAL_MD_LEN);
+        pos += path_len;
+    }
+    qsort(p_index->p_entries, p_index->num_entries, sizeof(incremental_entry_t), compare_entries);
+    return true;
+}
+
+/* Loads the index of the last run, a missing or invalid index is treated as empty */
+static int load_index(const char * p_path, incremental_index_t * p_index)
+{
+    FILE * p_file = fopen(p_path, "rb");
+    ostream_to_dynbuf_t content = {0};
+    char buf[INCREMENTAL_READ_BUF_SIZE];
+    gta_errinfo_t errinfo = 0;
+    size_t len = 0;
+    int ret = EXIT_FAILURE;
+
+    if (NULL == p_file) {
+        if (ENOENT == errno) {
+            return EXIT_SUCCESS;
+        }
+        fprintf(stderr, "Cannot open index %s: %s\n", p_path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    ostream_to_dynbuf_init(&content);
+    while (0 < (len = fread(buf, 1, sizeof(buf), p_file))) {
+        if (len != ostream_to_dynbuf_write(&content, buf, len, &errinfo)) {
+            fprintf(stderr, "Memory allocation error\n");
+            goto cleanup;
+        }
+    }
+    if (ferror(p_file)) {
+        fprintf(stderr, "Cannot read index %s\n", p_path);
+        goto cleanup;
+    }
+    if (!parse_index(content.buf, content.buf_pos, p_index)) {
+        fprintf(stderr, "Index %s is invalid, all files are hashed again\n", p_path);
+        free_index(p_index);
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    fclose(p_file);
+    ostream_to_dynbuf_free(&content);
+    return ret;
+}
+
+/* Collects the regular files below p_root/p_rel, seals and the index (p_index_st) are skipped */
+static int walk_dir(
+    const char * p_root,
+    const char * p_rel,
+    const struct stat * p_index_st,
+    incremental_index_t * p_files)
+{
+    char * p_dir = ('\0' == *p_rel) ? strdup(p_root) : join_path(p_root, p_rel, "");
+    DIR * p_d = (NULL == p_dir) ? NULL : opendir(p_dir);
+    struct dirent * p_dirent = NULL;
+    int ret = EXIT_FAILURE;
+
+    if (NULL == p_d) {
+        fprintf(stderr, "Cannot open directory %s\n", (NULL != p_dir) ? p_dir : p_root);
+        free(p_dir);
+        return EXIT_FAILURE;
+    }
+    while (NULL != (p_dirent = readdir(p_d))) {
+        struct stat st = {0};
+        const char * p_name = p_dirent->d_name;
+        if ((0 == strcmp(p_name, ".")) || (0 == strcmp(p_name, "..")) ||
+            has_suffix(p_name, INCREMENTAL_SEAL_SUFFIX) ||
+            has_suffix(p_name, INCREMENTAL_SEAL_SUFFIX INCREMENTAL_TMP_SUFFIX)) {
+            continue;
+        }
+        char * p_child = ('\0' == *p_rel) ? strdup(p_name) : join_path(p_rel, p_name, "");
+        char * p_full = join_path(p_root, (NULL != p_child) ? p_child : "", "");
+        if ((NULL == p_child) || (NULL == p_full)) {
+            fprintf(stderr, "Memory allocation error\n");
+            free(p_child);
+            free(p_full);
+            goto cleanup;
+        }
+        /* Symbolic links are not followed */
+        if (0 != lstat(p_full, &st)) {
+            fprintf(stderr, "Cannot access %s\n", p_full);
+            free(p_child);
+            free(p_full);
+            goto cleanup;
+        }
+        free(p_full);
+        if (S_ISDIR(st.st_mode)) {
+            int result = walk_dir(p_root, p_child, p_index_st, p_files);
+            free(p_child);
+            if (EXIT_SUCCESS != result) {
+                goto cleanup;
+            }
+        } else if (S_ISREG(st.st_mode) && ((NULL == p_index_st) || (st.st_dev != p_index_st->st_dev) ||
+                                          (st.st_ino != p_index_st->st_ino))) {
+            incremental_entry_t * p_entry = add_entry(p_files, p_child);
+            if (NULL == p_entry) {
+                fprintf(stderr, "Memory allocation error\n");
+                goto cleanup;
+            }
+            p_entry->size = (uint64_t)st.st_size;
+            p_entry->mtime_ns = ((uint64_t)st.st_mtim.tv_sec * 1000000000) + (uint64_t)st.st_mtim.tv_nsec;
+        } else {
+            free(p_child);
+        }
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    closedir(p_d);
+    free(p_dir);
+    return ret;
+}
+
+static int hash_file(EVP_MD_CTX * p_ctx, const char * p_path, unsigned char * p_hash)
+{
+    char buf[INCREMENTAL_READ_BUF_SIZE];
+    size_t len = 0;
+    int ret = EXIT_FAILURE;
+    FILE * p_file = fopen(p_path, "rb");
+
+    if (NULL == p_file) {
+        fprintf(stderr, "Cannot open file %s\n", p_path);
+        return EXIT_FAILURE;
+    }
+    if (1 != EVP_DigestInit_ex(p_ctx, EVP_sha256(), NULL)) {
+        goto cleanup;
+    }
+    while (0 < (len = fread(buf, 1, sizeof(buf), p_file))) {
+        if (1 != EVP_DigestUpdate(p_ctx, buf, len)) {
+            goto cleanup;
+        }
+    }
+    if (ferror(p_file)) {
+        fprintf(stderr, "Cannot read file %s\n", p_path);
+        goto cleanup;
+    }
+    if (1 == EVP_DigestFinal_ex(p_ctx, p_hash, NULL)) {
+        ret = EXIT_SUCCESS;
+    }
+
+cleanup:
+    fclose(p_file);
+    return ret;
+}
+
+/* Writes the seal of p_root/p_rel to its seal path, the seal is renamed into place when it is complete */
+static int seal_file(gta_context_handle_t h_ctx, const char * p_root, const char * p_rel, gta_errinfo_t * p_errinfo)
+{
+    int ret = EXIT_FAILURE;
+    myio_ifilestream_t istream = {0};
+    myio_ofilestream_t ostream = {0};
+    char * p_path = join_path(p_root, p_rel, "");
+    char * p_seal = join_path(p_root, p_rel, INCREMENTAL_SEAL_SUFFIX);
+    char * p_tmp = join_path(p_root, p_rel, INCREMENTAL_SEAL_SUFFIX INCREMENTAL_TMP_SUFFIX);
+
+    if ((NULL == p_path) || (NULL == p_seal) || (NULL == p_tmp)) {
+        fprintf(stderr, "Memory allocation error\n");
+        goto cleanup;
+    }
+    if (!myio_open_ifilestream(&istream, p_path, p_errinfo)) {
+        fprintf(stderr, "Cannot open file %s\n", p_path);
+        goto cleanup;
+    }
+    if (!myio_open_ofilestream(&ostream, p_tmp, p_errinfo)) {
+        fprintf(stderr, "Cannot open file %s\n", p_tmp);
+        goto cleanup;
+    }
+    bool b_ok = TRACE_BOOL(
+        gta_authenticate_data_detached,
+        (h_ctx, (gtaio_istream_t *)&istream, (gtaio_ostream_t *)&ostream, p_errinfo),
+        p_errinfo);
+    if (!b_ok) {
+        fprintf(stderr, "gta_authenticate_data_detached failed for %s with ERROR_CODE %ld\n", p_path, *p_errinfo);
+    }
+    b_ok = (0 == fflush(ostream.file)) && b_ok;
+    myio_close_ofilestream(&ostream, p_errinfo);
+    if (!b_ok || (0 != rename(p_tmp, p_seal))) {
+        remove(p_tmp);
+        goto cleanup;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    if (NULL != istream.file) {
+        myio_close_ifilestream(&istream, p_errinfo);
+    }
+    free(p_path);
+    free(p_seal);
+    free(p_tmp);
+    return ret;
+}
+
+/* Writes the index to a temporary file which replaces the index when it is complete */
+static int write_index(const char * p_path, const incremental_index_t * p_index)
+{
+    char header[INCREMENTAL_HEADER_LEN] = {0};
+    char * p_tmp = malloc(strlen(p_path) + sizeof(INCREMENTAL_TMP_SUFFIX));
+    FILE * p_file = NULL;
+    bool b_ok = false;
+
+    if (NULL == p_tmp) {
+        fprintf(stderr, "Memory allocation error\n");
+        return EXIT_FAILURE;
+    }
+    sprintf(p_tmp, "%s%s", p_path, INCREMENTAL_TMP_SUFFIX);
+    p_file = fopen(p_tmp, "wb");
+    if (NULL == p_file) {
+        fprintf(stderr, "Cannot create file %s\n", p_tmp);
+        free(p_tmp);
+        return EXIT_FAILURE;
+    }
+
+    memcpy(header, INCREMENTAL_MAGIC, 8);
+    put_u32(&header[8], INCREMENTAL_VERSION);
+    put_u64(&header[16], p_index->run_ns);
+    put_u64(&header[24], p_index->num_entries);
+    put_u32(&header[32], (uint32_t)strlen(p_index->p_pers));
+    put_u32(&header[36], (uint32_t)strlen(p_index->p_prof));
+    b_ok = (1 == fwrite(header, sizeof(header), 1, p_file)) &&
+           (strlen(p_index->p_pers) == fwrite(p_index->p_pers, 1, strlen(p_index->p_pers), p_file)) &&
+           (strlen(p_index->p_prof) == fwrite(p_index->p_prof, 1, strlen(p_index->p_prof), p_file));
+    for (size_t i = 0; b_ok && (i < p_index->num_entries); ++i) {
+        const incremental_entry_t * p_entry = &p_index->p_entries[i];
+        char raw[INCREMENTAL_ENTRY_LEN] = {0};
+        size_t path_len = strlen(p_entry->p_path);
+
+        put_u32(raw, (uint32_t)path_len);
+        put_u64(&raw[8], p_entry->size);
+        put_u64(&raw[16], p_entry->mtime_ns);
+        memcpy(&raw[24], p_entry->hash, INCREMENTAL_MD_LEN);
+        b_ok = (1 == fwrite(raw, sizeof(raw), 1, p_file)) && (path_len == fwrite(p_entry->p_path, 1, path_len, p_file));
+    }
+    b_ok = b_ok && (0 == fflush(p_file)) && (0 == fsync(fileno(p_file)));
+    b_ok = (0 == fclose(p_file)) && b_ok;
+    if (!b_ok || (0 != rename(p_tmp, p_path))) {
+        fprintf(stderr, "Cannot write index %s\n", p_path);
+        remove(p_tmp);
+        free(p_tmp);
+        return EXIT_FAILURE;
+    }
+    free(p_tmp);
+    return EXIT_SUCCESS;
+}
+
+int incremental_authenticate(
+    gta_instance_handle_t h_inst,
+    const char * p_pers,
+    const char * p_prof,
+    const char * p_dir,
+    const char * p_index,
+    gtaio_ostream_t * p_ostream,
+    gta_errinfo_t * p_errinfo)
+{
+    int ret = EXIT_FAILURE;
+    incremental_index_t old_index = {0};
+    incremental_index_t index = {0};
+    struct stat index_st = {0};
+    struct timespec now = {0};
+    gta_context_handle_t h_ctx = GTA_HANDLE_INVALID;
+    EVP_MD_CTX * p_md_ctx = EVP_MD_CTX_new();
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    index.run_ns = ((uint64_t)now.tv_sec * 1000000000) + (uint64_t)now.tv_nsec;
+    index.p_pers = strdup(p_pers);
+    index.p_prof = strdup(p_prof);
+    if ((NULL == p_md_ctx) || (NULL == index.p_pers) || (NULL == index.p_prof)) {
+        fprintf(stderr, "Memory allocation error\n");
+        goto cleanup;
+    }
+    if ((EXIT_SUCCESS != load_index(p_index, &old_index)) ||
+        (EXIT_SUCCESS != walk_dir(p_dir, "", (0 == stat(p_index, &index_st)) ? &index_st : NULL, &index))) {
+        goto cleanup;
+    }
+    qsort(index.p_entries, index.num_entries, sizeof(incremental_entry_t), compare_entries);
+
+    /* Seals of another personality or profile are replaced */
+    bool b_same_key = (NULL != old_index.p_pers) && (0 == strcmp(old_index.p_pers, p_pers)) &&
+                      (0 == strcmp(old_index.p_prof, p_prof));
+    for (size_t i = 0; i < index.num_entries; ++i) {
+        incremental_entry_t * p_entry = &index.p_entries[i];
+        const incremental_entry_t * p_old = NULL;
+        struct stat seal_st = {0};
+
+        if (0 != old_index.num_entries) {
+            p_old = bsearch(
+                p_entry, old_index.p_entries, old_index.num_entries, sizeof(incremental_entry_t), compare_entries);
+        }
+        /* A file modified during the last run may have changed after it was hashed */
+        if ((NULL != p_old) && (p_old->size == p_entry->size) && (p_old->mtime_ns == p_entry->mtime_ns) &&
+            (p_entry->mtime_ns < old_index.run_ns)) {
+            memcpy(p_entry->hash, p_old->hash, INCREMENTAL_MD_LEN);
+        } else {
+            char * p_path = join_path(p_dir, p_entry->p_path, "");
+            int result = (NULL == p_path) ? EXIT_FAILURE : hash_file(p_md_ctx, p_path, p_entry->hash);
+            free(p_path);
+            if (EXIT_SUCCESS != result) {
+                goto cleanup;
+            }
+        }
+
+        char * p_seal = join_path(p_dir, p_entry->p_path, INCREMENTAL_SEAL_SUFFIX);
+        bool b_seal_exists = (NULL != p_seal) && (0 == stat(p_seal, &seal_st));
+        free(p_seal);
+        if (b_same_key && (NULL != p_old) && b_seal_exists &&
+            (0 == memcmp(p_old->hash, p_entry->hash, INCREMENTAL_MD_LEN))) {
+            continue;
+        }
+
+        /* The context is only opened if a file has to be authenticated */
+        if (GTA_HANDLE_INVALID == h_ctx) {
+            h_ctx = TRACE_PTR(gta_context_open, (h_inst, p_pers, p_prof, p_errinfo), p_errinfo);
+            if (GTA_HANDLE_INVALID == h_ctx) {
+                fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", *p_errinfo);
+                goto cleanup;
+            }
+        }
+        if (EXIT_SUCCESS != seal_file(h_ctx, p_dir, p_entry->p_path, p_errinfo)) {
+            goto cleanup;
+        }
+        size_t len = strlen(p_entry->p_path);
+        if ((len != p_ostream->write(p_ostream, p_entry->p_path, len, p_errinfo)) ||
+            (1 != p_ostream->write(p_ostream, "\n", 1, p_errinfo))) {
+            goto cleanup;
+        }
+    }
+    if (!p_ostream->finish(p_ostream, 0, p_errinfo) || (EXIT_SUCCESS != write_index(p_index, &index))) {
+        goto cleanup;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    if ((GTA_HANDLE_INVALID != h_ctx) && !TRACE_BOOL(gta_context_close, (h_ctx, p_errinfo), p_errinfo)) {
+        fprintf(stderr, "gta_context_close failed with ERROR_CODE %ld\n", *p_errinfo);
+        ret = EXIT_FAILURE;
+    }
+    EVP_MD_CTX_free(p_md_ctx);
+    free_index(&old_index);
+    free_index(&index);
+    return ret;
+}
+
+/*** end of file ***/
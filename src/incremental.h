@@ -0,0 +1,61 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef GTA_CLI_INCREMENTAL_H
+#define GTA_CLI_INCREMENTAL_H
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+extern "C" {
+/* *INDENT-ON* */
+#endif
+
+/*---------------------------------------------------------------------*/
+
+#include <gta_api/gta_api.h>
+
+/*
+ * Incremental authentication of a directory tree. Every regular file gets a
+ * detached seal "<file>.seal". The index keeps the state of the last run,
+ * all integers are stored little-endian:
+ *
+ *   header:  magic "GTAINCR1", u32 version, u32 reserved, u64 time of the
+ *            run (ns since the epoch), u64 number of entries, u32 length of
+ *            the personality, u32 length of the profile, personality, profile
+ *   entry:   u32 length of the path, u32 reserved, u64 size, u64
+ *            modification time (ns since the epoch), SHA-256 of the content,
+ *            path relative to the directory (the seal path is the path with
+ *            the suffix ".seal")
+ *
+ * A file is hashed again only if its size or modification time differs
+ * from the index, or if it was modified during the run which wrote the
+ * index. It is authenticated only if its hash differs, its seal is missing
+ * or the personality or profile has changed.
+ */
+
+#define INCREMENTAL_SEAL_SUFFIX ".seal"
+
+/* Authenticates the changed files of p_dir, writes the paths of the authenticated files to ostream */
+int incremental_authenticate(
+    gta_instance_handle_t h_inst,
+    const char * p_pers,
+    const char * p_prof,
+    const char * p_dir,
+    const char * p_index,
+    gtaio_ostream_t * p_ostream,
+    gta_errinfo_t * p_errinfo);
+
+/*---------------------------------------------------------------------*/
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+}
+/* *INDENT-ON* */
+#endif
+
+#endif /* GTA_CLI_INCREMENTAL_H */
+
+/*** end of file ***/
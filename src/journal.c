@@ -0,0 +1,312 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "journal.h"
+
+#include "metrics.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <openssl/evp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define JOURNAL_HASH_LEN 32
+#define JOURNAL_READ_BUF_SIZE 65536
+
+static int hex_value(char c)
+{
+    if (('0' <= c) && ('9' >= c)) {
+        return c - '0';
+    }
+    if (('a' <= c) && ('f' >= c)) {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+/* Parses "<hash> <size> <item>", the line is terminated by '\0' */
+static bool parse_line(char * p_line, journal_entry_t * p_entry)
+{
+    char * p_endptr = NULL;
+
+    for (size_t i = 0; i < JOURNAL_HASH_LEN; ++i) {
+        int high = hex_value(p_line[2 * i]);
+        int low = (0 > high) ? -1 : hex_value(p_line[(2 * i) + 1]);
+        if (0 > low) {
+            return false;
+        }
+        p_entry->hash[i] = (unsigned char)((high << 4) | low);
+    }
+    p_line += 2 * JOURNAL_HASH_LEN;
+    if ((' ' != p_line[0]) || ('0' > p_line[1]) || ('9' < p_line[1])) {
+        return false;
+    }
+    errno = 0;
+    p_entry->size = strtoull(&p_line[1], &p_endptr, 10);
+    if ((0 != errno) || (' ' != *p_endptr) || ('\0' == p_endptr[1])) {
+        return false;
+    }
+    p_entry->p_item = p_endptr + 1;
+    return true;
+}
+
+/* Orders the entries by item, entries of the same item in the order of the journal */
+static int compare_entries(const void * p_a, const void * p_b)
+{
+    const journal_entry_t * p_entry_a = p_a;
+    const journal_entry_t * p_entry_b = p_b;
+    int result = strcmp(p_entry_a->p_item, p_entry_b->p_item);
+
+    if (0 != result) {
+        return result;
+    }
+    /* the items point into the content of the journal */
+    return (p_entry_a->p_item < p_entry_b->p_item) ? -1 : (p_entry_a->p_item > p_entry_b->p_item);
+}
+
+static int compare_item(const void * p_key, const void * p_element)
+{
+    return strcmp(p_key, ((const journal_entry_t *)p_element)->p_item);
+}
+
+/* Reads the journal, drops a torn last line and builds the sorted list of completed items */
+static int load_entries(journal_t * p_journal, const char * p_path)
+{
+    struct stat st = {0};
+    size_t len = 0;
+    size_t num_lines = 0;
+    size_t end = 0; /* end of the last complete line */
+
+    if (0 != fstat(p_journal->fd, &st)) {
+        fprintf(stderr, "Cannot read journal %s: %s\n", p_path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    len = (size_t)st.st_size;
+    p_journal->p_data = malloc(len + 1);
+    if (NULL == p_journal->p_data) {
+        fprintf(stderr, "Memory allocation error\n");
+        return EXIT_FAILURE;
+    }
+    for (size_t pos = 0; pos < len;) {
+        ssize_t got = pread(p_journal->fd, &p_journal->p_data[pos], len - pos, (off_t)pos);
+        if (0 >= got) {
+            if ((0 > got) && (EINTR == errno)) {
+                continue;
+            }
+            fprintf(stderr, "Cannot read journal %s\n", p_path);
+            return EXIT_FAILURE;
+        }
+        pos += (size_t)got;
+    }
+    for (size_t pos = 0; pos < len; ++pos) {
+        if ('\n' == p_journal->p_data[pos]) {
+            ++num_lines;
+            end = pos + 1;
+        }
+    }
+    /* A line appended after the torn line of a crash would otherwise be merged with it */
+    if ((end != len) && (0 != ftruncate(p_journal->fd, (off_t)end))) {
+        fprintf(stderr, "Cannot truncate journal %s: %s\n", p_path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    p_journal->p_entries = calloc((0 == num_lines) ? 1 : num_lines, sizeof(journal_entry_t));
+    if (NULL == p_journal->p_entries) {
+        fprintf(stderr, "Memory allocation error\n");
+        return EXIT_FAILURE;
+    }
+    for (size_t pos = 0; pos < end;) {
+        char * p_line = &p_journal->p_data[pos];
+        char * p_newline = memchr(p_line, '\n', end - pos);
+        *p_newline = '\0';
+        pos = (size_t)(p_newline - p_journal->p_data) + 1;
+        /* A malformed line is not trusted, its item is processed again */
+        if (parse_line(p_line, &p_journal->p_entries[p_journal->num_entries])) {
+            ++p_journal->num_entries;
+        }
+    }
+
+    /* Keep the last entry of an item which has been processed several times */
+    qsort(p_journal->p_entries, p_journal->num_entries, sizeof(journal_entry_t), compare_entries);
+    size_t num_unique = 0;
+    for (size_t i = 0; i < p_journal->num_entries; ++i) {
+        if ((0 != num_unique) && (0 == strcmp(p_journal->p_entries[num_unique - 1].p_item,
+                                              p_journal->p_entries[i].p_item))) {
+            --num_unique;
+        }
+        p_journal->p_entries[num_unique++] = p_journal->p_entries[i];
+    }
+    p_journal->num_entries = num_unique;
+    return EXIT_SUCCESS;
+}
+
+int journal_open(journal_t * p_journal, const char * p_path)
+{
+    p_journal->fd = open(p_path, O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+    if (0 > p_journal->fd) {
+        fprintf(stderr, "Cannot open journal %s: %s\n", p_path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (0 != flock(p_journal->fd, LOCK_EX | LOCK_NB)) {
+        fprintf(stderr, "Journal %s is used by another run\n", p_path);
+        close(p_journal->fd);
+        p_journal->fd = -1;
+        return EXIT_FAILURE;
+    }
+    pthread_mutex_init(&p_journal->mutex, NULL);
+    p_journal->last_sync_ns = metrics_now_ns();
+    if (EXIT_SUCCESS != load_entries(p_journal, p_path)) {
+        journal_close(p_journal);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/* Computes the SHA-256 hash and the size of a file */
+static bool hash_file(const char * p_path, unsigned char * p_hash, uint64_t * p_size)
+{
+    bool b_ret = false;
+    char buf[JOURNAL_READ_BUF_SIZE];
+    size_t len = 0;
+    uint64_t size = 0;
+    FILE * p_file = fopen(p_path, "rb");
+    EVP_MD_CTX * p_ctx = EVP_MD_CTX_new();
+
+    if ((NULL == p_file) || (NULL == p_ctx) || (1 != EVP_DigestInit_ex(p_ctx, EVP_sha256(), NULL))) {
+        goto cleanup;
+    }
+    while (0 < (len = fread(buf, 1, sizeof(buf), p_file))) {
+        if (1 != EVP_DigestUpdate(p_ctx, buf, len)) {
+            goto cleanup;
+        }
+        size += len;
+    }
+    if (!ferror(p_file) && (1 == EVP_DigestFinal_ex(p_ctx, p_hash, NULL))) {
+        *p_size = size;
+        b_ret = true;
+    }
+
+cleanup:
+    if (NULL != p_file) {
+        fclose(p_file);
+    }
+    EVP_MD_CTX_free(p_ctx);
+    return b_ret;
+}
+
+bool journal_is_complete(journal_t * p_journal, const char * p_item, const char * p_output)
+{
+    struct stat st = {0};
+    unsigned char hash[JOURNAL_HASH_LEN] = {0};
+    uint64_t size = 0;
+    const journal_entry_t * p_entry =
+        bsearch(p_item, p_journal->p_entries, p_journal->num_entries, sizeof(journal_entry_t), compare_item);
+
+    /* The size is checked first, a missing or truncated output is not read */
+    if ((NULL == p_entry) || (0 != stat(p_output, &st)) || (p_entry->size != (uint64_t)st.st_size)) {
+        return false;
+    }
+    return hash_file(p_output, hash, &size) && (p_entry->size == size) &&
+           (0 == memcmp(p_entry->hash, hash, JOURNAL_HASH_LEN));
+}
+
+static bool write_full(int fd, const char * p_buf, size_t len)
+{
+    while (0 < len) {
+        ssize_t written = write(fd, p_buf, len);
+        if (0 > written) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return false;
+        }
+        p_buf += written;
+        len -= (size_t)written;
+    }
+    return true;
+}
+
+int journal_record(journal_t * p_journal, const char * p_item, const char * p_output)
+{
+    int ret = EXIT_FAILURE;
+    unsigned char hash[JOURNAL_HASH_LEN] = {0};
+    uint64_t size = 0;
+    char * p_line = NULL;
+    size_t len = 0;
+
+    /* An item containing a newline cannot be recorded, it is processed again on a restart */
+    if (NULL != strchr(p_item, '\n')) {
+        return EXIT_SUCCESS;
+    }
+    if (!hash_file(p_output, hash, &size)) {
+        fprintf(stderr, "Cannot read file %s\n", p_output);
+        return EXIT_FAILURE;
+    }
+    len = (2 * JOURNAL_HASH_LEN) + 1 + 20 + 1 + strlen(p_item) + 2;
+    p_line = malloc(len);
+    if (NULL == p_line) {
+        fprintf(stderr, "Memory allocation error\n");
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < JOURNAL_HASH_LEN; ++i) {
+        snprintf(&p_line[2 * i], 3, "%02x", hash[i]);
+    }
+    len = (2 * JOURNAL_HASH_LEN) +
+          (size_t)snprintf(&p_line[2 * JOURNAL_HASH_LEN], len - (2 * JOURNAL_HASH_LEN), " %llu %s\n",
+                           (unsigned long long)size, p_item);
+
+    pthread_mutex_lock(&p_journal->mutex);
+    if (!write_full(p_journal->fd, p_line, len)) {
+        fprintf(stderr, "Cannot write journal: %s\n", strerror(errno));
+        goto cleanup;
+    }
+    ++p_journal->unsynced;
+    uint64_t now_ns = metrics_now_ns();
+    if ((JOURNAL_SYNC_ITEMS <= p_journal->unsynced) ||
+        ((now_ns - p_journal->last_sync_ns) >= ((uint64_t)JOURNAL_SYNC_MS * 1000000))) {
+        if (0 != fdatasync(p_journal->fd)) {
+            fprintf(stderr, "Cannot sync journal: %s\n", strerror(errno));
+            goto cleanup;
+        }
+        p_journal->unsynced = 0;
+        p_journal->last_sync_ns = now_ns;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    pthread_mutex_unlock(&p_journal->mutex);
+    free(p_line);
+    return ret;
+}
+
+int journal_close(journal_t * p_journal)
+{
+    int ret = EXIT_SUCCESS;
+
+    if (0 > p_journal->fd) {
+        return EXIT_SUCCESS;
+    }
+    if ((0 != p_journal->unsynced) && (0 != fdatasync(p_journal->fd))) {
+        fprintf(stderr, "Cannot sync journal: %s\n", strerror(errno));
+        ret = EXIT_FAILURE;
+    }
+    close(p_journal->fd);
+    p_journal->fd = -1;
+    pthread_mutex_destroy(&p_journal->mutex);
+    free(p_journal->p_entries);
+    free(p_journal->p_data);
+    p_journal->p_entries = NULL;
+    p_journal->p_data = NULL;
+    p_journal->num_entries = 0;
+    p_journal->unsynced = 0;
+    return ret;
+}
+
+/*** end of file ***/
@@ -0,0 +1,77 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef GTA_CLI_JOURNAL_H
+#define GTA_CLI_JOURNAL_H
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+extern "C" {
+/* *INDENT-ON* */
+#endif
+
+/*---------------------------------------------------------------------*/
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Checkpoint journal of a bulk operation. Every completed item is appended
+ * as a line
+ *
+ *   <SHA-256 of the output in hex> <size of the output> <item>
+ *
+ * The journal is synced after JOURNAL_SYNC_ITEMS lines or JOURNAL_SYNC_MS
+ * milliseconds, so a crash loses at most the last batch of lines and these
+ * items are processed again. When the operation is restarted with the same
+ * journal, an item is skipped if its output still has the recorded size
+ * and hash. A torn last line is ignored.
+ */
+
+#define JOURNAL_SYNC_ITEMS 64
+#define JOURNAL_SYNC_MS 200
+
+typedef struct journal_entry {
+    char * p_item;
+    uint64_t size;
+    unsigned char hash[32];
+} journal_entry_t;
+
+typedef struct journal {
+    int fd;                       /* journal file, opened for appending and locked with flock() */
+    pthread_mutex_t mutex;        /* serializes the appends of the worker threads */
+    char * p_data;                /* content of the journal when it was opened, holds the items of the entries */
+    journal_entry_t * p_entries;  /* entries of the previous runs, sorted by item */
+    size_t num_entries;           /* number of entries of the previous runs */
+    size_t unsynced;              /* lines written since the last sync */
+    uint64_t last_sync_ns;        /* time of the last sync */
+} journal_t;
+
+/* Opens or creates the journal, loads the completed items and locks it against a concurrent run */
+int journal_open(journal_t * p_journal, const char * p_path);
+
+/* Returns true if the item is recorded as completed and p_output still matches the recorded size and hash */
+bool journal_is_complete(journal_t * p_journal, const char * p_item, const char * p_output);
+
+/* Records the item with the hash of its output p_output as completed, may be called from several threads */
+int journal_record(journal_t * p_journal, const char * p_item, const char * p_output);
+
+/* Syncs and closes the journal, can be called for a journal which is not open */
+int journal_close(journal_t * p_journal);
+
+/*---------------------------------------------------------------------*/
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+}
+/* *INDENT-ON* */
+#endif
+
+#endif /* GTA_CLI_JOURNAL_H */
+
+/*** end of file ***/
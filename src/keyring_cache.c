@@ -0,0 +1,212 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "keyring_cache.h"
+
+#include <errno.h>
+#include <gta_api/util/gta_memset.h>
+#include <linux/keyctl.h>
+#include <openssl/evp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* Name of the keyring holding all cache entries */
+#define KEYRING_CACHE_NAME "gta-cli"
+/* Prefix of the description of a cache entry */
+#define KEYRING_CACHE_DESC_PREFIX "gta-cli:unseal:"
+
+/* Key permissions, not exported by linux/keyctl.h */
+#define KEY_POS_ALL 0x3f000000
+#define KEY_USR_VIEW 0x00010000
+#define KEY_USR_READ 0x00020000
+#define KEY_USR_WRITE 0x00040000
+#define KEY_USR_SEARCH 0x00080000
+#define KEY_USR_LINK 0x00100000
+
+/* Entries are readable by the owning user, also without possessing the keyring */
+#define KEYRING_CACHE_KEY_PERM (KEY_POS_ALL | KEY_USR_VIEW | KEY_USR_READ | KEY_USR_SEARCH)
+#define KEYRING_CACHE_RING_PERM (KEYRING_CACHE_KEY_PERM | KEY_USR_WRITE | KEY_USR_LINK)
+
+/* libc does not provide wrappers for the keyring syscalls (they live in libkeyutils) */
+static long sys_add_key(const char * type, const char * desc, const void * payload, size_t len, int32_t keyring)
+{
+    return syscall(SYS_add_key, type, desc, payload, len, keyring);
+}
+
+static long sys_keyctl(int cmd, unsigned long arg2, unsigned long arg3, unsigned long arg4, unsigned long arg5)
+{
+    return syscall(SYS_keyctl, cmd, arg2, arg3, arg4, arg5);
+}
+
+/* Returns the id of the gta-cli keyring in the parent keyring, creating it if requested */
+static long get_cache_keyring(int parent_keyring, bool create)
+{
+    long ring = sys_keyctl(
+        KEYCTL_SEARCH, (unsigned long)parent_keyring, (unsigned long)"keyring", (unsigned long)KEYRING_CACHE_NAME, 0);
+    if ((0 > ring) && create) {
+        ring = sys_add_key("keyring", KEYRING_CACHE_NAME, NULL, 0, parent_keyring);
+        if (0 <= ring) {
+            sys_keyctl(KEYCTL_SETPERM, (unsigned long)ring, KEYRING_CACHE_RING_PERM, 0, 0);
+        }
+    }
+    return ring;
+}
+
+int keyring_cache_parse(const char * p_spec, keyring_cache_t * p_cache)
+{
+    const char * p_ttl = NULL;
+    char * p_endptr = NULL;
+
+    if (0 == strncmp(p_spec, "keyring:", 8)) {
+        p_cache->parent_keyring = KEY_SPEC_USER_KEYRING;
+        p_ttl = p_spec + 8;
+    } else if (0 == strncmp(p_spec, "session_keyring:", 16)) {
+        p_cache->parent_keyring = KEY_SPEC_SESSION_KEYRING;
+        p_ttl = p_spec + 16;
+    } else {
+        fprintf(stderr, "Invalid cache specification: %s\n", p_spec);
+        return EXIT_FAILURE;
+    }
+
+    unsigned long ttl = strtoul(p_ttl, &p_endptr, 10);
+    if (('\0' == *p_ttl) || ('\0' != *p_endptr) || (0 == ttl) || (UINT32_MAX < ttl)) {
+        fprintf(stderr, "Invalid input: '%s' is not a valid TTL in seconds\n", p_ttl);
+        return EXIT_FAILURE;
+    }
+    p_cache->ttl = (unsigned int)ttl;
+    p_cache->desc[0] = '\0';
+
+    return EXIT_SUCCESS;
+}
+
+int keyring_cache_set_desc(
+    keyring_cache_t * p_cache,
+    const char * p_pers,
+    const char * p_prof,
+    const char * p_sealed,
+    size_t sealed_len)
+{
+    int ret = EXIT_FAILURE;
+    unsigned char md[EVP_MAX_MD_SIZE] = {0};
+    unsigned int md_len = 0;
+    EVP_MD_CTX * p_md_ctx = EVP_MD_CTX_new();
+
+    if (NULL == p_md_ctx) {
+        return EXIT_FAILURE;
+    }
+
+    /* Personality and profile are hashed including their NULL-terminator to keep the encoding unambiguous */
+    if ((1 != EVP_DigestInit_ex(p_md_ctx, EVP_sha256(), NULL)) ||
+        (1 != EVP_DigestUpdate(p_md_ctx, p_pers, strlen(p_pers) + 1)) ||
+        (1 != EVP_DigestUpdate(p_md_ctx, p_prof, strlen(p_prof) + 1)) ||
+        (1 != EVP_DigestUpdate(p_md_ctx, p_sealed, sealed_len)) || (1 != EVP_DigestFinal_ex(p_md_ctx, md, &md_len))) {
+        goto cleanup;
+    }
+
+    size_t pos = strlen(KEYRING_CACHE_DESC_PREFIX);
+    memcpy(p_cache->desc, KEYRING_CACHE_DESC_PREFIX, pos);
+    for (unsigned int i = 0; i < md_len; ++i) {
+        snprintf(&p_cache->desc[pos], sizeof(p_cache->desc) - pos, "%02x", md[i]);
+        pos += 2;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    EVP_MD_CTX_free(p_md_ctx);
+    return ret;
+}
+
+bool keyring_cache_lookup(const keyring_cache_t * p_cache, char ** pp_data, size_t * p_data_len)
+{
+    char * p_data = NULL;
+
+    long ring = get_cache_keyring(p_cache->parent_keyring, false);
+    if (0 > ring) {
+        return false;
+    }
+
+    /* Expired entries are not found by KEYCTL_SEARCH (EKEYEXPIRED) */
+    long key = sys_keyctl(KEYCTL_SEARCH, (unsigned long)ring, (unsigned long)"user", (unsigned long)p_cache->desc, 0);
+    if (0 > key) {
+        return false;
+    }
+
+    /* The payload size is limited, so a single read with the maximum size is sufficient */
+    p_data = malloc(KEYRING_CACHE_MAX_PAYLOAD);
+    if (NULL == p_data) {
+        return false;
+    }
+    long len = sys_keyctl(KEYCTL_READ, (unsigned long)key, (unsigned long)p_data, KEYRING_CACHE_MAX_PAYLOAD, 0);
+    if ((0 > len) || (KEYRING_CACHE_MAX_PAYLOAD < len)) {
+        keyring_cache_free_data(p_data, KEYRING_CACHE_MAX_PAYLOAD);
+        return false;
+    }
+
+    *pp_data = p_data;
+    *p_data_len = (size_t)len;
+    return true;
+}
+
+int keyring_cache_store(const keyring_cache_t * p_cache, const char * p_data, size_t data_len)
+{
+    if (KEYRING_CACHE_MAX_PAYLOAD < data_len) {
+        fprintf(stderr, "Unsealed data too large to be cached\n");
+        return EXIT_FAILURE;
+    }
+
+    long ring = get_cache_keyring(p_cache->parent_keyring, true);
+    if (0 > ring) {
+        fprintf(stderr, "Cannot access kernel keyring (errno %d)\n", errno);
+        return EXIT_FAILURE;
+    }
+
+    /* An existing (possibly expired) entry with the same description is updated */
+    long key = sys_add_key("user", p_cache->desc, p_data, data_len, (int32_t)ring);
+    if (0 > key) {
+        fprintf(stderr, "Cannot add key to kernel keyring (errno %d)\n", errno);
+        return EXIT_FAILURE;
+    }
+
+    if ((0 != sys_keyctl(KEYCTL_SETPERM, (unsigned long)key, KEYRING_CACHE_KEY_PERM, 0, 0)) ||
+        (0 != sys_keyctl(KEYCTL_SET_TIMEOUT, (unsigned long)key, p_cache->ttl, 0, 0))) {
+        /* Never leave an entry without timeout behind */
+        sys_keyctl(KEYCTL_REVOKE, (unsigned long)key, 0, 0, 0);
+        fprintf(stderr, "Cannot set timeout of key in kernel keyring (errno %d)\n", errno);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+void keyring_cache_free_data(char * p_data, size_t data_len)
+{
+    if (NULL != p_data) {
+        gta_memset(p_data, data_len, 0, data_len);
+        free(p_data);
+    }
+}
+
+int keyring_cache_flush(void)
+{
+    int ret = EXIT_SUCCESS;
+    const int parent_keyrings[] = {KEY_SPEC_USER_KEYRING, KEY_SPEC_SESSION_KEYRING};
+
+    for (size_t i = 0; i < (sizeof(parent_keyrings) / sizeof(parent_keyrings[0])); ++i) {
+        long ring = get_cache_keyring(parent_keyrings[i], false);
+        if ((0 <= ring) && (0 != sys_keyctl(KEYCTL_CLEAR, (unsigned long)ring, 0, 0, 0))) {
+            fprintf(stderr, "Cannot clear keyring %s (errno %d)\n", KEYRING_CACHE_NAME, errno);
+            ret = EXIT_FAILURE;
+        }
+    }
+
+    return ret;
+}
+
+/*** end of file ***/
@@ -0,0 +1,80 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef GTA_CLI_KEYRING_CACHE_H
+#define GTA_CLI_KEYRING_CACHE_H
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+extern "C" {
+/* *INDENT-ON* */
+#endif
+
+/*---------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Cache for unsealed data in the Linux kernel keyring. Cache entries are
+ * stored as "user" keys in a dedicated keyring which is linked into the
+ * user or session keyring. Keys are described by a hash over personality,
+ * profile and sealed data, and expire after a configurable time.
+ */
+
+/* Length of a key description including NULL-terminator */
+#define KEYRING_CACHE_DESC_LEN 80
+
+/* Maximum payload size of a "user" key in the kernel keyring */
+#define KEYRING_CACHE_MAX_PAYLOAD 32767
+
+typedef struct keyring_cache {
+    int parent_keyring;                /* KEY_SPEC_USER_KEYRING or KEY_SPEC_SESSION_KEYRING */
+    unsigned int ttl;                  /* time to live of cache entries in seconds */
+    char desc[KEYRING_CACHE_DESC_LEN]; /* description of the cache entry */
+} keyring_cache_t;
+
+/*
+ * Parses a cache specification of the form "keyring:TTL" (user keyring) or
+ * "session_keyring:TTL" (session keyring).
+ */
+int keyring_cache_parse(const char * p_spec, keyring_cache_t * p_cache);
+
+/* Derives the key description for sealed data unsealed with the given personality and profile */
+int keyring_cache_set_desc(
+    keyring_cache_t * p_cache,
+    const char * p_pers,
+    const char * p_prof,
+    const char * p_sealed,
+    size_t sealed_len);
+
+/*
+ * Looks up the cache entry described by p_cache. On a hit, the cached data is
+ * returned in *pp_data (to be freed by the caller with keyring_cache_free_data)
+ * and true is returned.
+ */
+bool keyring_cache_lookup(const keyring_cache_t * p_cache, char ** pp_data, size_t * p_data_len);
+
+/* Stores data as cache entry described by p_cache */
+int keyring_cache_store(const keyring_cache_t * p_cache, const char * p_data, size_t data_len);
+
+/* Clears and frees data returned by keyring_cache_lookup */
+void keyring_cache_free_data(char * p_data, size_t data_len);
+
+/* Removes all cache entries from the user and the session keyring */
+int keyring_cache_flush(void);
+
+/*---------------------------------------------------------------------*/
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+}
+/* *INDENT-ON* */
+#endif
+
+#endif /* GTA_CLI_KEYRING_CACHE_H */
+
+/*** end of file ***/
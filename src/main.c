@@ -4,15 +4,37 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include "batch.h"
+#include "chunked.h"
+#include "compress.h"
+#include "exec_secrets.h"
+#include "gta_cli_config.h"
+#include "incremental.h"
+#include "journal.h"
+#include "keyring_cache.h"
+#include "metrics.h"
+#include "perf_counters.h"
+#include "record.h"
+#include "reseal.h"
+#include "sealed_log.h"
+#include "statedir.h"
 #include "streams.h"
+#include "trace.h"
+#include "tree_hash.h"
+#include "vault.h"
+#include "watch.h"
 #include <dirent.h>
+#include <errno.h>
 #include <gta_api/gta_api.h>
 #include <inttypes.h>
 #include <openssl/evp.h>
+#include <openssl/objects.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 extern const struct gta_function_list_t * gta_sw_provider_init(
     gta_context_handle_t,
@@ -28,18 +50,10 @@ extern const struct gta_function_list_t * gta_sw_provider_init(
 #define MAXLEN_PERSONALITY_NAME 100
 #define MAXLEN_ATTRIBUTE 150
 #define MAXLEN_STATEDIR_PATH 150
+#define MAXLEN_DIGEST_NAME 32
 
-/* List of all profiles supported by gta-cli */
-static char profiles_to_register[][MAXLEN_PROFILE] = {
-    "ch.iec.30168.basic.local_data_protection",
-    "ch.iec.30168.basic.local_data_integrity_only",
-    "com.github.generic-trust-anchor-api.basic.rsa",
-    "com.github.generic-trust-anchor-api.basic.ec",
-    "com.github.generic-trust-anchor-api.basic.tls",
-    "com.github.generic-trust-anchor-api.basic.signature",
-    "com.github.generic-trust-anchor-api.basic.jwt",
-    "com.github.generic-trust-anchor-api.basic.enroll",
-    "org.opcfoundation.ECC-nistP256"};
+/* List of all profiles supported by gta-cli, selected with the meson option profiles */
+static char profiles_to_register[][MAXLEN_PROFILE] = {GTA_CLI_PROFILES};
 
 bool gta_sw_provider_gta_register_provider(
     gta_instance_handle_t h_inst,
@@ -54,10 +68,13 @@ bool gta_sw_provider_gta_register_provider(
         .provider_init_config = init_config,
         .profile_info = {.profile_name = profile, .protection_properties = {0}, .priority = 0}};
 
-    return gta_register_provider(h_inst, &provider_info, p_errinfo);
+    return TRACE_BOOL(gta_register_provider, (h_inst, &provider_info, p_errinfo), p_errinfo);
 }
 
-/* Enum for function selection */
+/*
+ * Enum for function selection. The code of a function is only compiled if
+ * GTA_CLI_FUNC_<NAME> is defined in gta_cli_config.h (meson option functions).
+ */
 enum functions {
     identifier_assign,
     personality_create,
@@ -73,14 +90,49 @@ enum functions {
     personality_attributes_enumerate,
     authenticate_data_detached,
     verify_data_detached,
+    authenticate_batch,
+    verify_batch,
+    reseal,
+    vault_put,
+    vault_get,
+    vault_list,
+    exec,
+    watch,
     personality_enroll,
     personality_remove,
     devicestate_transition,
     devicestate_recede,
     access_policy_simple,
+    cache_flush,
+    metrics_summary,
+    replay,
     FUNC_UNKNOWN
 };
 
+/* Code shared by several functions */
+#if defined(GTA_CLI_FUNC_AUTHENTICATE_DATA_DETACHED) || defined(GTA_CLI_FUNC_VERIFY_DATA_DETACHED)
+#define WITH_DATA_DETACHED
+#endif
+#if defined(GTA_CLI_FUNC_VAULT_PUT) || defined(GTA_CLI_FUNC_VAULT_GET) || defined(GTA_CLI_FUNC_VAULT_LIST)
+#define WITH_VAULT
+#endif
+#if defined(GTA_CLI_FUNC_SEAL_DATA) || defined(GTA_CLI_FUNC_UNSEAL_DATA) || defined(GTA_CLI_FUNC_RESEAL) ||            \
+    defined(WITH_DATA_DETACHED)
+#define WITH_PROGRESS
+/* --chunk_size and --threads */
+#define WITH_CHUNKED
+#endif
+#if defined(GTA_CLI_FUNC_RESEAL) || defined(WITH_VAULT)
+#define WITH_JOURNAL
+#endif
+/* Functions with an output passing the digest stage */
+#if defined(GTA_CLI_FUNC_SEAL_DATA) || defined(GTA_CLI_FUNC_UNSEAL_DATA) ||                                            \
+    defined(GTA_CLI_FUNC_PERSONALITY_GET_ATTRIBUTE) || defined(GTA_CLI_FUNC_AUTHENTICATE_DATA_DETACHED) ||             \
+    defined(GTA_CLI_FUNC_AUTHENTICATE_BATCH) || defined(GTA_CLI_FUNC_RESEAL) || defined(GTA_CLI_FUNC_VAULT_PUT) ||     \
+    defined(GTA_CLI_FUNC_VAULT_GET) || defined(GTA_CLI_FUNC_PERSONALITY_ENROLL)
+#define WITH_DIGEST_STAGE
+#endif
+
 /* struct for an attribute */
 typedef struct t_attribute {
     char * p_type;
@@ -97,6 +149,7 @@ typedef struct t_ctx_attributes {
 /* Structure to store the parsed arguments */
 struct arguments {
     enum functions func;
+    char * func_name;
     char * app_name;
     char * id_type;
     char * id_val;
@@ -120,6 +173,40 @@ struct arguments {
     gta_access_policy_handle_t h_auth_recede;
     size_t * owner_lock_count;
     char * descr_type;
+    char * cache;
+    char * metrics_file;
+    char * record;
+    char * binary;
+    char * trace;
+    char * state_mode;
+    char * lock_timeout;
+    bool io_stats;
+    bool perf_counters;
+    char * out_digest;
+    char * compress;
+    char * chunk_size;
+    char * threads;
+    char * range;
+    char * tree_hash;
+    char * data_list;
+    char * proof;
+    bool log_mode;
+    bool decompress;
+    char * flush_ms;
+    char * flush_bytes;
+    char * to_pers;
+    char * to_prof;
+    char * dir;
+    char * out_dir;
+    char * vault;
+    char * key;
+    t_ctx_attributes secrets;     /* exec: list of --secret NAME=FILE, unsealed into memfds */
+    t_ctx_attributes secrets_env; /* exec: list of --secret_env NAME=FILE, unsealed into environment variables */
+    char ** exec_argv;            /* exec: command and arguments after "--" */
+    char * journal;
+    bool incremental;
+    char * index;
+    char * op;
 };
 
 /* Function prototypes */
@@ -147,6 +234,7 @@ int parse_args(int argc, char * argv[], struct arguments * arguments)
 
     /* Default values */
     arguments->func = FUNC_UNKNOWN;
+    arguments->func_name = NULL;
     arguments->app_name = NULL;
     arguments->id_type = NULL;
     arguments->id_val = NULL;
@@ -167,6 +255,42 @@ int parse_args(int argc, char * argv[], struct arguments * arguments)
     arguments->h_auth_recede = GTA_HANDLE_INVALID;
     arguments->owner_lock_count = NULL;
     arguments->descr_type = NULL;
+    arguments->cache = NULL;
+    arguments->metrics_file = getenv(METRICS_FILE_ENV);
+    arguments->record = NULL;
+    arguments->binary = NULL;
+    arguments->trace = NULL;
+    arguments->state_mode = NULL;
+    arguments->lock_timeout = NULL;
+    arguments->io_stats = false;
+    arguments->perf_counters = false;
+    arguments->out_digest = NULL;
+    arguments->compress = NULL;
+    arguments->chunk_size = NULL;
+    arguments->threads = NULL;
+    arguments->range = NULL;
+    arguments->tree_hash = NULL;
+    arguments->data_list = NULL;
+    arguments->proof = NULL;
+    arguments->log_mode = false;
+    arguments->decompress = false;
+    arguments->flush_ms = NULL;
+    arguments->flush_bytes = NULL;
+    arguments->to_pers = NULL;
+    arguments->to_prof = NULL;
+    arguments->dir = NULL;
+    arguments->out_dir = NULL;
+    arguments->vault = NULL;
+    arguments->key = NULL;
+    arguments->secrets.num = 0;
+    arguments->secrets.p_attr = NULL;
+    arguments->secrets_env.num = 0;
+    arguments->secrets_env.p_attr = NULL;
+    arguments->exec_argv = NULL;
+    arguments->journal = NULL;
+    arguments->incremental = false;
+    arguments->index = NULL;
+    arguments->op = NULL;
 
     /* Parse the arguments */
 
@@ -177,52 +301,137 @@ int parse_args(int argc, char * argv[], struct arguments * arguments)
     if (strcmp(argv[1], "--help") == 0) {
         show_help();
         exit(EXIT_SUCCESS);
+#if defined(GTA_CLI_FUNC_IDENTIFIER_ASSIGN)
     } else if (strcmp(argv[1], "identifier_assign") == 0) {
         arguments->func = identifier_assign;
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_CREATE)
     } else if (strcmp(argv[1], "personality_create") == 0) {
         arguments->func = personality_create;
+#endif
+#if defined(GTA_CLI_FUNC_SEAL_DATA)
     } else if (strcmp(argv[1], "seal_data") == 0) {
         arguments->func = seal_data;
+#endif
+#if defined(GTA_CLI_FUNC_UNSEAL_DATA)
     } else if (strcmp(argv[1], "unseal_data") == 0) {
         arguments->func = unseal_data;
+#endif
+#if defined(GTA_CLI_FUNC_IDENTIFIER_ENUMERATE)
     } else if (strcmp(argv[1], "identifier_enumerate") == 0) {
         arguments->func = identifier_enumerate;
         b_options = false;
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ENUMERATE)
     } else if (strcmp(argv[1], "personality_enumerate") == 0) {
         arguments->func = personality_enumerate;
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ENUMERATE_APPLICATION)
     } else if (strcmp(argv[1], "personality_enumerate_application") == 0) {
         arguments->func = personality_enumerate_application;
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ADD_ATTRIBUTE)
     } else if (strcmp(argv[1], "personality_add_attribute") == 0) {
         arguments->func = personality_add_attribute;
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ADD_TRUSTED_ATTRIBUTE)
     } else if (strcmp(argv[1], "personality_add_trusted_attribute") == 0) {
         arguments->func = personality_add_trusted_attribute;
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_GET_ATTRIBUTE)
     } else if (strcmp(argv[1], "personality_get_attribute") == 0) {
         arguments->func = personality_get_attribute;
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_REMOVE_ATTRIBUTE)
     } else if (strcmp(argv[1], "personality_remove_attribute") == 0) {
         arguments->func = personality_remove_attribute;
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ATTRIBUTES_ENUMERATE)
     } else if (strcmp(argv[1], "personality_attributes_enumerate") == 0) {
         arguments->func = personality_attributes_enumerate;
+#endif
+#if defined(GTA_CLI_FUNC_AUTHENTICATE_DATA_DETACHED)
     } else if (strcmp(argv[1], "authenticate_data_detached") == 0) {
         arguments->func = authenticate_data_detached;
+#endif
+#if defined(GTA_CLI_FUNC_VERIFY_DATA_DETACHED)
     } else if (strcmp(argv[1], "verify_data_detached") == 0) {
         arguments->func = verify_data_detached;
+#endif
+#if defined(GTA_CLI_FUNC_AUTHENTICATE_BATCH)
+    } else if (strcmp(argv[1], "authenticate_batch") == 0) {
+        arguments->func = authenticate_batch;
+#endif
+#if defined(GTA_CLI_FUNC_VERIFY_BATCH)
+    } else if (strcmp(argv[1], "verify_batch") == 0) {
+        arguments->func = verify_batch;
+#endif
+#if defined(GTA_CLI_FUNC_RESEAL)
+    } else if (strcmp(argv[1], "reseal") == 0) {
+        arguments->func = reseal;
+#endif
+#if defined(GTA_CLI_FUNC_VAULT_PUT)
+    } else if (strcmp(argv[1], "vault_put") == 0) {
+        arguments->func = vault_put;
+#endif
+#if defined(GTA_CLI_FUNC_VAULT_GET)
+    } else if (strcmp(argv[1], "vault_get") == 0) {
+        arguments->func = vault_get;
+#endif
+#if defined(GTA_CLI_FUNC_VAULT_LIST)
+    } else if (strcmp(argv[1], "vault_list") == 0) {
+        arguments->func = vault_list;
+#endif
+#if defined(GTA_CLI_FUNC_EXEC)
+    } else if (strcmp(argv[1], "exec") == 0) {
+        arguments->func = exec;
+#endif
+#if defined(GTA_CLI_FUNC_WATCH)
+    } else if (strcmp(argv[1], "watch") == 0) {
+        arguments->func = watch;
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ENROLL)
     } else if (strcmp(argv[1], "personality_enroll") == 0) {
         arguments->func = personality_enroll;
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_REMOVE)
     } else if (strcmp(argv[1], "personality_remove") == 0) {
         arguments->func = personality_remove;
+#endif
+#if defined(GTA_CLI_FUNC_DEVICESTATE_TRANSITION)
     } else if (strcmp(argv[1], "devicestate_transition") == 0) {
         arguments->func = devicestate_transition;
+#endif
+#if defined(GTA_CLI_FUNC_DEVICESTATE_RECEDE)
     } else if (strcmp(argv[1], "devicestate_recede") == 0) {
         arguments->func = devicestate_recede;
         b_options = false;
+#endif
+#if defined(GTA_CLI_FUNC_ACCESS_POLICY_SIMPLE)
     } else if (strcmp(argv[1], "access_policy_simple") == 0) {
         arguments->func = access_policy_simple;
         b_options = false;
+#endif
+#if defined(GTA_CLI_FUNC_CACHE_FLUSH)
+    } else if (strcmp(argv[1], "cache_flush") == 0) {
+        arguments->func = cache_flush;
+        b_options = false;
+#endif
+#if defined(GTA_CLI_FUNC_METRICS_SUMMARY)
+    } else if (strcmp(argv[1], "metrics_summary") == 0) {
+        arguments->func = metrics_summary;
+        b_options = false;
+#endif
+#if defined(GTA_CLI_FUNC_REPLAY)
+    } else if (strcmp(argv[1], "replay") == 0) {
+        arguments->func = replay;
+#endif
     } else {
         fprintf(stderr, "Unknown argument: %s\n", argv[1]);
         show_help();
         return EXIT_FAILURE;
     }
+    arguments->func_name = argv[1];
 
     if (b_options && (2 >= argc)) {
         fprintf(stderr, "Missing function arguments \n");
@@ -387,6 +596,97 @@ int parse_args(int argc, char * argv[], struct arguments * arguments)
             }
         } else if (strncmp(argv[i], "--descr_type=", 13) == 0) {
             arguments->descr_type = argv[i] + 13;
+        } else if (strncmp(argv[i], "--cache=", 8) == 0) {
+            arguments->cache = argv[i] + 8;
+        } else if (strncmp(argv[i], "--metrics_file=", 15) == 0) {
+            arguments->metrics_file = argv[i] + 15;
+        } else if (strncmp(argv[i], "--record=", 9) == 0) {
+            arguments->record = argv[i] + 9;
+        } else if (strncmp(argv[i], "--binary=", 9) == 0) {
+            arguments->binary = argv[i] + 9;
+        } else if (strncmp(argv[i], "--trace=", 8) == 0) {
+            arguments->trace = argv[i] + 8;
+        } else if (strncmp(argv[i], "--state_mode=", 13) == 0) {
+            arguments->state_mode = argv[i] + 13;
+        } else if (strncmp(argv[i], "--lock_timeout=", 15) == 0) {
+            arguments->lock_timeout = argv[i] + 15;
+        } else if (strcmp(argv[i], "--io_stats") == 0) {
+            arguments->io_stats = true;
+        } else if (strcmp(argv[i], "--perf_counters") == 0) {
+            arguments->perf_counters = true;
+        } else if (strncmp(argv[i], "--out_digest=", 13) == 0) {
+            arguments->out_digest = argv[i] + 13;
+        } else if (strncmp(argv[i], "--compress=", 11) == 0) {
+            arguments->compress = argv[i] + 11;
+        } else if (strncmp(argv[i], "--chunk_size=", 13) == 0) {
+            arguments->chunk_size = argv[i] + 13;
+        } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+            arguments->threads = argv[i] + 10;
+        } else if (strncmp(argv[i], "--range=", 8) == 0) {
+            arguments->range = argv[i] + 8;
+        } else if (strncmp(argv[i], "--tree_hash=", 12) == 0) {
+            arguments->tree_hash = argv[i] + 12;
+        } else if (strncmp(argv[i], "--data_list=", 12) == 0) {
+            arguments->data_list = argv[i] + 12;
+        } else if (strncmp(argv[i], "--proof=", 8) == 0) {
+            arguments->proof = argv[i] + 8;
+        } else if (strcmp(argv[i], "--log_mode") == 0) {
+            arguments->log_mode = true;
+        } else if (strcmp(argv[i], "--decompress") == 0) {
+            arguments->decompress = true;
+        } else if (strncmp(argv[i], "--flush_ms=", 11) == 0) {
+            arguments->flush_ms = argv[i] + 11;
+        } else if (strncmp(argv[i], "--flush_bytes=", 14) == 0) {
+            arguments->flush_bytes = argv[i] + 14;
+        } else if (strncmp(argv[i], "--to_pers=", 10) == 0) {
+            arguments->to_pers = argv[i] + 10;
+        } else if (strncmp(argv[i], "--to_prof=", 10) == 0) {
+            arguments->to_prof = argv[i] + 10;
+        } else if (strncmp(argv[i], "--dir=", 6) == 0) {
+            arguments->dir = argv[i] + 6;
+        } else if (strncmp(argv[i], "--out_dir=", 10) == 0) {
+            arguments->out_dir = argv[i] + 10;
+        } else if (strncmp(argv[i], "--vault=", 8) == 0) {
+            arguments->vault = argv[i] + 8;
+        } else if (strncmp(argv[i], "--key=", 6) == 0) {
+            arguments->key = argv[i] + 6;
+        } else if (strncmp(argv[i], "--journal=", 10) == 0) {
+            arguments->journal = argv[i] + 10;
+        } else if (strcmp(argv[i], "--incremental") == 0) {
+            arguments->incremental = true;
+        } else if (strncmp(argv[i], "--index=", 8) == 0) {
+            arguments->index = argv[i] + 8;
+        } else if (strncmp(argv[i], "--op=", 5) == 0) {
+            arguments->op = argv[i] + 5;
+        } else if ((strcmp(argv[i], "--secret_env") == 0) || (strcmp(argv[i], "--secret") == 0)) {
+            t_ctx_attributes * p_secrets =
+                (strcmp(argv[i], "--secret_env") == 0) ? &arguments->secrets_env : &arguments->secrets;
+            t_attribute * p_new_secret = NULL;
+            i++;
+            if (NULL == argv[i]) {
+                fprintf(stderr, "Missing function arguments\n");
+                show_function_help(arguments->func);
+                return EXIT_FAILURE;
+            }
+
+            ++p_secrets->num;
+            p_new_secret = realloc(p_secrets->p_attr, p_secrets->num * sizeof(t_attribute));
+            if (NULL != p_new_secret) {
+                p_secrets->p_attr = p_new_secret;
+                if (EXIT_SUCCESS != parse_attributes(argv[i], &(p_secrets->p_attr[p_secrets->num - 1]))) {
+                    fprintf(stderr, "Missing function arguments\n");
+                    return EXIT_FAILURE;
+                }
+            } else {
+                fprintf(stderr, "Memory allocation error\n");
+                return EXIT_FAILURE;
+            }
+#if defined(GTA_CLI_FUNC_EXEC)
+        } else if ((exec == arguments->func) && (strcmp(argv[i], "--") == 0)) {
+            /* the remaining arguments are the command */
+            arguments->exec_argv = &argv[i + 1];
+            break;
+#endif
         } else if (strcmp(argv[i], "--help") == 0) {
             show_function_help(arguments->func);
             exit(EXIT_SUCCESS);
@@ -405,50 +705,150 @@ void show_help()
     printf("To print help:\ngta-cli --help \n");
     printf("cli usage: gta-cli <FUNCTION> --options\n");
     printf("\nSupported functions:\n");
+#if defined(GTA_CLI_FUNC_IDENTIFIER_ASSIGN)
     printf("  identifier_assign                  assign an identifier to the device\n");
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_CREATE)
     printf("  personality_create                 create a personality on the device for a given identifier\n");
+#endif
+#if defined(GTA_CLI_FUNC_SEAL_DATA)
     printf("  seal_data                          protect a piece of data according to the given profile and "
            "personality\n");
+#endif
+#if defined(GTA_CLI_FUNC_UNSEAL_DATA)
     printf("  unseal_data                        recover a piece of data according to the given profile and "
            "personality\n");
+#endif
+#if defined(GTA_CLI_FUNC_IDENTIFIER_ENUMERATE)
     printf("  identifier_enumerate               enumerate all identifiers managed by GTA API\n");
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ENUMERATE)
     printf("  personality_enumerate              enumerate all personalities that are known to GTA API by their "
            "identifier\n");
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ENUMERATE_APPLICATION)
     printf("  personality_enumerate_application  enumerate all personalities that are known to GTA API by their "
            "application name\n");
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ADD_ATTRIBUTE)
     printf("  personality_add_attribute          assign an additional general attribute to an existing personality\n");
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ADD_TRUSTED_ATTRIBUTE)
     printf("  personality_add_trusted_attribute  assign an additional trusted attribute to an existing personality\n");
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_GET_ATTRIBUTE)
     printf("  personality_get_attribute          get attribute of a personality\n");
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_REMOVE_ATTRIBUTE)
     printf("  personality_remove_attribute       remove attribute of a personality\n");
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ATTRIBUTES_ENUMERATE)
     printf("  personality_attributes_enumerate   enumerate all attributes belonging to a personality\n");
+#endif
+#if defined(GTA_CLI_FUNC_AUTHENTICATE_DATA_DETACHED)
     printf("  authenticate_data_detached         calculate a cryptographic seal for the provided data according to the "
            "given profile and personality\n");
+#endif
+#if defined(GTA_CLI_FUNC_VERIFY_DATA_DETACHED)
     printf("  verify_data_detached               verify a cryptographic seal for the provided data according to the "
            "profile and personality\n");
+#endif
+#if defined(GTA_CLI_FUNC_AUTHENTICATE_BATCH)
+    printf("  authenticate_batch                 calculate one cryptographic seal for a batch of files and an "
+           "inclusion proof per file\n");
+#endif
+#if defined(GTA_CLI_FUNC_VERIFY_BATCH)
+    printf("  verify_batch                       verify a file of a batch with its inclusion proof and the seal of the "
+           "batch\n");
+#endif
+#if defined(GTA_CLI_FUNC_RESEAL)
+    printf("  reseal                             unseal data and seal it with another personality in one process "
+           "(key rotation)\n");
+#endif
+#if defined(GTA_CLI_FUNC_VAULT_PUT)
+    printf("  vault_put                          seal a value and store it under a key in a vault file\n");
+#endif
+#if defined(GTA_CLI_FUNC_VAULT_GET)
+    printf("  vault_get                          recover the values of keys from a vault file\n");
+#endif
+#if defined(GTA_CLI_FUNC_VAULT_LIST)
+    printf("  vault_list                         list the keys of a vault file\n");
+#endif
+#if defined(GTA_CLI_FUNC_EXEC)
+    printf("  exec                               unseal secrets into memfds or environment variables and execute a "
+           "command\n");
+#endif
+#if defined(GTA_CLI_FUNC_WATCH)
+    printf("  watch                              seal or authenticate the files dropped into a spool directory\n");
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ENROLL)
     printf("  personality_enroll                 create an enrollment request for a personality according to the given "
            "profile\n");
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_REMOVE)
     printf("  personality_remove                 remove a personality\n");
+#endif
+#if defined(GTA_CLI_FUNC_DEVICESTATE_TRANSITION)
     printf("  devicestate_transition             advance into a new transition device state (push)\n");
+#endif
+#if defined(GTA_CLI_FUNC_DEVICESTATE_RECEDE)
     printf("  devicestate_recede                 recede into the previous transition device state (pop)\n");
+#endif
+#if defined(GTA_CLI_FUNC_ACCESS_POLICY_SIMPLE)
     printf("  access_policy_simple               get handle for a simple (static) access policy\n");
+#endif
+#if defined(GTA_CLI_FUNC_CACHE_FLUSH)
+    printf("  cache_flush                        remove all unsealed data cached by unseal_data --cache\n");
+#endif
+#if defined(GTA_CLI_FUNC_METRICS_SUMMARY)
+    printf("  metrics_summary                    print latency percentiles and throughput from a metrics file\n");
+#endif
+#if defined(GTA_CLI_FUNC_REPLAY)
+    printf("  replay                             replay a workload recorded with --record and compare the latencies\n");
+#endif
 
     printf("\nSupported profiles:\n");
     for (size_t i = 0; i < (sizeof(profiles_to_register) / sizeof(profiles_to_register[0])); ++i) {
         printf("  %s\n", profiles_to_register[i]);
     }
 
+    printf("\nOptions supported by all functions:\n");
+    printf("  [--metrics_file=FILE]  append a metrics record (NDJSON) for the invocation to FILE, can also be set "
+           "with the environment variable %s\n",
+           METRICS_FILE_ENV);
+    printf("  [--record=FILE]        append the invocation with the sizes and hashes of its inputs and output to FILE "
+           "(NDJSON) for a later replay\n");
+    printf("  [--trace=FILE]         write a trace of all GTA API calls and stream callbacks in Chrome trace-event "
+           "JSON format to FILE\n");
+    printf("  [--state_mode=MODE]    'direct' (default) or 'tmpfs': work on a locked, memory-backed copy of the state "
+           "directory, changed files are written back atomically at the end\n");
+    printf("  [--lock_timeout=MS]    maximum time in milliseconds to wait for the lock of the state directory "
+           "[default: no limit]\n");
+    printf("  [--io_stats]           print statistics of the stream callbacks of the provider to stderr, show a "
+           "progress meter if stderr is a terminal\n");
+    printf("  [--perf_counters]      count CPU cycles, instructions, cache and branch misses, task clock, page faults "
+           "and context switches per phase with perf_event_open, print them to stderr and add them to the metrics "
+           "record\n");
+    printf("  [--compress=ALG[:LEVEL]] seal_data only: compress the data with zlib or zstd before sealing, "
+           "unseal_data --decompress decompresses it\n");
+    printf("  [--out_digest=ALG:FILE] digest the output (e.g. sha256:FILE) while it is written and store the digest "
+           "as hex string in FILE\n");
+
     printf("\nFor function-specific help, use: gta-cli <FUNCTION> --help\n");
 }
 
 void show_function_help(enum functions func)
 {
     switch (func) {
+#if defined(GTA_CLI_FUNC_IDENTIFIER_ASSIGN)
     case identifier_assign:
         printf("Usage: gta-cli identifier_assign --options\n");
         printf("Options:\n");
         printf("  --id_type=IDENTIFIER_TYPE  type for the identifier being assigned\n");
         printf("  --id_val=IDENTIFIER_VALUE  value for the identifier being assigned\n");
         break;
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_CREATE)
     case personality_create:
         printf("Usage: gta-cli personality_create --options\n");
         printf("Options:\n");
@@ -462,25 +862,51 @@ void show_function_help(enum functions func)
         printf("  [--acc_pol_admin=HANDLE]     access policy defining administration of the personality [default: "
                "initial access policy]\n");
         break;
+#endif
+#if defined(GTA_CLI_FUNC_SEAL_DATA)
     case seal_data:
         printf("Usage: gta-cli seal_data --options\n");
         printf("Options:\n");
         printf("  --pers=PERSONALITY_NAME  personality to use for the operation\n");
         printf("  --prof=PROFILE_NAME      profile to use for the operation\n");
         printf("  [--data=FILE]            data to be sealed, if --data is not set data will be read from stdin\n");
+        printf("  [--chunk_size=SIZE]      seal the data as chunked container with chunks of SIZE bytes (suffix K, M "
+               "or G), the chunks are sealed in parallel\n");
+        printf("  [--threads=N]            number of threads sealing chunks [default: 0, number of online CPUs]\n");
+        printf("  [--log_mode]             read the input continuously and append it as sealed frames, each frame is "
+               "synced to disk\n");
+        printf("  [--flush_ms=MS]          log_mode: maximum time data is collected before it is sealed [default: "
+               "%d]\n",
+               SEALED_LOG_DEFAULT_FLUSH_MS);
+        printf("  [--flush_bytes=SIZE]     log_mode: maximum size of a frame (suffix K, M or G) [default: 64K]\n");
         break;
+#endif
+#if defined(GTA_CLI_FUNC_UNSEAL_DATA)
     case unseal_data:
         printf("Usage: gta-cli unseal_data --options\n");
         printf("Options:\n");
         printf("  --pers=PERSONALITY_NAME  personality to use for the operation\n");
         printf("  --prof=PROFILE_NAME      profile to use for the operation\n");
         printf("  [--data=FILE]            data to be unsealed, if --data is not set data will be read from stdin\n");
+        printf("  [--cache=keyring:TTL]    cache the unsealed data for TTL seconds in the user kernel keyring, use "
+               "session_keyring:TTL for the session keyring\n");
+        printf("  [--threads=N]            number of threads unsealing the chunks of a chunked container [default: "
+               "0, number of online CPUs]\n");
+        printf("  [--range=OFFSET:LEN]     unseal only LEN bytes at OFFSET of a chunked container file given with "
+               "--data, only the chunks covering the range are unsealed\n");
+        printf("  [--log_mode]             unseal a sealed log written by seal_data --log_mode\n");
+        printf("  [--decompress]           decompress data sealed with seal_data --compress (chunked containers "
+               "record this themselves)\n");
         break;
+#endif
+#if defined(GTA_CLI_FUNC_IDENTIFIER_ENUMERATE)
     case identifier_enumerate:
         printf("Usage: gta-cli identifier_enumerate --options\n");
         printf("Options:\n");
         printf("  none\n");
         break;
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ENUMERATE)
     case personality_enumerate:
         printf("Usage: gta-cli personality_enumerate --options\n");
         printf("Options:\n");
@@ -489,6 +915,8 @@ void show_function_help(enum functions func)
         printf("  [--pers_flag={ALL|ACTIVE|INACTIVE}] select between active and deactivated personalities [default: "
                "ALL]\n");
         break;
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ENUMERATE_APPLICATION)
     case personality_enumerate_application:
         printf("Usage: gta-cli personality_enumerate_application --options\n");
         printf("Options:\n");
@@ -497,6 +925,8 @@ void show_function_help(enum functions func)
         printf("  [--pers_flag={ALL|ACTIVE|INACTIVE}] select between active and deactivated personalities [default: "
                "ALL]\n");
         break;
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ADD_ATTRIBUTE)
     case personality_add_attribute:
         printf("Usage: gta-cli personality_add_attribute --options\n");
         printf("Options:\n");
@@ -507,6 +937,8 @@ void show_function_help(enum functions func)
         printf("  [--attr_val=FILE]           value for the general attribute, if --attr_val is not set the value will "
                "be read from stdin\n");
         break;
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ADD_TRUSTED_ATTRIBUTE)
     case personality_add_trusted_attribute:
         printf("Usage: gta-cli personality_add_trusted_attribute --options\n");
         printf("Options:\n");
@@ -517,6 +949,8 @@ void show_function_help(enum functions func)
         printf("  [--attr_val=FILE]           value for the trusted attribute, if --attr_val is not set the value will "
                "be read from stdin\n");
         break;
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_GET_ATTRIBUTE)
     case personality_get_attribute:
         printf("Usage: gta-cli personality_get_attribute --options\n");
         printf("Options:\n");
@@ -524,6 +958,8 @@ void show_function_help(enum functions func)
         printf("  --prof=PROFILE              profile to use\n");
         printf("  --attr_name=ATTRIBUTE_NAME  attribute to be queried\n");
         break;
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_REMOVE_ATTRIBUTE)
     case personality_remove_attribute:
         printf("Usage: gta-cli personality_remove_attribute --options\n");
         printf("Options:\n");
@@ -531,11 +967,15 @@ void show_function_help(enum functions func)
         printf("  --prof=PROFILE              profile to use\n");
         printf("  --attr_name=ATTRIBUTE_NAME  attribute to be removed\n");
         break;
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ATTRIBUTES_ENUMERATE)
     case personality_attributes_enumerate:
         printf("Usage: gta-cli personality_attributes_enumerate --options\n");
         printf("Options:\n");
         printf("  --pers=PERSONALITY_NAME  personality for which the available attributes are enumerated\n");
         break;
+#endif
+#if defined(GTA_CLI_FUNC_AUTHENTICATE_DATA_DETACHED)
     case authenticate_data_detached:
         printf("Usage: gta-cli authenticate_data_detached --options\n");
         printf("Options:\n");
@@ -543,7 +983,21 @@ void show_function_help(enum functions func)
         printf("  --prof=PROFILE           profile to use for the operation\n");
         printf(
             "  --data=FILE              data to be protected, if --data is not set the data will be read from stdin\n");
+        printf("                           a comma separated list of files (--data=FILE1,FILE2) is read as one "
+               "concatenated stream\n");
+        printf("  [--data_list=FILE]       files read as one concatenated stream instead of --data, one path per "
+               "line\n");
+        printf("  [--tree_hash=ALG:CHUNK]  authenticate the Merkle tree hash of the data (e.g. sha256:4M), the chunks "
+               "are hashed in parallel\n");
+        printf("  [--threads=N]            number of threads hashing chunks [default: 0, number of online CPUs]\n");
+        printf("  [--incremental]          authenticate every file of --dir to FILE.seal, files which are unchanged "
+               "since the last run are skipped\n");
+        printf("  [--dir=DIR]              directory tree authenticated with --incremental\n");
+        printf("  [--index=FILE]           index of sizes, modification times and hashes of the files of --dir, the "
+               "paths of the authenticated files are written to stdout\n");
         break;
+#endif
+#if defined(GTA_CLI_FUNC_VERIFY_DATA_DETACHED)
     case verify_data_detached:
         printf("Usage: gta-cli verify_data_detached --options\n");
         printf("Options:\n");
@@ -551,8 +1005,121 @@ void show_function_help(enum functions func)
         printf("  --prof=PROFILE           profile to use for the operation\n");
         printf(
             "  --data=FILE              data to be verified, if --data is not set the data will be read from stdin\n");
+        printf("                           a comma separated list of files (--data=FILE1,FILE2) is read as one "
+               "concatenated stream\n");
+        printf("  [--data_list=FILE]       files read as one concatenated stream instead of --data, one path per "
+               "line\n");
         printf("  --seal=FILE              authentication seal to be verified\n");
+        printf("  [--tree_hash=ALG:CHUNK]  verify the Merkle tree hash of the data, use the value given to "
+               "authenticate_data_detached\n");
+        printf("  [--threads=N]            number of threads hashing chunks [default: 0, number of online CPUs]\n");
+        break;
+#endif
+#if defined(GTA_CLI_FUNC_AUTHENTICATE_BATCH)
+    case authenticate_batch:
+        printf("Usage: gta-cli authenticate_batch --options\n");
+        printf("Options:\n");
+        printf("  --pers=PERSONALITY_NAME  personality to use for the operation\n");
+        printf("  --prof=PROFILE           profile to use for the operation\n");
+        printf("  [--data_list=FILE]       files to be protected, one path per line, if --data_list is not set the "
+               "list will be read from stdin\n");
+        printf("The seal of the batch is written to stdout, the inclusion proof of each file to FILE%s\n",
+               BATCH_PROOF_SUFFIX);
+        break;
+#endif
+#if defined(GTA_CLI_FUNC_VERIFY_BATCH)
+    case verify_batch:
+        printf("Usage: gta-cli verify_batch --options\n");
+        printf("Options:\n");
+        printf("  --pers=PERSONALITY_NAME  personality to use for the operation\n");
+        printf("  --prof=PROFILE           profile to use for the operation\n");
+        printf("  --data=FILE              file to be verified\n");
+        printf("  [--proof=FILE]           inclusion proof of the file [default: FILE%s]\n", BATCH_PROOF_SUFFIX);
+        printf("  --seal=FILE              seal of the batch\n");
+        break;
+#endif
+#if defined(GTA_CLI_FUNC_RESEAL)
+    case reseal:
+        printf("Usage: gta-cli reseal --options\n");
+        printf("Options:\n");
+        printf("  --pers=PERSONALITY_NAME     personality the data is sealed with\n");
+        printf("  --prof=PROFILE              profile the data is sealed with\n");
+        printf("  --to_pers=PERSONALITY_NAME  personality to seal the data with\n");
+        printf("  --to_prof=PROFILE           profile to seal the data with\n");
+        printf("  [--data=FILE]               sealed data, if neither --data nor --dir is set the data will be read "
+               "from stdin, the resealed data is written to stdout\n");
+        printf("  [--dir=DIR]                 reseal all files of DIR to files with the same name in --out_dir\n");
+        printf("  [--out_dir=DIR]             directory for the resealed files of --dir\n");
+        printf("  [--threads=N]               number of files resealed in parallel with --dir [default: 0, number of "
+               "online CPUs]\n");
+        printf("  [--journal=FILE]            record the resealed files of --dir in FILE, a restarted run skips the "
+               "files which are complete\n");
+        printf("The plaintext is passed in memory and never written to a file\n");
+        break;
+#endif
+#if defined(GTA_CLI_FUNC_VAULT_PUT)
+    case vault_put:
+        printf("Usage: gta-cli vault_put --options\n");
+        printf("Options:\n");
+        printf("  --pers=PERSONALITY_NAME  personality to use for the operation\n");
+        printf("  --prof=PROFILE           profile to use for the operation\n");
+        printf("  --vault=FILE             vault file, created if it does not exist\n");
+        printf("  --key=KEY                key of the value (up to %d printable characters except '/' and ',')\n",
+               VAULT_MAX_KEY_LEN);
+        printf("  --data=FILE              value to be protected, if --data is not set the value will be read from "
+               "stdin\n");
+        break;
+#endif
+#if defined(GTA_CLI_FUNC_VAULT_GET)
+    case vault_get:
+        printf("Usage: gta-cli vault_get --options\n");
+        printf("Options:\n");
+        printf("  --pers=PERSONALITY_NAME  personality to use for the operation\n");
+        printf("  --prof=PROFILE           profile to use for the operation\n");
+        printf("  --vault=FILE             vault file\n");
+        printf("  --key=KEY[,KEY...]       key of the value written to stdout, or several keys with --out_dir\n");
+        printf("  [--out_dir=DIR]          write the value of each key to the file DIR/KEY\n");
+        printf("  [--journal=FILE]         record the keys written to --out_dir in FILE, a restarted run skips the "
+               "keys which are complete\n");
+        break;
+#endif
+#if defined(GTA_CLI_FUNC_VAULT_LIST)
+    case vault_list:
+        printf("Usage: gta-cli vault_list --options\n");
+        printf("Options:\n");
+        printf("  --vault=FILE             vault file\n");
         break;
+#endif
+#if defined(GTA_CLI_FUNC_EXEC)
+    case exec:
+        printf("Usage: gta-cli exec --options -- COMMAND [ARGUMENT...]\n");
+        printf("Options:\n");
+        printf("  --pers=PERSONALITY_NAME       personality to use for the operation\n");
+        printf("  --prof=PROFILE                profile to use for the operation\n");
+        printf("  [(--secret NAME=FILE)...]     unseal FILE into a sealed memfd inherited by COMMAND, the environment "
+               "variable NAME is set to its path /dev/fd/N\n");
+        printf("  [(--secret_env NAME=FILE)...] unseal FILE into the environment variable NAME\n");
+        printf("The secrets are never written to the file system, COMMAND replaces gta-cli after the GTA instance "
+               "has been released\n");
+        break;
+#endif
+#if defined(GTA_CLI_FUNC_WATCH)
+    case watch:
+        printf("Usage: gta-cli watch --options\n");
+        printf("Options:\n");
+        printf("  --pers=PERSONALITY_NAME  personality to use for the operation\n");
+        printf("  --prof=PROFILE           profile to use for the operation\n");
+        printf("  --op=OP                  'seal' or 'authenticate'\n");
+        printf("  --dir=DIR                spool directory, files starting with '.' are ignored\n");
+        printf("  --out_dir=DIR            done directory on the same file system: seal writes the sealed data to "
+               "DIR/NAME, authenticate moves the file to DIR/NAME and writes the seal to DIR/NAME%s\n",
+               WATCH_SEAL_SUFFIX);
+        printf("  [--flush_ms=MS]          time files are collected into a batch after the first one [default: %d]\n",
+               WATCH_DEFAULT_FLUSH_MS);
+        printf("Runs until SIGINT or SIGTERM is received\n");
+        break;
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ENROLL)
     case personality_enroll:
         printf("Usage: gta-cli personality_enroll --options\n");
         printf("Options:\n");
@@ -571,12 +1138,16 @@ void show_function_help(enum functions func)
         printf("                                            FILE is the path to a file with the attribute value as "
                "binary\n");
         break;
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_REMOVE)
     case personality_remove:
         printf("Usage: gta-cli personality_remove --options\n");
         printf("Options:\n");
         printf("  --pers=PERSONALITY_NAME   personality which should be deleted\n");
         printf("  --prof=PROFILE_NAME       profile that should be used deleting the personality\n");
         break;
+#endif
+#if defined(GTA_CLI_FUNC_DEVICESTATE_TRANSITION)
     case devicestate_transition:
         printf("Usage: gta-cli devicestate_transition --options\n");
         printf("Options:\n");
@@ -587,17 +1158,47 @@ void show_function_help(enum functions func)
         printf("                                        with authentication by physical access for future device "
                "states\n");
         break;
+#endif
+#if defined(GTA_CLI_FUNC_DEVICESTATE_RECEDE)
     case devicestate_recede:
         printf("Usage: gta-cli devicestate_recede\n");
         printf("No options\n");
         break;
+#endif
+#if defined(GTA_CLI_FUNC_ACCESS_POLICY_SIMPLE)
     case access_policy_simple:
         printf("Usage: gta-cli access_policy_simple\n");
         printf("Options:\n");
         printf(" [--descr_type={INITIAL|BASIC|PHYSICAL_PRESENCE}]   type of single access descriptor that is used to "
                "setup the simple access policy [default: INITIAL]\n");
         break;
+#endif
+#if defined(GTA_CLI_FUNC_CACHE_FLUSH)
+    case cache_flush:
+        printf("Usage: gta-cli cache_flush\n");
+        printf("No options\n");
+        break;
+#endif
+#if defined(GTA_CLI_FUNC_METRICS_SUMMARY)
+    case metrics_summary:
+        printf("Usage: gta-cli metrics_summary --options\n");
+        printf("Options:\n");
+        printf("  [--metrics_file=FILE]  metrics file to be evaluated [default: environment variable %s]\n",
+               METRICS_FILE_ENV);
+        break;
+
+#endif
+#if defined(GTA_CLI_FUNC_REPLAY)
+    case replay:
+        printf("Usage: gta-cli replay --options\n");
+        printf("Options:\n");
+        printf("  --record=FILE          workload recorded with --record\n");
+        printf("  [--binary=PATH]        gta-cli binary to be measured [default: this binary]\n");
+        printf("  [--dir=DIR]            new or empty scratch directory which is kept for inspection [default: a "
+               "temporary directory]\n");
+        break;
 
+#endif
     default:
         fprintf(stderr, "Unknown function.\n");
         show_help();
@@ -705,6 +1306,76 @@ int init_ifilestream(const char * data, myio_ifilestream_t * ifilestream)
     return EXIT_SUCCESS;
 }
 
+#if defined(WITH_DATA_DETACHED)
+/* True if the data is given as list of files (--data=a,b,c or --data_list) */
+static bool is_data_list(const char * data, const char * data_list)
+{
+    return (NULL != data_list) || ((NULL != data) && (NULL != strchr(data, ',')));
+}
+
+/*
+ * Helper function to initialize a multi_istream, which reads the files of the
+ * comma separated list in data or of the list file data_list (one path per
+ * line) one after another.
+ */
+static int init_multi_istream(const char * data, const char * data_list, multi_istream_t * istream)
+{
+    int ret = EXIT_FAILURE;
+    char * p_copy = NULL;
+    FILE * p_list = NULL;
+    char * p_line = NULL;
+    size_t line_size = 0;
+    ssize_t len = 0;
+
+    multi_istream_init(istream);
+    if ((NULL != data) && (NULL != data_list)) {
+        fprintf(stderr, "Only one of --data and --data_list can be set\n");
+        return EXIT_FAILURE;
+    }
+    if (NULL != data) {
+        if (NULL == (p_copy = strdup(data))) {
+            fprintf(stderr, "Memory allocation error\n");
+            goto cleanup;
+        }
+        char * p_save = NULL;
+        for (char * p_path = strtok_r(p_copy, ",", &p_save); NULL != p_path; p_path = strtok_r(NULL, ",", &p_save)) {
+            if (EXIT_SUCCESS != multi_istream_add(istream, p_path)) {
+                goto cleanup;
+            }
+        }
+    } else {
+        if (NULL == (p_list = fopen(data_list, "r"))) {
+            fprintf(stderr, "Cannot open file %s\n", data_list);
+            goto cleanup;
+        }
+        while (0 <= (len = getline(&p_line, &line_size, p_list))) {
+            while ((0 < len) && (('\n' == p_line[len - 1]) || ('\r' == p_line[len - 1]))) {
+                p_line[--len] = '\0';
+            }
+            if ((0 != len) && (EXIT_SUCCESS != multi_istream_add(istream, p_line))) {
+                goto cleanup;
+            }
+        }
+    }
+    if (0 == istream->num_files) {
+        fprintf(stderr, "No data files given\n");
+        goto cleanup;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    if (EXIT_SUCCESS != ret) {
+        multi_istream_close(istream);
+    }
+    free(p_copy);
+    free(p_line);
+    if (NULL != p_list) {
+        fclose(p_list);
+    }
+    return ret;
+}
+#endif
+
 /* Initializes ofilestream to stdout. */
 void init_ofilestream(myio_ofilestream_t * ofilestream)
 {
@@ -713,6 +1384,235 @@ void init_ofilestream(myio_ofilestream_t * ofilestream)
     ofilestream->file = stdout;
 }
 
+/* Functions which only read the provider state can share the state directory */
+static bool is_state_reader(enum functions func)
+{
+    switch (func) {
+    case seal_data:
+    case unseal_data:
+    case identifier_enumerate:
+    case personality_enumerate:
+    case personality_enumerate_application:
+    case personality_get_attribute:
+    case personality_attributes_enumerate:
+    case authenticate_data_detached:
+    case verify_data_detached:
+    case authenticate_batch:
+    case verify_batch:
+    case reseal:
+    case vault_put:
+    case vault_get:
+    case vault_list:
+    case exec:
+    case watch:
+    case access_policy_simple:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static int parse_lock_timeout(const char * p_timeout, long * p_timeout_ms)
+{
+    char * p_endptr = NULL;
+    long timeout_ms = strtol(p_timeout, &p_endptr, 10);
+
+    if (('\0' == *p_timeout) || ('\0' != *p_endptr) || (0 > timeout_ms)) {
+        fprintf(stderr, "Invalid input: '%s' is not a valid lock timeout\n", p_timeout);
+        return EXIT_FAILURE;
+    }
+    *p_timeout_ms = timeout_ms;
+    return EXIT_SUCCESS;
+}
+
+/* Mutex functions of the GTA instance, required as chunked containers are processed by several threads */
+static void * mutex_create(void)
+{
+    pthread_mutex_t * p_mutex = malloc(sizeof(pthread_mutex_t));
+    if ((NULL != p_mutex) && (0 != pthread_mutex_init(p_mutex, NULL))) {
+        free(p_mutex);
+        p_mutex = NULL;
+    }
+    return p_mutex;
+}
+
+static bool mutex_destroy(void * p_mutex)
+{
+    bool b_ret = (0 == pthread_mutex_destroy((pthread_mutex_t *)p_mutex));
+    free(p_mutex);
+    return b_ret;
+}
+
+static bool mutex_lock(void * p_mutex)
+{
+    return 0 == pthread_mutex_lock((pthread_mutex_t *)p_mutex);
+}
+
+static bool mutex_unlock(void * p_mutex)
+{
+    return 0 == pthread_mutex_unlock((pthread_mutex_t *)p_mutex);
+}
+
+/* Registers the profiles for the provider working on the state directory p_state_dir */
+static bool register_profiles(gta_instance_handle_t h_inst, const char * p_state_dir, gta_errinfo_t * p_errinfo)
+{
+    istream_from_buf_t init_config = {0};
+
+    istream_from_buf_init(&init_config, p_state_dir, strnlen(p_state_dir, MAXLEN_STATEDIR_PATH));
+    for (size_t i = 0; i < (sizeof(profiles_to_register) / sizeof(profiles_to_register[0])); ++i) {
+        if (!TRACE_BOOL(
+                gta_sw_provider_gta_register_provider,
+                (h_inst, (gtaio_istream_t *)&init_config, profiles_to_register[i], p_errinfo),
+                p_errinfo)) {
+            fprintf(stderr, "gta_sw_provider_gta_register_provider failed with ERROR_CODE %ld\n", *p_errinfo);
+            return false;
+        }
+    }
+    return true;
+}
+
+#if defined(GTA_CLI_FUNC_WATCH)
+/*
+ * Session of watch: the state directory is locked with a shared lock and an
+ * instance and a context are opened for each batch only, so the daemon
+ * neither blocks writers of the state nor works on an outdated state.
+ */
+typedef struct watch_state_session {
+    watch_session_t session; /* interface used by watch_run */
+    statedir_t statedir;
+    const char * p_state_dir;
+    enum statedir_mode state_mode;
+    long lock_timeout_ms;
+    const struct gta_instance_params_t * p_inst_params;
+    const char * p_pers;
+    const char * p_prof;
+    gta_instance_handle_t h_inst;
+    gta_context_handle_t h_ctx;
+} watch_state_session_t;
+
+static void watch_session_end(watch_state_session_t * p_session)
+{
+    gta_errinfo_t errinfo = 0;
+
+    if (GTA_HANDLE_INVALID != p_session->h_ctx) {
+        TRACE_BOOL(gta_context_close, (p_session->h_ctx, &errinfo), &errinfo);
+        p_session->h_ctx = GTA_HANDLE_INVALID;
+    }
+    if (GTA_HANDLE_INVALID != p_session->h_inst) {
+        TRACE_BOOL(gta_instance_final, (p_session->h_inst, &errinfo), &errinfo);
+        p_session->h_inst = GTA_HANDLE_INVALID;
+    }
+    statedir_close(&p_session->statedir);
+}
+
+static gta_context_handle_t watch_session_begin(watch_state_session_t * p_session, gta_errinfo_t * p_errinfo)
+{
+    if (EXIT_SUCCESS != statedir_open(
+                            &p_session->statedir,
+                            p_session->p_state_dir,
+                            p_session->state_mode,
+                            false,
+                            p_session->lock_timeout_ms)) {
+        return GTA_HANDLE_INVALID;
+    }
+    p_session->h_inst = TRACE_PTR(gta_instance_init, (p_session->p_inst_params, p_errinfo), p_errinfo);
+    if (NULL == p_session->h_inst) {
+        fprintf(stderr, "h_inst failed with ERROR_CODE %ld\n", *p_errinfo);
+        watch_session_end(p_session);
+        return GTA_HANDLE_INVALID;
+    }
+    if (!register_profiles(p_session->h_inst, statedir_work_path(&p_session->statedir), p_errinfo)) {
+        watch_session_end(p_session);
+        return GTA_HANDLE_INVALID;
+    }
+    p_session->h_ctx = TRACE_PTR(
+        gta_context_open, (p_session->h_inst, p_session->p_pers, p_session->p_prof, p_errinfo), p_errinfo);
+    if (NULL == p_session->h_ctx) {
+        fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", *p_errinfo);
+        watch_session_end(p_session);
+        return GTA_HANDLE_INVALID;
+    }
+    return p_session->h_ctx;
+}
+#endif
+
+/* Begins a phase of the invocation, recorded in the metrics, as span in the trace and in the counters (NULL: none) */
+static void phase_begin(metrics_t * p_metrics, perf_counters_t * p_perf, enum metrics_phase phase)
+{
+    metrics_phase_begin(p_metrics, phase);
+    trace_span_begin();
+    if (NULL != p_perf) {
+        perf_counters_phase_begin(p_perf, phase);
+    }
+}
+
+/* Ends a phase of the invocation, does nothing if the phase is not running */
+static void phase_end(metrics_t * p_metrics, perf_counters_t * p_perf, enum metrics_phase phase)
+{
+    if (NULL != p_perf) {
+        perf_counters_phase_end(p_perf, phase);
+    }
+    if (0 != p_metrics->phase_start_ns[phase]) {
+        trace_span_end("phase", metrics_phase_name(phase));
+    }
+    metrics_phase_end(p_metrics, phase);
+}
+
+#if defined(WITH_DIGEST_STAGE)
+/* Returns the sink of the operation, preceded by the digest stage if --out_digest is given */
+static gtaio_ostream_t * digest_stage(digest_ostream_t * p_digest, gtaio_ostream_t * p_sink)
+{
+    if (NULL == p_digest->md_ctx) {
+        return p_sink;
+    }
+    p_digest->inner = p_sink;
+    return (gtaio_ostream_t *)p_digest;
+}
+#endif
+
+#if defined(GTA_CLI_FUNC_UNSEAL_DATA)
+/* Writes a buffer to stdout, passing the output stages */
+static bool write_output(digest_ostream_t * p_digest, const char * p_buf, size_t len)
+{
+    myio_ofilestream_t ostream_stdout = {0};
+    gta_errinfo_t errinfo = 0;
+
+    init_ofilestream(&ostream_stdout);
+    gtaio_ostream_t * p_ostream = digest_stage(p_digest, (gtaio_ostream_t *)&ostream_stdout);
+    return len == p_ostream->write(p_ostream, p_buf, len, &errinfo);
+}
+#endif
+
+/* Parses "ALG:FILE" and initializes the digest stage */
+static int init_out_digest(const char * p_spec, digest_ostream_t * p_digest, const char ** pp_path)
+{
+    char md_name[MAXLEN_DIGEST_NAME] = {0};
+    const char * p_sep = strchr(p_spec, ':');
+
+    if ((NULL == p_sep) || ('\0' == p_sep[1]) || (p_sep == p_spec) || ((size_t)(p_sep - p_spec) >= sizeof(md_name))) {
+        fprintf(stderr, "Invalid input: '%s' is not of the form ALG:FILE\n", p_spec);
+        return EXIT_FAILURE;
+    }
+    memcpy(md_name, p_spec, (size_t)(p_sep - p_spec));
+    *pp_path = p_sep + 1;
+
+    return digest_ostream_init(p_digest, NULL, md_name);
+}
+
+/* Writes the digest of the output to a file */
+static int write_out_digest(const char * p_hex, const char * p_path)
+{
+    FILE * p_file = fopen(p_path, "w");
+    if (NULL == p_file) {
+        fprintf(stderr, "Cannot open digest file %s\n", p_path);
+        return EXIT_FAILURE;
+    }
+    bool b_ok = (0 <= fprintf(p_file, "%s\n", p_hex));
+    b_ok = (0 == fclose(p_file)) && b_ok;
+
+    return b_ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 int pers_add_attribute(
     gta_instance_handle_t h_inst,
     gta_context_handle_t h_ctx,
@@ -734,26 +1634,30 @@ int pers_add_attribute(
         goto cleanup;
     }
 
-    h_ctx = gta_context_open(h_inst, arguments->pers, arguments->prof, &errinfo);
+    h_ctx = TRACE_PTR(gta_context_open, (h_inst, arguments->pers, arguments->prof, &errinfo), &errinfo);
     if (NULL == h_ctx) {
         fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", errinfo);
         goto cleanup;
     }
 
     if (trusted) {
-        if (!gta_personality_add_trusted_attribute(
-                h_ctx, arguments->attr_type, arguments->attr_name, (gtaio_istream_t *)&istream_attr_val, &errinfo)) {
+        if (!TRACE_BOOL(
+                gta_personality_add_trusted_attribute,
+                (h_ctx, arguments->attr_type, arguments->attr_name, (gtaio_istream_t *)&istream_attr_val, &errinfo),
+                &errinfo)) {
             fprintf(stderr, "gta_personality_add_attribute failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
     } else {
-        if (!gta_personality_add_attribute(
-                h_ctx, arguments->attr_type, arguments->attr_name, (gtaio_istream_t *)&istream_attr_val, &errinfo)) {
+        if (!TRACE_BOOL(
+                gta_personality_add_attribute,
+                (h_ctx, arguments->attr_type, arguments->attr_name, (gtaio_istream_t *)&istream_attr_val, &errinfo),
+                &errinfo)) {
             fprintf(stderr, "gta_personality_add_attribute failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
     }
-    if (!gta_context_close(h_ctx, &errinfo)) {
+    if (!TRACE_BOOL(gta_context_close, (h_ctx, &errinfo), &errinfo)) {
         fprintf(stderr, "gta_context_close failed with ERROR_CODE %ld\n", errinfo);
         goto cleanup;
     }
@@ -909,9 +1813,96 @@ int main(int argc, char * argv[])
 
     gta_instance_handle_t h_inst = GTA_HANDLE_INVALID;
     gta_context_handle_t h_ctx = GTA_HANDLE_INVALID;
+    gta_context_handle_t h_ctx_target = GTA_HANDLE_INVALID; /* reseal: context the data is sealed with */
     myio_ifilestream_t istream = {0};
     myio_ifilestream_t istream_seal = {0};
     gta_errinfo_t errinfo = 0;
+#if defined(GTA_CLI_FUNC_UNSEAL_DATA)
+    keyring_cache_t unseal_cache = {0};
+#endif
+    ostream_to_dynbuf_t sealed_data = {0};
+    ostream_to_dynbuf_t unsealed_data = {0};
+    metrics_t metrics = {0};
+    perf_counters_t perf = {0};
+    perf_counters_t * p_perf = NULL; /* NULL if the phases are not counted */
+    char perf_json[1536] = {0};
+    stats_istream_t istream_stats = {0};
+    stats_istream_t istream_seal_stats = {0};
+    stats_ostream_t ostream_stats = {0};
+    enum statedir_mode state_mode = STATEDIR_MODE_DIRECT;
+    long lock_timeout_ms = STATEDIR_LOCK_WAIT_FOREVER;
+    statedir_t statedir = {.lock_fd = -1};
+#if defined(WITH_PROGRESS)
+    const char * p_progress = NULL;
+#endif
+    digest_ostream_t ostream_digest = {0};
+    const char * p_out_digest_path = NULL;
+    char out_hash[MAXLEN_DIGEST_NAME + 1 + (2 * EVP_MAX_MD_SIZE) + 1] = {0}; /* "ALG:HEX" */
+#if defined(GTA_CLI_FUNC_SEAL_DATA)
+    compress_istream_t istream_compress = {0};
+#endif
+#if defined(GTA_CLI_FUNC_UNSEAL_DATA)
+    decompress_ostream_t ostream_decompress = {0};
+    peek_istream_t istream_peek = {0};
+#endif
+#if defined(WITH_DATA_DETACHED)
+    tree_hash_t tree_hash = {0};
+    char tree_hash_encoded[TREE_HASH_MAX_ENCODED] = {0};
+    istream_from_buf_t istream_tree_hash = {0};
+    multi_istream_t istream_multi = {0};
+#endif
+#if defined(WITH_VAULT)
+    vault_t vault = {.fd = -1};
+#endif
+#if defined(WITH_JOURNAL)
+    journal_t journal = {.fd = -1};
+#endif
+#if defined(WITH_CHUNKED)
+    size_t chunk_size = 0;
+    unsigned int threads = 0;
+#endif
+
+    /* Functions which do not require a GTA instance */
+#if defined(GTA_CLI_FUNC_CACHE_FLUSH)
+    if (cache_flush == arguments.func) {
+        return keyring_cache_flush();
+    }
+#endif
+#if defined(GTA_CLI_FUNC_METRICS_SUMMARY)
+    if (metrics_summary == arguments.func) {
+        if (NULL == arguments.metrics_file) {
+            fprintf(stderr, "Invalid or missing function arguments\n");
+            show_function_help(arguments.func);
+            return EXIT_FAILURE;
+        }
+        return metrics_print_summary(arguments.metrics_file);
+    }
+#endif
+#if defined(GTA_CLI_FUNC_REPLAY)
+    if (replay == arguments.func) {
+        if (NULL == arguments.record) {
+            fprintf(stderr, "Invalid or missing function arguments\n");
+            show_function_help(arguments.func);
+            return EXIT_FAILURE;
+        }
+        return record_replay(arguments.record, arguments.binary, arguments.dir);
+    }
+#endif
+
+    metrics_init(&metrics, arguments.func_name, arguments.prof);
+    trace_set_invocation(arguments.func_name, arguments.prof);
+#if defined(WITH_PROGRESS)
+    if (arguments.io_stats && isatty(STDERR_FILENO)) {
+        p_progress = arguments.func_name;
+    }
+#endif
+    if ((NULL != arguments.trace) && (EXIT_SUCCESS != trace_open(arguments.trace))) {
+        return EXIT_FAILURE;
+    }
+    /* Without counters (e.g. in a container) the invocation continues uncounted */
+    if (arguments.perf_counters && (EXIT_SUCCESS == perf_counters_open(&perf))) {
+        p_perf = &perf;
+    }
 
     /* GTA instance used by the tests */
     struct gta_instance_params_t inst_params = {
@@ -919,18 +1910,94 @@ int main(int argc, char * argv[])
         {
             .calloc = &calloc,
             .free = &free,
-            .mutex_create = NULL,
-            .mutex_destroy = NULL,
-            .mutex_lock = NULL,
-            .mutex_unlock = NULL,
+            .mutex_create = &mutex_create,
+            .mutex_destroy = &mutex_destroy,
+            .mutex_lock = &mutex_lock,
+            .mutex_unlock = &mutex_unlock,
         },
         NULL};
 
-    istream_from_buf_t init_config = {0};
-    istream_from_buf_init(&init_config, p_state_dir, strnlen(p_state_dir, MAXLEN_STATEDIR_PATH));
+    ostream_to_dynbuf_init(&sealed_data);
+    ostream_to_dynbuf_init(&unsealed_data);
+
+    if ((NULL != arguments.out_digest) &&
+        (EXIT_SUCCESS != init_out_digest(arguments.out_digest, &ostream_digest, &p_out_digest_path))) {
+        goto cleanup;
+    }
+    /* The output of a recorded invocation is identified by its hash in a replay */
+    if ((NULL != arguments.record) && (NULL == arguments.out_digest) &&
+        (EXIT_SUCCESS != digest_ostream_init(&ostream_digest, NULL, "sha256"))) {
+        goto cleanup;
+    }
+
+#if defined(GTA_CLI_FUNC_UNSEAL_DATA)
+    /*
+     * Cached unseal: the sealed data is read completely, as the cache entry is
+     * identified by its hash. On a cache hit the GTA instance is not needed.
+     */
+    if ((unseal_data == arguments.func) && (NULL != arguments.cache)) {
+        char * p_cached = NULL;
+        size_t cached_len = 0;
+
+        if ((NULL == arguments.pers) || (NULL == arguments.prof)) {
+            fprintf(stderr, "Invalid function arguments\n");
+            show_function_help(arguments.func);
+            goto cleanup;
+        }
+        if ((EXIT_SUCCESS != keyring_cache_parse(arguments.cache, &unseal_cache)) ||
+            (EXIT_SUCCESS != init_ifilestream(arguments.data, &istream)) ||
+            (EXIT_SUCCESS != read_istream_to_dynbuf((gtaio_istream_t *)&istream, &sealed_data)) ||
+            (EXIT_SUCCESS !=
+             keyring_cache_set_desc(
+                 &unseal_cache, arguments.pers, arguments.prof, sealed_data.buf, sealed_data.buf_pos))) {
+            goto cleanup;
+        }
+
+        if (keyring_cache_lookup(&unseal_cache, &p_cached, &cached_len)) {
+            if (!write_output(&ostream_digest, p_cached, cached_len)) {
+                keyring_cache_free_data(p_cached, KEYRING_CACHE_MAX_PAYLOAD);
+                goto cleanup;
+            }
+            keyring_cache_free_data(p_cached, KEYRING_CACHE_MAX_PAYLOAD);
+            ret = EXIT_SUCCESS;
+            goto cleanup;
+        }
+    }
+#endif
+
+#if defined(WITH_CHUNKED)
+    if (((NULL != arguments.chunk_size) && (EXIT_SUCCESS != chunked_parse_size(arguments.chunk_size, &chunk_size))) ||
+        ((NULL != arguments.threads) && (EXIT_SUCCESS != chunked_parse_threads(arguments.threads, &threads)))) {
+        goto cleanup;
+    }
+#endif
+#if defined(WITH_DATA_DETACHED)
+    if ((NULL != arguments.tree_hash) && (EXIT_SUCCESS != tree_hash_parse(arguments.tree_hash, &tree_hash))) {
+        goto cleanup;
+    }
+#endif
+    if ((NULL != arguments.state_mode) && (EXIT_SUCCESS != statedir_parse_mode(arguments.state_mode, &state_mode))) {
+        goto cleanup;
+    }
+    if ((NULL != arguments.lock_timeout) &&
+        (EXIT_SUCCESS != parse_lock_timeout(arguments.lock_timeout, &lock_timeout_ms))) {
+        goto cleanup;
+    }
+    /* Only operations writing one output file per item can be resumed */
+    if ((NULL != arguments.journal) && !((reseal == arguments.func) && (NULL != arguments.dir)) &&
+        !((vault_get == arguments.func) && (NULL != arguments.out_dir))) {
+        fprintf(stderr, "--journal is only supported by reseal --dir and vault_get --out_dir\n");
+        goto cleanup;
+    }
+    if (EXIT_SUCCESS !=
+        statedir_open(&statedir, p_state_dir, state_mode, !is_state_reader(arguments.func), lock_timeout_ms)) {
+        goto cleanup;
+    }
 
     /* initialising gta_instance */
-    h_inst = gta_instance_init(&inst_params, &errinfo);
+    phase_begin(&metrics, p_perf, METRICS_PHASE_INSTANCE_INIT);
+    h_inst = TRACE_PTR(gta_instance_init, (&inst_params, &errinfo), &errinfo);
+    phase_end(&metrics, p_perf, METRICS_PHASE_INSTANCE_INIT);
 
     if (NULL == h_inst) {
         fprintf(stderr, "h_inst failed with ERROR_CODE %ld\n", errinfo);
@@ -938,16 +2005,17 @@ int main(int argc, char * argv[])
     }
 
     /* register profiles for provider */
-    for (size_t i = 0; i < (sizeof(profiles_to_register) / sizeof(profiles_to_register[0])); ++i) {
-        if (!gta_sw_provider_gta_register_provider(
-                h_inst, (gtaio_istream_t *)&init_config, profiles_to_register[i], &errinfo)) {
-            fprintf(stderr, "gta_sw_provider_gta_register_provider failed with ERROR_CODE %ld\n", errinfo);
-            goto cleanup;
-        }
+    phase_begin(&metrics, p_perf, METRICS_PHASE_PROVIDER_REGISTER);
+    if (!register_profiles(h_inst, statedir_work_path(&statedir), &errinfo)) {
+        goto cleanup;
     }
 
+    phase_end(&metrics, p_perf, METRICS_PHASE_PROVIDER_REGISTER);
+
     /* Call the selected function with the parsed arguments */
+    phase_begin(&metrics, p_perf, METRICS_PHASE_OPERATION);
     switch (arguments.func) {
+#if defined(GTA_CLI_FUNC_IDENTIFIER_ASSIGN)
     case identifier_assign: {
 
         if (NULL == arguments.id_type || NULL == arguments.id_val) {
@@ -956,13 +2024,15 @@ int main(int argc, char * argv[])
             goto cleanup;
         }
 
-        if (!gta_identifier_assign(h_inst, arguments.id_type, arguments.id_val, &errinfo)) {
+        if (!TRACE_BOOL(gta_identifier_assign, (h_inst, arguments.id_type, arguments.id_val, &errinfo), &errinfo)) {
             fprintf(stderr, "gta_identifier_assign failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
 
         break;
     }
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_CREATE)
     case personality_create: {
 
         if (NULL == arguments.id_val || NULL == arguments.pers || NULL == arguments.prof ||
@@ -978,7 +2048,8 @@ int main(int argc, char * argv[])
 
         gta_access_policy_handle_t h_auth_initial = GTA_HANDLE_INVALID;
         if ((GTA_HANDLE_INVALID == arguments.h_auth_use) || (GTA_HANDLE_INVALID == arguments.h_auth_admin)) {
-            h_auth_initial = gta_access_policy_simple(h_inst, GTA_ACCESS_DESCRIPTOR_TYPE_INITIAL, &errinfo);
+            h_auth_initial = TRACE_PTR(
+                gta_access_policy_simple, (h_inst, GTA_ACCESS_DESCRIPTOR_TYPE_INITIAL, &errinfo), &errinfo);
             if (h_auth_initial == NULL) {
                 fprintf(stderr, "gta_access_policy_simple failed with ERROR_CODE %ld\n", errinfo);
                 goto cleanup;
@@ -996,21 +2067,25 @@ int main(int argc, char * argv[])
             h_auth_admin = h_auth_initial;
         }
 
-        if (!gta_personality_create(
-                h_inst,
-                arguments.id_val,
-                arguments.pers,
-                arguments.app_name,
-                arguments.prof,
-                h_auth_use,
-                h_auth_admin,
-                protection_properties,
+        if (!TRACE_BOOL(
+                gta_personality_create,
+                (h_inst,
+                 arguments.id_val,
+                 arguments.pers,
+                 arguments.app_name,
+                 arguments.prof,
+                 h_auth_use,
+                 h_auth_admin,
+                 protection_properties,
+                 &errinfo),
                 &errinfo)) {
             fprintf(stderr, "gta_personality_create failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
         break;
     }
+#endif
+#if defined(GTA_CLI_FUNC_SEAL_DATA)
     case seal_data: {
         if (NULL == arguments.pers || NULL == arguments.prof) {
             fprintf(stderr, "Invalid or missing function arguments\n");
@@ -1020,22 +2095,93 @@ int main(int argc, char * argv[])
 
         myio_ofilestream_t ostream_protected_data = {0};
         init_ofilestream(&ostream_protected_data);
+        gtaio_istream_t * p_istream = (gtaio_istream_t *)&istream;
 
         if (EXIT_SUCCESS != init_ifilestream(arguments.data, &istream)) {
             goto cleanup;
         }
 
-        h_ctx = gta_context_open(h_inst, arguments.pers, arguments.prof, &errinfo);
+        if (arguments.log_mode) {
+            unsigned int flush_ms = SEALED_LOG_DEFAULT_FLUSH_MS;
+            size_t flush_bytes = SEALED_LOG_DEFAULT_FLUSH_BYTES;
+
+            /* The frames are written directly to the file descriptor, the output stages are not available */
+            if ((NULL != arguments.compress) || (0 != chunk_size) || (NULL != arguments.out_digest)) {
+                fprintf(stderr, "Invalid function arguments\n");
+                show_function_help(arguments.func);
+                goto cleanup;
+            }
+            if (((NULL != arguments.flush_ms) &&
+                 (EXIT_SUCCESS != sealed_log_parse_ms(arguments.flush_ms, &flush_ms))) ||
+                ((NULL != arguments.flush_bytes) &&
+                 (EXIT_SUCCESS != chunked_parse_size(arguments.flush_bytes, &flush_bytes)))) {
+                goto cleanup;
+            }
+
+            h_ctx = TRACE_PTR(gta_context_open, (h_inst, arguments.pers, arguments.prof, &errinfo), &errinfo);
+            if (NULL == h_ctx) {
+                fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", errinfo);
+                goto cleanup;
+            }
+            fflush(stdout);
+            if (EXIT_SUCCESS !=
+                sealed_log_write(h_ctx, fileno(istream.file), STDOUT_FILENO, flush_ms, flush_bytes, &errinfo)) {
+                goto cleanup;
+            }
+            if (!TRACE_BOOL(gta_context_close, (h_ctx, &errinfo), &errinfo)) {
+                fprintf(stderr, "gta_context_close failed with ERROR_CODE %ld\n", errinfo);
+                goto cleanup;
+            }
+            break;
+        }
+
+        if (NULL != arguments.compress) {
+            enum compress_alg alg = COMPRESS_NONE;
+            int level = 0;
+            if ((EXIT_SUCCESS != compress_parse(arguments.compress, &alg, &level)) ||
+                (EXIT_SUCCESS != compress_istream_init(&istream_compress, p_istream, alg, level))) {
+                goto cleanup;
+            }
+            p_istream = (gtaio_istream_t *)&istream_compress;
+        }
+
+        stats_istream_init(&istream_stats, p_istream);
+        stats_ostream_init(&ostream_stats, digest_stage(&ostream_digest, (gtaio_ostream_t *)&ostream_protected_data));
+        istream_stats.stats.p_progress = p_progress;
+
+        if (0 != chunk_size) {
+            if (EXIT_SUCCESS != chunked_seal(
+                                    h_inst,
+                                    arguments.pers,
+                                    arguments.prof,
+                                    (gtaio_istream_t *)&istream_stats,
+                                    (gtaio_ostream_t *)&ostream_stats,
+                                    chunk_size,
+                                    (NULL != arguments.compress) ? CHUNKED_FLAG_COMPRESSED : 0,
+                                    threads,
+                                    &errinfo)) {
+                goto cleanup;
+            }
+            if (NULL != arguments.data) {
+                myio_close_ifilestream(&istream, &errinfo);
+            }
+            break;
+        }
+
+        h_ctx = TRACE_PTR(gta_context_open, (h_inst, arguments.pers, arguments.prof, &errinfo), &errinfo);
         if (NULL == h_ctx) {
             fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
 
-        if (!gta_seal_data(h_ctx, (gtaio_istream_t *)&istream, (gtaio_ostream_t *)&ostream_protected_data, &errinfo)) {
+        if (!TRACE_BOOL(
+                gta_seal_data,
+                (h_ctx, (gtaio_istream_t *)&istream_stats, (gtaio_ostream_t *)&ostream_stats, &errinfo),
+                &errinfo)) {
             fprintf(stderr, "gta_seal_data failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
-        if (!gta_context_close(h_ctx, &errinfo)) {
+        if (!TRACE_BOOL(gta_context_close, (h_ctx, &errinfo), &errinfo)) {
             fprintf(stderr, "gta_context_close failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
@@ -1046,6 +2192,8 @@ int main(int argc, char * argv[])
 
         break;
     }
+#endif
+#if defined(GTA_CLI_FUNC_UNSEAL_DATA)
     case unseal_data: {
         if (NULL == arguments.pers || NULL == arguments.prof) {
             fprintf(stderr, "Invalid function arguments\n");
@@ -1055,26 +2203,127 @@ int main(int argc, char * argv[])
 
         myio_ofilestream_t ostream_unsealed_data = {0};
         init_ofilestream(&ostream_unsealed_data);
-
-        if (EXIT_SUCCESS != init_ifilestream(arguments.data, &istream)) {
-            goto cleanup;
+        istream_from_buf_t istream_sealed_data = {0};
+        gtaio_istream_t * p_istream = (gtaio_istream_t *)&istream;
+        gtaio_ostream_t * p_ostream = digest_stage(&ostream_digest, (gtaio_ostream_t *)&ostream_unsealed_data);
+
+        if (arguments.log_mode) {
+            if ((NULL != arguments.cache) || arguments.decompress) {
+                fprintf(stderr, "Invalid function arguments\n");
+                show_function_help(arguments.func);
+                goto cleanup;
+            }
+            if (EXIT_SUCCESS != init_ifilestream(arguments.data, &istream)) {
+                goto cleanup;
+            }
+            h_ctx = TRACE_PTR(gta_context_open, (h_inst, arguments.pers, arguments.prof, &errinfo), &errinfo);
+            if (NULL == h_ctx) {
+                fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", errinfo);
+                goto cleanup;
+            }
+            stats_istream_init(&istream_stats, p_istream);
+            stats_ostream_init(&ostream_stats, p_ostream);
+            if (EXIT_SUCCESS != sealed_log_read(
+                                    h_ctx,
+                                    (gtaio_istream_t *)&istream_stats,
+                                    (gtaio_ostream_t *)&ostream_stats,
+                                    &errinfo)) {
+                goto cleanup;
+            }
+            if (!TRACE_BOOL(gta_context_close, (h_ctx, &errinfo), &errinfo)) {
+                fprintf(stderr, "gta_context_close failed with ERROR_CODE %ld\n", errinfo);
+                goto cleanup;
+            }
+            break;
         }
 
-        h_ctx = gta_context_open(h_inst, arguments.pers, arguments.prof, &errinfo);
+        if (NULL != arguments.range) {
+            uint64_t offset = 0;
+            uint64_t len = 0;
 
-        if (NULL == h_ctx) {
-            fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", errinfo);
-            goto cleanup;
+            /* The file is mapped, so it cannot be read from stdin or the cache, compressed data is not supported */
+            if ((NULL == arguments.data) || (NULL != arguments.cache) || arguments.decompress) {
+                fprintf(stderr, "Invalid function arguments\n");
+                show_function_help(arguments.func);
+                goto cleanup;
+            }
+            stats_ostream_init(&ostream_stats, p_ostream);
+            if ((EXIT_SUCCESS != chunked_parse_range(arguments.range, &offset, &len)) ||
+                (EXIT_SUCCESS != chunked_unseal_range(
+                                     h_inst,
+                                     arguments.pers,
+                                     arguments.prof,
+                                     arguments.data,
+                                     offset,
+                                     len,
+                                     (gtaio_ostream_t *)&ostream_stats,
+                                     &errinfo))) {
+                goto cleanup;
+            }
+            break;
         }
 
-        if (!gta_unseal_data(h_ctx, (gtaio_istream_t *)&istream, (gtaio_ostream_t *)&ostream_unsealed_data, &errinfo)) {
-            fprintf(stderr, "gta_unseal_data failed with ERROR_CODE %ld\n", errinfo);
+        if (NULL != arguments.cache) {
+            /* Cache miss: the sealed data has already been read, collect the unsealed data for the cache */
+            istream_from_buf_init(&istream_sealed_data, sealed_data.buf, sealed_data.buf_pos);
+            p_istream = (gtaio_istream_t *)&istream_sealed_data;
+            p_ostream = (gtaio_ostream_t *)&unsealed_data;
+        } else if (EXIT_SUCCESS != init_ifilestream(arguments.data, &istream)) {
             goto cleanup;
         }
 
-        if (!gta_context_close(h_ctx, &errinfo)) {
-            fprintf(stderr, "gta_context_close failed with ERROR_CODE %ld\n", errinfo);
-            goto cleanup;
+        stats_istream_init(&istream_stats, p_istream);
+        stats_ostream_init(&ostream_stats, (gtaio_ostream_t *)&ostream_decompress);
+        istream_stats.stats.p_progress = p_progress;
+
+        /*
+         * Chunked containers are detected by their magic and carry a flag for compressed data, the peeked bytes are
+         * still read by the unseal. The plaintext itself is never inspected for compression.
+         */
+        size_t peeked = 0;
+        peek_istream_init(&istream_peek, (gtaio_istream_t *)&istream_stats);
+        const char * p_magic = peek_istream_peek(&istream_peek, PEEK_ISTREAM_MAX, &peeked, &errinfo);
+        bool b_chunked = chunked_is_container(p_magic, peeked);
+        decompress_ostream_init(
+            &ostream_decompress,
+            p_ostream,
+            b_chunked ? chunked_is_compressed(p_magic, peeked) : arguments.decompress);
+        if (b_chunked) {
+            if (EXIT_SUCCESS != chunked_unseal(
+                                    h_inst,
+                                    arguments.pers,
+                                    arguments.prof,
+                                    (gtaio_istream_t *)&istream_peek,
+                                    (gtaio_ostream_t *)&ostream_stats,
+                                    threads,
+                                    &errinfo)) {
+                goto cleanup;
+            }
+        } else {
+            h_ctx = TRACE_PTR(gta_context_open, (h_inst, arguments.pers, arguments.prof, &errinfo), &errinfo);
+            if (NULL == h_ctx) {
+                fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", errinfo);
+                goto cleanup;
+            }
+            if (!TRACE_BOOL(
+                    gta_unseal_data,
+                    (h_ctx, (gtaio_istream_t *)&istream_peek, (gtaio_ostream_t *)&ostream_stats, &errinfo),
+                    &errinfo)) {
+                fprintf(stderr, "gta_unseal_data failed with ERROR_CODE %ld\n", errinfo);
+                goto cleanup;
+            }
+            if (!TRACE_BOOL(gta_context_close, (h_ctx, &errinfo), &errinfo)) {
+                fprintf(stderr, "gta_context_close failed with ERROR_CODE %ld\n", errinfo);
+                goto cleanup;
+            }
+        }
+
+        if (NULL != arguments.cache) {
+            if (!write_output(&ostream_digest, unsealed_data.buf, unsealed_data.buf_pos)) {
+                goto cleanup;
+            }
+            /* A failure to populate the cache is not fatal, the next call unseals again */
+            keyring_cache_store(&unseal_cache, unsealed_data.buf, unsealed_data.buf_pos);
         }
 
         if (NULL != arguments.data) {
@@ -1083,6 +2332,8 @@ int main(int argc, char * argv[])
 
         break;
     }
+#endif
+#if defined(GTA_CLI_FUNC_IDENTIFIER_ENUMERATE)
     case identifier_enumerate: {
         int num_of_identifier = 0;
         bool b_loop = true;
@@ -1097,8 +2348,10 @@ int main(int argc, char * argv[])
             ostream_to_buf_init(&o_idtype, idtypebuf, sizeof(idtypebuf));
             ostream_to_buf_init(&o_idname, idnamebuf, sizeof(idnamebuf));
 
-            if (gta_identifier_enumerate(
-                    h_inst, &h_enum, (gtaio_ostream_t *)&o_idtype, (gtaio_ostream_t *)&o_idname, &errinfo)) {
+            if (TRACE_BOOL(
+                    gta_identifier_enumerate,
+                    (h_inst, &h_enum, (gtaio_ostream_t *)&o_idtype, (gtaio_ostream_t *)&o_idname, &errinfo),
+                    &errinfo)) {
                 printf("[%d]\n", num_of_identifier);
                 printf("Identifier Type:    %s\n", idtypebuf);
                 printf("Identifier Value:   %s\n\n", idnamebuf);
@@ -1111,6 +2364,8 @@ int main(int argc, char * argv[])
         break;
     }
 
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ENUMERATE)
     case personality_enumerate: {
         if (NULL == arguments.id_val) {
             fprintf(stderr, "Invalid function arguments\n");
@@ -1132,8 +2387,10 @@ int main(int argc, char * argv[])
         while (b_loop) {
             ostream_to_buf_init(&o_persname, persnamebuf, sizeof(persnamebuf));
 
-            if (gta_personality_enumerate(
-                    h_inst, arguments.id_val, &h_enum, pers_flag, (gtaio_ostream_t *)&o_persname, &errinfo)) {
+            if (TRACE_BOOL(
+                    gta_personality_enumerate,
+                    (h_inst, arguments.id_val, &h_enum, pers_flag, (gtaio_ostream_t *)&o_persname, &errinfo),
+                    &errinfo)) {
                 printf("[%d]\n", num_of_personality);
                 printf("Identifier Value:   %s\n", arguments.id_val);
                 printf("Personality Name:   %s\n\n", persnamebuf);
@@ -1150,6 +2407,8 @@ int main(int argc, char * argv[])
 
         break;
     }
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ENUMERATE_APPLICATION)
     case personality_enumerate_application: {
         if (NULL == arguments.app_name) {
             fprintf(stderr, "Invalid function arguments\n");
@@ -1171,8 +2430,10 @@ int main(int argc, char * argv[])
         while (b_loop) {
             ostream_to_buf_init(&o_persname, persnamebuf, sizeof(persnamebuf));
 
-            if (gta_personality_enumerate_application(
-                    h_inst, arguments.app_name, &h_enum, pers_flag, (gtaio_ostream_t *)&o_persname, &errinfo)) {
+            if (TRACE_BOOL(
+                    gta_personality_enumerate_application,
+                    (h_inst, arguments.app_name, &h_enum, pers_flag, (gtaio_ostream_t *)&o_persname, &errinfo),
+                    &errinfo)) {
                 printf("[%d]\n", num_of_personality);
                 printf("Personality Name:   %s\n\n", persnamebuf);
                 num_of_personality++;
@@ -1188,18 +2449,24 @@ int main(int argc, char * argv[])
 
         break;
     }
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ADD_ATTRIBUTE)
     case personality_add_attribute: {
         if (EXIT_SUCCESS != pers_add_attribute(h_inst, h_ctx, &arguments, false)) {
             goto cleanup;
         }
         break;
     }
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ADD_TRUSTED_ATTRIBUTE)
     case personality_add_trusted_attribute: {
         if (EXIT_SUCCESS != pers_add_attribute(h_inst, h_ctx, &arguments, true)) {
             goto cleanup;
         }
         break;
     }
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_GET_ATTRIBUTE)
     case personality_get_attribute: {
 
         if (NULL == arguments.pers || NULL == arguments.prof || NULL == arguments.attr_name) {
@@ -1211,25 +2478,30 @@ int main(int argc, char * argv[])
         myio_ofilestream_t ostream_attr_value = {0};
         init_ofilestream(&ostream_attr_value);
 
-        h_ctx = gta_context_open(h_inst, arguments.pers, arguments.prof, &errinfo);
+        h_ctx = TRACE_PTR(gta_context_open, (h_inst, arguments.pers, arguments.prof, &errinfo), &errinfo);
         if (NULL == h_ctx) {
             fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
 
-        if (!gta_personality_get_attribute(
-                h_ctx, arguments.attr_name, (gtaio_ostream_t *)&ostream_attr_value, &errinfo)) {
+        stats_ostream_init(&ostream_stats, digest_stage(&ostream_digest, (gtaio_ostream_t *)&ostream_attr_value));
+        if (!TRACE_BOOL(
+                gta_personality_get_attribute,
+                (h_ctx, arguments.attr_name, (gtaio_ostream_t *)&ostream_stats, &errinfo),
+                &errinfo)) {
             fprintf(stderr, "gta_personality_get_attribute failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
 
-        if (!gta_context_close(h_ctx, &errinfo)) {
+        if (!TRACE_BOOL(gta_context_close, (h_ctx, &errinfo), &errinfo)) {
             fprintf(stderr, "gta_context_close failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
 
         break;
     }
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_REMOVE_ATTRIBUTE)
     case personality_remove_attribute: {
 
         if (NULL == arguments.pers || NULL == arguments.prof || NULL == arguments.attr_name) {
@@ -1238,24 +2510,26 @@ int main(int argc, char * argv[])
             goto cleanup;
         }
 
-        h_ctx = gta_context_open(h_inst, arguments.pers, arguments.prof, &errinfo);
+        h_ctx = TRACE_PTR(gta_context_open, (h_inst, arguments.pers, arguments.prof, &errinfo), &errinfo);
         if (NULL == h_ctx) {
             fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
 
-        if (!gta_personality_remove_attribute(h_ctx, arguments.attr_name, &errinfo)) {
+        if (!TRACE_BOOL(gta_personality_remove_attribute, (h_ctx, arguments.attr_name, &errinfo), &errinfo)) {
             fprintf(stderr, "gta_personality_remove_attribute failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
 
-        if (!gta_context_close(h_ctx, &errinfo)) {
+        if (!TRACE_BOOL(gta_context_close, (h_ctx, &errinfo), &errinfo)) {
             fprintf(stderr, "gta_context_close failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
 
         break;
     }
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ATTRIBUTES_ENUMERATE)
     case personality_attributes_enumerate: {
 
         if (NULL == arguments.pers) {
@@ -1277,12 +2551,14 @@ int main(int argc, char * argv[])
             ostream_to_buf_init(&o_attrtype, attrtypebuf, sizeof(attrtypebuf));
             ostream_to_buf_init(&o_attrname, attrnamebuf, sizeof(attrnamebuf));
 
-            if (gta_personality_attributes_enumerate(
-                    h_inst,
-                    arguments.pers,
-                    &h_enum,
-                    (gtaio_ostream_t *)&o_attrtype,
-                    (gtaio_ostream_t *)&o_attrname,
+            if (TRACE_BOOL(
+                    gta_personality_attributes_enumerate,
+                    (h_inst,
+                     arguments.pers,
+                     &h_enum,
+                     (gtaio_ostream_t *)&o_attrtype,
+                     (gtaio_ostream_t *)&o_attrname,
+                     &errinfo),
                     &errinfo)) {
                 printf("[%d]\n", num_of_attribute);
                 printf("Attribute Type:   %s\n", attrtypebuf);
@@ -1295,8 +2571,13 @@ int main(int argc, char * argv[])
 
         break;
     }
+#endif
+#if defined(GTA_CLI_FUNC_AUTHENTICATE_DATA_DETACHED)
     case authenticate_data_detached: {
-        if (NULL == arguments.pers || NULL == arguments.prof) {
+        if (NULL == arguments.pers || NULL == arguments.prof ||
+            (arguments.incremental && ((NULL == arguments.dir) || (NULL == arguments.index) ||
+                                       (NULL != arguments.data) || (NULL != arguments.data_list) ||
+                                       (NULL != arguments.tree_hash)))) {
             fprintf(stderr, "Invalid or missing function arguments\n");
             show_function_help(arguments.func);
             goto cleanup;
@@ -1305,33 +2586,73 @@ int main(int argc, char * argv[])
         myio_ofilestream_t ostream_seal = {0};
         init_ofilestream(&ostream_seal);
 
-        if (EXIT_SUCCESS != init_ifilestream(arguments.data, &istream)) {
+        if (arguments.incremental) {
+            /* The context is opened only if a file has changed */
+            stats_ostream_init(&ostream_stats, (gtaio_ostream_t *)&ostream_seal);
+            if (EXIT_SUCCESS != incremental_authenticate(
+                                    h_inst,
+                                    arguments.pers,
+                                    arguments.prof,
+                                    arguments.dir,
+                                    arguments.index,
+                                    (gtaio_ostream_t *)&ostream_stats,
+                                    &errinfo)) {
+                goto cleanup;
+            }
+            break;
+        }
+
+        gtaio_istream_t * p_data = (gtaio_istream_t *)&istream;
+        if (is_data_list(arguments.data, arguments.data_list)) {
+            /* The files are read one after another, like a concatenated file */
+            if (EXIT_SUCCESS != init_multi_istream(arguments.data, arguments.data_list, &istream_multi)) {
+                goto cleanup;
+            }
+            p_data = (gtaio_istream_t *)&istream_multi;
+        } else if (EXIT_SUCCESS != init_ifilestream(arguments.data, &istream)) {
             goto cleanup;
         }
 
-        h_ctx = gta_context_open(h_inst, arguments.pers, arguments.prof, &errinfo);
+        h_ctx = TRACE_PTR(gta_context_open, (h_inst, arguments.pers, arguments.prof, &errinfo), &errinfo);
 
         if (NULL == h_ctx) {
             fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
 
-        if (!gta_authenticate_data_detached(
-                h_ctx, (gtaio_istream_t *)&istream, (gtaio_ostream_t *)&ostream_seal, &errinfo)) {
+        stats_istream_init(&istream_stats, p_data);
+        stats_ostream_init(&ostream_stats, digest_stage(&ostream_digest, (gtaio_ostream_t *)&ostream_seal));
+        istream_stats.stats.p_progress = p_progress;
+        gtaio_istream_t * p_istream = (gtaio_istream_t *)&istream_stats;
+        if (NULL != arguments.tree_hash) {
+            /* Only the tree hash of the data is passed to the provider */
+            if (EXIT_SUCCESS != tree_hash_compute(&tree_hash, p_istream, threads)) {
+                goto cleanup;
+            }
+            istream_from_buf_init(
+                &istream_tree_hash, tree_hash_encoded, tree_hash_encode(&tree_hash, tree_hash_encoded));
+            p_istream = (gtaio_istream_t *)&istream_tree_hash;
+        }
+        if (!TRACE_BOOL(
+                gta_authenticate_data_detached,
+                (h_ctx, p_istream, (gtaio_ostream_t *)&ostream_stats, &errinfo),
+                &errinfo)) {
             fprintf(stderr, "gta_authenticate_data_detached failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
 
-        if (!gta_context_close(h_ctx, &errinfo)) {
+        if (!TRACE_BOOL(gta_context_close, (h_ctx, &errinfo), &errinfo)) {
             fprintf(stderr, "gta_context_close failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
 
-        if (arguments.data != NULL) {
+        if ((arguments.data != NULL) && (NULL != istream.file)) {
             myio_close_ifilestream(&istream, &errinfo);
         }
         break;
     }
+#endif
+#if defined(GTA_CLI_FUNC_VERIFY_DATA_DETACHED)
     case verify_data_detached: {
         if (NULL == arguments.pers || NULL == arguments.prof || NULL == arguments.seal) {
             fprintf(stderr, "Invalid or missing function arguments\n");
@@ -1339,7 +2660,13 @@ int main(int argc, char * argv[])
             goto cleanup;
         }
 
-        if (EXIT_SUCCESS != init_ifilestream(arguments.data, &istream)) {
+        gtaio_istream_t * p_data = (gtaio_istream_t *)&istream;
+        if (is_data_list(arguments.data, arguments.data_list)) {
+            if (EXIT_SUCCESS != init_multi_istream(arguments.data, arguments.data_list, &istream_multi)) {
+                goto cleanup;
+            }
+            p_data = (gtaio_istream_t *)&istream_multi;
+        } else if (EXIT_SUCCESS != init_ifilestream(arguments.data, &istream)) {
             goto cleanup;
         }
 
@@ -1347,24 +2674,39 @@ int main(int argc, char * argv[])
             goto cleanup;
         }
 
-        h_ctx = gta_context_open(h_inst, arguments.pers, arguments.prof, &errinfo);
+        h_ctx = TRACE_PTR(gta_context_open, (h_inst, arguments.pers, arguments.prof, &errinfo), &errinfo);
 
         if (NULL == h_ctx) {
             fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
 
-        if (!gta_verify_data_detached(h_ctx, (gtaio_istream_t *)&istream, (gtaio_istream_t *)&istream_seal, &errinfo)) {
+        stats_istream_init(&istream_stats, p_data);
+        stats_istream_init(&istream_seal_stats, (gtaio_istream_t *)&istream_seal);
+        istream_stats.stats.p_progress = p_progress;
+        gtaio_istream_t * p_istream = (gtaio_istream_t *)&istream_stats;
+        if (NULL != arguments.tree_hash) {
+            if (EXIT_SUCCESS != tree_hash_compute(&tree_hash, p_istream, threads)) {
+                goto cleanup;
+            }
+            istream_from_buf_init(
+                &istream_tree_hash, tree_hash_encoded, tree_hash_encode(&tree_hash, tree_hash_encoded));
+            p_istream = (gtaio_istream_t *)&istream_tree_hash;
+        }
+        if (!TRACE_BOOL(
+                gta_verify_data_detached,
+                (h_ctx, p_istream, (gtaio_istream_t *)&istream_seal_stats, &errinfo),
+                &errinfo)) {
             fprintf(stderr, "gta_verify_data_detached failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
 
-        if (!gta_context_close(h_ctx, &errinfo)) {
+        if (!TRACE_BOOL(gta_context_close, (h_ctx, &errinfo), &errinfo)) {
             fprintf(stderr, "gta_context_close failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
 
-        if (arguments.data != NULL) {
+        if ((arguments.data != NULL) && (NULL != istream.file)) {
             myio_close_ifilestream(&istream, &errinfo);
         }
 
@@ -1372,6 +2714,348 @@ int main(int argc, char * argv[])
 
         break;
     }
+#endif
+#if defined(GTA_CLI_FUNC_AUTHENTICATE_BATCH)
+    case authenticate_batch: {
+        if (NULL == arguments.pers || NULL == arguments.prof) {
+            fprintf(stderr, "Invalid or missing function arguments\n");
+            show_function_help(arguments.func);
+            goto cleanup;
+        }
+
+        myio_ofilestream_t ostream_seal = {0};
+        init_ofilestream(&ostream_seal);
+
+        h_ctx = TRACE_PTR(gta_context_open, (h_inst, arguments.pers, arguments.prof, &errinfo), &errinfo);
+        if (NULL == h_ctx) {
+            fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", errinfo);
+            goto cleanup;
+        }
+
+        stats_ostream_init(&ostream_stats, digest_stage(&ostream_digest, (gtaio_ostream_t *)&ostream_seal));
+        if (EXIT_SUCCESS !=
+            batch_authenticate(h_ctx, arguments.data_list, (gtaio_ostream_t *)&ostream_stats, &errinfo)) {
+            goto cleanup;
+        }
+
+        if (!TRACE_BOOL(gta_context_close, (h_ctx, &errinfo), &errinfo)) {
+            fprintf(stderr, "gta_context_close failed with ERROR_CODE %ld\n", errinfo);
+            goto cleanup;
+        }
+        break;
+    }
+#endif
+#if defined(GTA_CLI_FUNC_RESEAL)
+    case reseal: {
+        if ((NULL == arguments.pers) || (NULL == arguments.prof) || (NULL == arguments.to_pers) ||
+            (NULL == arguments.to_prof) || ((NULL == arguments.dir) != (NULL == arguments.out_dir)) ||
+            ((NULL != arguments.dir) && (NULL != arguments.data))) {
+            fprintf(stderr, "Invalid or missing function arguments\n");
+            show_function_help(arguments.func);
+            goto cleanup;
+        }
+
+        if (NULL != arguments.dir) {
+            if ((NULL != arguments.journal) && (EXIT_SUCCESS != journal_open(&journal, arguments.journal))) {
+                goto cleanup;
+            }
+            /* Every worker opens its own pair of contexts */
+            if (EXIT_SUCCESS != reseal_dir(
+                                    h_inst,
+                                    arguments.pers,
+                                    arguments.prof,
+                                    arguments.to_pers,
+                                    arguments.to_prof,
+                                    arguments.dir,
+                                    arguments.out_dir,
+                                    threads,
+                                    (NULL != arguments.journal) ? &journal : NULL,
+                                    &errinfo)) {
+                goto cleanup;
+            }
+            if (EXIT_SUCCESS != journal_close(&journal)) {
+                goto cleanup;
+            }
+            break;
+        }
+
+        myio_ofilestream_t ostream_resealed = {0};
+        init_ofilestream(&ostream_resealed);
+
+        if (EXIT_SUCCESS != init_ifilestream(arguments.data, &istream)) {
+            goto cleanup;
+        }
+
+        h_ctx = TRACE_PTR(gta_context_open, (h_inst, arguments.pers, arguments.prof, &errinfo), &errinfo);
+        if (NULL == h_ctx) {
+            fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", errinfo);
+            goto cleanup;
+        }
+        h_ctx_target =
+            TRACE_PTR(gta_context_open, (h_inst, arguments.to_pers, arguments.to_prof, &errinfo), &errinfo);
+        if (NULL == h_ctx_target) {
+            fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", errinfo);
+            goto cleanup;
+        }
+
+        stats_istream_init(&istream_stats, (gtaio_istream_t *)&istream);
+        stats_ostream_init(&ostream_stats, digest_stage(&ostream_digest, (gtaio_ostream_t *)&ostream_resealed));
+        istream_stats.stats.p_progress = p_progress;
+        if (EXIT_SUCCESS != reseal_stream(
+                                h_ctx,
+                                h_ctx_target,
+                                (gtaio_istream_t *)&istream_stats,
+                                (gtaio_ostream_t *)&ostream_stats,
+                                &errinfo)) {
+            goto cleanup;
+        }
+
+        if (!TRACE_BOOL(gta_context_close, (h_ctx_target, &errinfo), &errinfo)) {
+            fprintf(stderr, "gta_context_close failed with ERROR_CODE %ld\n", errinfo);
+            goto cleanup;
+        }
+        h_ctx_target = GTA_HANDLE_INVALID;
+        if (!TRACE_BOOL(gta_context_close, (h_ctx, &errinfo), &errinfo)) {
+            fprintf(stderr, "gta_context_close failed with ERROR_CODE %ld\n", errinfo);
+            goto cleanup;
+        }
+
+        if (arguments.data != NULL) {
+            myio_close_ifilestream(&istream, &errinfo);
+        }
+        break;
+    }
+#endif
+#if defined(GTA_CLI_FUNC_VAULT_PUT) || defined(GTA_CLI_FUNC_VAULT_GET)
+    case vault_put:
+    case vault_get: {
+        if ((NULL == arguments.pers) || (NULL == arguments.prof) || (NULL == arguments.vault) ||
+            (NULL == arguments.key) ||
+            ((vault_get == arguments.func) && (NULL == arguments.out_dir) && (NULL != strchr(arguments.key, ',')))) {
+            fprintf(stderr, "Invalid or missing function arguments\n");
+            show_function_help(arguments.func);
+            goto cleanup;
+        }
+
+        myio_ofilestream_t ostream_value = {0};
+        init_ofilestream(&ostream_value);
+
+        if ((vault_put == arguments.func) && (EXIT_SUCCESS != init_ifilestream(arguments.data, &istream))) {
+            goto cleanup;
+        }
+
+        h_ctx = TRACE_PTR(gta_context_open, (h_inst, arguments.pers, arguments.prof, &errinfo), &errinfo);
+        if (NULL == h_ctx) {
+            fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", errinfo);
+            goto cleanup;
+        }
+        if (EXIT_SUCCESS != vault_open(&vault, arguments.vault, vault_put == arguments.func)) {
+            goto cleanup;
+        }
+
+        stats_istream_init(&istream_stats, (gtaio_istream_t *)&istream);
+        stats_ostream_init(&ostream_stats, digest_stage(&ostream_digest, (gtaio_ostream_t *)&ostream_value));
+        if (vault_put == arguments.func) {
+            if (EXIT_SUCCESS !=
+                vault_store(&vault, h_ctx, arguments.key, (gtaio_istream_t *)&istream_stats, &errinfo)) {
+                goto cleanup;
+            }
+        } else if (NULL != arguments.out_dir) {
+            if ((NULL != arguments.journal) && (EXIT_SUCCESS != journal_open(&journal, arguments.journal))) {
+                goto cleanup;
+            }
+            if (EXIT_SUCCESS != vault_fetch_many(
+                                    &vault,
+                                    h_ctx,
+                                    arguments.key,
+                                    arguments.out_dir,
+                                    (NULL != arguments.journal) ? &journal : NULL,
+                                    &errinfo)) {
+                goto cleanup;
+            }
+            if (EXIT_SUCCESS != journal_close(&journal)) {
+                goto cleanup;
+            }
+        } else if (EXIT_SUCCESS !=
+                   vault_fetch(&vault, h_ctx, arguments.key, (gtaio_ostream_t *)&ostream_stats, &errinfo)) {
+            goto cleanup;
+        }
+        vault_close(&vault);
+
+        if (!TRACE_BOOL(gta_context_close, (h_ctx, &errinfo), &errinfo)) {
+            fprintf(stderr, "gta_context_close failed with ERROR_CODE %ld\n", errinfo);
+            goto cleanup;
+        }
+
+        if ((vault_put == arguments.func) && (arguments.data != NULL)) {
+            myio_close_ifilestream(&istream, &errinfo);
+        }
+        break;
+    }
+#endif
+#if defined(GTA_CLI_FUNC_VAULT_LIST)
+    case vault_list: {
+        if (NULL == arguments.vault) {
+            fprintf(stderr, "Invalid or missing function arguments\n");
+            show_function_help(arguments.func);
+            goto cleanup;
+        }
+
+        myio_ofilestream_t ostream_keys = {0};
+        init_ofilestream(&ostream_keys);
+
+        if (EXIT_SUCCESS != vault_open(&vault, arguments.vault, false)) {
+            goto cleanup;
+        }
+        if (EXIT_SUCCESS != vault_list_keys(&vault, (gtaio_ostream_t *)&ostream_keys, &errinfo)) {
+            goto cleanup;
+        }
+        vault_close(&vault);
+        break;
+    }
+#endif
+#if defined(GTA_CLI_FUNC_EXEC)
+    case exec: {
+        if ((NULL == arguments.pers) || (NULL == arguments.prof) || (NULL == arguments.exec_argv) ||
+            (NULL == arguments.exec_argv[0]) || (0 == arguments.secrets.num + arguments.secrets_env.num)) {
+            fprintf(stderr, "Invalid or missing function arguments\n");
+            show_function_help(arguments.func);
+            goto cleanup;
+        }
+        for (size_t i = 0; i < arguments.secrets.num + arguments.secrets_env.num; ++i) {
+            const char * p_name = (i < arguments.secrets.num)
+                                      ? arguments.secrets.p_attr[i].p_type
+                                      : arguments.secrets_env.p_attr[i - arguments.secrets.num].p_type;
+            if (!exec_secret_check_name(p_name)) {
+                fprintf(stderr, "Invalid input: '%s' is not a valid environment variable name\n", p_name);
+                goto cleanup;
+            }
+        }
+
+        /* All secrets are unsealed with one context */
+        h_ctx = TRACE_PTR(gta_context_open, (h_inst, arguments.pers, arguments.prof, &errinfo), &errinfo);
+        if (NULL == h_ctx) {
+            fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", errinfo);
+            goto cleanup;
+        }
+        for (size_t i = 0; i < arguments.secrets.num; ++i) {
+            if (EXIT_SUCCESS != exec_secret_to_memfd(
+                                    h_ctx,
+                                    arguments.secrets.p_attr[i].p_type,
+                                    arguments.secrets.p_attr[i].p_val,
+                                    &errinfo)) {
+                goto cleanup;
+            }
+        }
+        for (size_t i = 0; i < arguments.secrets_env.num; ++i) {
+            if (EXIT_SUCCESS != exec_secret_to_env(
+                                    h_ctx,
+                                    arguments.secrets_env.p_attr[i].p_type,
+                                    arguments.secrets_env.p_attr[i].p_val,
+                                    &errinfo)) {
+                goto cleanup;
+            }
+        }
+
+        if (!TRACE_BOOL(gta_context_close, (h_ctx, &errinfo), &errinfo)) {
+            fprintf(stderr, "gta_context_close failed with ERROR_CODE %ld\n", errinfo);
+            goto cleanup;
+        }
+        /* the command is executed at the end of main when the instance and the state directory are released */
+        break;
+    }
+#endif
+#if defined(GTA_CLI_FUNC_WATCH)
+    case watch: {
+        enum watch_op op = WATCH_OP_SEAL;
+        unsigned int flush_ms = WATCH_DEFAULT_FLUSH_MS;
+
+        if ((NULL == arguments.pers) || (NULL == arguments.prof) || (NULL == arguments.op) ||
+            (NULL == arguments.dir) || (NULL == arguments.out_dir)) {
+            fprintf(stderr, "Invalid or missing function arguments\n");
+            show_function_help(arguments.func);
+            goto cleanup;
+        }
+        if ((EXIT_SUCCESS != watch_parse_op(arguments.op, &op)) ||
+            ((NULL != arguments.flush_ms) && (EXIT_SUCCESS != sealed_log_parse_ms(arguments.flush_ms, &flush_ms)))) {
+            goto cleanup;
+        }
+
+        /* The context is opened once to check personality and profile before the spool directory is watched */
+        h_ctx = TRACE_PTR(gta_context_open, (h_inst, arguments.pers, arguments.prof, &errinfo), &errinfo);
+        if (NULL == h_ctx) {
+            fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", errinfo);
+            goto cleanup;
+        }
+        TRACE_BOOL(gta_context_close, (h_ctx, &errinfo), &errinfo);
+        h_ctx = GTA_HANDLE_INVALID;
+
+        /* Instance and state directory are opened again for each batch */
+        TRACE_BOOL(gta_instance_final, (h_inst, &errinfo), &errinfo);
+        h_inst = GTA_HANDLE_INVALID;
+        statedir_close(&statedir);
+
+        watch_state_session_t session = {
+            .session =
+                {
+                    .begin = (watch_session_begin_t)watch_session_begin,
+                    .end = (watch_session_end_t)watch_session_end,
+                },
+            .statedir = {.lock_fd = -1},
+            .p_state_dir = p_state_dir,
+            .state_mode = state_mode,
+            .lock_timeout_ms = lock_timeout_ms,
+            .p_inst_params = &inst_params,
+            .p_pers = arguments.pers,
+            .p_prof = arguments.prof,
+            .h_inst = GTA_HANDLE_INVALID,
+            .h_ctx = GTA_HANDLE_INVALID,
+        };
+        if (EXIT_SUCCESS !=
+            watch_run((watch_session_t *)&session, op, arguments.dir, arguments.out_dir, flush_ms, &errinfo)) {
+            goto cleanup;
+        }
+        break;
+    }
+#endif
+#if defined(GTA_CLI_FUNC_VERIFY_BATCH)
+    case verify_batch: {
+        if (NULL == arguments.pers || NULL == arguments.prof || NULL == arguments.data || NULL == arguments.seal) {
+            fprintf(stderr, "Invalid or missing function arguments\n");
+            show_function_help(arguments.func);
+            goto cleanup;
+        }
+
+        if (EXIT_SUCCESS != init_ifilestream(arguments.seal, &istream_seal)) {
+            goto cleanup;
+        }
+
+        h_ctx = TRACE_PTR(gta_context_open, (h_inst, arguments.pers, arguments.prof, &errinfo), &errinfo);
+        if (NULL == h_ctx) {
+            fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", errinfo);
+            goto cleanup;
+        }
+
+        stats_istream_init(&istream_seal_stats, (gtaio_istream_t *)&istream_seal);
+        if (EXIT_SUCCESS != batch_verify(
+                                h_ctx,
+                                arguments.data,
+                                arguments.proof,
+                                (gtaio_istream_t *)&istream_seal_stats,
+                                &errinfo)) {
+            goto cleanup;
+        }
+
+        if (!TRACE_BOOL(gta_context_close, (h_ctx, &errinfo), &errinfo)) {
+            fprintf(stderr, "gta_context_close failed with ERROR_CODE %ld\n", errinfo);
+            goto cleanup;
+        }
+
+        myio_close_ifilestream(&istream_seal, &errinfo);
+        break;
+    }
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_ENROLL)
     case personality_enroll: {
         if (NULL == arguments.pers || NULL == arguments.prof) {
             fprintf(stderr, "Invalid or missing function arguments\n");
@@ -1382,7 +3066,7 @@ int main(int argc, char * argv[])
         myio_ofilestream_t ostream_enrollment_request = {0};
         init_ofilestream(&ostream_enrollment_request);
 
-        h_ctx = gta_context_open(h_inst, arguments.pers, arguments.prof, &errinfo);
+        h_ctx = TRACE_PTR(gta_context_open, (h_inst, arguments.pers, arguments.prof, &errinfo), &errinfo);
 
         if (NULL == h_ctx) {
             fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", errinfo);
@@ -1398,8 +3082,10 @@ int main(int argc, char * argv[])
                     goto cleanup;
                 }
 
-                if (!gta_context_set_attribute(
-                        h_ctx, arguments.ctx_attributes_bin.p_attr[i].p_type, (gtaio_istream_t *)&istream, &errinfo)) {
+                if (!TRACE_BOOL(
+                        gta_context_set_attribute,
+                        (h_ctx, arguments.ctx_attributes_bin.p_attr[i].p_type, (gtaio_istream_t *)&istream, &errinfo),
+                        &errinfo)) {
                     printf("gta_context_set_attribute failed with ERROR_CODE %ld\n", errinfo);
                     goto cleanup;
                 }
@@ -1417,10 +3103,12 @@ int main(int argc, char * argv[])
                     arguments.ctx_attributes.p_attr[i].p_val,
                     strnlen(arguments.ctx_attributes.p_attr[i].p_val, MAXLEN_ATTRIBUTE) + 1);
 
-                if (!gta_context_set_attribute(
-                        h_ctx,
-                        arguments.ctx_attributes.p_attr[i].p_type,
-                        (gtaio_istream_t *)&istream_attr_val,
+                if (!TRACE_BOOL(
+                        gta_context_set_attribute,
+                        (h_ctx,
+                         arguments.ctx_attributes.p_attr[i].p_type,
+                         (gtaio_istream_t *)&istream_attr_val,
+                         &errinfo),
                         &errinfo)) {
                     fprintf(stderr, "gta_context_set_attribute failed with ERROR_CODE %ld\n", errinfo);
                     goto cleanup;
@@ -1431,18 +3119,22 @@ int main(int argc, char * argv[])
         free_ctx_attributes(&arguments.ctx_attributes);
         free_ctx_attributes(&arguments.ctx_attributes_bin);
 
-        if (!gta_personality_enroll(h_ctx, (gtaio_ostream_t *)&ostream_enrollment_request, &errinfo)) {
+        stats_ostream_init(
+            &ostream_stats, digest_stage(&ostream_digest, (gtaio_ostream_t *)&ostream_enrollment_request));
+        if (!TRACE_BOOL(gta_personality_enroll, (h_ctx, (gtaio_ostream_t *)&ostream_stats, &errinfo), &errinfo)) {
             fprintf(stderr, "gta_personality_enroll failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
 
-        if (!gta_context_close(h_ctx, &errinfo)) {
+        if (!TRACE_BOOL(gta_context_close, (h_ctx, &errinfo), &errinfo)) {
             fprintf(stderr, "gta_context_close failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
 
         break;
     }
+#endif
+#if defined(GTA_CLI_FUNC_PERSONALITY_REMOVE)
     case personality_remove: {
         if (NULL == arguments.pers || NULL == arguments.prof) {
             fprintf(stderr, "Invalid or missing function arguments\n");
@@ -1450,25 +3142,27 @@ int main(int argc, char * argv[])
             goto cleanup;
         }
 
-        h_ctx = gta_context_open(h_inst, arguments.pers, arguments.prof, &errinfo);
+        h_ctx = TRACE_PTR(gta_context_open, (h_inst, arguments.pers, arguments.prof, &errinfo), &errinfo);
 
         if (NULL == h_ctx) {
             fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
 
-        if (!gta_personality_remove(h_ctx, &errinfo)) {
+        if (!TRACE_BOOL(gta_personality_remove, (h_ctx, &errinfo), &errinfo)) {
             fprintf(stderr, "gta_personality_remove failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
 
-        if (!gta_context_close(h_ctx, &errinfo)) {
+        if (!TRACE_BOOL(gta_context_close, (h_ctx, &errinfo), &errinfo)) {
             fprintf(stderr, "gta_context_close failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
 
         break;
     }
+#endif
+#if defined(GTA_CLI_FUNC_DEVICESTATE_TRANSITION)
     case devicestate_transition: {
 
         if (NULL == arguments.owner_lock_count || GTA_HANDLE_INVALID == arguments.h_auth_recede) {
@@ -1477,7 +3171,10 @@ int main(int argc, char * argv[])
             goto cleanup;
         }
 
-        if (!gta_devicestate_transition(h_inst, arguments.h_auth_recede, *arguments.owner_lock_count, &errinfo)) {
+        if (!TRACE_BOOL(
+                gta_devicestate_transition,
+                (h_inst, arguments.h_auth_recede, *arguments.owner_lock_count, &errinfo),
+                &errinfo)) {
             fprintf(stderr, "gta_devicestate_transition failed with ERROR_CODE %ld\n", errinfo);
             free(arguments.owner_lock_count);
             goto cleanup;
@@ -1487,15 +3184,18 @@ int main(int argc, char * argv[])
         break;
     }
 
+#endif
+#if defined(GTA_CLI_FUNC_DEVICESTATE_RECEDE)
     case devicestate_recede: {
 
         gta_access_token_t physical_presence_token;
-        if (!gta_access_token_get_physical_presence(h_inst, physical_presence_token, &errinfo)) {
+        if (!TRACE_BOOL(
+                gta_access_token_get_physical_presence, (h_inst, physical_presence_token, &errinfo), &errinfo)) {
             fprintf(stderr, "gta_access_token_get_physical_presence failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
 
-        if (!gta_devicestate_recede(h_inst, physical_presence_token, &errinfo)) {
+        if (!TRACE_BOOL(gta_devicestate_recede, (h_inst, physical_presence_token, &errinfo), &errinfo)) {
             fprintf(stderr, "gta_devicestate_recede failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
         }
@@ -1503,6 +3203,8 @@ int main(int argc, char * argv[])
         break;
     }
 
+#endif
+#if defined(GTA_CLI_FUNC_ACCESS_POLICY_SIMPLE)
     case access_policy_simple: {
 
         gta_access_descriptor_type_t access_descriptor_type = GTA_ACCESS_DESCRIPTOR_TYPE_INITIAL;
@@ -1512,7 +3214,7 @@ int main(int argc, char * argv[])
             goto cleanup;
         }
 
-        h_simple = gta_access_policy_simple(h_inst, access_descriptor_type, &errinfo);
+        h_simple = TRACE_PTR(gta_access_policy_simple, (h_inst, access_descriptor_type, &errinfo), &errinfo);
         if (GTA_HANDLE_INVALID == h_simple) {
             fprintf(stderr, "gta_access_policy_simple failed with ERROR_CODE %ld\n", errinfo);
             goto cleanup;
@@ -1522,6 +3224,7 @@ int main(int argc, char * argv[])
         break;
     }
 
+#endif
     default:
         fprintf(stderr, "Unknown function.\n");
         goto cleanup;
@@ -1530,19 +3233,102 @@ int main(int argc, char * argv[])
     ret = EXIT_SUCCESS;
 
 cleanup:
+    /* Close phases left by an error */
+    phase_end(&metrics, p_perf, METRICS_PHASE_INSTANCE_INIT);
+    phase_end(&metrics, p_perf, METRICS_PHASE_PROVIDER_REGISTER);
+    phase_end(&metrics, p_perf, METRICS_PHASE_OPERATION);
     if ((NULL != istream.file) && (stdin != istream.file)) {
         myio_close_ifilestream(&istream, &errinfo);
     }
     if (NULL != istream_seal.file) {
         myio_close_ifilestream(&istream_seal, &errinfo);
     }
+#if defined(WITH_DATA_DETACHED)
+    multi_istream_close(&istream_multi);
+#endif
+#if defined(WITH_VAULT)
+    vault_close(&vault);
+#endif
+#if defined(WITH_JOURNAL)
+    journal_close(&journal);
+#endif
     free_ctx_attributes(&arguments.ctx_attributes);
     free_ctx_attributes(&arguments.ctx_attributes_bin);
+    free_ctx_attributes(&arguments.secrets);
+    free_ctx_attributes(&arguments.secrets_env);
+    ostream_to_dynbuf_free(&sealed_data);
+    ostream_to_dynbuf_free(&unsealed_data);
+    if ((EXIT_SUCCESS == ret) && (NULL != ostream_digest.md_ctx)) {
+        int len = snprintf(out_hash, sizeof(out_hash), "%s:", OBJ_nid2ln(EVP_MD_CTX_type(ostream_digest.md_ctx)));
+        if ((EXIT_SUCCESS != digest_ostream_final(&ostream_digest, &out_hash[len], sizeof(out_hash) - (size_t)len)) ||
+            ((NULL != p_out_digest_path) && (EXIT_SUCCESS != write_out_digest(&out_hash[len], p_out_digest_path)))) {
+            out_hash[0] = '\0';
+            ret = EXIT_FAILURE;
+        }
+    }
+    digest_ostream_free(&ostream_digest);
+#if defined(GTA_CLI_FUNC_SEAL_DATA)
+    compress_istream_free(&istream_compress);
+#endif
+#if defined(GTA_CLI_FUNC_UNSEAL_DATA)
+    decompress_ostream_free(&ostream_decompress);
+#endif
+    if (GTA_HANDLE_INVALID != h_ctx_target) {
+        TRACE_BOOL(gta_context_close, (h_ctx_target, &errinfo), &errinfo);
+    }
     if (GTA_HANDLE_INVALID != h_ctx) {
-        gta_context_close(h_ctx, &errinfo);
+        TRACE_BOOL(gta_context_close, (h_ctx, &errinfo), &errinfo);
     }
     if (GTA_HANDLE_INVALID != h_inst) {
-        gta_instance_final(h_inst, &errinfo);
+        TRACE_BOOL(gta_instance_final, (h_inst, &errinfo), &errinfo);
+    }
+    /* The provider has persisted its state with gta_instance_final */
+    if ((EXIT_SUCCESS != statedir_close(&statedir)) && (EXIT_SUCCESS == ret)) {
+        ret = EXIT_FAILURE;
+    }
+    if (NULL != arguments.metrics_file) {
+        metrics.bytes_in = istream_stats.stats.bytes + istream_seal_stats.stats.bytes;
+        metrics.bytes_out = ostream_stats.stats.bytes;
+        if ((NULL != p_perf) && (0 != perf_counters_json(p_perf, perf_json, sizeof(perf_json)))) {
+            metrics.extra = perf_json;
+        }
+        metrics_append(&metrics, arguments.metrics_file, ret, (EXIT_SUCCESS == ret) ? 0 : errinfo);
+    }
+    if (NULL != arguments.record) {
+        /* Plaintext is not recorded, only its size */
+        bool b_plaintext_out = (unseal_data == arguments.func) || (vault_get == arguments.func);
+        record_io_t record_io = {
+            .b_secret_data = (seal_data == arguments.func) || (vault_put == arguments.func),
+            .stdin_size = (NULL == arguments.data) ? istream_stats.stats.bytes : 0,
+            .out_size = ostream_digest.bytes,
+            .p_out_hash = (b_plaintext_out || ('\0' == out_hash[0])) ? NULL : out_hash,
+        };
+        record_append(arguments.record, argc, argv, &metrics, ret, &record_io);
+    }
+    if (arguments.io_stats) {
+        if (0 != istream_stats.stats.first_ns) {
+            io_stats_print("input", &istream_stats.stats);
+        }
+        if (0 != istream_seal_stats.stats.first_ns) {
+            io_stats_print("second input", &istream_seal_stats.stats);
+        }
+        if (0 != ostream_stats.stats.first_ns) {
+            io_stats_print("output", &ostream_stats.stats);
+        }
+    }
+    if (NULL != p_perf) {
+        perf_counters_print(p_perf);
+        perf_counters_close(p_perf);
+    }
+    trace_close();
+
+#if defined(GTA_CLI_FUNC_EXEC)
+    if ((exec == arguments.func) && (EXIT_SUCCESS == ret)) {
+        fflush(stdout);
+        execvp(arguments.exec_argv[0], arguments.exec_argv);
+        fprintf(stderr, "Cannot execute %s: %s\n", arguments.exec_argv[0], strerror(errno));
+        ret = EXIT_FAILURE;
     }
+#endif
     return ret;
 }
@@ -0,0 +1,309 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "metrics.h"
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Maximum length of a metrics record, records are written with a single write() */
+#define MAXLEN_METRICS_RECORD 2048
+/* Maximum length of function and profile names in a metrics record */
+#define MAXLEN_METRICS_NAME 160
+
+static const char * phase_names[METRICS_PHASE_COUNT] = {
+    "instance_init",
+    "provider_register",
+    "operation",
+};
+
+uint64_t metrics_now_ns(void)
+{
+    struct timespec ts = {0};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+const char * metrics_phase_name(enum metrics_phase phase)
+{
+    return phase_names[phase];
+}
+
+void metrics_init(metrics_t * p_metrics, const char * func, const char * prof)
+{
+    memset(p_metrics, 0, sizeof(metrics_t));
+    p_metrics->func = func;
+    p_metrics->prof = prof;
+    p_metrics->start_ns = metrics_now_ns();
+}
+
+void metrics_phase_begin(metrics_t * p_metrics, enum metrics_phase phase)
+{
+    p_metrics->phase_start_ns[phase] = metrics_now_ns();
+}
+
+void metrics_phase_end(metrics_t * p_metrics, enum metrics_phase phase)
+{
+    if (0 != p_metrics->phase_start_ns[phase]) {
+        p_metrics->phase_ns[phase] += metrics_now_ns() - p_metrics->phase_start_ns[phase];
+        p_metrics->phase_start_ns[phase] = 0;
+    }
+}
+
+/* Copies a name for a JSON string, characters which would need escaping are replaced */
+static void copy_name(char * p_dst, const char * p_src, size_t dst_size)
+{
+    size_t i = 0;
+    if (NULL != p_src) {
+        for (; ('\0' != p_src[i]) && (i < dst_size - 1); ++i) {
+            p_dst[i] = (('"' == p_src[i]) || ('\\' == p_src[i]) || (0x20 > (unsigned char)p_src[i])) ? '_' : p_src[i];
+        }
+    }
+    p_dst[i] = '\0';
+}
+
+int metrics_append(const metrics_t * p_metrics, const char * path, int ret, gta_errinfo_t errinfo)
+{
+    char record[MAXLEN_METRICS_RECORD] = {0};
+    char func[MAXLEN_METRICS_NAME] = {0};
+    char prof[MAXLEN_METRICS_NAME] = {0};
+    struct timespec now = {0};
+    int len = 0;
+
+    copy_name(func, p_metrics->func, sizeof(func));
+    copy_name(prof, p_metrics->prof, sizeof(prof));
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    len = snprintf(
+        record,
+        sizeof(record),
+        "{\"ts\":%lld.%03ld,\"pid\":%ld,\"func\":\"%s\",\"prof\":\"%s\",\"ret\":%d,\"errinfo\":%ld,"
+        "\"bytes_in\":%" PRIu64 ",\"bytes_out\":%" PRIu64,
+        (long long)now.tv_sec,
+        now.tv_nsec / 1000000,
+        (long)getpid(),
+        func,
+        prof,
+        ret,
+        (long)errinfo,
+        p_metrics->bytes_in,
+        p_metrics->bytes_out);
+    for (size_t i = 0; i < METRICS_PHASE_COUNT; ++i) {
+        len += snprintf(
+            &record[len],
+            sizeof(record) - (size_t)len,
+            ",\"%s_us\":%" PRIu64,
+            phase_names[i],
+            p_metrics->phase_ns[i] / 1000);
+    }
+    len += snprintf(
+        &record[len],
+        sizeof(record) - (size_t)len,
+        ",\"total_us\":%" PRIu64 "%s}\n",
+        (metrics_now_ns() - p_metrics->start_ns) / 1000,
+        (NULL == p_metrics->extra) ? "" : p_metrics->extra);
+    if ((size_t)len >= sizeof(record)) {
+        return EXIT_FAILURE;
+    }
+
+    /* A single write to a file opened with O_APPEND is not interleaved with writes of other processes */
+    int fd = open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0640);
+    if (0 > fd) {
+        fprintf(stderr, "Cannot open metrics file %s\n", path);
+        return EXIT_FAILURE;
+    }
+    ssize_t written = write(fd, record, (size_t)len);
+    close(fd);
+
+    return (written == len) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*
+ * metrics_summary
+ */
+
+typedef struct metrics_group {
+    char func[MAXLEN_METRICS_NAME];
+    char prof[MAXLEN_METRICS_NAME];
+    size_t count;
+    size_t errors;
+    uint64_t * p_total_us; /* total duration of all invocations, sorted for the percentiles */
+    size_t total_us_size;
+    uint64_t bytes;
+    uint64_t operation_us;
+} metrics_group_t;
+
+/* Returns a pointer to the value of key in an NDJSON record, NULL if not found */
+static const char * find_value(const char * p_record, const char * p_key)
+{
+    char pattern[MAXLEN_METRICS_NAME] = {0};
+    snprintf(pattern, sizeof(pattern), "\"%s\":", p_key);
+    const char * p_value = strstr(p_record, pattern);
+    return (NULL == p_value) ? NULL : p_value + strlen(pattern);
+}
+
+static uint64_t get_u64(const char * p_record, const char * p_key)
+{
+    const char * p_value = find_value(p_record, p_key);
+    return (NULL == p_value) ? 0 : strtoull(p_value, NULL, 10);
+}
+
+static void get_str(const char * p_record, const char * p_key, char * p_dst, size_t dst_size)
+{
+    const char * p_value = find_value(p_record, p_key);
+    size_t i = 0;
+    if ((NULL != p_value) && ('"' == *p_value)) {
+        ++p_value;
+        for (; ('"' != p_value[i]) && ('\0' != p_value[i]) && (i < dst_size - 1); ++i) {
+            p_dst[i] = p_value[i];
+        }
+    }
+    p_dst[i] = '\0';
+}
+
+static int compare_u64(const void * p_a, const void * p_b)
+{
+    uint64_t a = *(const uint64_t *)p_a;
+    uint64_t b = *(const uint64_t *)p_b;
+    return (a > b) - (a < b);
+}
+
+/* Nearest-rank percentile of a sorted array */
+static uint64_t percentile(const uint64_t * p_sorted, size_t count, unsigned int pct)
+{
+    size_t rank = ((count * pct) + 99) / 100;
+    return p_sorted[(0 == rank) ? 0 : rank - 1];
+}
+
+static metrics_group_t * get_group(
+    metrics_group_t ** pp_groups,
+    size_t * p_num_groups,
+    const char * func,
+    const char * prof)
+{
+    for (size_t i = 0; i < *p_num_groups; ++i) {
+        if ((0 == strcmp((*pp_groups)[i].func, func)) && (0 == strcmp((*pp_groups)[i].prof, prof))) {
+            return &(*pp_groups)[i];
+        }
+    }
+
+    metrics_group_t * p_new_groups = realloc(*pp_groups, (*p_num_groups + 1) * sizeof(metrics_group_t));
+    if (NULL == p_new_groups) {
+        return NULL;
+    }
+    *pp_groups = p_new_groups;
+    metrics_group_t * p_group = &p_new_groups[*p_num_groups];
+    memset(p_group, 0, sizeof(metrics_group_t));
+    memcpy(p_group->func, func, sizeof(p_group->func));
+    memcpy(p_group->prof, prof, sizeof(p_group->prof));
+    ++(*p_num_groups);
+
+    return p_group;
+}
+
+int metrics_print_summary(const char * path)
+{
+    int ret = EXIT_FAILURE;
+    char record[MAXLEN_METRICS_RECORD] = {0};
+    metrics_group_t * p_groups = NULL;
+    size_t num_groups = 0;
+
+    FILE * p_file = fopen(path, "r");
+    if (NULL == p_file) {
+        fprintf(stderr, "Cannot open metrics file %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    while (NULL != fgets(record, sizeof(record), p_file)) {
+        char func[MAXLEN_METRICS_NAME] = {0};
+        char prof[MAXLEN_METRICS_NAME] = {0};
+
+        get_str(record, "func", func, sizeof(func));
+        get_str(record, "prof", prof, sizeof(prof));
+        if ('\0' == func[0]) {
+            /* skip malformed records */
+            continue;
+        }
+
+        metrics_group_t * p_group = get_group(&p_groups, &num_groups, func, prof);
+        if (NULL == p_group) {
+            fprintf(stderr, "Memory allocation error\n");
+            goto cleanup;
+        }
+        if (p_group->count == p_group->total_us_size) {
+            size_t new_size = (0 == p_group->total_us_size) ? 64 : 2 * p_group->total_us_size;
+            uint64_t * p_new = realloc(p_group->p_total_us, new_size * sizeof(uint64_t));
+            if (NULL == p_new) {
+                fprintf(stderr, "Memory allocation error\n");
+                goto cleanup;
+            }
+            p_group->p_total_us = p_new;
+            p_group->total_us_size = new_size;
+        }
+        p_group->p_total_us[p_group->count] = get_u64(record, "total_us");
+        p_group->count++;
+        if (0 != get_u64(record, "ret")) {
+            p_group->errors++;
+        }
+        p_group->bytes += get_u64(record, "bytes_in") + get_u64(record, "bytes_out");
+        p_group->operation_us += get_u64(record, "operation_us");
+    }
+
+    printf(
+        "%-34s %-50s %8s %8s %10s %10s %10s %10s %10s\n",
+        "FUNCTION",
+        "PROFILE",
+        "CALLS",
+        "ERRORS",
+        "P50_US",
+        "P90_US",
+        "P99_US",
+        "CALLS/S",
+        "MIB/S");
+    for (size_t i = 0; i < num_groups; ++i) {
+        metrics_group_t * p_group = &p_groups[i];
+        uint64_t sum_us = 0;
+
+        qsort(p_group->p_total_us, p_group->count, sizeof(uint64_t), compare_u64);
+        for (size_t k = 0; k < p_group->count; ++k) {
+            sum_us += p_group->p_total_us[k];
+        }
+
+        /* Throughput of serial invocations and provider throughput during the operation phase */
+        double calls_per_s = (0 == sum_us) ? 0.0 : (double)p_group->count * 1e6 / (double)sum_us;
+        double mib_per_s = (0 == p_group->operation_us)
+                               ? 0.0
+                               : ((double)p_group->bytes / (1024.0 * 1024.0)) * 1e6 / (double)p_group->operation_us;
+        printf(
+            "%-34s %-50s %8zu %8zu %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10.1f %10.2f\n",
+            p_group->func,
+            ('\0' == p_group->prof[0]) ? "-" : p_group->prof,
+            p_group->count,
+            p_group->errors,
+            percentile(p_group->p_total_us, p_group->count, 50),
+            percentile(p_group->p_total_us, p_group->count, 90),
+            percentile(p_group->p_total_us, p_group->count, 99),
+            calls_per_s,
+            mib_per_s);
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    for (size_t i = 0; i < num_groups; ++i) {
+        free(p_groups[i].p_total_us);
+    }
+    free(p_groups);
+    fclose(p_file);
+    return ret;
+}
+
+/*** end of file ***/
@@ -0,0 +1,77 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef GTA_CLI_METRICS_H
+#define GTA_CLI_METRICS_H
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+extern "C" {
+/* *INDENT-ON* */
+#endif
+
+/*---------------------------------------------------------------------*/
+
+#include <gta_api/gta_api.h>
+#include <stdint.h>
+
+/*
+ * Per-invocation metrics. One NDJSON record per invocation is appended to a
+ * metrics file with a single write() on a file opened with O_APPEND, so
+ * concurrent invocations can share the same file.
+ */
+
+/* Environment variable to enable metrics without command line argument */
+#define METRICS_FILE_ENV "GTA_CLI_METRICS_FILE"
+
+/* Phases of an invocation */
+enum metrics_phase {
+    METRICS_PHASE_INSTANCE_INIT,
+    METRICS_PHASE_PROVIDER_REGISTER,
+    METRICS_PHASE_OPERATION,
+    METRICS_PHASE_COUNT
+};
+
+typedef struct metrics {
+    const char * func; /* function name as given on the command line */
+    const char * prof; /* profile name, NULL if not applicable */
+    uint64_t start_ns;
+    uint64_t phase_start_ns[METRICS_PHASE_COUNT]; /* start of a running phase, 0 if not running */
+    uint64_t phase_ns[METRICS_PHASE_COUNT];
+    uint64_t bytes_in;  /* bytes read by the provider from input streams */
+    uint64_t bytes_out; /* bytes written by the provider to output streams */
+    const char * extra; /* further members of the record (",\"key\":value..."), NULL if none */
+} metrics_t;
+
+/* Returns the value of the monotonic clock in nanoseconds */
+uint64_t metrics_now_ns(void);
+
+const char * metrics_phase_name(enum metrics_phase phase);
+
+void metrics_init(metrics_t * p_metrics, const char * func, const char * prof);
+
+void metrics_phase_begin(metrics_t * p_metrics, enum metrics_phase phase);
+
+/* Ends a phase, does nothing if the phase is not running */
+void metrics_phase_end(metrics_t * p_metrics, enum metrics_phase phase);
+
+/* Appends the record for this invocation to the metrics file */
+int metrics_append(const metrics_t * p_metrics, const char * path, int ret, gta_errinfo_t errinfo);
+
+/* Prints p50/p90/p99 latencies and throughput per function and profile of a metrics file */
+int metrics_print_summary(const char * path);
+
+/*---------------------------------------------------------------------*/
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+}
+/* *INDENT-ON* */
+#endif
+
+#endif /* GTA_CLI_METRICS_H */
+
+/*** end of file ***/
@@ -0,0 +1,218 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "perf_counters.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+typedef struct perf_counter_desc {
+    const char * name;
+    uint32_t type;
+    uint64_t config;
+} perf_counter_desc_t;
+
+/* The first counter of each type is the group leader */
+static const perf_counter_desc_t counters[PERF_COUNTER_COUNT] = {
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"cache_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {"task_clock_ns", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+    {"page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+    {"context_switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+};
+
+/* Read format of a single counter with PERF_FORMAT_TOTAL_TIME_ENABLED and PERF_FORMAT_TOTAL_TIME_RUNNING */
+enum { VALUE, TIME_ENABLED, TIME_RUNNING };
+
+static int open_counter(const perf_counter_desc_t * p_desc, int group_fd, bool b_user_only)
+{
+    struct perf_event_attr attr = {0};
+
+    attr.size = sizeof(attr);
+    attr.type = p_desc->type;
+    attr.config = p_desc->config;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    /* Members follow the state of their leader */
+    attr.disabled = (-1 == group_fd) ? 1 : 0;
+    attr.inherit = 1;
+    attr.exclude_kernel = b_user_only ? 1 : 0;
+    attr.exclude_hv = 1;
+
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC);
+}
+
+static bool read_counter(int fd, uint64_t values[3])
+{
+    return (ssize_t)(3 * sizeof(uint64_t)) == read(fd, values, 3 * sizeof(uint64_t));
+}
+
+/* Returns the group leader of a counter, -1 if the group is not open */
+static int leader_of(const perf_counters_t * p_perf, size_t counter)
+{
+    return (PERF_TYPE_HARDWARE == counters[counter].type) ? p_perf->fd[PERF_COUNTER_CYCLES]
+                                                          : p_perf->fd[PERF_COUNTER_TASK_CLOCK];
+}
+
+static void set_groups(perf_counters_t * p_perf, unsigned long request)
+{
+    const int leaders[] = {p_perf->fd[PERF_COUNTER_CYCLES], p_perf->fd[PERF_COUNTER_TASK_CLOCK]};
+    for (size_t i = 0; i < sizeof(leaders) / sizeof(leaders[0]); ++i) {
+        if (-1 != leaders[i]) {
+            ioctl(leaders[i], request, PERF_IOC_FLAG_GROUP);
+        }
+    }
+}
+
+int perf_counters_open(perf_counters_t * p_perf)
+{
+    int hw_errno = 0;
+    int sw_errno = 0;
+
+    memset(p_perf, 0, sizeof(perf_counters_t));
+    for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+        p_perf->fd[i] = -1;
+    }
+
+    for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+        bool b_leader = (PERF_COUNTER_CYCLES == i) || (PERF_COUNTER_TASK_CLOCK == i);
+        int group_fd = b_leader ? -1 : leader_of(p_perf, i);
+        if (!b_leader && (-1 == group_fd)) {
+            continue;
+        }
+
+        int fd = open_counter(&counters[i], group_fd, p_perf->b_user_only);
+        if ((0 > fd) && b_leader && !p_perf->b_user_only && ((EACCES == errno) || (EPERM == errno))) {
+            /* perf_event_paranoid > 1 only allows to count user space */
+            p_perf->b_user_only = true;
+            fd = open_counter(&counters[i], group_fd, p_perf->b_user_only);
+        }
+        if ((0 > fd) && (PERF_COUNTER_CYCLES == i)) {
+            hw_errno = errno;
+        } else if ((0 > fd) && (PERF_COUNTER_TASK_CLOCK == i)) {
+            sw_errno = errno;
+        }
+        p_perf->fd[i] = (0 > fd) ? -1 : fd;
+    }
+
+    if ((-1 == p_perf->fd[PERF_COUNTER_CYCLES]) && (-1 == p_perf->fd[PERF_COUNTER_TASK_CLOCK])) {
+        fprintf(stderr, "Performance counters not available: %s\n", strerror(sw_errno));
+        return EXIT_FAILURE;
+    }
+    if (-1 == p_perf->fd[PERF_COUNTER_CYCLES]) {
+        fprintf(stderr, "Hardware performance counters not available: %s\n", strerror(hw_errno));
+    }
+    return EXIT_SUCCESS;
+}
+
+void perf_counters_phase_begin(perf_counters_t * p_perf, enum metrics_phase phase)
+{
+    for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+        if ((-1 != p_perf->fd[i]) && !read_counter(p_perf->fd[i], p_perf->start[i])) {
+            memset(p_perf->start[i], 0, sizeof(p_perf->start[i]));
+        }
+    }
+    p_perf->b_running[phase] = true;
+    set_groups(p_perf, PERF_EVENT_IOC_ENABLE);
+}
+
+void perf_counters_phase_end(perf_counters_t * p_perf, enum metrics_phase phase)
+{
+    if (!p_perf->b_running[phase]) {
+        return;
+    }
+    set_groups(p_perf, PERF_EVENT_IOC_DISABLE);
+    p_perf->b_running[phase] = false;
+    p_perf->b_counted[phase] = true;
+
+    for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+        uint64_t end[3] = {0};
+        if ((-1 == p_perf->fd[i]) || !read_counter(p_perf->fd[i], end)) {
+            continue;
+        }
+        uint64_t value = end[VALUE] - p_perf->start[i][VALUE];
+        uint64_t enabled = end[TIME_ENABLED] - p_perf->start[i][TIME_ENABLED];
+        uint64_t running = end[TIME_RUNNING] - p_perf->start[i][TIME_RUNNING];
+        if ((0 != running) && (running < enabled)) {
+            /* The counter was multiplexed with other events */
+            value = (uint64_t)((double)value * (double)enabled / (double)running);
+        }
+        p_perf->value[phase][i] += value;
+    }
+}
+
+void perf_counters_print(const perf_counters_t * p_perf)
+{
+    fprintf(stderr, "Performance counters%s:\n", p_perf->b_user_only ? " (user space only)" : "");
+    for (size_t phase = 0; phase < METRICS_PHASE_COUNT; ++phase) {
+        if (!p_perf->b_counted[phase]) {
+            continue;
+        }
+        fprintf(stderr, "  %s:", metrics_phase_name((enum metrics_phase)phase));
+        const char * p_sep = " ";
+        for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+            if (-1 != p_perf->fd[i]) {
+                fprintf(stderr, "%s%s %" PRIu64, p_sep, counters[i].name, p_perf->value[phase][i]);
+                p_sep = ", ";
+            }
+        }
+        if ((-1 != p_perf->fd[PERF_COUNTER_INSTRUCTIONS]) && (0 != p_perf->value[phase][PERF_COUNTER_CYCLES])) {
+            fprintf(
+                stderr,
+                ", IPC %.2f",
+                (double)p_perf->value[phase][PERF_COUNTER_INSTRUCTIONS] /
+                    (double)p_perf->value[phase][PERF_COUNTER_CYCLES]);
+        }
+        fprintf(stderr, "\n");
+    }
+}
+
+size_t perf_counters_json(const perf_counters_t * p_perf, char * p_buf, size_t buf_size)
+{
+    size_t len = 0;
+
+    p_buf[0] = '\0';
+    for (size_t phase = 0; phase < METRICS_PHASE_COUNT; ++phase) {
+        for (size_t i = 0; (i < PERF_COUNTER_COUNT) && p_perf->b_counted[phase]; ++i) {
+            if ((-1 == p_perf->fd[i]) || (len >= buf_size)) {
+                continue;
+            }
+            len += (size_t)snprintf(
+                &p_buf[len],
+                buf_size - len,
+                ",\"%s_%s\":%" PRIu64,
+                metrics_phase_name((enum metrics_phase)phase),
+                counters[i].name,
+                p_perf->value[phase][i]);
+        }
+    }
+    if (len >= buf_size) {
+        /* never return a truncated member */
+        p_buf[0] = '\0';
+        return 0;
+    }
+    return len;
+}
+
+void perf_counters_close(perf_counters_t * p_perf)
+{
+    for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+        if (-1 != p_perf->fd[i]) {
+            close(p_perf->fd[i]);
+            p_perf->fd[i] = -1;
+        }
+    }
+}
+
+/*** end of file ***/
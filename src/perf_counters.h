@@ -0,0 +1,79 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef GTA_CLI_PERF_COUNTERS_H
+#define GTA_CLI_PERF_COUNTERS_H
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+extern "C" {
+/* *INDENT-ON* */
+#endif
+
+/*---------------------------------------------------------------------*/
+
+#include "metrics.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Hardware and software performance counters (perf_event_open) per phase of
+ * an invocation. The counters are opened once as two groups, hardware
+ * counters led by cycles and software counters led by task-clock, and are
+ * enabled only while a phase is running. Threads created during a phase are
+ * counted as well. Counters which cannot be opened (no PMU in a VM or
+ * container, perf_event_paranoid, seccomp) are left out. Counts are scaled
+ * if the kernel had to multiplex the counters.
+ */
+
+enum perf_counter {
+    PERF_COUNTER_CYCLES,
+    PERF_COUNTER_INSTRUCTIONS,
+    PERF_COUNTER_CACHE_MISSES,
+    PERF_COUNTER_BRANCH_MISSES,
+    PERF_COUNTER_TASK_CLOCK,
+    PERF_COUNTER_PAGE_FAULTS,
+    PERF_COUNTER_CONTEXT_SWITCHES,
+    PERF_COUNTER_COUNT
+};
+
+typedef struct perf_counters {
+    int fd[PERF_COUNTER_COUNT];      /* -1 if the counter is not available */
+    bool b_user_only;                /* kernel space is excluded (perf_event_paranoid) */
+    bool b_running[METRICS_PHASE_COUNT];
+    bool b_counted[METRICS_PHASE_COUNT];
+    uint64_t start[PERF_COUNTER_COUNT][3]; /* value, time enabled and time running at the start of a phase */
+    uint64_t value[METRICS_PHASE_COUNT][PERF_COUNTER_COUNT];
+} perf_counters_t;
+
+/* Opens the counters, prints a note and returns EXIT_FAILURE if none is available (the phases are not counted then) */
+int perf_counters_open(perf_counters_t * p_perf);
+
+void perf_counters_phase_begin(perf_counters_t * p_perf, enum metrics_phase phase);
+
+/* Ends a phase, does nothing if the phase is not running */
+void perf_counters_phase_end(perf_counters_t * p_perf, enum metrics_phase phase);
+
+/* Prints the counts of all counted phases to stderr */
+void perf_counters_print(const perf_counters_t * p_perf);
+
+/* Formats the counts as members of a JSON object (",\"operation_cycles\":N..."), returns the length, 0 if too long */
+size_t perf_counters_json(const perf_counters_t * p_perf, char * p_buf, size_t buf_size);
+
+void perf_counters_close(perf_counters_t * p_perf);
+
+/*---------------------------------------------------------------------*/
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+}
+/* *INDENT-ON* */
+#endif
+
+#endif /* GTA_CLI_PERF_COUNTERS_H */
+
+/*** end of file ***/
@@ -0,0 +1,1051 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define _GNU_SOURCE
+
+#include "record.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <inttypes.h>
+#include <openssl/evp.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Length of "sha256:" and the hex digest */
+#define MAXLEN_HASH (16 + (2 * EVP_MAX_MD_SIZE) + 1)
+#define MAXLEN_FUNC_NAME 64
+#define MAXLEN_PATH 4096
+
+/* Placeholders in the recorded arguments */
+#define PLACEHOLDER_INPUT "{in"
+#define PLACEHOLDER_SECRET "{secret:"
+
+/*
+ * Growing string buffer, an allocation error is remembered and reported
+ * when the buffer is used
+ */
+typedef struct strbuf {
+    char * p_buf;
+    size_t len;
+    size_t size;
+    bool b_error;
+} strbuf_t;
+
+static void strbuf_append(strbuf_t * p_sb, const char * p_data, size_t len)
+{
+    if (p_sb->b_error) {
+        return;
+    }
+    if (p_sb->len + len + 1 > p_sb->size) {
+        size_t new_size = (0 == p_sb->size) ? 256 : p_sb->size;
+        while (p_sb->len + len + 1 > new_size) {
+            new_size *= 2;
+        }
+        char * p_new = realloc(p_sb->p_buf, new_size);
+        if (NULL == p_new) {
+            p_sb->b_error = true;
+            return;
+        }
+        p_sb->p_buf = p_new;
+        p_sb->size = new_size;
+    }
+    memcpy(&p_sb->p_buf[p_sb->len], p_data, len);
+    p_sb->len += len;
+    p_sb->p_buf[p_sb->len] = '\0';
+}
+
+static void strbuf_printf(strbuf_t * p_sb, const char * p_format, ...)
+{
+    char buf[256] = {0};
+    va_list args;
+
+    va_start(args, p_format);
+    int len = vsnprintf(buf, sizeof(buf), p_format, args);
+    va_end(args);
+    if ((0 > len) || ((size_t)len >= sizeof(buf))) {
+        p_sb->b_error = true;
+        return;
+    }
+    strbuf_append(p_sb, buf, (size_t)len);
+}
+
+/* Appends a string as JSON string, '"', '\' and control characters are escaped */
+static void strbuf_append_json(strbuf_t * p_sb, const char * p_str)
+{
+    strbuf_append(p_sb, "\"", 1);
+    for (; '\0' != *p_str; ++p_str) {
+        if (('"' == *p_str) || ('\\' == *p_str)) {
+            strbuf_append(p_sb, "\\", 1);
+            strbuf_append(p_sb, p_str, 1);
+        } else if (0x20 > (unsigned char)*p_str) {
+            strbuf_printf(p_sb, "\\u%04x", (unsigned int)(unsigned char)*p_str);
+        } else {
+            strbuf_append(p_sb, p_str, 1);
+        }
+    }
+    strbuf_append(p_sb, "\"", 1);
+}
+
+static void strbuf_free(strbuf_t * p_sb)
+{
+    free(p_sb->p_buf);
+    memset(p_sb, 0, sizeof(strbuf_t));
+}
+
+/* Gets the size of a regular file and, if p_hash is not NULL, its hash as "sha256:HEX" */
+static bool hash_file(const char * p_path, uint64_t * p_size, char * p_hash, size_t hash_size)
+{
+    struct stat st = {0};
+    unsigned char md[EVP_MAX_MD_SIZE] = {0};
+    unsigned int md_len = 0;
+    char buf[65536];
+    bool b_ok = false;
+
+    if ((0 != stat(p_path, &st)) || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+    *p_size = (uint64_t)st.st_size;
+    if (NULL == p_hash) {
+        return true;
+    }
+
+    FILE * p_file = fopen(p_path, "rb");
+    EVP_MD_CTX * p_md_ctx = EVP_MD_CTX_new();
+    if ((NULL == p_file) || (NULL == p_md_ctx) || (1 != EVP_DigestInit_ex(p_md_ctx, EVP_sha256(), NULL))) {
+        goto cleanup;
+    }
+    size_t got = 0;
+    while (0 < (got = fread(buf, 1, sizeof(buf), p_file))) {
+        if (1 != EVP_DigestUpdate(p_md_ctx, buf, got)) {
+            goto cleanup;
+        }
+    }
+    if (ferror(p_file) || (1 != EVP_DigestFinal_ex(p_md_ctx, md, &md_len)) || (hash_size < 8 + (2 * md_len) + 1)) {
+        goto cleanup;
+    }
+    memcpy(p_hash, "sha256:", 8);
+    for (unsigned int i = 0; i < md_len; ++i) {
+        snprintf(&p_hash[7 + (2 * i)], hash_size - 7 - (2 * i), "%02x", md[i]);
+    }
+    b_ok = true;
+
+cleanup:
+    EVP_MD_CTX_free(p_md_ctx);
+    if (NULL != p_file) {
+        fclose(p_file);
+    }
+    return b_ok;
+}
+
+/*
+ * Appends "PREFIX{inN},{inN+1}..." to p_arg and size and hash of every file of a comma separated list to p_rec.
+ * Returns false if not all elements are regular files.
+ */
+static bool append_input_files(
+    strbuf_t * p_arg,
+    strbuf_t * p_rec,
+    const char * p_prefix,
+    const char * p_list,
+    bool b_secret,
+    unsigned int * p_num_in)
+{
+    strbuf_t inputs = {0};
+    strbuf_t arg = {0};
+    unsigned int num_in = *p_num_in;
+    bool b_ok = true;
+
+    strbuf_append(&arg, p_prefix, strlen(p_prefix));
+    for (const char * p_elem = p_list; b_ok && (NULL != p_elem);) {
+        const char * p_sep = strchr(p_elem, ',');
+        size_t len = (NULL == p_sep) ? strlen(p_elem) : (size_t)(p_sep - p_elem);
+        char path[MAXLEN_PATH] = {0};
+        char hash[MAXLEN_HASH] = {0};
+        uint64_t size = 0;
+
+        b_ok = (0 != len) && (len < sizeof(path));
+        if (b_ok) {
+            memcpy(path, p_elem, len);
+            b_ok = hash_file(path, &size, b_secret ? NULL : hash, sizeof(hash));
+        }
+        if (b_ok) {
+            strbuf_printf(&arg, "%s" PLACEHOLDER_INPUT "%u}", (num_in == *p_num_in) ? "" : ",", num_in);
+            strbuf_printf(&inputs, ",\"in%u_size\":%" PRIu64, num_in, size);
+            if (!b_secret) {
+                strbuf_printf(&inputs, ",\"in%u_hash\":\"%s\"", num_in, hash);
+            }
+            ++num_in;
+        }
+        p_elem = (NULL == p_sep) ? NULL : p_sep + 1;
+    }
+
+    b_ok = b_ok && !arg.b_error && !inputs.b_error;
+    if (b_ok) {
+        strbuf_append(p_arg, arg.p_buf, arg.len);
+        strbuf_append(p_rec, inputs.p_buf, inputs.len);
+        *p_num_in = num_in;
+    }
+    strbuf_free(&arg);
+    strbuf_free(&inputs);
+    return b_ok;
+}
+
+/* Options which only control the observation of an invocation */
+static bool is_observation_option(const char * p_arg)
+{
+    static const char * options[] = {
+        "--record=",
+        "--trace=",
+        "--metrics_file=",
+        "--out_digest=",
+        "--io_stats",
+        "--perf_counters",
+    };
+    for (size_t i = 0; i < sizeof(options) / sizeof(options[0]); ++i) {
+        if (0 == strncmp(p_arg, options[i], strlen(options[i]))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int record_append(
+    const char * path,
+    int argc,
+    char * argv[],
+    const metrics_t * p_metrics,
+    int ret,
+    const record_io_t * p_io)
+{
+    int result = EXIT_FAILURE;
+    strbuf_t rec = {0};
+    strbuf_t args = {0};
+    unsigned int num_in = 0;
+    bool b_command = false; /* arguments after "--" belong to the command of exec */
+    struct timespec now = {0};
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    strbuf_printf(
+        &rec,
+        "{\"ts\":%lld.%03ld,\"pid\":%ld,\"func\":",
+        (long long)now.tv_sec,
+        now.tv_nsec / 1000000,
+        (long)getpid());
+    strbuf_append_json(&rec, argv[1]);
+    strbuf_printf(
+        &rec,
+        ",\"ret\":%d,\"total_us\":%" PRIu64 ",\"operation_us\":%" PRIu64,
+        ret,
+        (metrics_now_ns() - p_metrics->start_ns) / 1000,
+        p_metrics->phase_ns[METRICS_PHASE_OPERATION] / 1000);
+
+    for (int i = 2; i < argc; ++i) {
+        const char * p_arg = argv[i];
+        strbuf_t arg = {0};
+
+        if (!b_command && is_observation_option(p_arg)) {
+            continue;
+        }
+        if (b_command) {
+            strbuf_append(&arg, p_arg, strlen(p_arg));
+        } else if (0 == strcmp(p_arg, "--")) {
+            b_command = true;
+            strbuf_append(&arg, p_arg, strlen(p_arg));
+        } else if (0 == strncmp(p_arg, "--data=", 7)) {
+            if (!append_input_files(&arg, &rec, "--data=", p_arg + 7, p_io->b_secret_data, &num_in)) {
+                strbuf_append(&arg, p_arg, strlen(p_arg));
+            }
+        } else if (0 == strncmp(p_arg, "--seal=", 7)) {
+            if (!append_input_files(&arg, &rec, "--seal=", p_arg + 7, false, &num_in)) {
+                strbuf_append(&arg, p_arg, strlen(p_arg));
+            }
+        } else if (0 == strncmp(p_arg, "--proof=", 8)) {
+            if (!append_input_files(&arg, &rec, "--proof=", p_arg + 8, false, &num_in)) {
+                strbuf_append(&arg, p_arg, strlen(p_arg));
+            }
+        } else if (0 == strncmp(p_arg, "--ctx_attr_file=", 16)) {
+            if (!append_input_files(&arg, &rec, "--ctx_attr_file=", p_arg + 16, false, &num_in)) {
+                strbuf_append(&arg, p_arg, strlen(p_arg));
+            }
+        } else if (0 == strncmp(p_arg, "--attr_val=", 11)) {
+            strbuf_printf(&arg, "--attr_val=" PLACEHOLDER_SECRET "%zu}", strlen(p_arg + 11));
+        } else if (((0 == strcmp(p_arg, "--ctx_attr")) || (0 == strcmp(p_arg, "--ctx_attr_bin")) ||
+                    (0 == strcmp(p_arg, "--secret")) || (0 == strcmp(p_arg, "--secret_env"))) &&
+                   (i + 1 < argc)) {
+            /* TYPE=VALUE, TYPE=FILE or NAME=FILE in the next argument, the parser has replaced '=' by '\0' */
+            const char * p_name = argv[++i];
+            const char * p_value = p_name + strlen(p_name) + 1;
+            bool b_secret = (0 != strcmp(p_arg, "--ctx_attr_bin"));
+
+            strbuf_append_json(&args, p_arg);
+            strbuf_append(&args, ",", 1);
+            strbuf_append(&arg, p_name, strlen(p_name));
+            strbuf_append(&arg, "=", 1);
+            if ((0 == strcmp(p_arg, "--ctx_attr")) ||
+                !append_input_files(&arg, &rec, "", p_value, b_secret, &num_in)) {
+                strbuf_printf(&arg, PLACEHOLDER_SECRET "%zu}", strlen(p_value));
+            }
+        } else {
+            strbuf_append(&arg, p_arg, strlen(p_arg));
+        }
+
+        if (arg.b_error) {
+            rec.b_error = true;
+        } else if (NULL != arg.p_buf) {
+            strbuf_append_json(&args, arg.p_buf);
+            strbuf_append(&args, ",", 1);
+        }
+        strbuf_free(&arg);
+    }
+    /* drop the last separator */
+    if (0 != args.len) {
+        args.p_buf[--args.len] = '\0';
+    }
+
+    if (0 != p_io->stdin_size) {
+        strbuf_printf(&rec, ",\"stdin_size\":%" PRIu64, p_io->stdin_size);
+    }
+    if (0 != p_io->out_size) {
+        strbuf_printf(&rec, ",\"out_size\":%" PRIu64, p_io->out_size);
+        if (NULL != p_io->p_out_hash) {
+            strbuf_printf(&rec, ",\"out_hash\":\"%s\"", p_io->p_out_hash);
+        }
+    }
+    strbuf_append(&rec, ",\"args\":[", 9);
+    strbuf_append(&rec, (NULL == args.p_buf) ? "" : args.p_buf, args.len);
+    strbuf_append(&rec, "]}\n", 3);
+    if (rec.b_error || args.b_error) {
+        fprintf(stderr, "Memory allocation error\n");
+        goto cleanup;
+    }
+
+    /* A single write to a file opened with O_APPEND is not interleaved with writes of other processes */
+    int fd = open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0640);
+    if (0 > fd) {
+        fprintf(stderr, "Cannot open record file %s\n", path);
+        goto cleanup;
+    }
+    ssize_t written = write(fd, rec.p_buf, rec.len);
+    close(fd);
+    result = (written == (ssize_t)rec.len) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+cleanup:
+    strbuf_free(&rec);
+    strbuf_free(&args);
+    return result;
+}
+
+/*
+ * record_replay
+ */
+
+/* File of the replay which stands for recorded data with the given hash */
+typedef struct replay_file {
+    char hash[MAXLEN_HASH];
+    char * p_path;
+} replay_file_t;
+
+/* Path in the scratch directory which stands for a recorded path */
+typedef struct replay_path {
+    char * p_recorded;
+    char * p_path;
+} replay_path_t;
+
+typedef struct replay_group {
+    char func[MAXLEN_FUNC_NAME];
+    size_t count;
+    size_t failed;
+    uint64_t * p_recorded_us;
+    uint64_t * p_replayed_us;
+    size_t size;
+} replay_group_t;
+
+typedef struct replay {
+    const char * p_binary;
+    char scratch_dir[MAXLEN_PATH];
+    replay_file_t * p_files;
+    size_t num_files;
+    replay_path_t * p_paths;
+    size_t num_paths;
+    replay_group_t * p_groups;
+    size_t num_groups;
+    size_t skipped;
+    uint64_t seq; /* number of the next file created by the replay */
+} replay_t;
+
+/* Returns a pointer to the value of key in an NDJSON record, NULL if not found */
+static const char * find_value(const char * p_record, const char * p_key)
+{
+    char pattern[MAXLEN_FUNC_NAME + 4] = {0};
+    snprintf(pattern, sizeof(pattern), "\"%s\":", p_key);
+    const char * p_value = strstr(p_record, pattern);
+    return (NULL == p_value) ? NULL : p_value + strlen(pattern);
+}
+
+static bool get_u64(const char * p_record, const char * p_key, uint64_t * p_value)
+{
+    const char * p_str = find_value(p_record, p_key);
+    if (NULL == p_str) {
+        return false;
+    }
+    *p_value = strtoull(p_str, NULL, 10);
+    return true;
+}
+
+/* Gets a string value without escape sequences (function names and hashes) */
+static bool get_str(const char * p_record, const char * p_key, char * p_dst, size_t dst_size)
+{
+    const char * p_value = find_value(p_record, p_key);
+    size_t i = 0;
+    if ((NULL == p_value) || ('"' != *p_value)) {
+        return false;
+    }
+    ++p_value;
+    for (; ('"' != p_value[i]) && ('\0' != p_value[i]) && (i < dst_size - 1); ++i) {
+        p_dst[i] = p_value[i];
+    }
+    p_dst[i] = '\0';
+    return '"' == p_value[i];
+}
+
+/* Parses a JSON string written by strbuf_append_json, returns the position after it or NULL */
+static const char * parse_json_string(const char * p_str, strbuf_t * p_dst)
+{
+    if ('"' != *p_str) {
+        return NULL;
+    }
+    for (++p_str; '"' != *p_str; ++p_str) {
+        if ('\0' == *p_str) {
+            return NULL;
+        }
+        if ('\\' != *p_str) {
+            strbuf_append(p_dst, p_str, 1);
+            continue;
+        }
+        ++p_str;
+        if ('u' == *p_str) {
+            char hex[5] = {0};
+            if (4 != strnlen(p_str + 1, 4)) {
+                return NULL;
+            }
+            memcpy(hex, p_str + 1, 4);
+            char c = (char)strtoul(hex, NULL, 16);
+            strbuf_append(p_dst, &c, 1);
+            p_str += 4;
+        } else if ('\0' != *p_str) {
+            strbuf_append(p_dst, p_str, 1);
+        } else {
+            return NULL;
+        }
+    }
+    return p_str + 1;
+}
+
+/* Parses the array "args" of a record into a NULL terminated list of strings */
+static char ** parse_args(const char * p_record, size_t * p_num_args)
+{
+    const char * p_pos = find_value(p_record, "args");
+    char ** pp_args = calloc(1, sizeof(char *));
+    size_t num_args = 0;
+
+    if ((NULL == p_pos) || ('[' != *p_pos) || (NULL == pp_args)) {
+        free(pp_args);
+        return NULL;
+    }
+    for (++p_pos; ']' != *p_pos; ++num_args) {
+        strbuf_t arg = {0};
+        char ** pp_new = realloc(pp_args, (num_args + 2) * sizeof(char *));
+        if (NULL != pp_new) {
+            pp_args = pp_new;
+            p_pos = parse_json_string(p_pos, &arg);
+        }
+        if ((NULL == pp_new) || (NULL == p_pos) || arg.b_error) {
+            strbuf_free(&arg);
+            break;
+        }
+        /* an empty argument has no buffer */
+        pp_args[num_args] = (NULL == arg.p_buf) ? strdup("") : arg.p_buf;
+        pp_args[num_args + 1] = NULL;
+        if (',' == *p_pos) {
+            ++p_pos;
+        }
+    }
+    if ((NULL == p_pos) || (']' != *p_pos)) {
+        for (size_t i = 0; i < num_args; ++i) {
+            free(pp_args[i]);
+        }
+        free(pp_args);
+        return NULL;
+    }
+    *p_num_args = num_args;
+    return pp_args;
+}
+
+static void free_args(char ** pp_args, size_t num_args)
+{
+    if (NULL != pp_args) {
+        for (size_t i = 0; i < num_args; ++i) {
+            free(pp_args[i]);
+        }
+        free(pp_args);
+    }
+}
+
+/* Writes size bytes of pseudo-random data (xorshift64) to a new file */
+static bool create_input(const char * p_path, uint64_t size, uint64_t seed)
+{
+    uint64_t state = seed | 1;
+    uint64_t buf[8192];
+    bool b_ok = true;
+
+    FILE * p_file = fopen(p_path, "wb");
+    if (NULL == p_file) {
+        fprintf(stderr, "Cannot create file %s\n", p_path);
+        return false;
+    }
+    while (b_ok && (0 < size)) {
+        size_t len = (size < sizeof(buf)) ? (size_t)size : sizeof(buf);
+        for (size_t i = 0; i < (len + 7) / 8; ++i) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            buf[i] = state;
+        }
+        b_ok = (len == fwrite(buf, 1, len, p_file));
+        size -= len;
+    }
+    b_ok = (0 == fclose(p_file)) && b_ok;
+    return b_ok;
+}
+
+static const char * lookup_file(const replay_t * p_replay, const char * p_hash)
+{
+    for (size_t i = 0; i < p_replay->num_files; ++i) {
+        if (0 == strcmp(p_replay->p_files[i].hash, p_hash)) {
+            return p_replay->p_files[i].p_path;
+        }
+    }
+    return NULL;
+}
+
+/* Remembers that the file stands for recorded data with the hash, a previous file for it is replaced */
+static bool add_file(replay_t * p_replay, const char * p_hash, const char * p_path)
+{
+    char * p_copy = strdup(p_path);
+    if (NULL == p_copy) {
+        return false;
+    }
+    for (size_t i = 0; i < p_replay->num_files; ++i) {
+        if (0 == strcmp(p_replay->p_files[i].hash, p_hash)) {
+            unlink(p_replay->p_files[i].p_path);
+            free(p_replay->p_files[i].p_path);
+            p_replay->p_files[i].p_path = p_copy;
+            return true;
+        }
+    }
+    replay_file_t * p_new = realloc(p_replay->p_files, (p_replay->num_files + 1) * sizeof(replay_file_t));
+    if (NULL == p_new) {
+        free(p_copy);
+        return false;
+    }
+    p_replay->p_files = p_new;
+    snprintf(p_new[p_replay->num_files].hash, sizeof(p_new[p_replay->num_files].hash), "%s", p_hash);
+    p_new[p_replay->num_files].p_path = p_copy;
+    ++p_replay->num_files;
+    return true;
+}
+
+/*
+ * Functions and options which would act on data or state outside of the
+ * scratch directory: exec runs arbitrary commands and watch does not return,
+ * replay and metrics_summary read files which are left out of the record,
+ * cache_flush and --cache use the keyring of the user, the files of --dir and
+ * --data_list are not recorded.
+ */
+static bool is_replayable(const char * p_func, char ** pp_args, size_t num_args)
+{
+    static const char * funcs[] = {"exec", "watch", "replay", "metrics_summary", "cache_flush"};
+    static const char * options[] = {"--dir=", "--data_list=", "--cache="};
+
+    for (size_t i = 0; i < sizeof(funcs) / sizeof(funcs[0]); ++i) {
+        if (0 == strcmp(p_func, funcs[i])) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < num_args; ++i) {
+        for (size_t j = 0; j < sizeof(options) / sizeof(options[0]); ++j) {
+            if (0 == strncmp(pp_args[i], options[j], strlen(options[j]))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/* Returns the path in the scratch directory which stands for a recorded path, it is created on first use */
+static const char * scratch_path(replay_t * p_replay, const char * p_recorded, bool b_dir)
+{
+    char path[MAXLEN_PATH] = {0};
+
+    for (size_t i = 0; i < p_replay->num_paths; ++i) {
+        if (0 == strcmp(p_replay->p_paths[i].p_recorded, p_recorded)) {
+            return p_replay->p_paths[i].p_path;
+        }
+    }
+    snprintf(path, sizeof(path), "%s/paths/%" PRIu64, p_replay->scratch_dir, p_replay->seq++);
+    if (b_dir && (0 != mkdir(path, 0700))) {
+        fprintf(stderr, "Cannot create directory %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    replay_path_t * p_new = realloc(p_replay->p_paths, (p_replay->num_paths + 1) * sizeof(replay_path_t));
+    if (NULL == p_new) {
+        return NULL;
+    }
+    p_replay->p_paths = p_new;
+    p_new[p_replay->num_paths].p_recorded = strdup(p_recorded);
+    p_new[p_replay->num_paths].p_path = strdup(path);
+    if ((NULL == p_new[p_replay->num_paths].p_recorded) || (NULL == p_new[p_replay->num_paths].p_path)) {
+        free(p_new[p_replay->num_paths].p_recorded);
+        free(p_new[p_replay->num_paths].p_path);
+        return NULL;
+    }
+    return p_new[p_replay->num_paths++].p_path;
+}
+
+/*
+ * Replaces the path of an option which writes files by a path in the scratch
+ * directory, the same recorded path is always replaced by the same path (e.g.
+ * the vault of vault_put and vault_get). Takes the ownership of p_arg.
+ */
+static char * map_output_option(replay_t * p_replay, char * p_arg)
+{
+    static const struct {
+        const char * p_option;
+        bool b_dir;
+    } options[] = {{"--out_dir=", true}, {"--vault=", false}, {"--journal=", false}, {"--index=", false}};
+
+    for (size_t i = 0; (NULL != p_arg) && (i < sizeof(options) / sizeof(options[0])); ++i) {
+        size_t len = strlen(options[i].p_option);
+        if (0 == strncmp(p_arg, options[i].p_option, len)) {
+            const char * p_path = scratch_path(p_replay, p_arg + len, options[i].b_dir);
+            size_t size = (NULL == p_path) ? 0 : len + strlen(p_path) + 1;
+            char * p_mapped = (NULL == p_path) ? NULL : malloc(size);
+            if (NULL != p_mapped) {
+                snprintf(p_mapped, size, "%s%s", options[i].p_option, p_path);
+            }
+            free(p_arg);
+            return p_mapped;
+        }
+    }
+    return p_arg;
+}
+
+/* Replaces the placeholders of a recorded argument */
+static char * substitute(const char * p_arg, char ** pp_inputs, size_t num_inputs)
+{
+    strbuf_t sb = {0};
+
+    while ('\0' != *p_arg) {
+        char * p_end = NULL;
+        if (0 == strncmp(p_arg, PLACEHOLDER_INPUT, strlen(PLACEHOLDER_INPUT))) {
+            unsigned long idx = strtoul(p_arg + strlen(PLACEHOLDER_INPUT), &p_end, 10);
+            if (('}' == *p_end) && (idx < num_inputs)) {
+                strbuf_append(&sb, pp_inputs[idx], strlen(pp_inputs[idx]));
+                p_arg = p_end + 1;
+                continue;
+            }
+        } else if (0 == strncmp(p_arg, PLACEHOLDER_SECRET, strlen(PLACEHOLDER_SECRET))) {
+            unsigned long len = strtoul(p_arg + strlen(PLACEHOLDER_SECRET), &p_end, 10);
+            if (('}' == *p_end) && (len <= MAXLEN_PATH)) {
+                for (unsigned long i = 0; i < len; ++i) {
+                    strbuf_append(&sb, "x", 1);
+                }
+                p_arg = p_end + 1;
+                continue;
+            }
+        }
+        strbuf_append(&sb, p_arg, 1);
+        ++p_arg;
+    }
+    if (sb.b_error) {
+        strbuf_free(&sb);
+        return NULL;
+    }
+    return (NULL == sb.p_buf) ? strdup("") : sb.p_buf;
+}
+
+/* Runs the binary with stdin and stdout redirected to files, returns the exit status or -1 */
+static int run_child(
+    const replay_t * p_replay,
+    char ** pp_argv,
+    const char * p_stdin_path,
+    const char * p_stdout_path,
+    const char * p_state_dir)
+{
+    char stderr_path[MAXLEN_PATH] = {0};
+    int status = 0;
+
+    snprintf(stderr_path, sizeof(stderr_path), "%s/stderr.log", p_replay->scratch_dir);
+    fflush(stdout);
+    pid_t pid = fork();
+    if (0 > pid) {
+        fprintf(stderr, "Cannot start %s: %s\n", p_replay->p_binary, strerror(errno));
+        return -1;
+    }
+    if (0 == pid) {
+        int in_fd = open((NULL == p_stdin_path) ? "/dev/null" : p_stdin_path, O_RDONLY);
+        int out_fd = open(p_stdout_path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        int err_fd = open(stderr_path, O_WRONLY | O_CREAT | O_APPEND, 0600);
+        if ((0 > in_fd) || (0 > out_fd) || (0 > err_fd) || (0 > dup2(in_fd, STDIN_FILENO)) ||
+            (0 > dup2(out_fd, STDOUT_FILENO)) || (0 > dup2(err_fd, STDERR_FILENO)) ||
+            (0 != setenv("GTA_STATE_DIRECTORY", p_state_dir, 1))) {
+            _exit(127);
+        }
+        execv(p_replay->p_binary, pp_argv);
+        _exit(127);
+    }
+    while (0 > waitpid(pid, &status, 0)) {
+        if (EINTR != errno) {
+            return -1;
+        }
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+static replay_group_t * get_group(replay_t * p_replay, const char * p_func)
+{
+    for (size_t i = 0; i < p_replay->num_groups; ++i) {
+        if (0 == strcmp(p_replay->p_groups[i].func, p_func)) {
+            return &p_replay->p_groups[i];
+        }
+    }
+    replay_group_t * p_new = realloc(p_replay->p_groups, (p_replay->num_groups + 1) * sizeof(replay_group_t));
+    if (NULL == p_new) {
+        return NULL;
+    }
+    p_replay->p_groups = p_new;
+    replay_group_t * p_group = &p_new[p_replay->num_groups];
+    memset(p_group, 0, sizeof(replay_group_t));
+    snprintf(p_group->func, sizeof(p_group->func), "%s", p_func);
+    ++p_replay->num_groups;
+    return p_group;
+}
+
+static bool add_timing(replay_group_t * p_group, uint64_t recorded_us, uint64_t replayed_us)
+{
+    if (p_group->count == p_group->size) {
+        size_t new_size = (0 == p_group->size) ? 64 : 2 * p_group->size;
+        uint64_t * p_recorded = realloc(p_group->p_recorded_us, new_size * sizeof(uint64_t));
+        if (NULL != p_recorded) {
+            p_group->p_recorded_us = p_recorded;
+        }
+        uint64_t * p_replayed = realloc(p_group->p_replayed_us, new_size * sizeof(uint64_t));
+        if (NULL != p_replayed) {
+            p_group->p_replayed_us = p_replayed;
+        }
+        if ((NULL == p_recorded) || (NULL == p_replayed)) {
+            return false;
+        }
+        p_group->size = new_size;
+    }
+    p_group->p_recorded_us[p_group->count] = recorded_us;
+    p_group->p_replayed_us[p_group->count] = replayed_us;
+    p_group->count++;
+    return true;
+}
+
+/* Reads total_us of the metrics record written by the replayed invocation */
+static bool read_replayed_us(const char * p_metrics_path, uint64_t * p_total_us)
+{
+    char record[2048] = {0};
+    FILE * p_file = fopen(p_metrics_path, "r");
+    if (NULL == p_file) {
+        return false;
+    }
+    bool b_ok = (NULL != fgets(record, sizeof(record), p_file)) && get_u64(record, "total_us", p_total_us);
+    fclose(p_file);
+    return b_ok;
+}
+
+/* Replays one record, returns false on errors which end the replay */
+static bool replay_record(replay_t * p_replay, const char * p_record)
+{
+    char func[MAXLEN_FUNC_NAME] = {0};
+    char path[MAXLEN_PATH] = {0};
+    char out_path[MAXLEN_PATH] = {0};
+    char stdin_path[MAXLEN_PATH] = {0};
+    char state_dir[MAXLEN_PATH] = {0};
+    char metrics_arg[MAXLEN_PATH] = {0};
+    char * inputs[64] = {0};
+    bool b_owned[64] = {0}; /* the input is a temporary file of this invocation */
+    size_t num_inputs = 0;
+    char ** pp_args = NULL;
+    size_t num_args = 0;
+    char ** pp_argv = NULL;
+    uint64_t value = 0;
+    bool b_ok = false;
+
+    if (!get_str(p_record, "func", func, sizeof(func)) || (NULL == (pp_args = parse_args(p_record, &num_args)))) {
+        /* skip malformed records */
+        ++p_replay->skipped;
+        return true;
+    }
+    if (!is_replayable(func, pp_args, num_args)) {
+        ++p_replay->skipped;
+        free_args(pp_args, num_args);
+        return true;
+    }
+
+    /* Inputs: the output of an earlier invocation with the recorded hash or random data of the recorded size */
+    for (; num_inputs < sizeof(inputs) / sizeof(inputs[0]); ++num_inputs) {
+        char key[32] = {0};
+        char hash[MAXLEN_HASH] = {0};
+        snprintf(key, sizeof(key), "in%zu_size", num_inputs);
+        if (!get_u64(p_record, key, &value)) {
+            break;
+        }
+        snprintf(key, sizeof(key), "in%zu_hash", num_inputs);
+        bool b_hash = get_str(p_record, key, hash, sizeof(hash));
+        const char * p_known = b_hash ? lookup_file(p_replay, hash) : NULL;
+        if (NULL == p_known) {
+            snprintf(path, sizeof(path), "%s/in/%" PRIu64, p_replay->scratch_dir, p_replay->seq++);
+            if (!create_input(path, value, p_replay->seq) || (b_hash && !add_file(p_replay, hash, path))) {
+                goto cleanup;
+            }
+            b_owned[num_inputs] = !b_hash;
+            p_known = path;
+        }
+        if (NULL == (inputs[num_inputs] = strdup(p_known))) {
+            goto cleanup;
+        }
+    }
+    if (get_u64(p_record, "stdin_size", &value)) {
+        snprintf(stdin_path, sizeof(stdin_path), "%s/in/%" PRIu64, p_replay->scratch_dir, p_replay->seq++);
+        if (!create_input(stdin_path, value, p_replay->seq)) {
+            goto cleanup;
+        }
+    }
+    snprintf(out_path, sizeof(out_path), "%s/out/%" PRIu64, p_replay->scratch_dir, p_replay->seq++);
+    snprintf(state_dir, sizeof(state_dir), "%s/gta_state", p_replay->scratch_dir);
+    snprintf(metrics_arg, sizeof(metrics_arg), "--metrics_file=%s/metrics.ndjson", p_replay->scratch_dir);
+
+    /* binary, function, arguments, --metrics_file, NULL */
+    pp_argv = calloc(num_args + 4, sizeof(char *));
+    if (NULL == pp_argv) {
+        goto cleanup;
+    }
+    pp_argv[0] = strdup(p_replay->p_binary);
+    pp_argv[1] = strdup(func);
+    for (size_t i = 0; i < num_args; ++i) {
+        pp_argv[2 + i] = map_output_option(p_replay, substitute(pp_args[i], inputs, num_inputs));
+    }
+    pp_argv[2 + num_args] = strdup(metrics_arg);
+    for (size_t i = 0; i < num_args + 3; ++i) {
+        if (NULL == pp_argv[i]) {
+            goto cleanup;
+        }
+    }
+
+    unlink(metrics_arg + strlen("--metrics_file="));
+    int status = run_child(p_replay, pp_argv, ('\0' == stdin_path[0]) ? NULL : stdin_path, out_path, state_dir);
+    uint64_t recorded_ret = 0;
+    uint64_t recorded_us = 0;
+    uint64_t replayed_us = 0;
+    get_u64(p_record, "ret", &recorded_ret);
+    replay_group_t * p_group = get_group(p_replay, func);
+    if (NULL == p_group) {
+        goto cleanup;
+    }
+    if ((0 > status) || ((0 == status) != (0 == recorded_ret)) ||
+        !read_replayed_us(metrics_arg + strlen("--metrics_file="), &replayed_us)) {
+        p_group->failed++;
+    } else if (get_u64(p_record, "total_us", &recorded_us) && !add_timing(p_group, recorded_us, replayed_us)) {
+        goto cleanup;
+    }
+
+    /* The output stands for the recorded output in later invocations */
+    char hash[MAXLEN_HASH] = {0};
+    if ((0 == status) && get_str(p_record, "out_hash", hash, sizeof(hash))) {
+        if (!add_file(p_replay, hash, out_path)) {
+            goto cleanup;
+        }
+    } else {
+        unlink(out_path);
+    }
+    b_ok = true;
+
+cleanup:
+    if (!b_ok) {
+        fprintf(stderr, "Cannot replay %s\n", func);
+    }
+    if ('\0' != stdin_path[0]) {
+        unlink(stdin_path);
+    }
+    for (size_t i = 0; i < num_inputs; ++i) {
+        if (b_owned[i]) {
+            unlink(inputs[i]);
+        }
+        free(inputs[i]);
+    }
+    free_args(pp_argv, num_args + 3);
+    free_args(pp_args, num_args);
+    return b_ok;
+}
+
+static int compare_u64(const void * p_a, const void * p_b)
+{
+    uint64_t a = *(const uint64_t *)p_a;
+    uint64_t b = *(const uint64_t *)p_b;
+    return (a > b) - (a < b);
+}
+
+/* Nearest-rank percentile of a sorted array */
+static uint64_t percentile(const uint64_t * p_sorted, size_t count, unsigned int pct)
+{
+    size_t rank = ((count * pct) + 99) / 100;
+    return p_sorted[(0 == rank) ? 0 : rank - 1];
+}
+
+static double delta_pct(uint64_t recorded, uint64_t replayed)
+{
+    return (0 == recorded) ? 0.0 : (((double)replayed / (double)recorded) - 1.0) * 100.0;
+}
+
+static void print_report(replay_t * p_replay)
+{
+    printf(
+        "%-34s %8s %8s %12s %12s %9s %12s %12s %9s\n",
+        "FUNCTION",
+        "CALLS",
+        "FAILED",
+        "REC_P50_US",
+        "REP_P50_US",
+        "DELTA",
+        "REC_P90_US",
+        "REP_P90_US",
+        "DELTA");
+    for (size_t i = 0; i < p_replay->num_groups; ++i) {
+        replay_group_t * p_group = &p_replay->p_groups[i];
+        if (0 == p_group->count) {
+            printf("%-34s %8zu %8zu\n", p_group->func, p_group->failed, p_group->failed);
+            continue;
+        }
+        qsort(p_group->p_recorded_us, p_group->count, sizeof(uint64_t), compare_u64);
+        qsort(p_group->p_replayed_us, p_group->count, sizeof(uint64_t), compare_u64);
+        uint64_t rec_p50 = percentile(p_group->p_recorded_us, p_group->count, 50);
+        uint64_t rep_p50 = percentile(p_group->p_replayed_us, p_group->count, 50);
+        uint64_t rec_p90 = percentile(p_group->p_recorded_us, p_group->count, 90);
+        uint64_t rep_p90 = percentile(p_group->p_replayed_us, p_group->count, 90);
+        printf(
+            "%-34s %8zu %8zu %12" PRIu64 " %12" PRIu64 " %+8.1f%% %12" PRIu64 " %12" PRIu64 " %+8.1f%%\n",
+            p_group->func,
+            p_group->count + p_group->failed,
+            p_group->failed,
+            rec_p50,
+            rep_p50,
+            delta_pct(rec_p50, rep_p50),
+            rec_p90,
+            rep_p90,
+            delta_pct(rec_p90, rep_p90));
+    }
+    if (0 != p_replay->skipped) {
+        printf(
+            "%zu records skipped (exec, watch, replay, metrics_summary, cache_flush, --dir, --data_list, --cache or "
+            "malformed)\n",
+            p_replay->skipped);
+    }
+}
+
+static int remove_entry(const char * p_path, const struct stat * p_st, int type, struct FTW * p_ftw)
+{
+    return remove(p_path);
+}
+
+int record_replay(const char * path, const char * p_binary, const char * p_scratch_dir)
+{
+    int ret = EXIT_FAILURE;
+    replay_t replay = {.p_binary = (NULL == p_binary) ? "/proc/self/exe" : p_binary};
+    bool b_temporary = (NULL == p_scratch_dir);
+    bool b_created = false;
+    char * p_record = NULL;
+    size_t record_size = 0;
+    char dir[MAXLEN_PATH] = {0};
+
+    FILE * p_file = fopen(path, "r");
+    if (NULL == p_file) {
+        fprintf(stderr, "Cannot open record file %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    if (b_temporary) {
+        const char * p_tmp = getenv("TMPDIR");
+        snprintf(
+            replay.scratch_dir,
+            sizeof(replay.scratch_dir),
+            "%s/gta-cli-replay-XXXXXX",
+            (NULL == p_tmp) ? "/tmp" : p_tmp);
+        if (NULL == mkdtemp(replay.scratch_dir)) {
+            fprintf(stderr, "Cannot create scratch directory: %s\n", strerror(errno));
+            goto cleanup;
+        }
+    } else {
+        snprintf(replay.scratch_dir, sizeof(replay.scratch_dir), "%s", p_scratch_dir);
+        if ((0 != mkdir(replay.scratch_dir, 0700)) && (EEXIST != errno)) {
+            fprintf(stderr, "Cannot create scratch directory %s: %s\n", replay.scratch_dir, strerror(errno));
+            goto cleanup;
+        }
+    }
+    b_created = true;
+    /* The state directory must be new, the replay starts with an empty state */
+    const char * subdirs[] = {"gta_state", "in", "out", "paths"};
+    for (size_t i = 0; i < sizeof(subdirs) / sizeof(subdirs[0]); ++i) {
+        snprintf(dir, sizeof(dir), "%s/%s", replay.scratch_dir, subdirs[i]);
+        if (0 != mkdir(dir, 0700)) {
+            fprintf(stderr, "Cannot create directory %s: %s\n", dir, strerror(errno));
+            goto cleanup;
+        }
+    }
+
+    while (0 < getline(&p_record, &record_size, p_file)) {
+        if (!replay_record(&replay, p_record)) {
+            goto cleanup;
+        }
+    }
+    print_report(&replay);
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    fclose(p_file);
+    free(p_record);
+    if (b_temporary && b_created) {
+        nftw(replay.scratch_dir, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+    }
+    for (size_t i = 0; i < replay.num_files; ++i) {
+        free(replay.p_files[i].p_path);
+    }
+    free(replay.p_files);
+    for (size_t i = 0; i < replay.num_paths; ++i) {
+        free(replay.p_paths[i].p_recorded);
+        free(replay.p_paths[i].p_path);
+    }
+    free(replay.p_paths);
+    for (size_t i = 0; i < replay.num_groups; ++i) {
+        free(replay.p_groups[i].p_recorded_us);
+        free(replay.p_groups[i].p_replayed_us);
+    }
+    free(replay.p_groups);
+    return ret;
+}
+
+/*** end of file ***/
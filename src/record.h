@@ -0,0 +1,88 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef GTA_CLI_RECORD_H
+#define GTA_CLI_RECORD_H
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+extern "C" {
+/* *INDENT-ON* */
+#endif
+
+/*---------------------------------------------------------------------*/
+
+#include "metrics.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Workload capture and replay. With --record=FILE every invocation appends
+ * one NDJSON record to FILE with a single write() on a file opened with
+ * O_APPEND:
+ *
+ *   {"ts":..,"pid":..,"func":"seal_data","ret":0,"total_us":..,"operation_us":..,
+ *    "in0_size":..,"in0_hash":"sha256:..","stdin_size":..,"out_size":..,"out_hash":"sha256:..",
+ *    "args":["--pers=p","--prof=..","--data={in0}"]}
+ *
+ * Input files (--data, --seal, --proof, --ctx_attr_file, files of
+ * --ctx_attr_bin, --secret and --secret_env) are replaced by "{inN}" in the
+ * arguments and recorded with size and hash, values of --attr_val and
+ * --ctx_attr by "{secret:LEN}".
+ * Data which is confidential (plaintext to be sealed, unsealed output,
+ * secrets) is only recorded with its size. Options for observability (--record, --trace,
+ * --metrics_file, --out_digest, --io_stats, --perf_counters) are left out.
+ *
+ * A replay runs the recorded invocations in order with another gta-cli
+ * binary against a scratch state directory. Inputs are random data of the
+ * recorded size, except if the hash of an input matches the output of an
+ * earlier invocation (e.g. unseal_data of the output of seal_data): then
+ * the output of the replayed invocation is used. The paths of --out_dir,
+ * --vault, --journal and --index are replaced by paths in the scratch
+ * directory. Invocations which would act on data or state outside of the
+ * scratch directory (exec, watch, replay, metrics_summary, cache_flush,
+ * --dir, --data_list, --cache) are skipped.
+ */
+
+/* Data of an invocation which is recorded in addition to the arguments */
+typedef struct record_io {
+    bool b_secret_data;      /* the files of --data are confidential */
+    uint64_t stdin_size;     /* bytes read from stdin */
+    uint64_t out_size;       /* bytes written to stdout */
+    const char * p_out_hash; /* "ALG:HEX" of the output, NULL if not known or confidential */
+} record_io_t;
+
+/*
+ * Appends the record for this invocation to the record file. argv must have
+ * been parsed: the first '=' of the arguments after --ctx_attr, --ctx_attr_bin,
+ * --secret and --secret_env is replaced by '\0'.
+ */
+int record_append(
+    const char * path,
+    int argc,
+    char * argv[],
+    const metrics_t * p_metrics,
+    int ret,
+    const record_io_t * p_io);
+
+/*
+ * Replays a record file with the binary (NULL: this gta-cli) in p_scratch_dir
+ * (NULL: a temporary directory which is removed afterwards) and prints the
+ * latencies per function compared with the recorded run
+ */
+int record_replay(const char * path, const char * p_binary, const char * p_scratch_dir);
+
+/*---------------------------------------------------------------------*/
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+}
+/* *INDENT-ON* */
+#endif
+
+#endif /* GTA_CLI_RECORD_H */
+
+/*** end of file ***/
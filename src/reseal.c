@@ -0,0 +1,556 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "reseal.h"
+
+#include "streams.h"
+#include "trace.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <gta_api/util/gta_memset.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Upper bound for the number of worker threads */
+#define RESEAL_MAX_THREADS 256
+/* Suffix of the file written while a file is resealed */
+#define RESEAL_TMP_SUFFIX ".reseal.tmp"
+
+struct plain_pipe;
+
+/* gtaio_ostream writing into the pipe, used by gta_unseal_data */
+typedef struct pipe_ostream {
+    /* public interface as defined for gtaio_ostream */
+    void * p_reserved0;
+    void * p_reserved1;
+    gtaio_stream_write_t write;
+    gtaio_stream_finish_t finish;
+
+    /* private implementation details */
+    struct plain_pipe * p_pipe;
+} pipe_ostream_t;
+
+/* gtaio_istream reading from the pipe, used by gta_seal_data */
+typedef struct pipe_istream {
+    /* public interface as defined for gtaio_istream */
+    gtaio_stream_read_t read;
+    gtaio_stream_eof_t eof;
+    void * p_reserved2;
+    void * p_reserved3;
+
+    /* private implementation details */
+    struct plain_pipe * p_pipe;
+} pipe_istream_t;
+
+/* Bounded ring buffer holding the plaintext between the two threads */
+typedef struct plain_pipe {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond; /* signalled on every state change */
+    char buf[RESEAL_PIPE_SIZE];
+    size_t pos;          /* position of the first unread byte */
+    size_t len;          /* number of unread bytes */
+    bool b_write_done;   /* gta_unseal_data has finished */
+    bool b_write_failed; /* gta_unseal_data has failed, the plaintext is incomplete */
+    bool b_read_done;    /* gta_seal_data has returned, written data is discarded */
+    pipe_ostream_t ostream;
+    pipe_istream_t istream;
+
+    /* arguments of the unseal thread */
+    gta_context_handle_t h_src;
+    gtaio_istream_t * p_sealed;
+    gta_errinfo_t errinfo;
+} plain_pipe_t;
+
+static size_t pipe_ostream_write(pipe_ostream_t * ostream, const char * data, size_t len, gta_errinfo_t * p_errinfo)
+{
+    plain_pipe_t * p_pipe = ostream->p_pipe;
+    size_t written = 0;
+
+    pthread_mutex_lock(&p_pipe->mutex);
+    while (written < len) {
+        while ((RESEAL_PIPE_SIZE == p_pipe->len) && !p_pipe->b_read_done) {
+            pthread_cond_wait(&p_pipe->cond, &p_pipe->mutex);
+        }
+        if (p_pipe->b_read_done) {
+            /* gta_seal_data has failed, stop gta_unseal_data */
+            *p_errinfo = GTA_ERROR_INTERNAL_ERROR;
+            break;
+        }
+        size_t tail = (p_pipe->pos + p_pipe->len) % RESEAL_PIPE_SIZE;
+        size_t chunk = RESEAL_PIPE_SIZE - p_pipe->len;
+        if (chunk > (RESEAL_PIPE_SIZE - tail)) {
+            chunk = RESEAL_PIPE_SIZE - tail;
+        }
+        if (chunk > (len - written)) {
+            chunk = len - written;
+        }
+        memcpy(&p_pipe->buf[tail], &data[written], chunk);
+        p_pipe->len += chunk;
+        written += chunk;
+        pthread_cond_broadcast(&p_pipe->cond);
+    }
+    pthread_mutex_unlock(&p_pipe->mutex);
+    return written;
+}
+
+static bool pipe_ostream_finish(pipe_ostream_t * ostream, gta_errinfo_t errinfo, gta_errinfo_t * p_errinfo)
+{
+    plain_pipe_t * p_pipe = ostream->p_pipe;
+
+    pthread_mutex_lock(&p_pipe->mutex);
+    p_pipe->b_write_done = true;
+    if (0 != errinfo) {
+        p_pipe->b_write_failed = true;
+        p_pipe->errinfo = errinfo;
+    }
+    pthread_cond_broadcast(&p_pipe->cond);
+    pthread_mutex_unlock(&p_pipe->mutex);
+    return true;
+}
+
+static size_t pipe_istream_read(pipe_istream_t * istream, char * data, size_t len, gta_errinfo_t * p_errinfo)
+{
+    plain_pipe_t * p_pipe = istream->p_pipe;
+    size_t read = 0;
+
+    pthread_mutex_lock(&p_pipe->mutex);
+    while ((0 == p_pipe->len) && !p_pipe->b_write_done) {
+        pthread_cond_wait(&p_pipe->cond, &p_pipe->mutex);
+    }
+    while ((read < len) && (0 < p_pipe->len)) {
+        size_t chunk = RESEAL_PIPE_SIZE - p_pipe->pos;
+        if (chunk > p_pipe->len) {
+            chunk = p_pipe->len;
+        }
+        if (chunk > (len - read)) {
+            chunk = len - read;
+        }
+        memcpy(&data[read], &p_pipe->buf[p_pipe->pos], chunk);
+        gta_memset(&p_pipe->buf[p_pipe->pos], chunk, 0, chunk);
+        p_pipe->pos = (p_pipe->pos + chunk) % RESEAL_PIPE_SIZE;
+        p_pipe->len -= chunk;
+        read += chunk;
+    }
+    if ((0 == read) && p_pipe->b_write_failed) {
+        *p_errinfo = GTA_ERROR_INTERNAL_ERROR;
+    }
+    pthread_cond_broadcast(&p_pipe->cond);
+    pthread_mutex_unlock(&p_pipe->mutex);
+    return read;
+}
+
+static bool pipe_istream_eof(pipe_istream_t * istream, gta_errinfo_t * p_errinfo)
+{
+    plain_pipe_t * p_pipe = istream->p_pipe;
+    bool b_eof = false;
+
+    pthread_mutex_lock(&p_pipe->mutex);
+    /* Wait until there is data or the end of data is known */
+    while ((0 == p_pipe->len) && !p_pipe->b_write_done) {
+        pthread_cond_wait(&p_pipe->cond, &p_pipe->mutex);
+    }
+    b_eof = (0 == p_pipe->len);
+    pthread_mutex_unlock(&p_pipe->mutex);
+    return b_eof;
+}
+
+static void * unseal_main(void * p_arg)
+{
+    plain_pipe_t * p_pipe = p_arg;
+    gta_errinfo_t errinfo = 0;
+
+    bool b_ok = TRACE_BOOL(
+        gta_unseal_data, (p_pipe->h_src, p_pipe->p_sealed, (gtaio_ostream_t *)&p_pipe->ostream, &errinfo), &errinfo);
+
+    pthread_mutex_lock(&p_pipe->mutex);
+    /* Providers do not necessarily call finish, the end of data is set here in any case */
+    p_pipe->b_write_done = true;
+    if (!b_ok) {
+        p_pipe->b_write_failed = true;
+        p_pipe->errinfo = errinfo;
+    }
+    pthread_cond_broadcast(&p_pipe->cond);
+    pthread_mutex_unlock(&p_pipe->mutex);
+    return NULL;
+}
+
+int reseal_stream(
+    gta_context_handle_t h_src,
+    gta_context_handle_t h_dst,
+    gtaio_istream_t * p_istream,
+    gtaio_ostream_t * p_ostream,
+    gta_errinfo_t * p_errinfo)
+{
+    int ret = EXIT_FAILURE;
+    pthread_t unsealer = {0};
+    plain_pipe_t * p_pipe = calloc(1, sizeof(plain_pipe_t));
+
+    if (NULL == p_pipe) {
+        fprintf(stderr, "Memory allocation error\n");
+        return EXIT_FAILURE;
+    }
+    pthread_mutex_init(&p_pipe->mutex, NULL);
+    pthread_cond_init(&p_pipe->cond, NULL);
+    p_pipe->ostream.write = (gtaio_stream_write_t)pipe_ostream_write;
+    p_pipe->ostream.finish = (gtaio_stream_finish_t)pipe_ostream_finish;
+    p_pipe->ostream.p_pipe = p_pipe;
+    p_pipe->istream.read = (gtaio_stream_read_t)pipe_istream_read;
+    p_pipe->istream.eof = (gtaio_stream_eof_t)pipe_istream_eof;
+    p_pipe->istream.p_pipe = p_pipe;
+    p_pipe->h_src = h_src;
+    p_pipe->p_sealed = p_istream;
+
+    if (0 != pthread_create(&unsealer, NULL, unseal_main, p_pipe)) {
+        fprintf(stderr, "Cannot create thread\n");
+        goto cleanup;
+    }
+
+    bool b_sealed = TRACE_BOOL(
+        gta_seal_data, (h_dst, (gtaio_istream_t *)&p_pipe->istream, p_ostream, p_errinfo), p_errinfo);
+
+    /* Releases the unseal thread if gta_seal_data stopped reading early */
+    pthread_mutex_lock(&p_pipe->mutex);
+    p_pipe->b_read_done = true;
+    pthread_cond_broadcast(&p_pipe->cond);
+    pthread_mutex_unlock(&p_pipe->mutex);
+    pthread_join(unsealer, NULL);
+
+    if (!b_sealed) {
+        fprintf(stderr, "gta_seal_data failed with ERROR_CODE %ld\n", *p_errinfo);
+        goto cleanup;
+    }
+    /* The output is only valid if the complete plaintext has been sealed */
+    if (p_pipe->b_write_failed) {
+        *p_errinfo = p_pipe->errinfo;
+        fprintf(stderr, "gta_unseal_data failed with ERROR_CODE %ld\n", *p_errinfo);
+        goto cleanup;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    pthread_cond_destroy(&p_pipe->cond);
+    pthread_mutex_destroy(&p_pipe->mutex);
+    gta_memset(p_pipe, sizeof(plain_pipe_t), 0, sizeof(plain_pipe_t));
+    free(p_pipe);
+    return ret;
+}
+
+/*
+ * Directory mode
+ */
+
+typedef struct reseal_dir_job {
+    pthread_mutex_t mutex;
+    char ** pp_names; /* regular files of the input directory */
+    size_t num_names;
+    size_t next;           /* index of the next file to be resealed */
+    size_t num_failed;     /* number of files which could not be resealed */
+    bool b_context_failed; /* a worker could not open its contexts */
+    gta_errinfo_t errinfo; /* errinfo of the first error */
+
+    gta_instance_handle_t h_inst;
+    const char * p_src_pers;
+    const char * p_src_prof;
+    const char * p_dst_pers;
+    const char * p_dst_prof;
+    const char * p_in_dir;
+    const char * p_out_dir;
+    journal_t * p_journal;
+} reseal_dir_job_t;
+
+static char * join_path(const char * p_dir, const char * p_name, const char * p_suffix)
+{
+    size_t len = strlen(p_dir) + 1 + strlen(p_name) + strlen(p_suffix) + 1;
+    char * p_path = malloc(len);
+
+    if (NULL != p_path) {
+        snprintf(p_path, len, "%s/%s%s", p_dir, p_name, p_suffix);
+    }
+    return p_path;
+}
+
+static bool sync_dir(const char * p_dir)
+{
+    int fd = open(p_dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (0 > fd) {
+        return false;
+    }
+    bool b_synced = (0 == fsync(fd));
+    close(fd);
+    return b_synced;
+}
+
+/* Reseals a single file of the directory, the result is renamed into place when it is complete */
+static bool reseal_file(
+    reseal_dir_job_t * p_job,
+    gta_context_handle_t h_src,
+    gta_context_handle_t h_dst,
+    const char * p_name,
+    gta_errinfo_t * p_errinfo)
+{
+    bool b_ret = false;
+    myio_ifilestream_t istream = {0};
+    myio_ofilestream_t ostream = {0};
+    char * p_in = join_path(p_job->p_in_dir, p_name, "");
+    char * p_out = join_path(p_job->p_out_dir, p_name, "");
+    char * p_tmp = join_path(p_job->p_out_dir, p_name, RESEAL_TMP_SUFFIX);
+
+    if ((NULL == p_in) || (NULL == p_out) || (NULL == p_tmp)) {
+        fprintf(stderr, "Memory allocation error\n");
+        goto cleanup;
+    }
+    if ((NULL != p_job->p_journal) && journal_is_complete(p_job->p_journal, p_name, p_out)) {
+        b_ret = true;
+        goto cleanup;
+    }
+    if (!myio_open_ifilestream(&istream, p_in, p_errinfo)) {
+        fprintf(stderr, "Cannot open file %s\n", p_in);
+        goto cleanup;
+    }
+    if (!myio_open_ofilestream(&ostream, p_tmp, p_errinfo)) {
+        fprintf(stderr, "Cannot open file %s\n", p_tmp);
+        goto cleanup;
+    }
+    int result = reseal_stream(h_src, h_dst, (gtaio_istream_t *)&istream, (gtaio_ostream_t *)&ostream, p_errinfo);
+    /* The content must be on disk before the rename makes it visible under the name of the original */
+    bool b_flushed = (0 == fflush(ostream.file)) && (0 == fsync(fileno(ostream.file)));
+    myio_close_ofilestream(&ostream, p_errinfo);
+    if ((EXIT_SUCCESS != result) || !b_flushed) {
+        remove(p_tmp);
+        goto cleanup;
+    }
+    if (0 != rename(p_tmp, p_out)) {
+        fprintf(stderr, "Cannot rename %s to %s\n", p_tmp, p_out);
+        remove(p_tmp);
+        goto cleanup;
+    }
+    /* The rename must be on disk before the file is recorded as complete */
+    if (!sync_dir(p_job->p_out_dir)) {
+        fprintf(stderr, "Cannot sync directory %s\n", p_job->p_out_dir);
+        goto cleanup;
+    }
+    if ((NULL != p_job->p_journal) && (EXIT_SUCCESS != journal_record(p_job->p_journal, p_name, p_out))) {
+        goto cleanup;
+    }
+    b_ret = true;
+
+cleanup:
+    if (NULL != istream.file) {
+        myio_close_ifilestream(&istream, p_errinfo);
+    }
+    if (!b_ret) {
+        fprintf(stderr, "Cannot reseal %s\n", (NULL != p_in) ? p_in : p_name);
+    }
+    free(p_in);
+    free(p_out);
+    free(p_tmp);
+    return b_ret;
+}
+
+static void * dir_worker_main(void * p_arg)
+{
+    reseal_dir_job_t * p_job = p_arg;
+    gta_errinfo_t errinfo = 0;
+    gta_context_handle_t h_src = GTA_HANDLE_INVALID;
+    gta_context_handle_t h_dst = GTA_HANDLE_INVALID;
+
+    h_src = TRACE_PTR(gta_context_open, (p_job->h_inst, p_job->p_src_pers, p_job->p_src_prof, &errinfo), &errinfo);
+    if (GTA_HANDLE_INVALID != h_src) {
+        h_dst =
+            TRACE_PTR(gta_context_open, (p_job->h_inst, p_job->p_dst_pers, p_job->p_dst_prof, &errinfo), &errinfo);
+    }
+    if (GTA_HANDLE_INVALID == h_dst) {
+        pthread_mutex_lock(&p_job->mutex);
+        if (!p_job->b_context_failed) {
+            fprintf(stderr, "gta_context_open failed with ERROR_CODE %ld\n", errinfo);
+            p_job->b_context_failed = true;
+            p_job->errinfo = errinfo;
+        }
+        pthread_mutex_unlock(&p_job->mutex);
+        goto cleanup;
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&p_job->mutex);
+        size_t index = p_job->next;
+        if (index >= p_job->num_names) {
+            pthread_mutex_unlock(&p_job->mutex);
+            break;
+        }
+        ++p_job->next;
+        pthread_mutex_unlock(&p_job->mutex);
+
+        /* A failed file does not stop the others, the files are independent */
+        if (!reseal_file(p_job, h_src, h_dst, p_job->pp_names[index], &errinfo)) {
+            pthread_mutex_lock(&p_job->mutex);
+            if ((0 == p_job->num_failed) && !p_job->b_context_failed) {
+                p_job->errinfo = errinfo;
+            }
+            ++p_job->num_failed;
+            pthread_mutex_unlock(&p_job->mutex);
+        }
+    }
+
+cleanup:
+    if (GTA_HANDLE_INVALID != h_dst) {
+        TRACE_BOOL(gta_context_close, (h_dst, &errinfo), &errinfo);
+    }
+    if (GTA_HANDLE_INVALID != h_src) {
+        TRACE_BOOL(gta_context_close, (h_src, &errinfo), &errinfo);
+    }
+    return NULL;
+}
+
+static bool has_suffix(const char * p_name, const char * p_suffix)
+{
+    size_t name_len = strlen(p_name);
+    size_t suffix_len = strlen(p_suffix);
+    return (name_len >= suffix_len) && (0 == strcmp(&p_name[name_len - suffix_len], p_suffix));
+}
+
+/*
+ * Collects the names of the regular files of the directory. If the output is
+ * written into the same directory, files left over by an interrupted reseal
+ * are skipped.
+ */
+static int list_dir(const char * p_dir, bool b_skip_tmp, char *** ppp_names, size_t * p_num_names)
+{
+    int ret = EXIT_FAILURE;
+    DIR * p_d = opendir(p_dir);
+    struct dirent * p_entry = NULL;
+    char ** pp_names = NULL;
+    size_t num_names = 0;
+    size_t names_size = 0;
+
+    if (NULL == p_d) {
+        fprintf(stderr, "Cannot open directory %s\n", p_dir);
+        return EXIT_FAILURE;
+    }
+    while (NULL != (p_entry = readdir(p_d))) {
+        struct stat st = {0};
+        char * p_path = join_path(p_dir, p_entry->d_name, "");
+        bool b_regular = (NULL != p_path) && (0 == stat(p_path, &st)) && S_ISREG(st.st_mode);
+        free(p_path);
+        if (!b_regular || (b_skip_tmp && has_suffix(p_entry->d_name, RESEAL_TMP_SUFFIX))) {
+            continue;
+        }
+        if (num_names == names_size) {
+            size_t new_size = (0 == names_size) ? 64 : (2 * names_size);
+            char ** pp_new = realloc(pp_names, new_size * sizeof(char *));
+            if (NULL == pp_new) {
+                fprintf(stderr, "Memory allocation error\n");
+                goto cleanup;
+            }
+            pp_names = pp_new;
+            names_size = new_size;
+        }
+        if (NULL == (pp_names[num_names] = strdup(p_entry->d_name))) {
+            fprintf(stderr, "Memory allocation error\n");
+            goto cleanup;
+        }
+        ++num_names;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    closedir(p_d);
+    if (EXIT_SUCCESS != ret) {
+        for (size_t i = 0; i < num_names; ++i) {
+            free(pp_names[i]);
+        }
+        free(pp_names);
+        pp_names = NULL;
+        num_names = 0;
+    }
+    *ppp_names = pp_names;
+    *p_num_names = num_names;
+    return ret;
+}
+
+int reseal_dir(
+    gta_instance_handle_t h_inst,
+    const char * p_src_pers,
+    const char * p_src_prof,
+    const char * p_dst_pers,
+    const char * p_dst_prof,
+    const char * p_in_dir,
+    const char * p_out_dir,
+    unsigned int threads,
+    journal_t * p_journal,
+    gta_errinfo_t * p_errinfo)
+{
+    int ret = EXIT_FAILURE;
+    pthread_t * p_workers = NULL;
+    unsigned int num_workers = 0;
+    reseal_dir_job_t job = {
+        .h_inst = h_inst,
+        .p_src_pers = p_src_pers,
+        .p_src_prof = p_src_prof,
+        .p_dst_pers = p_dst_pers,
+        .p_dst_prof = p_dst_prof,
+        .p_in_dir = p_in_dir,
+        .p_out_dir = p_out_dir,
+        .p_journal = p_journal};
+
+    struct stat in_st = {0};
+    struct stat out_st = {0};
+    bool b_same_dir = (0 == stat(p_in_dir, &in_st)) && (0 == stat(p_out_dir, &out_st)) &&
+                      (in_st.st_dev == out_st.st_dev) && (in_st.st_ino == out_st.st_ino);
+    if (EXIT_SUCCESS != list_dir(p_in_dir, b_same_dir, &job.pp_names, &job.num_names)) {
+        return EXIT_FAILURE;
+    }
+    if (0 == threads) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (1 > cpus) ? 1 : ((RESEAL_MAX_THREADS < cpus) ? RESEAL_MAX_THREADS : (unsigned int)cpus);
+    }
+    /* Each worker holds two contexts, there is no use in more workers than files */
+    if (threads > job.num_names) {
+        threads = (0 == job.num_names) ? 1 : (unsigned int)job.num_names;
+    }
+    p_workers = calloc(threads, sizeof(pthread_t));
+    if (NULL == p_workers) {
+        fprintf(stderr, "Memory allocation error\n");
+        goto cleanup;
+    }
+
+    pthread_mutex_init(&job.mutex, NULL);
+    for (; num_workers < threads; ++num_workers) {
+        if (0 != pthread_create(&p_workers[num_workers], NULL, dir_worker_main, &job)) {
+            break;
+        }
+    }
+    if (0 == num_workers) {
+        fprintf(stderr, "Cannot create thread\n");
+    }
+    for (unsigned int i = 0; i < num_workers; ++i) {
+        pthread_join(p_workers[i], NULL);
+    }
+    pthread_mutex_destroy(&job.mutex);
+
+    /* Files left over if no worker could open its contexts */
+    job.num_failed += job.num_names - job.next;
+    if ((0 != job.num_failed) || job.b_context_failed) {
+        fprintf(stderr, "%zu of %zu files could not be resealed\n", job.num_failed, job.num_names);
+        *p_errinfo = job.errinfo;
+        goto cleanup;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    free(p_workers);
+    for (size_t i = 0; i < job.num_names; ++i) {
+        free(job.pp_names[i]);
+    }
+    free(job.pp_names);
+    return ret;
+}
+
+/*** end of file ***/
@@ -0,0 +1,69 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef GTA_CLI_RESEAL_H
+#define GTA_CLI_RESEAL_H
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+extern "C" {
+/* *INDENT-ON* */
+#endif
+
+/*---------------------------------------------------------------------*/
+
+#include "journal.h"
+#include <gta_api/gta_api.h>
+
+/*
+ * In-process reseal (key rotation). gta_unseal_data with the source context
+ * runs on a helper thread and writes the plaintext into a bounded in-memory
+ * pipe, which is read by gta_seal_data with the target context on the
+ * calling thread. The plaintext is never written to a file.
+ */
+
+/* Size of the in-memory pipe between gta_unseal_data and gta_seal_data */
+#define RESEAL_PIPE_SIZE (256 * 1024)
+
+/* Unseals the data of istream with h_src and seals it with h_dst to ostream */
+int reseal_stream(
+    gta_context_handle_t h_src,
+    gta_context_handle_t h_dst,
+    gtaio_istream_t * p_istream,
+    gtaio_ostream_t * p_ostream,
+    gta_errinfo_t * p_errinfo);
+
+/*
+ * Reseals every regular file of p_in_dir to a file with the same name in
+ * p_out_dir using the given number of worker threads (0: number of online
+ * CPUs). Each worker opens its own source and target contexts. A resealed
+ * file is written to a temporary file and renamed when it is complete.
+ * With a journal (NULL: none) files resealed by a previous run are skipped
+ * and every resealed file is recorded.
+ */
+int reseal_dir(
+    gta_instance_handle_t h_inst,
+    const char * p_src_pers,
+    const char * p_src_prof,
+    const char * p_dst_pers,
+    const char * p_dst_prof,
+    const char * p_in_dir,
+    const char * p_out_dir,
+    unsigned int threads,
+    journal_t * p_journal,
+    gta_errinfo_t * p_errinfo);
+
+/*---------------------------------------------------------------------*/
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+}
+/* *INDENT-ON* */
+#endif
+
+#endif /* GTA_CLI_RESEAL_H */
+
+/*** end of file ***/
@@ -0,0 +1,428 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sealed_log.h"
+
+#include "metrics.h"
+#include "streams.h"
+#include "trace.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <gta_api/util/gta_memset.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/random.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FRAME_HEADER_LEN 8
+/* Run id, sequence number, flags */
+#define BATCH_PREFIX_LEN 17
+#define BATCH_FLAG_LAST 0x01
+/* Upper bound for the length of a sealed batch accepted by the reader */
+#define MAX_FRAME_LEN (1024 * 1024 * 1024)
+
+static void put_u64(char * p_buf, uint64_t value)
+{
+    for (size_t i = 0; i < 8; ++i) {
+        p_buf[i] = (char)((value >> (8 * i)) & 0xff);
+    }
+}
+
+static void put_u32(char * p_buf, uint32_t value)
+{
+    for (size_t i = 0; i < 4; ++i) {
+        p_buf[i] = (char)((value >> (8 * i)) & 0xff);
+    }
+}
+
+static uint64_t get_u64(const char * p_buf)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        value |= (uint64_t)(unsigned char)p_buf[i] << (8 * i);
+    }
+    return value;
+}
+
+static uint32_t get_u32(const char * p_buf)
+{
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        value |= (uint32_t)(unsigned char)p_buf[i] << (8 * i);
+    }
+    return value;
+}
+
+int sealed_log_parse_ms(const char * p_spec, unsigned int * p_flush_ms)
+{
+    char * p_endptr = NULL;
+    unsigned long flush_ms = strtoul(p_spec, &p_endptr, 10);
+
+    if (('\0' == *p_spec) || ('\0' != *p_endptr) || ('-' == p_spec[0]) || (0 == flush_ms) ||
+        (3600000 < flush_ms)) {
+        fprintf(stderr, "Invalid input: '%s' is not a valid flush interval\n", p_spec);
+        return EXIT_FAILURE;
+    }
+    *p_flush_ms = (unsigned int)flush_ms;
+    return EXIT_SUCCESS;
+}
+
+static bool write_full(int fd, const char * p_buf, size_t len)
+{
+    while (0 < len) {
+        ssize_t written = write(fd, p_buf, len);
+        if (0 > written) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return false;
+        }
+        p_buf += written;
+        len -= (size_t)written;
+    }
+    return true;
+}
+
+/* Seals a batch (prefix and data in p_batch) and appends it as frame */
+static bool append_frame(
+    gta_context_handle_t h_ctx,
+    int out_fd,
+    char * p_batch,
+    size_t len,
+    uint64_t run_id,
+    uint64_t seq,
+    bool b_last,
+    ostream_to_dynbuf_t * p_sealed,
+    gta_errinfo_t * p_errinfo)
+{
+    istream_from_buf_t istream = {0};
+    char header[FRAME_HEADER_LEN] = {0};
+
+    put_u64(p_batch, run_id);
+    put_u64(&p_batch[8], seq);
+    p_batch[16] = b_last ? BATCH_FLAG_LAST : 0;
+    istream_from_buf_init(&istream, p_batch, len);
+    p_sealed->buf_pos = 0;
+    if (!TRACE_BOOL(
+            gta_seal_data, (h_ctx, (gtaio_istream_t *)&istream, (gtaio_ostream_t *)p_sealed, p_errinfo), p_errinfo)) {
+        fprintf(stderr, "gta_seal_data failed with ERROR_CODE %ld\n", *p_errinfo);
+        return false;
+    }
+    if (UINT32_MAX < p_sealed->buf_pos) {
+        fprintf(stderr, "Sealed batch too large\n");
+        return false;
+    }
+
+    memcpy(header, SEALED_LOG_FRAME_MAGIC, 4);
+    put_u32(&header[4], (uint32_t)p_sealed->buf_pos);
+    if (!write_full(out_fd, header, sizeof(header)) || !write_full(out_fd, p_sealed->buf, p_sealed->buf_pos)) {
+        fprintf(stderr, "Cannot write frame: %s\n", strerror(errno));
+        return false;
+    }
+    /* Pipes and terminals cannot be synced */
+    if ((0 != fdatasync(out_fd)) && (EINVAL != errno) && (EROFS != errno)) {
+        fprintf(stderr, "Cannot sync frame: %s\n", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+static bool pread_full(int fd, char * p_buf, size_t len, off_t offset)
+{
+    while (0 < len) {
+        ssize_t got = pread(fd, p_buf, len, offset);
+        if (0 > got) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return false;
+        }
+        if (0 == got) {
+            errno = EIO;
+            return false;
+        }
+        p_buf += got;
+        len -= (size_t)got;
+        offset += got;
+    }
+    return true;
+}
+
+/*
+ * If the output is a regular file which already contains frames, e.g. of a
+ * writer which crashed, a torn frame at its end is truncated. Otherwise the
+ * frames of this run would follow the torn frame and could not be read.
+ */
+static bool repair_tail(int out_fd)
+{
+    struct stat st = {0};
+    if ((0 != fstat(out_fd, &st)) || !S_ISREG(st.st_mode) || (0 == st.st_size)) {
+        return true;
+    }
+
+    /* The output is usually opened for writing only */
+    char path[64] = {0};
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", out_fd);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (0 > fd) {
+        fprintf(stderr, "Warning: cannot check the end of the sealed log: %s\n", strerror(errno));
+        return true;
+    }
+
+    bool b_ok = false;
+    off_t offset = 0;
+    char header[FRAME_HEADER_LEN] = {0};
+    while ((off_t)sizeof(header) <= (st.st_size - offset)) {
+        if (!pread_full(fd, header, sizeof(header), offset)) {
+            fprintf(stderr, "Cannot read sealed log: %s\n", strerror(errno));
+            goto cleanup;
+        }
+        if ((0 != memcmp(header, SEALED_LOG_FRAME_MAGIC, 4)) || (MAX_FRAME_LEN < get_u32(&header[4]))) {
+            fprintf(stderr, "Output is not a sealed log\n");
+            goto cleanup;
+        }
+        off_t end = offset + (off_t)sizeof(header) + (off_t)get_u32(&header[4]);
+        if (end > st.st_size) {
+            break;
+        }
+        offset = end;
+    }
+    if (offset < st.st_size) {
+        if ((0 != ftruncate(out_fd, offset)) || (0 > lseek(out_fd, 0, SEEK_END))) {
+            fprintf(stderr, "Cannot truncate torn frame of sealed log: %s\n", strerror(errno));
+            goto cleanup;
+        }
+        fprintf(
+            stderr,
+            "Torn last frame of sealed log truncated (%lld bytes)\n",
+            (long long)(st.st_size - offset));
+    }
+    b_ok = true;
+
+cleanup:
+    close(fd);
+    return b_ok;
+}
+
+int sealed_log_write(
+    gta_context_handle_t h_ctx,
+    int in_fd,
+    int out_fd,
+    unsigned int flush_ms,
+    size_t flush_bytes,
+    gta_errinfo_t * p_errinfo)
+{
+    int ret = EXIT_FAILURE;
+    char * p_batch = malloc(BATCH_PREFIX_LEN + flush_bytes);
+    size_t len = 0;         /* number of data bytes in the batch */
+    uint64_t first_ns = 0;  /* arrival of the first data of the batch */
+    uint64_t seq = 0;
+    uint64_t run_id = 0;
+    bool b_eof = false;
+    ostream_to_dynbuf_t sealed = {0};
+
+    ostream_to_dynbuf_init(&sealed);
+    if (NULL == p_batch) {
+        fprintf(stderr, "Memory allocation error\n");
+        return EXIT_FAILURE;
+    }
+    if (sizeof(run_id) != getrandom(&run_id, sizeof(run_id), 0)) {
+        fprintf(stderr, "Cannot create run id: %s\n", strerror(errno));
+        goto cleanup;
+    }
+    if (!repair_tail(out_fd)) {
+        goto cleanup;
+    }
+
+    while (!b_eof) {
+        /* Wait for data, at most until the batch is due */
+        int timeout_ms = -1;
+        if (0 != len) {
+            uint64_t elapsed_ms = (metrics_now_ns() - first_ns) / 1000000;
+            timeout_ms = (elapsed_ms >= flush_ms) ? 0 : (int)(flush_ms - elapsed_ms);
+        }
+        struct pollfd pfd = {.fd = in_fd, .events = POLLIN};
+        int ready = poll(&pfd, 1, timeout_ms);
+        if ((0 > ready) && (EINTR != errno)) {
+            fprintf(stderr, "Cannot read input: %s\n", strerror(errno));
+            goto cleanup;
+        }
+
+        if (0 < ready) {
+            ssize_t got = read(in_fd, &p_batch[BATCH_PREFIX_LEN + len], flush_bytes - len);
+            if (0 > got) {
+                if (EINTR != errno) {
+                    fprintf(stderr, "Cannot read input: %s\n", strerror(errno));
+                    goto cleanup;
+                }
+            } else if (0 == got) {
+                b_eof = true;
+            } else {
+                if (0 == len) {
+                    first_ns = metrics_now_ns();
+                }
+                len += (size_t)got;
+            }
+        }
+
+        bool b_due = (0 != len) && (((metrics_now_ns() - first_ns) / 1000000) >= flush_ms);
+        /* At the end of the input, a run with frames is closed by a last frame, even if it has no data */
+        bool b_last = b_eof && ((0 != len) || (0 != seq));
+        if (b_last || ((0 != len) && (b_due || (flush_bytes == len)))) {
+            if (!append_frame(
+                    h_ctx, out_fd, p_batch, BATCH_PREFIX_LEN + len, run_id, seq, b_last, &sealed, p_errinfo)) {
+                goto cleanup;
+            }
+            gta_memset(p_batch, BATCH_PREFIX_LEN + len, 0, BATCH_PREFIX_LEN + len);
+            ++seq;
+            len = 0;
+        }
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    gta_memset(p_batch, BATCH_PREFIX_LEN + flush_bytes, 0, BATCH_PREFIX_LEN + flush_bytes);
+    free(p_batch);
+    ostream_to_dynbuf_free(&sealed);
+    return ret;
+}
+
+/* Reads until len bytes are read or the end of data is reached */
+static size_t read_full(gtaio_istream_t * p_istream, char * p_buf, size_t len, gta_errinfo_t * p_errinfo)
+{
+    size_t total = 0;
+    while ((total < len) && !p_istream->eof(p_istream, p_errinfo)) {
+        size_t read = p_istream->read(p_istream, &p_buf[total], len - total, p_errinfo);
+        if (0 == read) {
+            break;
+        }
+        total += read;
+    }
+    return total;
+}
+
+int sealed_log_read(
+    gta_context_handle_t h_ctx,
+    gtaio_istream_t * p_istream,
+    gtaio_ostream_t * p_ostream,
+    gta_errinfo_t * p_errinfo)
+{
+    int ret = EXIT_FAILURE;
+    char header[FRAME_HEADER_LEN] = {0};
+    char * p_frame = NULL;
+    size_t frame_size = 0;
+    uint64_t expected_seq = 0;
+    uint64_t run_id = 0;
+    bool b_run_open = false; /* a run has been started and its last frame not yet read */
+    uint64_t * p_run_ids = NULL; /* ids of all runs read */
+    size_t num_runs = 0;
+    ostream_to_dynbuf_t unsealed = {0};
+    istream_from_buf_t istream = {0};
+
+    ostream_to_dynbuf_init(&unsealed);
+    for (;;) {
+        size_t got = read_full(p_istream, header, sizeof(header), p_errinfo);
+        if (0 == got) {
+            break;
+        }
+        if ((sizeof(header) != got) || (0 != memcmp(header, SEALED_LOG_FRAME_MAGIC, 4)) ||
+            (MAX_FRAME_LEN < get_u32(&header[4]))) {
+            if (sizeof(header) != got) {
+                /* a frame torn by a crash of the writer */
+                fprintf(stderr, "Incomplete last frame ignored\n");
+                break;
+            }
+            fprintf(stderr, "Invalid frame in sealed log\n");
+            goto cleanup;
+        }
+
+        size_t len = get_u32(&header[4]);
+        if (len > frame_size) {
+            char * p_new = realloc(p_frame, len);
+            if (NULL == p_new) {
+                fprintf(stderr, "Memory allocation error\n");
+                goto cleanup;
+            }
+            p_frame = p_new;
+            frame_size = len;
+        }
+        if (len != read_full(p_istream, p_frame, len, p_errinfo)) {
+            fprintf(stderr, "Incomplete last frame ignored\n");
+            break;
+        }
+
+        istream_from_buf_init(&istream, p_frame, len);
+        unsealed.buf_pos = 0;
+        if (!TRACE_BOOL(
+                gta_unseal_data,
+                (h_ctx, (gtaio_istream_t *)&istream, (gtaio_ostream_t *)&unsealed, p_errinfo),
+                p_errinfo)) {
+            fprintf(stderr, "gta_unseal_data failed with ERROR_CODE %ld\n", *p_errinfo);
+            goto cleanup;
+        }
+
+        if (BATCH_PREFIX_LEN > unsealed.buf_pos) {
+            fprintf(stderr, "Sealed log is corrupted: invalid batch\n");
+            goto cleanup;
+        }
+        uint64_t frame_run_id = get_u64(unsealed.buf);
+        uint64_t seq = get_u64(&unsealed.buf[8]);
+        bool b_new_run = (0 == num_runs) || (frame_run_id != run_id);
+        if (b_new_run) {
+            /* Batches are numbered per run of the writer, a run starts with 0 and its id is not used again */
+            bool b_seen = false;
+            for (size_t i = 0; i < num_runs; ++i) {
+                b_seen = b_seen || (p_run_ids[i] == frame_run_id);
+            }
+            if ((0 != seq) || b_seen) {
+                fprintf(stderr, "Sealed log is corrupted: frame %llu out of order\n", (unsigned long long)seq);
+                goto cleanup;
+            }
+            if (b_run_open) {
+                fprintf(stderr, "Sealed log: a run ended without its last frame (writer crashed or frames dropped)\n");
+            }
+            uint64_t * p_new = realloc(p_run_ids, (num_runs + 1) * sizeof(uint64_t));
+            if (NULL == p_new) {
+                fprintf(stderr, "Memory allocation error\n");
+                goto cleanup;
+            }
+            p_run_ids = p_new;
+            p_run_ids[num_runs++] = frame_run_id;
+            run_id = frame_run_id;
+        } else if (!b_run_open || (seq != expected_seq)) {
+            fprintf(stderr, "Sealed log is corrupted: frame %llu out of order\n", (unsigned long long)seq);
+            goto cleanup;
+        }
+        expected_seq = seq + 1;
+        b_run_open = (0 == (BATCH_FLAG_LAST & unsealed.buf[16]));
+
+        size_t data_len = unsealed.buf_pos - BATCH_PREFIX_LEN;
+        if ((0 != data_len) &&
+            (data_len != p_ostream->write(p_ostream, &unsealed.buf[BATCH_PREFIX_LEN], data_len, p_errinfo))) {
+            goto cleanup;
+        }
+    }
+    if (b_run_open) {
+        fprintf(stderr, "Sealed log: the last run ended without its last frame (writer crashed or frames dropped)\n");
+    }
+    if (!p_ostream->finish(p_ostream, 0, p_errinfo)) {
+        goto cleanup;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    free(p_run_ids);
+    free(p_frame);
+    ostream_to_dynbuf_free(&unsealed);
+    return ret;
+}
+
+/*** end of file ***/
@@ -0,0 +1,72 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef GTA_CLI_SEALED_LOG_H
+#define GTA_CLI_SEALED_LOG_H
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+extern "C" {
+/* *INDENT-ON* */
+#endif
+
+/*---------------------------------------------------------------------*/
+
+#include <gta_api/gta_api.h>
+#include <stddef.h>
+
+/*
+ * Sealed append-only log. The data read continuously from a file
+ * descriptor is grouped into micro-batches, which are flushed after a time
+ * or when a size is reached. Each batch is sealed and appended as frame:
+ *
+ *   magic "GTLF", u32 length of the sealed batch (little-endian), sealed batch
+ *
+ * The plaintext of a batch starts with a prefix (little-endian): the random
+ * run id of the invocation of the writer (u64), the sequence number of the
+ * batch in the run (u64, starting with 0) and flags (u8) marking the last
+ * batch of a run. The reader requires sequence number 0 exactly when the run
+ * id changes and rejects run ids seen before, so frames cannot be reordered,
+ * replayed or inserted; a run without its last batch (crash of the writer
+ * or dropped frames) is reported. Every frame is synced to disk before the
+ * next batch is collected, so a crash loses at most the batch being
+ * collected. The concatenated batches yield the original data.
+ */
+
+#define SEALED_LOG_FRAME_MAGIC "GTLF"
+#define SEALED_LOG_DEFAULT_FLUSH_MS 100
+#define SEALED_LOG_DEFAULT_FLUSH_BYTES (64 * 1024)
+
+/* Parses the flush interval in milliseconds */
+int sealed_log_parse_ms(const char * p_spec, unsigned int * p_flush_ms);
+
+/* Reads in_fd until its end, seals the batches and appends the frames to out_fd */
+int sealed_log_write(
+    gta_context_handle_t h_ctx,
+    int in_fd,
+    int out_fd,
+    unsigned int flush_ms,
+    size_t flush_bytes,
+    gta_errinfo_t * p_errinfo);
+
+/* Reads the frames of a sealed log and writes the unsealed data to ostream */
+int sealed_log_read(
+    gta_context_handle_t h_ctx,
+    gtaio_istream_t * p_istream,
+    gtaio_ostream_t * p_ostream,
+    gta_errinfo_t * p_errinfo);
+
+/*---------------------------------------------------------------------*/
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+}
+/* *INDENT-ON* */
+#endif
+
+#endif /* GTA_CLI_SEALED_LOG_H */
+
+/*** end of file ***/
@@ -0,0 +1,428 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define _GNU_SOURCE
+
+#include "statedir.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Buffer size for copying and comparing files */
+#define STATEDIR_COPY_BUF_SIZE 65536
+/* Maximum interval between two attempts to acquire the lock */
+#define STATEDIR_LOCK_POLL_MAX_MS 100
+
+int statedir_parse_mode(const char * p_spec, enum statedir_mode * p_mode)
+{
+    if (0 == strcmp(p_spec, "direct")) {
+        *p_mode = STATEDIR_MODE_DIRECT;
+    } else if (0 == strcmp(p_spec, "tmpfs")) {
+        *p_mode = STATEDIR_MODE_TMPFS;
+    } else {
+        fprintf(stderr, "Invalid state mode: %s\n", p_spec);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+static bool join_path(char * p_dst, const char * p_dir, const char * p_name)
+{
+    int len = snprintf(p_dst, PATH_MAX, "%s/%s", p_dir, p_name);
+    return (0 < len) && (PATH_MAX > len);
+}
+
+static bool write_all(int fd, const char * p_buf, size_t len)
+{
+    while (0 < len) {
+        ssize_t written = write(fd, p_buf, len);
+        if (0 > written) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return false;
+        }
+        p_buf += written;
+        len -= (size_t)written;
+    }
+    return true;
+}
+
+/*
+ * Copies a regular file. With b_durable, the file is written to a unique
+ * temporary file which is synced and renamed over the destination, so the
+ * destination contains either the old or the new content after a power loss.
+ */
+static int copy_file(const char * p_src, const char * p_dst, mode_t mode, bool b_durable)
+{
+    int ret = EXIT_FAILURE;
+    char tmp_path[PATH_MAX] = {0};
+    char * p_buf = NULL;
+    int fd_src = -1;
+    int fd_dst = -1;
+    bool b_tmp_created = false;
+
+    if (b_durable) {
+        int len = snprintf(tmp_path, sizeof(tmp_path), "%s.gta-cli-tmp-XXXXXX", p_dst);
+        if ((0 > len) || ((int)sizeof(tmp_path) <= len)) {
+            return EXIT_FAILURE;
+        }
+        fd_dst = mkostemp(tmp_path, O_CLOEXEC);
+        b_tmp_created = (0 <= fd_dst);
+        if (!b_tmp_created || (0 != fchmod(fd_dst, mode & 0777))) {
+            goto cleanup;
+        }
+    } else {
+        fd_dst = open(p_dst, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, mode & 0777);
+    }
+
+    p_buf = malloc(STATEDIR_COPY_BUF_SIZE);
+    fd_src = open(p_src, O_RDONLY | O_CLOEXEC);
+    if ((NULL == p_buf) || (0 > fd_src) || (0 > fd_dst)) {
+        goto cleanup;
+    }
+
+    for (;;) {
+        ssize_t len = read(fd_src, p_buf, STATEDIR_COPY_BUF_SIZE);
+        if (0 > len) {
+            if (EINTR == errno) {
+                continue;
+            }
+            goto cleanup;
+        }
+        if (0 == len) {
+            break;
+        }
+        if (!write_all(fd_dst, p_buf, (size_t)len)) {
+            goto cleanup;
+        }
+    }
+
+    if (b_durable) {
+        if (0 != fsync(fd_dst)) {
+            goto cleanup;
+        }
+        close(fd_dst);
+        fd_dst = -1;
+        if (0 != rename(tmp_path, p_dst)) {
+            goto cleanup;
+        }
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    if (0 <= fd_dst) {
+        close(fd_dst);
+    }
+    if (0 <= fd_src) {
+        close(fd_src);
+    }
+    if ((EXIT_SUCCESS != ret) && b_tmp_created) {
+        unlink(tmp_path);
+    }
+    free(p_buf);
+    if (EXIT_SUCCESS != ret) {
+        fprintf(stderr, "Cannot copy %s to %s\n", p_src, p_dst);
+    }
+    return ret;
+}
+
+/* Returns true if both files exist and have the same content */
+static bool files_equal(const char * p_a, const char * p_b)
+{
+    bool ret = false;
+    struct stat st_a = {0};
+    struct stat st_b = {0};
+    char * p_buf_a = NULL;
+    char * p_buf_b = NULL;
+    int fd_a = -1;
+    int fd_b = -1;
+
+    if ((0 != stat(p_a, &st_a)) || (0 != stat(p_b, &st_b)) || (st_a.st_size != st_b.st_size)) {
+        return false;
+    }
+
+    p_buf_a = malloc(STATEDIR_COPY_BUF_SIZE);
+    p_buf_b = malloc(STATEDIR_COPY_BUF_SIZE);
+    fd_a = open(p_a, O_RDONLY | O_CLOEXEC);
+    fd_b = open(p_b, O_RDONLY | O_CLOEXEC);
+    if ((NULL == p_buf_a) || (NULL == p_buf_b) || (0 > fd_a) || (0 > fd_b)) {
+        goto cleanup;
+    }
+
+    for (;;) {
+        ssize_t len_a = read(fd_a, p_buf_a, STATEDIR_COPY_BUF_SIZE);
+        if (0 > len_a) {
+            goto cleanup;
+        }
+        if (0 == len_a) {
+            ret = true;
+            break;
+        }
+        /* Files in the state directory are small, a short read of the second file means a difference */
+        ssize_t len_b = read(fd_b, p_buf_b, (size_t)len_a);
+        if ((len_a != len_b) || (0 != memcmp(p_buf_a, p_buf_b, (size_t)len_a))) {
+            break;
+        }
+    }
+
+cleanup:
+    if (0 <= fd_a) {
+        close(fd_a);
+    }
+    if (0 <= fd_b) {
+        close(fd_b);
+    }
+    free(p_buf_a);
+    free(p_buf_b);
+    return ret;
+}
+
+static bool is_dot_entry(const char * p_name)
+{
+    return (0 == strcmp(p_name, ".")) || (0 == strcmp(p_name, ".."));
+}
+
+static void sync_dir(const char * p_path)
+{
+    int fd = open(p_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (0 <= fd) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+/* Removes a directory tree, errors are ignored */
+static void remove_tree(const char * p_path)
+{
+    DIR * p_dir = opendir(p_path);
+    struct dirent * p_entry = NULL;
+    char child[PATH_MAX] = {0};
+
+    if (NULL == p_dir) {
+        unlink(p_path);
+        return;
+    }
+    while (NULL != (p_entry = readdir(p_dir))) {
+        if (!is_dot_entry(p_entry->d_name) && join_path(child, p_path, p_entry->d_name)) {
+            remove_tree(child);
+        }
+    }
+    closedir(p_dir);
+    rmdir(p_path);
+}
+
+/*
+ * Copies the directory tree p_src into p_dst. With b_durable only changed
+ * files are copied (durably), and entries of p_dst which do not exist in
+ * p_src are removed.
+ */
+static int copy_tree(const char * p_src, const char * p_dst, bool b_durable)
+{
+    int ret = EXIT_SUCCESS;
+    DIR * p_dir = NULL;
+    struct dirent * p_entry = NULL;
+    struct stat st = {0};
+    char src_child[PATH_MAX] = {0};
+    char dst_child[PATH_MAX] = {0};
+    bool b_changed = false;
+
+    p_dir = opendir(p_src);
+    if (NULL == p_dir) {
+        fprintf(stderr, "Cannot open directory %s\n", p_src);
+        return EXIT_FAILURE;
+    }
+    while ((EXIT_SUCCESS == ret) && (NULL != (p_entry = readdir(p_dir)))) {
+        if (is_dot_entry(p_entry->d_name)) {
+            continue;
+        }
+        if (!join_path(src_child, p_src, p_entry->d_name) || !join_path(dst_child, p_dst, p_entry->d_name) ||
+            (0 != lstat(src_child, &st))) {
+            ret = EXIT_FAILURE;
+        } else if (S_ISDIR(st.st_mode)) {
+            if ((0 != mkdir(dst_child, st.st_mode & 0777)) && (EEXIST != errno)) {
+                fprintf(stderr, "Cannot create directory %s\n", dst_child);
+                ret = EXIT_FAILURE;
+            } else {
+                ret = copy_tree(src_child, dst_child, b_durable);
+            }
+        } else if (S_ISREG(st.st_mode)) {
+            if (!b_durable || !files_equal(src_child, dst_child)) {
+                ret = copy_file(src_child, dst_child, st.st_mode, b_durable);
+                b_changed = true;
+            }
+        }
+    }
+    closedir(p_dir);
+
+    if ((EXIT_SUCCESS == ret) && b_durable) {
+        /* Remove what the provider has removed from its copy */
+        p_dir = opendir(p_dst);
+        while ((NULL != p_dir) && (NULL != (p_entry = readdir(p_dir)))) {
+            if (!is_dot_entry(p_entry->d_name) && join_path(src_child, p_src, p_entry->d_name) &&
+                join_path(dst_child, p_dst, p_entry->d_name) && (0 != lstat(src_child, &st)) && (ENOENT == errno)) {
+                remove_tree(dst_child);
+                b_changed = true;
+            }
+        }
+        if (NULL != p_dir) {
+            closedir(p_dir);
+        }
+        /* Make the renames and removals durable */
+        if (b_changed) {
+            sync_dir(p_dst);
+        }
+    }
+
+    return ret;
+}
+
+static bool is_empty_dir(const char * p_path)
+{
+    bool ret = true;
+    struct dirent * p_entry = NULL;
+    DIR * p_dir = opendir(p_path);
+
+    if (NULL == p_dir) {
+        return false;
+    }
+    while (ret && (NULL != (p_entry = readdir(p_dir)))) {
+        ret = is_dot_entry(p_entry->d_name);
+    }
+    closedir(p_dir);
+    return ret;
+}
+
+/* Acquires the lock, polling with increasing interval if it is held by another process */
+static int acquire_lock(int fd, int operation, long timeout_ms)
+{
+    long waited_ms = 0;
+    long interval_ms = 1;
+
+    if (STATEDIR_LOCK_WAIT_FOREVER == timeout_ms) {
+        while (0 != flock(fd, operation)) {
+            if (EINTR != errno) {
+                return EXIT_FAILURE;
+            }
+        }
+        return EXIT_SUCCESS;
+    }
+
+    while (0 != flock(fd, operation | LOCK_NB)) {
+        if ((EWOULDBLOCK != errno) && (EINTR != errno)) {
+            return EXIT_FAILURE;
+        }
+        if (waited_ms >= timeout_ms) {
+            errno = EWOULDBLOCK;
+            return EXIT_FAILURE;
+        }
+        if (interval_ms > timeout_ms - waited_ms) {
+            interval_ms = timeout_ms - waited_ms;
+        }
+        struct timespec ts = {.tv_sec = interval_ms / 1000, .tv_nsec = (interval_ms % 1000) * 1000000};
+        nanosleep(&ts, NULL);
+        waited_ms += interval_ms;
+        interval_ms = (2 * interval_ms > STATEDIR_LOCK_POLL_MAX_MS) ? STATEDIR_LOCK_POLL_MAX_MS : 2 * interval_ms;
+    }
+    return EXIT_SUCCESS;
+}
+
+int statedir_open(
+    statedir_t * p_statedir,
+    const char * p_path,
+    enum statedir_mode mode,
+    bool b_exclusive,
+    long timeout_ms)
+{
+    p_statedir->mode = mode;
+    p_statedir->p_path = p_path;
+    p_statedir->work_path[0] = '\0';
+    p_statedir->lock_fd = -1;
+    p_statedir->b_exclusive = false;
+
+    /* flock() on the directory itself, so no lock file is visible to the provider */
+    p_statedir->lock_fd = open(p_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (0 > p_statedir->lock_fd) {
+        fprintf(stderr, "Cannot open state directory %s\n", p_path);
+        return EXIT_FAILURE;
+    }
+    if (!b_exclusive && is_empty_dir(p_path)) {
+        b_exclusive = true;
+    }
+    if (EXIT_SUCCESS != acquire_lock(p_statedir->lock_fd, b_exclusive ? LOCK_EX : LOCK_SH, timeout_ms)) {
+        if (EWOULDBLOCK == errno) {
+            fprintf(stderr, "Timeout while waiting for the lock of state directory %s\n", p_path);
+        } else {
+            fprintf(stderr, "Cannot lock state directory %s\n", p_path);
+        }
+        goto err;
+    }
+    p_statedir->b_exclusive = b_exclusive;
+
+    if (STATEDIR_MODE_DIRECT == mode) {
+        return EXIT_SUCCESS;
+    }
+
+    snprintf(p_statedir->work_path, sizeof(p_statedir->work_path), "%s/gta-cli-state-XXXXXX", STATEDIR_TMPFS_BASE);
+    if (NULL == mkdtemp(p_statedir->work_path)) {
+        fprintf(stderr, "Cannot create memory-backed state directory in %s\n", STATEDIR_TMPFS_BASE);
+        p_statedir->work_path[0] = '\0';
+        goto err;
+    }
+    if (EXIT_SUCCESS != copy_tree(p_path, p_statedir->work_path, false)) {
+        goto err;
+    }
+
+    return EXIT_SUCCESS;
+
+err:
+    if ('\0' != p_statedir->work_path[0]) {
+        remove_tree(p_statedir->work_path);
+        p_statedir->work_path[0] = '\0';
+    }
+    close(p_statedir->lock_fd);
+    p_statedir->lock_fd = -1;
+    return EXIT_FAILURE;
+}
+
+const char * statedir_work_path(const statedir_t * p_statedir)
+{
+    return ('\0' != p_statedir->work_path[0]) ? p_statedir->work_path : p_statedir->p_path;
+}
+
+int statedir_close(statedir_t * p_statedir)
+{
+    int ret = EXIT_SUCCESS;
+
+    if ('\0' != p_statedir->work_path[0]) {
+        /* Readers share the lock and must not write, their copy is discarded */
+        if (p_statedir->b_exclusive) {
+            ret = copy_tree(p_statedir->work_path, p_statedir->p_path, true);
+            if (EXIT_SUCCESS != ret) {
+                fprintf(stderr, "Writing back the state directory %s failed\n", p_statedir->p_path);
+            }
+        }
+        remove_tree(p_statedir->work_path);
+        p_statedir->work_path[0] = '\0';
+    }
+    if (0 <= p_statedir->lock_fd) {
+        /* Closing the descriptor releases the lock */
+        close(p_statedir->lock_fd);
+        p_statedir->lock_fd = -1;
+    }
+
+    return ret;
+}
+
+/*** end of file ***/
@@ -0,0 +1,84 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef GTA_CLI_STATEDIR_H
+#define GTA_CLI_STATEDIR_H
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+extern "C" {
+/* *INDENT-ON* */
+#endif
+
+/*---------------------------------------------------------------------*/
+
+#include <limits.h>
+#include <stdbool.h>
+
+/*
+ * Access to the state directory of the provider. The state directory is
+ * locked with flock() for the whole invocation (by watch for each batch):
+ * functions which only read the state take a shared lock, all others an
+ * exclusive lock. In tmpfs mode the state directory is copied to a
+ * memory-backed directory before the GTA instance is created. When the
+ * invocation ends, changed files are written back with write-to-temporary,
+ * fsync and rename, files removed by the provider are removed, and the copy
+ * is deleted. Only invocations holding the exclusive lock write back, the
+ * copy of a reader is discarded.
+ */
+
+/* Base directory for memory-backed copies of the state directory */
+#define STATEDIR_TMPFS_BASE "/dev/shm"
+
+/* Lock timeout to wait without limit */
+#define STATEDIR_LOCK_WAIT_FOREVER (-1)
+
+enum statedir_mode {
+    STATEDIR_MODE_DIRECT, /* provider works on the state directory itself */
+    STATEDIR_MODE_TMPFS,  /* provider works on a memory-backed copy */
+};
+
+typedef struct statedir {
+    enum statedir_mode mode;
+    const char * p_path;      /* persistent state directory */
+    char work_path[PATH_MAX]; /* memory-backed copy, empty if not used */
+    int lock_fd;              /* file descriptor holding the lock, -1 if not locked */
+    bool b_exclusive;         /* the lock is exclusive, changes are written back */
+} statedir_t;
+
+/* Parses "direct" or "tmpfs" */
+int statedir_parse_mode(const char * p_spec, enum statedir_mode * p_mode);
+
+/*
+ * Locks the state directory and prepares the directory to be used by the
+ * provider. A shared lock is escalated to an exclusive lock if the state
+ * directory is empty, as the provider creates its initial state. Fails if the
+ * lock cannot be acquired within timeout_ms milliseconds.
+ */
+int statedir_open(
+    statedir_t * p_statedir,
+    const char * p_path,
+    enum statedir_mode mode,
+    bool b_exclusive,
+    long timeout_ms);
+
+/* Returns the directory to be used by the provider */
+const char * statedir_work_path(const statedir_t * p_statedir);
+
+/* Writes changes back to the state directory (tmpfs mode) and releases the lock */
+int statedir_close(statedir_t * p_statedir);
+
+/*---------------------------------------------------------------------*/
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+}
+/* *INDENT-ON* */
+#endif
+
+#endif /* GTA_CLI_STATEDIR_H */
+
+/*** end of file ***/
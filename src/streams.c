@@ -1,19 +1,28 @@
 /*
- * SPDX-FileCopyrightText: Copyright 2025 Siemens
+ * SPDX-FileCopyrightText: Copyright 2025-2026 Siemens
  *
  * SPDX-License-Identifier: Apache-2.0
  */
 
 #include "streams.h"
 
+#include "metrics.h"
+#include "trace.h"
+
 #include <gta_api/gta_api.h>
 #include <gta_api/util/gta_memset.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+/* Initial allocation size of ostream_to_dynbuf */
+#define DYNBUF_INITIAL_SIZE 1024
+/* The progress meter is shown after this time and updated in this interval */
+#define PROGRESS_INTERVAL_NS 500000000u
+
 /*
  * myio_ifilestream reference implementation
  */
@@ -30,7 +39,10 @@ GTA_DEFINE_FUNCTION(
     myio_ifilestream_read,
     (myio_ifilestream_t * istream, char * data, size_t len, gta_errinfo_t * p_errinfo))
 {
-    return fread(data, sizeof(char), len, istream->file);
+    trace_io_begin("myio_ifilestream_read");
+    size_t read = fread(data, sizeof(char), len, istream->file);
+    trace_span_end_io("myio_ifilestream_read", read);
+    return read;
 }
 
 GTA_DEFINE_FUNCTION(bool, myio_ifilestream_eof, (myio_ifilestream_t * istream, gta_errinfo_t * p_errinfo))
@@ -81,7 +93,10 @@ GTA_DEFINE_FUNCTION(
     myio_ofilestream_write,
     (myio_ofilestream_t * ostream, char * data, size_t len, gta_errinfo_t * p_errinfo))
 {
-    return fwrite(data, sizeof(char), len, ostream->file);
+    trace_io_begin("myio_ofilestream_write");
+    size_t written = fwrite(data, sizeof(char), len, ostream->file);
+    trace_span_end_io("myio_ofilestream_write", written);
+    return written;
 }
 
 GTA_DEFINE_FUNCTION(
@@ -123,6 +138,7 @@ GTA_DEFINE_FUNCTION(
 /* gtaio_istream implementation to read from a temporary buffer */
 size_t istream_from_buf_read(istream_from_buf_t * istream, char * data, size_t len, gta_errinfo_t * p_errinfo)
 {
+    trace_io_begin("istream_from_buf_read");
     /* Check how many bytes are still available in data buffer */
     size_t bytes_available = istream->buf_size - istream->buf_pos;
     if (bytes_available < len) {
@@ -134,6 +150,7 @@ size_t istream_from_buf_read(istream_from_buf_t * istream, char * data, size_t l
     memcpy(data, &(istream->buf[istream->buf_pos]), len);
     /* Set new position in data buffer */
     istream->buf_pos += len;
+    trace_span_end_io("istream_from_buf_read", len);
 
     /* Return number of read bytes */
     return len;
@@ -159,6 +176,7 @@ bool ostream_finish(gtaio_ostream_t * ostream, gta_errinfo_t errinfo, gta_errinf
 /* gtaio_ostream implementation to write the output to a temporary buffer */
 size_t ostream_to_buf_write(ostream_to_buf_t * ostream, const char * data, size_t len, gta_errinfo_t * p_errinfo)
 {
+    trace_io_begin("ostream_to_buf_write");
     /* Check how many bytes are still available in data buffer */
     size_t bytes_available = ostream->buf_size - ostream->buf_pos;
     if (bytes_available < len) {
@@ -169,6 +187,7 @@ size_t ostream_to_buf_write(ostream_to_buf_t * ostream, const char * data, size_
     memcpy(&(ostream->buf[ostream->buf_pos]), data, len);
     /* Set new position in data buffer */
     ostream->buf_pos += len;
+    trace_span_end_io("ostream_to_buf_write", len);
 
     /* Return number of written bytes */
     return len;
@@ -184,4 +203,395 @@ void ostream_to_buf_init(ostream_to_buf_t * ostream, char * buf, size_t buf_size
     memset(buf, 0x00, buf_size);
 }
 
+/* gtaio_ostream implementation to write the output to a dynamically growing buffer */
+size_t ostream_to_dynbuf_write(ostream_to_dynbuf_t * ostream, const char * data, size_t len, gta_errinfo_t * p_errinfo)
+{
+    trace_io_begin("ostream_to_dynbuf_write");
+    if (len > (ostream->buf_size - ostream->buf_pos)) {
+        /* Grow the buffer at least by factor two to keep the number of reallocations low */
+        size_t new_size = (0 == ostream->buf_size) ? DYNBUF_INITIAL_SIZE : ostream->buf_size;
+        while (new_size - ostream->buf_pos < len) {
+            new_size *= 2;
+        }
+        char * new_buf = realloc(ostream->buf, new_size);
+        if (NULL == new_buf) {
+            *p_errinfo = GTA_ERROR_MEMORY;
+            trace_span_end_io("ostream_to_dynbuf_write", 0);
+            return 0;
+        }
+        ostream->buf = new_buf;
+        ostream->buf_size = new_size;
+    }
+    /* Copy the bytes to the buffer */
+    memcpy(&(ostream->buf[ostream->buf_pos]), data, len);
+    /* Set new position in data buffer */
+    ostream->buf_pos += len;
+    trace_span_end_io("ostream_to_dynbuf_write", len);
+
+    /* Return number of written bytes */
+    return len;
+}
+
+void ostream_to_dynbuf_init(ostream_to_dynbuf_t * ostream)
+{
+    ostream->write = (gtaio_stream_write_t)ostream_to_dynbuf_write;
+    ostream->finish = ostream_finish;
+    ostream->buf = NULL;
+    ostream->buf_size = 0;
+    ostream->buf_pos = 0;
+}
+
+int read_istream_to_dynbuf(gtaio_istream_t * istream, ostream_to_dynbuf_t * ostream)
+{
+    int ret = EXIT_FAILURE;
+    gta_errinfo_t errinfo = 0;
+    char buf[4096];
+
+    while (!istream->eof(istream, &errinfo)) {
+        size_t len = istream->read(istream, buf, sizeof(buf), &errinfo);
+        /* A stream which returns no data before its end has failed (e.g. fread of a directory) */
+        if ((0 != errinfo) || ((0 == len) && !istream->eof(istream, &errinfo))) {
+            fprintf(stderr, "Cannot read input\n");
+            goto cleanup;
+        }
+        if ((0 < len) && (len != ostream_to_dynbuf_write(ostream, buf, len, &errinfo))) {
+            fprintf(stderr, "Memory allocation error\n");
+            goto cleanup;
+        }
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    /* the buffer may contain unsealed data */
+    gta_memset(buf, sizeof(buf), 0, sizeof(buf));
+    return ret;
+}
+
+void ostream_to_dynbuf_free(ostream_to_dynbuf_t * ostream)
+{
+    if (NULL != ostream->buf) {
+        /* the buffer may contain unsealed data */
+        gta_memset(ostream->buf, ostream->buf_size, 0, ostream->buf_size);
+        free(ostream->buf);
+    }
+    ostream->buf = NULL;
+    ostream->buf_size = 0;
+    ostream->buf_pos = 0;
+}
+
+/*
+ * io_stats
+ */
+
+static uint64_t io_stats_begin(io_stats_t * p_stats)
+{
+    uint64_t now_ns = metrics_now_ns();
+    if (0 == p_stats->first_ns) {
+        p_stats->first_ns = now_ns;
+        p_stats->progress_ns = now_ns;
+    }
+    return now_ns;
+}
+
+static void io_stats_end(io_stats_t * p_stats, uint64_t begin_ns)
+{
+    p_stats->last_ns = metrics_now_ns();
+    p_stats->inside_ns += p_stats->last_ns - begin_ns;
+
+    if ((NULL != p_stats->p_progress) && (PROGRESS_INTERVAL_NS <= p_stats->last_ns - p_stats->progress_ns)) {
+        double elapsed_s = (double)(p_stats->last_ns - p_stats->first_ns) / 1e9;
+        fprintf(
+            stderr,
+            "\r%s: %.1f MiB, %.1f MiB/s ",
+            p_stats->p_progress,
+            (double)p_stats->bytes / (1024.0 * 1024.0),
+            (double)p_stats->bytes / (1024.0 * 1024.0) / elapsed_s);
+        p_stats->progress_ns = p_stats->last_ns;
+    }
+}
+
+static void io_stats_count(io_stats_t * p_stats, size_t len)
+{
+    size_t bucket = 0;
+    for (size_t rest = len; (0 < rest) && (IO_STATS_HIST_BUCKETS - 1 > bucket); rest >>= 1) {
+        ++bucket;
+    }
+    p_stats->bytes += len;
+    p_stats->calls++;
+    p_stats->hist[bucket]++;
+}
+
+void io_stats_print(const char * p_name, const io_stats_t * p_stats)
+{
+    uint64_t span_ns = p_stats->last_ns - p_stats->first_ns;
+    uint64_t outside_ns = (span_ns > p_stats->inside_ns) ? span_ns - p_stats->inside_ns : 0;
+
+    if ((NULL != p_stats->p_progress) && (p_stats->progress_ns != p_stats->first_ns)) {
+        /* terminate the line of the progress meter */
+        fprintf(stderr, "\n");
+    }
+    fprintf(stderr, "I/O statistics of %s:\n", p_name);
+    fprintf(
+        stderr,
+        "  bytes: %" PRIu64 ", calls: %" PRIu64 ", eof/finish calls: %" PRIu64 "\n",
+        p_stats->bytes,
+        p_stats->calls,
+        p_stats->eof_calls);
+    fprintf(
+        stderr,
+        "  time inside stream: %.3f ms, outside stream (provider): %.3f ms\n",
+        (double)p_stats->inside_ns / 1e6,
+        (double)outside_ns / 1e6);
+    for (size_t i = 0; i < IO_STATS_HIST_BUCKETS; ++i) {
+        if (0 == p_stats->hist[i]) {
+            continue;
+        }
+        unsigned long lower = (0 == i) ? 0 : 1ul << (i - 1);
+        if (IO_STATS_HIST_BUCKETS - 1 == i) {
+            fprintf(stderr, "  %7lu+        bytes: %" PRIu64 " calls\n", lower, p_stats->hist[i]);
+        } else {
+            unsigned long upper = (0 == i) ? 0 : (1ul << i) - 1;
+            fprintf(stderr, "  %7lu-%-7lu bytes: %" PRIu64 " calls\n", lower, upper, p_stats->hist[i]);
+        }
+    }
+}
+
+/* gtaio_istream decorator recording statistics of the calls to the wrapped istream */
+size_t stats_istream_read(stats_istream_t * istream, char * data, size_t len, gta_errinfo_t * p_errinfo)
+{
+    uint64_t begin_ns = io_stats_begin(&istream->stats);
+    size_t read = istream->inner->read(istream->inner, data, len, p_errinfo);
+    io_stats_count(&istream->stats, read);
+    io_stats_end(&istream->stats, begin_ns);
+    return read;
+}
+
+bool stats_istream_eof(stats_istream_t * istream, gta_errinfo_t * p_errinfo)
+{
+    uint64_t begin_ns = io_stats_begin(&istream->stats);
+    bool eof = istream->inner->eof(istream->inner, p_errinfo);
+    istream->stats.eof_calls++;
+    io_stats_end(&istream->stats, begin_ns);
+    return eof;
+}
+
+void stats_istream_init(stats_istream_t * istream, gtaio_istream_t * inner)
+{
+    istream->read = (gtaio_stream_read_t)stats_istream_read;
+    istream->eof = (gtaio_stream_eof_t)stats_istream_eof;
+    istream->inner = inner;
+    memset(&istream->stats, 0, sizeof(io_stats_t));
+}
+
+/* gtaio_ostream decorator recording statistics of the calls to the wrapped ostream */
+size_t stats_ostream_write(stats_ostream_t * ostream, const char * data, size_t len, gta_errinfo_t * p_errinfo)
+{
+    uint64_t begin_ns = io_stats_begin(&ostream->stats);
+    size_t written = ostream->inner->write(ostream->inner, data, len, p_errinfo);
+    io_stats_count(&ostream->stats, written);
+    io_stats_end(&ostream->stats, begin_ns);
+    return written;
+}
+
+bool stats_ostream_finish(stats_ostream_t * ostream, gta_errinfo_t errinfo, gta_errinfo_t * p_errinfo)
+{
+    uint64_t begin_ns = io_stats_begin(&ostream->stats);
+    bool ret = ostream->inner->finish(ostream->inner, errinfo, p_errinfo);
+    ostream->stats.eof_calls++;
+    io_stats_end(&ostream->stats, begin_ns);
+    return ret;
+}
+
+void stats_ostream_init(stats_ostream_t * ostream, gtaio_ostream_t * inner)
+{
+    ostream->write = (gtaio_stream_write_t)stats_ostream_write;
+    ostream->finish = (gtaio_stream_finish_t)stats_ostream_finish;
+    ostream->inner = inner;
+    memset(&ostream->stats, 0, sizeof(io_stats_t));
+}
+
+/*
+ * peek_istream
+ */
+
+size_t peek_istream_read(peek_istream_t * istream, char * data, size_t len, gta_errinfo_t * p_errinfo)
+{
+    size_t read = 0;
+
+    while ((read < len) && (istream->buf_pos < istream->buf_len)) {
+        data[read++] = istream->buf[istream->buf_pos++];
+    }
+    if ((read < len) && !istream->inner->eof(istream->inner, p_errinfo)) {
+        read += istream->inner->read(istream->inner, &data[read], len - read, p_errinfo);
+    }
+    return read;
+}
+
+bool peek_istream_eof(peek_istream_t * istream, gta_errinfo_t * p_errinfo)
+{
+    return (istream->buf_pos == istream->buf_len) && istream->inner->eof(istream->inner, p_errinfo);
+}
+
+void peek_istream_init(peek_istream_t * istream, gtaio_istream_t * inner)
+{
+    istream->read = (gtaio_stream_read_t)peek_istream_read;
+    istream->eof = (gtaio_stream_eof_t)peek_istream_eof;
+    istream->inner = inner;
+    istream->buf_len = 0;
+    istream->buf_pos = 0;
+}
+
+const char * peek_istream_peek(peek_istream_t * istream, size_t len, size_t * p_peeked, gta_errinfo_t * p_errinfo)
+{
+    if (PEEK_ISTREAM_MAX < len) {
+        len = PEEK_ISTREAM_MAX;
+    }
+    while ((istream->buf_len < len) && !istream->inner->eof(istream->inner, p_errinfo)) {
+        size_t read =
+            istream->inner->read(istream->inner, &istream->buf[istream->buf_len], len - istream->buf_len, p_errinfo);
+        if (0 == read) {
+            break;
+        }
+        istream->buf_len += read;
+    }
+    *p_peeked = (istream->buf_len < len) ? istream->buf_len : len;
+    return &istream->buf[istream->buf_pos];
+}
+
+/*
+ * digest_ostream
+ */
+
+size_t digest_ostream_write(digest_ostream_t * ostream, const char * data, size_t len, gta_errinfo_t * p_errinfo)
+{
+    size_t written = ostream->inner->write(ostream->inner, data, len, p_errinfo);
+    /* Only the data accepted by the wrapped ostream is digested */
+    if ((0 < written) && (1 != EVP_DigestUpdate(ostream->md_ctx, data, written))) {
+        *p_errinfo = GTA_ERROR_INTERNAL_ERROR;
+        return 0;
+    }
+    ostream->bytes += written;
+    return written;
+}
+
+bool digest_ostream_finish(digest_ostream_t * ostream, gta_errinfo_t errinfo, gta_errinfo_t * p_errinfo)
+{
+    return ostream->inner->finish(ostream->inner, errinfo, p_errinfo);
+}
+
+int digest_ostream_init(digest_ostream_t * ostream, gtaio_ostream_t * inner, const char * md_name)
+{
+    const EVP_MD * p_md = EVP_get_digestbyname(md_name);
+
+    ostream->write = (gtaio_stream_write_t)digest_ostream_write;
+    ostream->finish = (gtaio_stream_finish_t)digest_ostream_finish;
+    ostream->inner = inner;
+    ostream->md_ctx = NULL;
+    ostream->bytes = 0;
+
+    if (NULL == p_md) {
+        fprintf(stderr, "Unknown digest algorithm: %s\n", md_name);
+        return EXIT_FAILURE;
+    }
+    ostream->md_ctx = EVP_MD_CTX_new();
+    if ((NULL == ostream->md_ctx) || (1 != EVP_DigestInit_ex(ostream->md_ctx, p_md, NULL))) {
+        digest_ostream_free(ostream);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+int digest_ostream_final(digest_ostream_t * ostream, char * hex, size_t hex_size)
+{
+    unsigned char md[EVP_MAX_MD_SIZE] = {0};
+    unsigned int md_len = 0;
+
+    if ((1 != EVP_DigestFinal_ex(ostream->md_ctx, md, &md_len)) || (hex_size < (2 * (size_t)md_len) + 1)) {
+        return EXIT_FAILURE;
+    }
+    for (unsigned int i = 0; i < md_len; ++i) {
+        snprintf(&hex[2 * i], hex_size - (2 * i), "%02x", md[i]);
+    }
+    return EXIT_SUCCESS;
+}
+
+void digest_ostream_free(digest_ostream_t * ostream)
+{
+    EVP_MD_CTX_free(ostream->md_ctx);
+    ostream->md_ctx = NULL;
+}
+
+/*
+ * multi_istream
+ */
+
+size_t multi_istream_read(multi_istream_t * istream, char * data, size_t len, gta_errinfo_t * p_errinfo)
+{
+    size_t read = 0;
+
+    trace_io_begin("multi_istream_read");
+    /* A read crossing a file boundary is filled from the next file */
+    while ((read < len) && (istream->index < istream->num_files)) {
+        FILE * file = istream->files[istream->index];
+        read += fread(&data[read], sizeof(char), len - read, file);
+        if (ferror(file)) {
+            *p_errinfo = GTA_ERROR_INTERNAL_ERROR;
+            break;
+        }
+        if (feof(file)) {
+            ++istream->index;
+        }
+    }
+    trace_span_end_io("multi_istream_read", read);
+    return read;
+}
+
+bool multi_istream_eof(multi_istream_t * istream, gta_errinfo_t * p_errinfo)
+{
+    return istream->index == istream->num_files;
+}
+
+void multi_istream_init(multi_istream_t * istream)
+{
+    istream->read = (gtaio_stream_read_t)multi_istream_read;
+    istream->eof = (gtaio_stream_eof_t)multi_istream_eof;
+    istream->files = NULL;
+    istream->num_files = 0;
+    istream->files_size = 0;
+    istream->index = 0;
+}
+
+int multi_istream_add(multi_istream_t * istream, const char * path)
+{
+    if (istream->num_files == istream->files_size) {
+        size_t new_size = (0 == istream->files_size) ? 8 : (2 * istream->files_size);
+        FILE ** new_files = realloc(istream->files, new_size * sizeof(FILE *));
+        if (NULL == new_files) {
+            fprintf(stderr, "Memory allocation error\n");
+            return EXIT_FAILURE;
+        }
+        istream->files = new_files;
+        istream->files_size = new_size;
+    }
+    FILE * file = fopen(path, "rb");
+    if (NULL == file) {
+        fprintf(stderr, "Cannot open file %s\n", path);
+        return EXIT_FAILURE;
+    }
+    istream->files[istream->num_files++] = file;
+    return EXIT_SUCCESS;
+}
+
+void multi_istream_close(multi_istream_t * istream)
+{
+    for (size_t i = 0; i < istream->num_files; ++i) {
+        fclose(istream->files[i]);
+    }
+    free(istream->files);
+    istream->files = NULL;
+    istream->num_files = 0;
+    istream->files_size = 0;
+    istream->index = 0;
+}
+
 /*** end of file ***/
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: Copyright 2025 Siemens
+ * SPDX-FileCopyrightText: Copyright 2025-2026 Siemens
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -25,6 +25,8 @@ extern "C" {
 /*---------------------------------------------------------------------*/
 
 #include <gta_api/gta_api.h>
+#include <openssl/evp.h>
+#include <stdint.h>
 #include <stdio.h>
 
 /*
@@ -129,6 +131,181 @@ size_t ostream_to_buf_write(ostream_to_buf_t * ostream, const char * data, size_
 
 void ostream_to_buf_init(ostream_to_buf_t * ostream, char * buf, size_t buf_size);
 
+/* gtaio_ostream implementation to write the output to a dynamically growing buffer */
+typedef struct ostream_to_dynbuf {
+    /* public interface as defined for gtaio_ostream */
+    void * p_reserved0;
+    void * p_reserved1;
+    gtaio_stream_write_t write;
+    gtaio_stream_finish_t finish;
+
+    /* private implementation details */
+    char * buf;      /* data buffer, allocated on first write */
+    size_t buf_size; /* allocated size of data buffer */
+    size_t buf_pos;  /* number of bytes written to data buffer */
+} ostream_to_dynbuf_t;
+
+size_t ostream_to_dynbuf_write(ostream_to_dynbuf_t * ostream, const char * data, size_t len, gta_errinfo_t * p_errinfo);
+
+void ostream_to_dynbuf_init(ostream_to_dynbuf_t * ostream);
+
+/* Clears and frees the buffer of an ostream_to_dynbuf */
+void ostream_to_dynbuf_free(ostream_to_dynbuf_t * ostream);
+
+/* Reads all data from istream and appends it to ostream, fails on a read error */
+int read_istream_to_dynbuf(gtaio_istream_t * istream, ostream_to_dynbuf_t * ostream);
+
+/*---------------------------------------------------------------------*/
+
+/*
+ * Statistics of the stream callbacks of a provider. Bucket 0 of the histogram
+ * counts calls transferring no data, bucket i counts calls transferring
+ * [2^(i-1), 2^i) bytes, the last bucket counts all larger calls.
+ */
+#define IO_STATS_HIST_BUCKETS 18
+
+typedef struct io_stats {
+    uint64_t bytes;                       /* number of bytes transferred */
+    uint64_t calls;                       /* number of read or write calls */
+    uint64_t eof_calls;                   /* number of eof polls (istream) or finish calls (ostream) */
+    uint64_t hist[IO_STATS_HIST_BUCKETS]; /* number of calls by bytes transferred */
+    uint64_t inside_ns;                   /* time spent in the wrapped stream */
+    uint64_t first_ns;                    /* begin of the first callback, 0 if there was none */
+    uint64_t last_ns;                     /* end of the last callback */
+    const char * p_progress;              /* label of the progress meter on stderr, NULL if disabled */
+    uint64_t progress_ns;                 /* time of the last progress update */
+} io_stats_t;
+
+/* Prints the statistics of a stream to stderr */
+void io_stats_print(const char * p_name, const io_stats_t * p_stats);
+
+/* gtaio_istream decorator recording statistics of the calls to the wrapped istream */
+typedef struct stats_istream {
+    /* public interface as defined for gtaio_istream */
+    gtaio_stream_read_t read;
+    gtaio_stream_eof_t eof;
+    void * p_reserved2;
+    void * p_reserved3;
+
+    /* private implementation details */
+    gtaio_istream_t * inner; /* wrapped istream */
+    io_stats_t stats;
+} stats_istream_t;
+
+size_t stats_istream_read(stats_istream_t * istream, char * data, size_t len, gta_errinfo_t * p_errinfo);
+
+bool stats_istream_eof(stats_istream_t * istream, gta_errinfo_t * p_errinfo);
+
+void stats_istream_init(stats_istream_t * istream, gtaio_istream_t * inner);
+
+/* gtaio_ostream decorator recording statistics of the calls to the wrapped ostream */
+typedef struct stats_ostream {
+    /* public interface as defined for gtaio_ostream */
+    void * p_reserved0;
+    void * p_reserved1;
+    gtaio_stream_write_t write;
+    gtaio_stream_finish_t finish;
+
+    /* private implementation details */
+    gtaio_ostream_t * inner; /* wrapped ostream */
+    io_stats_t stats;
+} stats_ostream_t;
+
+size_t stats_ostream_write(stats_ostream_t * ostream, const char * data, size_t len, gta_errinfo_t * p_errinfo);
+
+bool stats_ostream_finish(stats_ostream_t * ostream, gta_errinfo_t errinfo, gta_errinfo_t * p_errinfo);
+
+void stats_ostream_init(stats_ostream_t * ostream, gtaio_ostream_t * inner);
+
+/*---------------------------------------------------------------------*/
+
+/* Maximum number of bytes which can be peeked from a peek_istream */
+#define PEEK_ISTREAM_MAX 16
+
+/* gtaio_istream allowing to look at the first bytes of the wrapped istream before they are read */
+typedef struct peek_istream {
+    /* public interface as defined for gtaio_istream */
+    gtaio_stream_read_t read;
+    gtaio_stream_eof_t eof;
+    void * p_reserved2;
+    void * p_reserved3;
+
+    /* private implementation details */
+    gtaio_istream_t * inner;    /* wrapped istream */
+    char buf[PEEK_ISTREAM_MAX]; /* peeked bytes */
+    size_t buf_len;             /* number of peeked bytes */
+    size_t buf_pos;             /* number of peeked bytes already read */
+} peek_istream_t;
+
+size_t peek_istream_read(peek_istream_t * istream, char * data, size_t len, gta_errinfo_t * p_errinfo);
+
+bool peek_istream_eof(peek_istream_t * istream, gta_errinfo_t * p_errinfo);
+
+void peek_istream_init(peek_istream_t * istream, gtaio_istream_t * inner);
+
+/*
+ * Reads up to len (at most PEEK_ISTREAM_MAX) bytes from the wrapped istream
+ * into the peek buffer and returns a pointer to it. The number of available
+ * bytes is returned in *p_peeked, it is less than len only at the end of data.
+ */
+const char * peek_istream_peek(peek_istream_t * istream, size_t len, size_t * p_peeked, gta_errinfo_t * p_errinfo);
+
+/*---------------------------------------------------------------------*/
+
+/* gtaio_ostream forwarding all data to the wrapped ostream and digesting it at the same time */
+typedef struct digest_ostream {
+    /* public interface as defined for gtaio_ostream */
+    void * p_reserved0;
+    void * p_reserved1;
+    gtaio_stream_write_t write;
+    gtaio_stream_finish_t finish;
+
+    /* private implementation details */
+    gtaio_ostream_t * inner; /* wrapped ostream */
+    EVP_MD_CTX * md_ctx;     /* NULL if not initialized */
+    uint64_t bytes;          /* bytes digested */
+} digest_ostream_t;
+
+size_t digest_ostream_write(digest_ostream_t * ostream, const char * data, size_t len, gta_errinfo_t * p_errinfo);
+
+bool digest_ostream_finish(digest_ostream_t * ostream, gta_errinfo_t errinfo, gta_errinfo_t * p_errinfo);
+
+/* Initializes the digest with an OpenSSL digest name (e.g. "sha256"), inner may be set later */
+int digest_ostream_init(digest_ostream_t * ostream, gtaio_ostream_t * inner, const char * md_name);
+
+/* Writes the digest as lowercase hex string to hex (at least 2 * EVP_MAX_MD_SIZE + 1 bytes) */
+int digest_ostream_final(digest_ostream_t * ostream, char * hex, size_t hex_size);
+
+void digest_ostream_free(digest_ostream_t * ostream);
+
+/*---------------------------------------------------------------------*/
+
+/* gtaio_istream reading several files one after another as one contiguous stream */
+typedef struct multi_istream {
+    /* public interface as defined for gtaio_istream */
+    gtaio_stream_read_t read;
+    gtaio_stream_eof_t eof;
+    void * p_reserved2;
+    void * p_reserved3;
+
+    /* private implementation details */
+    FILE ** files;     /* opened files in reading order */
+    size_t num_files;  /* number of opened files */
+    size_t files_size; /* allocated entries of files */
+    size_t index;      /* file currently read, num_files at the end of data */
+} multi_istream_t;
+
+size_t multi_istream_read(multi_istream_t * istream, char * data, size_t len, gta_errinfo_t * p_errinfo);
+
+bool multi_istream_eof(multi_istream_t * istream, gta_errinfo_t * p_errinfo);
+
+void multi_istream_init(multi_istream_t * istream);
+
+/* Opens the file and appends it to the stream, all files are opened before reading starts */
+int multi_istream_add(multi_istream_t * istream, const char * path);
+
+void multi_istream_close(multi_istream_t * istream);
+
 /*---------------------------------------------------------------------*/
 
 #if defined(__cplusplus)
@@ -0,0 +1,167 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "trace.h"
+
+#include "metrics.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(HAVE_SYS_SDT_H)
+#include <sys/sdt.h>
+#define TRACE_PROBE1(name, a1) DTRACE_PROBE1(gta_cli, name, a1)
+#define TRACE_PROBE2(name, a1, a2) DTRACE_PROBE2(gta_cli, name, a1, a2)
+#define TRACE_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(gta_cli, name, a1, a2, a3)
+#define TRACE_PROBE5(name, a1, a2, a3, a4, a5) DTRACE_PROBE5(gta_cli, name, a1, a2, a3, a4, a5)
+#else
+#define TRACE_PROBE1(name, a1)
+#define TRACE_PROBE2(name, a1, a2)
+#define TRACE_PROBE3(name, a1, a2, a3)
+#define TRACE_PROBE5(name, a1, a2, a3, a4, a5)
+#endif
+
+/* Maximum nesting depth of spans per thread, deeper spans are not recorded */
+#define TRACE_MAX_DEPTH 32
+
+static FILE * p_trace_file = NULL;
+static bool b_first_event = true;
+static pthread_mutex_t trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+static const char * p_probe_function = "";
+static const char * p_probe_profile = "";
+
+/* Start times of the open spans of the calling thread */
+static __thread uint64_t span_start_ns[TRACE_MAX_DEPTH];
+static __thread size_t span_depth = 0;
+
+int trace_open(const char * path)
+{
+    p_trace_file = fopen(path, "w");
+    if (NULL == p_trace_file) {
+        fprintf(stderr, "Cannot open trace file %s\n", path);
+        return EXIT_FAILURE;
+    }
+    /* JSON array format, viewers also accept the file if the closing bracket is missing */
+    fprintf(p_trace_file, "[");
+    b_first_event = true;
+    return EXIT_SUCCESS;
+}
+
+void trace_close(void)
+{
+    if (NULL != p_trace_file) {
+        pthread_mutex_lock(&trace_mutex);
+        fprintf(p_trace_file, "\n]\n");
+        fclose(p_trace_file);
+        p_trace_file = NULL;
+        pthread_mutex_unlock(&trace_mutex);
+    }
+}
+
+void trace_set_invocation(const char * function, const char * profile)
+{
+    p_probe_function = (NULL != function) ? function : "";
+    p_probe_profile = (NULL != profile) ? profile : "";
+}
+
+void trace_call_begin(const char * name)
+{
+    TRACE_PROBE3(call__entry, name, p_probe_function, p_probe_profile);
+    trace_span_begin();
+}
+
+void trace_io_begin(const char * name)
+{
+    TRACE_PROBE1(io__entry, name);
+    trace_span_begin();
+}
+
+void trace_span_begin(void)
+{
+    if (NULL == p_trace_file) {
+        return;
+    }
+    if (TRACE_MAX_DEPTH > span_depth) {
+        span_start_ns[span_depth] = metrics_now_ns();
+    }
+    span_depth++;
+}
+
+/* Pops the innermost span and writes it as complete event, p_args is a JSON object or NULL */
+static void write_event(const char * cat, const char * name, const char * p_args)
+{
+    if ((NULL == p_trace_file) || (0 == span_depth)) {
+        return;
+    }
+    span_depth--;
+    if (TRACE_MAX_DEPTH <= span_depth) {
+        return;
+    }
+
+    uint64_t end_ns = metrics_now_ns();
+    uint64_t start_ns = span_start_ns[span_depth];
+
+    pthread_mutex_lock(&trace_mutex);
+    if (NULL != p_trace_file) {
+        fprintf(
+            p_trace_file,
+            "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%ld,\"tid\":%ld%s%s}",
+            b_first_event ? "" : ",",
+            name,
+            cat,
+            (double)start_ns / 1000.0,
+            (double)(end_ns - start_ns) / 1000.0,
+            (long)getpid(),
+            (long)syscall(SYS_gettid),
+            (NULL != p_args) ? ",\"args\":" : "",
+            (NULL != p_args) ? p_args : "");
+        b_first_event = false;
+    }
+    pthread_mutex_unlock(&trace_mutex);
+}
+
+void trace_span_end(const char * cat, const char * name)
+{
+    write_event(cat, name, NULL);
+}
+
+void trace_span_end_io(const char * name, size_t bytes)
+{
+    char args[48] = {0};
+
+    TRACE_PROBE2(io__return, name, bytes);
+    if (NULL != p_trace_file) {
+        snprintf(args, sizeof(args), "{\"bytes\":%zu}", bytes);
+        write_event("io", name, args);
+    }
+}
+
+bool trace_span_end_bool(const char * name, bool result, const gta_errinfo_t * p_errinfo)
+{
+    char args[64] = {0};
+
+    TRACE_PROBE5(call__return, name, p_probe_function, p_probe_profile, (int)result, (long)*p_errinfo);
+    if (NULL != p_trace_file) {
+        if (result) {
+            snprintf(args, sizeof(args), "{\"ok\":true}");
+        } else {
+            snprintf(args, sizeof(args), "{\"ok\":false,\"errinfo\":%ld}", (long)*p_errinfo);
+        }
+        write_event("gta", name, args);
+    }
+    return result;
+}
+
+void * trace_span_end_ptr(const char * name, void * result, const gta_errinfo_t * p_errinfo)
+{
+    trace_span_end_bool(name, (NULL != result), p_errinfo);
+    return result;
+}
+
+/*** end of file ***/
@@ -0,0 +1,87 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef GTA_CLI_TRACE_H
+#define GTA_CLI_TRACE_H
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+extern "C" {
+/* *INDENT-ON* */
+#endif
+
+/*---------------------------------------------------------------------*/
+
+#include <gta_api/gta_api.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Span tracing in the Chrome/Perfetto trace-event JSON format. Every span is
+ * written as complete event ("ph":"X") with process and thread ID. While no
+ * trace file is open, beginning and ending spans only checks a flag.
+ *
+ * If the build has USDT support (meson option usdt), GTA API calls and
+ * stream callbacks additionally hit static probes of the provider gta_cli,
+ * independent of the trace file:
+ *
+ *   call-entry   (call, function, profile)
+ *   call-return  (call, function, profile, result, errinfo)
+ *   io-entry     (callback)
+ *   io-return    (callback, bytes)
+ *
+ * "call" is the name of the GTA API function, "function" and "profile" are
+ * the gta-cli function and profile of the invocation ("" if not set).
+ */
+
+/* Opens the trace file, spans are written to it until trace_close() is called */
+int trace_open(const char * path);
+
+void trace_close(void);
+
+/* Sets the gta-cli function and the profile passed to the probes of GTA API calls */
+void trace_set_invocation(const char * function, const char * profile);
+
+/* Begins a span on the calling thread, spans may be nested */
+void trace_span_begin(void);
+
+/* Begins the span of a GTA API call */
+void trace_call_begin(const char * name);
+
+/* Begins the span of a stream callback */
+void trace_io_begin(const char * name);
+
+/* Ends the innermost span of the calling thread */
+void trace_span_end(const char * cat, const char * name);
+
+/* Ends the innermost span of a stream callback, recording the number of bytes transferred */
+void trace_span_end_io(const char * name, size_t bytes);
+
+/* Ends the innermost span of a GTA API call with boolean result */
+bool trace_span_end_bool(const char * name, bool result, const gta_errinfo_t * p_errinfo);
+
+/* Ends the innermost span of a GTA API call returning a handle */
+void * trace_span_end_ptr(const char * name, void * result, const gta_errinfo_t * p_errinfo);
+
+/*
+ * Wrap a GTA API call in a span, e.g.
+ *   if (!TRACE_BOOL(gta_seal_data, (h_ctx, p_in, p_out, &errinfo), &errinfo))
+ * The comma operator guarantees that the span begins before the call is evaluated.
+ */
+#define TRACE_BOOL(func, args, p_errinfo) (trace_call_begin(#func), trace_span_end_bool(#func, func args, p_errinfo))
+#define TRACE_PTR(func, args, p_errinfo) (trace_call_begin(#func), trace_span_end_ptr(#func, func args, p_errinfo))
+
+/*---------------------------------------------------------------------*/
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+}
+/* *INDENT-ON* */
+#endif
+
+#endif /* GTA_CLI_TRACE_H */
+
+/*** end of file ***/
@@ -0,0 +1,342 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "tree_hash.h"
+
+#include "chunked.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TREE_HASH_VERSION 1
+/* Upper bound for the data read ahead while the previous batch is hashed */
+#define TREE_HASH_MAX_BATCH_BYTES (256 * 1024 * 1024)
+/* Number of chunks per thread in a batch */
+#define TREE_HASH_CHUNKS_PER_THREAD 4
+
+/*
+ * The calling thread reads the data in batches of chunks into two buffers.
+ * While the worker threads hash the chunks of one batch, the next batch is
+ * read into the other buffer.
+ */
+typedef struct hash_pool {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond; /* signalled when a batch is started or finished */
+    const EVP_MD * p_md;
+    size_t chunk_size;
+    bool b_stop;
+    bool b_error;
+
+    /* current batch */
+    const char * p_batch;
+    size_t batch_len;
+    size_t batch_chunks;
+    size_t next_chunk;       /* next chunk of the batch to be hashed */
+    size_t done_chunks;      /* number of hashed chunks of the batch */
+    unsigned char * p_leafs; /* leaf hashes of the batch */
+} hash_pool_t;
+
+static void put_u64(char * p_buf, uint64_t value)
+{
+    for (size_t i = 0; i < 8; ++i) {
+        p_buf[i] = (char)((value >> (8 * i)) & 0xff);
+    }
+}
+
+static void put_u32(char * p_buf, uint32_t value)
+{
+    for (size_t i = 0; i < 4; ++i) {
+        p_buf[i] = (char)((value >> (8 * i)) & 0xff);
+    }
+}
+
+int tree_hash_parse(const char * p_spec, tree_hash_t * p_tree_hash)
+{
+    const char * p_sep = strchr(p_spec, ':');
+
+    memset(p_tree_hash, 0, sizeof(*p_tree_hash));
+    if ((NULL == p_sep) || (p_sep == p_spec) || ((size_t)(p_sep - p_spec) >= sizeof(p_tree_hash->md_name))) {
+        fprintf(stderr, "Invalid input: '%s' is not of the form ALG:CHUNK\n", p_spec);
+        return EXIT_FAILURE;
+    }
+    memcpy(p_tree_hash->md_name, p_spec, (size_t)(p_sep - p_spec));
+
+    p_tree_hash->p_md = EVP_get_digestbyname(p_tree_hash->md_name);
+    if ((NULL == p_tree_hash->p_md) || (0 >= EVP_MD_size(p_tree_hash->p_md))) {
+        fprintf(stderr, "Unknown digest algorithm: %s\n", p_tree_hash->md_name);
+        return EXIT_FAILURE;
+    }
+    return chunked_parse_size(p_sep + 1, &p_tree_hash->chunk_size);
+}
+
+bool tree_hash_node(
+    const EVP_MD * p_md,
+    EVP_MD_CTX * p_ctx,
+    unsigned char prefix,
+    const void * p_data1,
+    size_t len1,
+    const void * p_data2,
+    size_t len2,
+    unsigned char * p_md_out)
+{
+    return (1 == EVP_DigestInit_ex(p_ctx, p_md, NULL)) && (1 == EVP_DigestUpdate(p_ctx, &prefix, 1)) &&
+           (1 == EVP_DigestUpdate(p_ctx, p_data1, len1)) &&
+           ((0 == len2) || (1 == EVP_DigestUpdate(p_ctx, p_data2, len2))) &&
+           (1 == EVP_DigestFinal_ex(p_ctx, p_md_out, NULL));
+}
+
+static void * worker_main(void * p_arg)
+{
+    hash_pool_t * p_pool = (hash_pool_t *)p_arg;
+    size_t md_len = (size_t)EVP_MD_size(p_pool->p_md);
+    EVP_MD_CTX * p_ctx = EVP_MD_CTX_new();
+
+    pthread_mutex_lock(&p_pool->mutex);
+    if (NULL == p_ctx) {
+        p_pool->b_error = true;
+    }
+    for (;;) {
+        /* Wait until a batch with chunks left is started */
+        while (!p_pool->b_stop && (p_pool->next_chunk == p_pool->batch_chunks)) {
+            pthread_cond_wait(&p_pool->cond, &p_pool->mutex);
+        }
+        if (p_pool->b_stop) {
+            break;
+        }
+        size_t chunk = p_pool->next_chunk++;
+        pthread_mutex_unlock(&p_pool->mutex);
+
+        size_t offset = chunk * p_pool->chunk_size;
+        size_t len = p_pool->batch_len - offset;
+        if (len > p_pool->chunk_size) {
+            len = p_pool->chunk_size;
+        }
+        bool b_ok = (NULL != p_ctx) && tree_hash_node(
+                                           p_pool->p_md,
+                                           p_ctx,
+                                           TREE_HASH_LEAF_PREFIX,
+                                           &p_pool->p_batch[offset],
+                                           len,
+                                           NULL,
+                                           0,
+                                           &p_pool->p_leafs[chunk * md_len]);
+
+        pthread_mutex_lock(&p_pool->mutex);
+        if (!b_ok) {
+            p_pool->b_error = true;
+        }
+        if (++p_pool->done_chunks == p_pool->batch_chunks) {
+            pthread_cond_broadcast(&p_pool->cond);
+        }
+    }
+    pthread_mutex_unlock(&p_pool->mutex);
+
+    EVP_MD_CTX_free(p_ctx);
+    return NULL;
+}
+
+/* Reads up to len bytes to p_read, less only at the end of the data, returns false on a read error */
+static bool read_batch(gtaio_istream_t * p_istream, char * p_buf, size_t len, size_t * p_read)
+{
+    gta_errinfo_t errinfo = 0;
+    size_t total = 0;
+
+    while ((total < len) && !p_istream->eof(p_istream, &errinfo)) {
+        size_t read = p_istream->read(p_istream, &p_buf[total], len - total, &errinfo);
+        /* A stream which returns no data before its end has failed (e.g. fread of a directory) */
+        if ((0 != errinfo) || ((0 == read) && !p_istream->eof(p_istream, &errinfo))) {
+            fprintf(stderr, "Cannot read input\n");
+            return false;
+        }
+        total += read;
+    }
+    *p_read = total;
+    return (0 == errinfo);
+}
+
+/* Reduces the leaf hashes to the root hash, the leafs are overwritten */
+static bool reduce_tree(tree_hash_t * p_tree_hash, unsigned char * p_nodes, size_t num_nodes)
+{
+    size_t md_len = (size_t)EVP_MD_size(p_tree_hash->p_md);
+    EVP_MD_CTX * p_ctx = EVP_MD_CTX_new();
+    bool b_ok = (NULL != p_ctx);
+
+    while (b_ok && (1 < num_nodes)) {
+        size_t num_parents = 0;
+        for (size_t i = 0; b_ok && (i < num_nodes); i += 2, ++num_parents) {
+            if (i + 1 == num_nodes) {
+                memmove(&p_nodes[num_parents * md_len], &p_nodes[i * md_len], md_len);
+            } else {
+                unsigned char parent[EVP_MAX_MD_SIZE] = {0};
+                b_ok = tree_hash_node(
+                    p_tree_hash->p_md,
+                    p_ctx,
+                    TREE_HASH_NODE_PREFIX,
+                    &p_nodes[i * md_len],
+                    md_len,
+                    &p_nodes[(i + 1) * md_len],
+                    md_len,
+                    parent);
+                memcpy(&p_nodes[num_parents * md_len], parent, md_len);
+            }
+        }
+        num_nodes = num_parents;
+    }
+    if (b_ok) {
+        memcpy(p_tree_hash->root, p_nodes, md_len);
+        p_tree_hash->root_len = (unsigned int)md_len;
+    }
+    EVP_MD_CTX_free(p_ctx);
+    return b_ok;
+}
+
+int tree_hash_compute(tree_hash_t * p_tree_hash, gtaio_istream_t * p_istream, unsigned int threads)
+{
+    int ret = EXIT_FAILURE;
+    hash_pool_t pool = {0};
+    size_t md_len = (size_t)EVP_MD_size(p_tree_hash->p_md);
+    char * p_bufs[2] = {NULL, NULL};
+    unsigned char * p_leafs = NULL;
+    size_t leafs_size = 0;
+    pthread_t * p_workers = NULL;
+    unsigned int num_workers = 0;
+
+    if (0 == threads) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (1 > cpus) ? 1 : (unsigned int)cpus;
+    }
+    size_t batch_chunks = threads * TREE_HASH_CHUNKS_PER_THREAD;
+    if (batch_chunks > TREE_HASH_MAX_BATCH_BYTES / p_tree_hash->chunk_size) {
+        batch_chunks = TREE_HASH_MAX_BATCH_BYTES / p_tree_hash->chunk_size;
+    }
+    if (0 == batch_chunks) {
+        batch_chunks = 1;
+    }
+    size_t batch_size = batch_chunks * p_tree_hash->chunk_size;
+
+    p_bufs[0] = malloc(batch_size);
+    p_bufs[1] = malloc(batch_size);
+    p_workers = calloc(threads, sizeof(pthread_t));
+    if ((NULL == p_bufs[0]) || (NULL == p_bufs[1]) || (NULL == p_workers)) {
+        fprintf(stderr, "Memory allocation error\n");
+        goto cleanup;
+    }
+
+    pool.p_md = p_tree_hash->p_md;
+    pool.chunk_size = p_tree_hash->chunk_size;
+    pthread_mutex_init(&pool.mutex, NULL);
+    pthread_cond_init(&pool.cond, NULL);
+    for (; num_workers < threads; ++num_workers) {
+        if (0 != pthread_create(&p_workers[num_workers], NULL, worker_main, &pool)) {
+            break;
+        }
+    }
+    if (0 == num_workers) {
+        fprintf(stderr, "Cannot create threads\n");
+    }
+
+    p_tree_hash->data_len = 0;
+    p_tree_hash->num_chunks = 0;
+    unsigned int cur = 0;
+    size_t len = 0;
+    bool b_read_ok = read_batch(p_istream, p_bufs[cur], batch_size, &len);
+    while (b_read_ok && (0 != num_workers) && ((0 != len) || (0 == p_tree_hash->num_chunks))) {
+        size_t chunks = (0 == len) ? 1 : ((len + p_tree_hash->chunk_size - 1) / p_tree_hash->chunk_size);
+
+        if (p_tree_hash->num_chunks + chunks > leafs_size) {
+            size_t new_size = (0 == leafs_size) ? 1024 : (2 * leafs_size);
+            while (new_size < p_tree_hash->num_chunks + chunks) {
+                new_size *= 2;
+            }
+            unsigned char * p_new_leafs = realloc(p_leafs, new_size * md_len);
+            if (NULL == p_new_leafs) {
+                fprintf(stderr, "Memory allocation error\n");
+                break;
+            }
+            p_leafs = p_new_leafs;
+            leafs_size = new_size;
+        }
+
+        /* Start hashing of the batch */
+        pthread_mutex_lock(&pool.mutex);
+        pool.p_batch = p_bufs[cur];
+        pool.batch_len = len;
+        pool.batch_chunks = chunks;
+        pool.next_chunk = 0;
+        pool.done_chunks = 0;
+        pool.p_leafs = &p_leafs[p_tree_hash->num_chunks * md_len];
+        pthread_cond_broadcast(&pool.cond);
+        pthread_mutex_unlock(&pool.mutex);
+
+        p_tree_hash->data_len += len;
+        p_tree_hash->num_chunks += chunks;
+
+        /* Read the next batch meanwhile, a short batch is the last one */
+        size_t next_len = 0;
+        if (batch_size == len) {
+            b_read_ok = read_batch(p_istream, p_bufs[1 - cur], batch_size, &next_len);
+        }
+
+        pthread_mutex_lock(&pool.mutex);
+        while (pool.done_chunks != pool.batch_chunks) {
+            pthread_cond_wait(&pool.cond, &pool.mutex);
+        }
+        bool b_error = pool.b_error;
+        pthread_mutex_unlock(&pool.mutex);
+        if (b_error || !b_read_ok) {
+            break;
+        }
+
+        cur = 1 - cur;
+        len = next_len;
+        if (0 == len) {
+            ret = EXIT_SUCCESS;
+            break;
+        }
+    }
+
+    pthread_mutex_lock(&pool.mutex);
+    pool.b_stop = true;
+    pthread_cond_broadcast(&pool.cond);
+    pthread_mutex_unlock(&pool.mutex);
+    for (unsigned int i = 0; i < num_workers; ++i) {
+        pthread_join(p_workers[i], NULL);
+    }
+    pthread_cond_destroy(&pool.cond);
+    pthread_mutex_destroy(&pool.mutex);
+
+    if ((EXIT_SUCCESS == ret) && !reduce_tree(p_tree_hash, p_leafs, (size_t)p_tree_hash->num_chunks)) {
+        fprintf(stderr, "Computation of the tree hash failed\n");
+        ret = EXIT_FAILURE;
+    }
+
+cleanup:
+    free(p_bufs[0]);
+    free(p_bufs[1]);
+    free(p_leafs);
+    free(p_workers);
+    return ret;
+}
+
+size_t tree_hash_encode(const tree_hash_t * p_tree_hash, char * p_buf)
+{
+    memset(p_buf, 0, TREE_HASH_MAX_ENCODED);
+    memcpy(p_buf, TREE_HASH_MAGIC, 8);
+    put_u32(&p_buf[8], TREE_HASH_VERSION);
+    put_u32(&p_buf[12], p_tree_hash->root_len);
+    put_u64(&p_buf[16], p_tree_hash->chunk_size);
+    put_u64(&p_buf[24], p_tree_hash->data_len);
+    put_u64(&p_buf[32], p_tree_hash->num_chunks);
+    /* md_name is NUL padded by tree_hash_parse */
+    memcpy(&p_buf[TREE_HASH_HEADER_LEN], p_tree_hash->md_name, TREE_HASH_MAX_NAME);
+    memcpy(&p_buf[TREE_HASH_HEADER_LEN + TREE_HASH_MAX_NAME], p_tree_hash->root, p_tree_hash->root_len);
+    return TREE_HASH_HEADER_LEN + TREE_HASH_MAX_NAME + p_tree_hash->root_len;
+}
+
+/*** end of file ***/
@@ -0,0 +1,89 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef GTA_CLI_TREE_HASH_H
+#define GTA_CLI_TREE_HASH_H
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+extern "C" {
+/* *INDENT-ON* */
+#endif
+
+/*---------------------------------------------------------------------*/
+
+#include <gta_api/gta_api.h>
+#include <openssl/evp.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Merkle tree hash of the data for authenticate_data_detached and
+ * verify_data_detached. The data is split into chunks of a fixed size which
+ * are hashed in parallel:
+ *
+ *   leaf = H(0x00 || chunk)
+ *   node = H(0x01 || left || right)
+ *
+ * Nodes are paired level by level, an unpaired last node is moved up
+ * unchanged. Empty data consists of a single empty chunk. Instead of the
+ * data, the encoded tree hash is passed to the provider (integers
+ * little-endian):
+ *
+ *   magic "GTATREE1", u32 version, u32 length of the root hash,
+ *   u64 chunk size, u64 length of the data, u64 number of chunks,
+ *   digest name (NUL padded to 32 bytes), root hash
+ */
+
+#define TREE_HASH_MAGIC "GTATREE1"
+#define TREE_HASH_LEAF_PREFIX 0x00
+#define TREE_HASH_NODE_PREFIX 0x01
+#define TREE_HASH_MAX_NAME 32
+#define TREE_HASH_HEADER_LEN 40
+#define TREE_HASH_MAX_ENCODED (TREE_HASH_HEADER_LEN + TREE_HASH_MAX_NAME + EVP_MAX_MD_SIZE)
+
+typedef struct tree_hash {
+    char md_name[TREE_HASH_MAX_NAME];
+    const EVP_MD * p_md;
+    size_t chunk_size;
+    uint64_t data_len;
+    uint64_t num_chunks;
+    unsigned char root[EVP_MAX_MD_SIZE];
+    unsigned int root_len;
+} tree_hash_t;
+
+/* Computes H(prefix || data1 || data2) of a leaf or node, data2 is optional (len2 = 0) */
+bool tree_hash_node(
+    const EVP_MD * p_md,
+    EVP_MD_CTX * p_ctx,
+    unsigned char prefix,
+    const void * p_data1,
+    size_t len1,
+    const void * p_data2,
+    size_t len2,
+    unsigned char * p_md_out);
+
+/* Parses "ALG:CHUNK" (e.g. "sha256:4M") */
+int tree_hash_parse(const char * p_spec, tree_hash_t * p_tree_hash);
+
+/* Reads all data of istream and computes the root hash using the given number of threads (0: online CPUs) */
+int tree_hash_compute(tree_hash_t * p_tree_hash, gtaio_istream_t * p_istream, unsigned int threads);
+
+/* Encodes the tree hash to p_buf of at least TREE_HASH_MAX_ENCODED bytes, returns the length */
+size_t tree_hash_encode(const tree_hash_t * p_tree_hash, char * p_buf);
+
+/*---------------------------------------------------------------------*/
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+}
+/* *INDENT-ON* */
+#endif
+
+#endif /* GTA_CLI_TREE_HASH_H */
+
+/*** end of file ***/
@@ -0,0 +1,812 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vault.h"
+
+#include "streams.h"
+#include "trace.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <openssl/rand.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define VAULT_MAGIC "GTAVAULT"
+#define VAULT_INDEX_MAGIC "GTAVIDX1"
+#define VAULT_MAGIC_LEN 8
+#define VAULT_VERSION 1
+#define VAULT_HEADER_LEN 24
+#define VAULT_RECORD_HEADER_LEN 16
+#define VAULT_INDEX_HEADER_LEN 40
+#define VAULT_INDEX_ENTRY_LEN 16
+/* Suffix of the files written before they are renamed into place */
+#define VAULT_TMP_SUFFIX ".tmp"
+/* Vaults smaller than this are not compacted */
+#define VAULT_COMPACT_MIN_SIZE (64 * 1024)
+
+static void put_u64(char * p_buf, uint64_t value)
+{
+    for (size_t i = 0; i < 8; ++i) {
+        p_buf[i] = (char)((value >> (8 * i)) & 0xff);
+    }
+}
+
+static void put_u32(char * p_buf, uint32_t value)
+{
+    for (size_t i = 0; i < 4; ++i) {
+        p_buf[i] = (char)((value >> (8 * i)) & 0xff);
+    }
+}
+
+static uint64_t get_u64(const char * p_buf)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        value |= (uint64_t)(unsigned char)p_buf[i] << (8 * i);
+    }
+    return value;
+}
+
+static uint32_t get_u32(const char * p_buf)
+{
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        value |= (uint32_t)(unsigned char)p_buf[i] << (8 * i);
+    }
+    return value;
+}
+
+/* FNV-1a, the index is only a lookup aid, the key of the record is always compared */
+static uint64_t hash_key(const char * p_key, size_t key_len)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < key_len; ++i) {
+        hash ^= (unsigned char)p_key[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static char * path_with_suffix(const char * p_path, const char * p_suffix)
+{
+    size_t len = strlen(p_path) + strlen(p_suffix) + 1;
+    char * p_result = malloc(len);
+
+    if (NULL != p_result) {
+        snprintf(p_result, len, "%s%s", p_path, p_suffix);
+    }
+    return p_result;
+}
+
+static bool write_full_fd(int fd, const char * p_buf, size_t len)
+{
+    while (0 < len) {
+        ssize_t written = write(fd, p_buf, len);
+        if (0 > written) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return false;
+        }
+        p_buf += written;
+        len -= (size_t)written;
+    }
+    return true;
+}
+
+static bool write_full(gtaio_ostream_t * p_ostream, const char * p_buf, size_t len, gta_errinfo_t * p_errinfo)
+{
+    size_t written = 0;
+    while (written < len) {
+        size_t n = p_ostream->write(p_ostream, &p_buf[written], len - written, p_errinfo);
+        if (0 == n) {
+            return false;
+        }
+        written += n;
+    }
+    return true;
+}
+
+bool vault_check_key(const char * p_key)
+{
+    size_t len = strlen(p_key);
+
+    if ((0 == len) || (VAULT_MAX_KEY_LEN < len) || (0 == strcmp(p_key, ".")) || (0 == strcmp(p_key, ".."))) {
+        return false;
+    }
+    for (size_t i = 0; i < len; ++i) {
+        /* Printable ASCII without space, keys are used as file names by vault_fetch_many */
+        if (('!' > p_key[i]) || ('~' < p_key[i]) || ('/' == p_key[i]) || (',' == p_key[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Locates the record at offset, returns false if it is not complete */
+static bool parse_record(
+    const vault_t * p_vault,
+    uint64_t offset,
+    const char ** pp_key,
+    size_t * p_key_len,
+    const char ** pp_sealed,
+    size_t * p_sealed_len)
+{
+    if ((offset > p_vault->data_end) || (VAULT_RECORD_HEADER_LEN > p_vault->data_end - offset)) {
+        return false;
+    }
+    const char * p_record = &p_vault->p_map[offset];
+    uint64_t key_len = get_u32(p_record);
+    uint64_t sealed_len = get_u64(&p_record[8]);
+    uint64_t available = p_vault->data_end - offset - VAULT_RECORD_HEADER_LEN;
+    if ((0 == key_len) || (VAULT_MAX_KEY_LEN < key_len) || (key_len > available) ||
+        (sealed_len > available - key_len)) {
+        return false;
+    }
+    *pp_key = &p_record[VAULT_RECORD_HEADER_LEN];
+    *p_key_len = (size_t)key_len;
+    *pp_sealed = &p_record[VAULT_RECORD_HEADER_LEN + key_len];
+    *p_sealed_len = (size_t)sealed_len;
+    return true;
+}
+
+static uint64_t entry_hash(const vault_t * p_vault, size_t index)
+{
+    return get_u64(&p_vault->p_entries[index * VAULT_INDEX_ENTRY_LEN]);
+}
+
+static uint64_t entry_offset(const vault_t * p_vault, size_t index)
+{
+    return get_u64(&p_vault->p_entries[(index * VAULT_INDEX_ENTRY_LEN) + 8]);
+}
+
+/* Index of the first entry with a hash not less than hash */
+static size_t lower_bound(const vault_t * p_vault, uint64_t hash)
+{
+    size_t low = 0;
+    size_t high = p_vault->num_entries;
+
+    while (low < high) {
+        size_t mid = low + ((high - low) / 2);
+        if (entry_hash(p_vault, mid) < hash) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/* Returns the index of the entry of the key or num_entries if the key is not in the vault */
+static size_t find_entry(const vault_t * p_vault, const char * p_key, size_t key_len)
+{
+    uint64_t hash = hash_key(p_key, key_len);
+
+    for (size_t i = lower_bound(p_vault, hash); (i < p_vault->num_entries) && (hash == entry_hash(p_vault, i));
+         ++i) {
+        const char * p_record_key = NULL;
+        size_t record_key_len = 0;
+        const char * p_sealed = NULL;
+        size_t sealed_len = 0;
+        if (parse_record(p_vault, entry_offset(p_vault, i), &p_record_key, &record_key_len, &p_sealed, &sealed_len) &&
+            (key_len == record_key_len) && (0 == memcmp(p_key, p_record_key, key_len))) {
+            return i;
+        }
+    }
+    return p_vault->num_entries;
+}
+
+static void free_entries(vault_t * p_vault)
+{
+    if (0 != p_vault->entries_size) {
+        free(p_vault->p_entries);
+    }
+    if (NULL != p_vault->p_index_map) {
+        munmap(p_vault->p_index_map, p_vault->index_map_len);
+    }
+    p_vault->p_entries = NULL;
+    p_vault->num_entries = 0;
+    p_vault->entries_size = 0;
+    p_vault->p_index_map = NULL;
+    p_vault->index_map_len = 0;
+}
+
+/* Makes room for one more entry, copies mapped entries to an allocated buffer */
+static int reserve_entry(vault_t * p_vault)
+{
+    if (p_vault->num_entries < p_vault->entries_size) {
+        return EXIT_SUCCESS;
+    }
+    size_t new_size = (64 > 2 * p_vault->num_entries) ? 64 : (2 * p_vault->num_entries);
+    char * p_new = malloc(new_size * VAULT_INDEX_ENTRY_LEN);
+    if (NULL == p_new) {
+        fprintf(stderr, "Memory allocation error\n");
+        return EXIT_FAILURE;
+    }
+    size_t num_entries = p_vault->num_entries;
+    if (0 != num_entries) {
+        memcpy(p_new, p_vault->p_entries, num_entries * VAULT_INDEX_ENTRY_LEN);
+    }
+    free_entries(p_vault);
+    p_vault->p_entries = p_new;
+    p_vault->num_entries = num_entries;
+    p_vault->entries_size = new_size;
+    return EXIT_SUCCESS;
+}
+
+/* Points the key to the record at offset, the record before replaced by it becomes dead */
+static int upsert_entry(vault_t * p_vault, const char * p_key, size_t key_len, uint64_t offset, uint64_t record_len)
+{
+    size_t index = find_entry(p_vault, p_key, key_len);
+
+    if (EXIT_SUCCESS != reserve_entry(p_vault)) {
+        return EXIT_FAILURE;
+    }
+    if (index < p_vault->num_entries) {
+        const char * p_old_key = NULL;
+        size_t old_key_len = 0;
+        const char * p_old_sealed = NULL;
+        size_t old_sealed_len = 0;
+        parse_record(p_vault, entry_offset(p_vault, index), &p_old_key, &old_key_len, &p_old_sealed, &old_sealed_len);
+        p_vault->live_bytes -= VAULT_RECORD_HEADER_LEN + old_key_len + old_sealed_len;
+    } else {
+        index = lower_bound(p_vault, hash_key(p_key, key_len));
+        memmove(
+            &p_vault->p_entries[(index + 1) * VAULT_INDEX_ENTRY_LEN],
+            &p_vault->p_entries[index * VAULT_INDEX_ENTRY_LEN],
+            (p_vault->num_entries - index) * VAULT_INDEX_ENTRY_LEN);
+        put_u64(&p_vault->p_entries[index * VAULT_INDEX_ENTRY_LEN], hash_key(p_key, key_len));
+        ++p_vault->num_entries;
+    }
+    put_u64(&p_vault->p_entries[(index * VAULT_INDEX_ENTRY_LEN) + 8], offset);
+    p_vault->live_bytes += record_len;
+    return EXIT_SUCCESS;
+}
+
+/* Builds the index by scanning all records, a torn record at the end is ignored */
+static int rebuild_index(vault_t * p_vault)
+{
+    uint64_t offset = VAULT_HEADER_LEN;
+
+    free_entries(p_vault);
+    p_vault->live_bytes = 0;
+    p_vault->data_end = p_vault->map_len;
+    for (;;) {
+        const char * p_key = NULL;
+        size_t key_len = 0;
+        const char * p_sealed = NULL;
+        size_t sealed_len = 0;
+        if (!parse_record(p_vault, offset, &p_key, &key_len, &p_sealed, &sealed_len)) {
+            break;
+        }
+        uint64_t record_len = VAULT_RECORD_HEADER_LEN + key_len + sealed_len;
+        if (EXIT_SUCCESS != upsert_entry(p_vault, p_key, key_len, offset, record_len)) {
+            return EXIT_FAILURE;
+        }
+        offset += record_len;
+    }
+    p_vault->data_end = offset;
+    return EXIT_SUCCESS;
+}
+
+/* Maps the index file, fails if it does not belong to the current state of the vault */
+static int load_index(vault_t * p_vault)
+{
+    int ret = EXIT_FAILURE;
+    char * p_index_path = path_with_suffix(p_vault->p_path, VAULT_INDEX_SUFFIX);
+    int fd = -1;
+    struct stat st = {0};
+
+    if ((NULL == p_index_path) || (0 > (fd = open(p_index_path, O_RDONLY | O_CLOEXEC))) || (0 != fstat(fd, &st)) ||
+        ((off_t)VAULT_INDEX_HEADER_LEN > st.st_size)) {
+        goto cleanup;
+    }
+    p_vault->index_map_len = (size_t)st.st_size;
+    p_vault->p_index_map = mmap(NULL, p_vault->index_map_len, PROT_READ, MAP_SHARED, fd, 0);
+    if (MAP_FAILED == p_vault->p_index_map) {
+        p_vault->p_index_map = NULL;
+        goto cleanup;
+    }
+    const char * p_header = p_vault->p_index_map;
+    uint64_t num_entries = get_u64(&p_header[32]);
+    if ((0 != memcmp(p_header, VAULT_INDEX_MAGIC, VAULT_MAGIC_LEN)) || (p_vault->id != get_u64(&p_header[8])) ||
+        (p_vault->map_len != get_u64(&p_header[16])) ||
+        (num_entries != (p_vault->index_map_len - VAULT_INDEX_HEADER_LEN) / VAULT_INDEX_ENTRY_LEN) ||
+        (p_vault->index_map_len != VAULT_INDEX_HEADER_LEN + (num_entries * VAULT_INDEX_ENTRY_LEN))) {
+        goto cleanup;
+    }
+    p_vault->p_entries = &p_vault->p_index_map[VAULT_INDEX_HEADER_LEN];
+    p_vault->num_entries = (size_t)num_entries;
+    p_vault->entries_size = 0;
+    p_vault->live_bytes = get_u64(&p_header[24]);
+    p_vault->data_end = p_vault->map_len;
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    if (EXIT_SUCCESS != ret) {
+        free_entries(p_vault);
+    }
+    if (0 <= fd) {
+        close(fd);
+    }
+    free(p_index_path);
+    return ret;
+}
+
+/* Writes the index to a temporary file and renames it into place */
+static int write_index(vault_t * p_vault)
+{
+    int ret = EXIT_FAILURE;
+    char * p_index_path = path_with_suffix(p_vault->p_path, VAULT_INDEX_SUFFIX);
+    char * p_tmp_path = path_with_suffix(p_vault->p_path, VAULT_INDEX_SUFFIX VAULT_TMP_SUFFIX);
+    char header[VAULT_INDEX_HEADER_LEN] = {0};
+    int fd = -1;
+
+    if ((NULL == p_index_path) || (NULL == p_tmp_path)) {
+        fprintf(stderr, "Memory allocation error\n");
+        goto cleanup;
+    }
+    memcpy(header, VAULT_INDEX_MAGIC, VAULT_MAGIC_LEN);
+    put_u64(&header[8], p_vault->id);
+    put_u64(&header[16], p_vault->data_end);
+    put_u64(&header[24], p_vault->live_bytes);
+    put_u64(&header[32], p_vault->num_entries);
+    fd = open(p_tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if ((0 > fd) || !write_full_fd(fd, header, sizeof(header)) ||
+        !write_full_fd(fd, p_vault->p_entries, p_vault->num_entries * VAULT_INDEX_ENTRY_LEN) || (0 != fsync(fd)) ||
+        (0 != close(fd))) {
+        fprintf(stderr, "Cannot write file %s\n", p_tmp_path);
+        if (0 <= fd) {
+            close(fd);
+        }
+        remove(p_tmp_path);
+        goto cleanup;
+    }
+    if (0 != rename(p_tmp_path, p_index_path)) {
+        fprintf(stderr, "Cannot rename %s to %s\n", p_tmp_path, p_index_path);
+        remove(p_tmp_path);
+        goto cleanup;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    free(p_index_path);
+    free(p_tmp_path);
+    return ret;
+}
+
+/* Maps the vault file in its current size and checks the header */
+static int map_vault(vault_t * p_vault)
+{
+    struct stat st = {0};
+
+    if (NULL != p_vault->p_map) {
+        munmap(p_vault->p_map, p_vault->map_len);
+        p_vault->p_map = NULL;
+    }
+    if ((0 != fstat(p_vault->fd, &st)) || ((off_t)VAULT_HEADER_LEN > st.st_size)) {
+        fprintf(stderr, "%s is not a vault\n", p_vault->p_path);
+        return EXIT_FAILURE;
+    }
+    p_vault->map_len = (size_t)st.st_size;
+    p_vault->p_map = mmap(NULL, p_vault->map_len, PROT_READ, MAP_SHARED, p_vault->fd, 0);
+    if (MAP_FAILED == p_vault->p_map) {
+        p_vault->p_map = NULL;
+        fprintf(stderr, "Cannot map file %s\n", p_vault->p_path);
+        return EXIT_FAILURE;
+    }
+    if ((0 != memcmp(p_vault->p_map, VAULT_MAGIC, VAULT_MAGIC_LEN)) ||
+        (VAULT_VERSION != get_u32(&p_vault->p_map[8]))) {
+        fprintf(stderr, "%s is not a vault\n", p_vault->p_path);
+        return EXIT_FAILURE;
+    }
+    p_vault->id = get_u64(&p_vault->p_map[16]);
+    return EXIT_SUCCESS;
+}
+
+/* Writes the header of an empty vault with a new random id */
+static bool write_header(int fd, uint64_t * p_id)
+{
+    char header[VAULT_HEADER_LEN] = {0};
+    unsigned char id[8] = {0};
+
+    if (1 != RAND_bytes(id, sizeof(id))) {
+        return false;
+    }
+    *p_id = get_u64((const char *)id);
+    memcpy(header, VAULT_MAGIC, VAULT_MAGIC_LEN);
+    put_u32(&header[8], VAULT_VERSION);
+    put_u64(&header[16], *p_id);
+    return write_full_fd(fd, header, sizeof(header));
+}
+
+int vault_open(vault_t * p_vault, const char * p_path, bool b_write)
+{
+    struct stat st = {0};
+
+    memset(p_vault, 0, sizeof(vault_t));
+    p_vault->fd = -1;
+    if (NULL == (p_vault->p_path = strdup(p_path))) {
+        fprintf(stderr, "Memory allocation error\n");
+        return EXIT_FAILURE;
+    }
+    for (;;) {
+        struct stat path_st = {0};
+        p_vault->fd = open(p_path, b_write ? (O_RDWR | O_CREAT | O_CLOEXEC) : (O_RDONLY | O_CLOEXEC), 0600);
+        if (0 > p_vault->fd) {
+            fprintf(stderr, "Cannot open file %s\n", p_path);
+            goto err;
+        }
+        /* Writers exclude each other and the readers */
+        while (0 != flock(p_vault->fd, b_write ? LOCK_EX : LOCK_SH)) {
+            if (EINTR != errno) {
+                fprintf(stderr, "Cannot lock file %s\n", p_path);
+                goto err;
+            }
+        }
+        if (0 != fstat(p_vault->fd, &st)) {
+            fprintf(stderr, "Cannot open file %s\n", p_path);
+            goto err;
+        }
+        /* A compaction may have replaced the file while this invocation waited for the lock */
+        if ((0 == stat(p_path, &path_st)) && (path_st.st_dev == st.st_dev) && (path_st.st_ino == st.st_ino)) {
+            break;
+        }
+        close(p_vault->fd);
+        p_vault->fd = -1;
+    }
+    if (b_write && (0 == st.st_size)) {
+        uint64_t id = 0;
+        if (!write_header(p_vault->fd, &id) || (0 != fsync(p_vault->fd))) {
+            fprintf(stderr, "Cannot write file %s\n", p_path);
+            goto err;
+        }
+    }
+    if (EXIT_SUCCESS != map_vault(p_vault)) {
+        goto err;
+    }
+    madvise(p_vault->p_map, p_vault->map_len, MADV_RANDOM);
+    if ((EXIT_SUCCESS != load_index(p_vault)) && (EXIT_SUCCESS != rebuild_index(p_vault))) {
+        goto err;
+    }
+    return EXIT_SUCCESS;
+
+err:
+    vault_close(p_vault);
+    return EXIT_FAILURE;
+}
+
+/* Rewrites the vault with the live records only and a new vault id */
+static int compact(vault_t * p_vault)
+{
+    int ret = EXIT_FAILURE;
+    char * p_tmp_path = path_with_suffix(p_vault->p_path, VAULT_TMP_SUFFIX);
+    int fd = -1;
+    uint64_t id = 0;
+    uint64_t offset = VAULT_HEADER_LEN;
+
+    if (NULL == p_tmp_path) {
+        fprintf(stderr, "Memory allocation error\n");
+        goto cleanup;
+    }
+    /* The records appended by this invocation are not mapped yet */
+    if ((EXIT_SUCCESS != map_vault(p_vault)) || (EXIT_SUCCESS != reserve_entry(p_vault))) {
+        goto cleanup;
+    }
+    fd = open(p_tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    /* The new vault is locked before it is renamed into place, until its index is written */
+    if ((0 > fd) || (0 != flock(fd, LOCK_EX)) || !write_header(fd, &id)) {
+        fprintf(stderr, "Cannot write file %s\n", p_tmp_path);
+        goto cleanup;
+    }
+    for (size_t i = 0; i < p_vault->num_entries; ++i) {
+        const char * p_key = NULL;
+        size_t key_len = 0;
+        const char * p_sealed = NULL;
+        size_t sealed_len = 0;
+        if (!parse_record(p_vault, entry_offset(p_vault, i), &p_key, &key_len, &p_sealed, &sealed_len)) {
+            fprintf(stderr, "%s is corrupted\n", p_vault->p_path);
+            goto cleanup;
+        }
+        size_t record_len = VAULT_RECORD_HEADER_LEN + key_len + sealed_len;
+        if (!write_full_fd(fd, &p_vault->p_map[entry_offset(p_vault, i)], record_len)) {
+            fprintf(stderr, "Cannot write file %s\n", p_tmp_path);
+            goto cleanup;
+        }
+        /* The entries keep their order, only the offsets change */
+        put_u64(&p_vault->p_entries[(i * VAULT_INDEX_ENTRY_LEN) + 8], offset);
+        offset += record_len;
+    }
+    if (0 != fsync(fd)) {
+        fprintf(stderr, "Cannot write file %s\n", p_tmp_path);
+        goto cleanup;
+    }
+    /*
+     * A reader opening the new vault before its index is written finds an
+     * index with another vault id and rebuilds it.
+     */
+    if (0 != rename(p_tmp_path, p_vault->p_path)) {
+        fprintf(stderr, "Cannot rename %s to %s\n", p_tmp_path, p_vault->p_path);
+        goto cleanup;
+    }
+    /* The lock of the new vault is kept, invocations waiting for the old one open the new one */
+    close(p_vault->fd);
+    p_vault->fd = fd;
+    fd = -1;
+    p_vault->id = id;
+    p_vault->data_end = offset;
+    p_vault->live_bytes = offset - VAULT_HEADER_LEN;
+    ret = write_index(p_vault);
+
+cleanup:
+    if (0 <= fd) {
+        close(fd);
+    }
+    if ((EXIT_SUCCESS != ret) && (NULL != p_tmp_path)) {
+        remove(p_tmp_path);
+    }
+    free(p_tmp_path);
+    return ret;
+}
+
+int vault_store(
+    vault_t * p_vault,
+    gta_context_handle_t h_ctx,
+    const char * p_key,
+    gtaio_istream_t * p_istream,
+    gta_errinfo_t * p_errinfo)
+{
+    int ret = EXIT_FAILURE;
+    size_t key_len = strlen(p_key);
+    ostream_to_dynbuf_t plain = {0};
+    ostream_to_dynbuf_t sealed = {0};
+    istream_from_buf_t istream_plain = {0};
+    char header[VAULT_RECORD_HEADER_LEN] = {0};
+
+    ostream_to_dynbuf_init(&plain);
+    ostream_to_dynbuf_init(&sealed);
+    if (!vault_check_key(p_key)) {
+        fprintf(stderr, "Invalid key: %s\n", p_key);
+        goto cleanup;
+    }
+
+    /* The sealed value is bound to its key */
+    put_u32(header, (uint32_t)key_len);
+    if ((4 != ostream_to_dynbuf_write(&plain, header, 4, p_errinfo)) ||
+        (key_len != ostream_to_dynbuf_write(&plain, p_key, key_len, p_errinfo))) {
+        goto cleanup;
+    }
+    if (EXIT_SUCCESS != read_istream_to_dynbuf(p_istream, &plain)) {
+        goto cleanup;
+    }
+    istream_from_buf_init(&istream_plain, plain.buf, plain.buf_pos);
+    if (!TRACE_BOOL(
+            gta_seal_data,
+            (h_ctx, (gtaio_istream_t *)&istream_plain, (gtaio_ostream_t *)&sealed, p_errinfo),
+            p_errinfo)) {
+        fprintf(stderr, "gta_seal_data failed with ERROR_CODE %ld\n", *p_errinfo);
+        goto cleanup;
+    }
+
+    /* Append the record, a torn record of a crashed writer is overwritten */
+    uint64_t offset = p_vault->data_end;
+    uint64_t record_len = VAULT_RECORD_HEADER_LEN + key_len + sealed.buf_pos;
+    put_u32(header, (uint32_t)key_len);
+    put_u32(&header[4], 0);
+    put_u64(&header[8], sealed.buf_pos);
+    if ((0 != ftruncate(p_vault->fd, (off_t)offset)) ||
+        ((off_t)offset != lseek(p_vault->fd, (off_t)offset, SEEK_SET)) ||
+        !write_full_fd(p_vault->fd, header, sizeof(header)) || !write_full_fd(p_vault->fd, p_key, key_len) ||
+        !write_full_fd(p_vault->fd, sealed.buf, sealed.buf_pos) || (0 != fdatasync(p_vault->fd))) {
+        fprintf(stderr, "Cannot write file %s\n", p_vault->p_path);
+        goto cleanup;
+    }
+    if (EXIT_SUCCESS != upsert_entry(p_vault, p_key, key_len, offset, record_len)) {
+        goto cleanup;
+    }
+    p_vault->data_end = offset + record_len;
+    if (EXIT_SUCCESS != write_index(p_vault)) {
+        goto cleanup;
+    }
+
+    uint64_t dead_bytes = p_vault->data_end - VAULT_HEADER_LEN - p_vault->live_bytes;
+    if ((VAULT_COMPACT_MIN_SIZE <= p_vault->data_end) && (dead_bytes > p_vault->live_bytes) &&
+        (EXIT_SUCCESS != compact(p_vault))) {
+        goto cleanup;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    ostream_to_dynbuf_free(&plain);
+    ostream_to_dynbuf_free(&sealed);
+    return ret;
+}
+
+int vault_fetch(
+    vault_t * p_vault,
+    gta_context_handle_t h_ctx,
+    const char * p_key,
+    gtaio_ostream_t * p_ostream,
+    gta_errinfo_t * p_errinfo)
+{
+    int ret = EXIT_FAILURE;
+    size_t key_len = strlen(p_key);
+    size_t index = find_entry(p_vault, p_key, key_len);
+    const char * p_record_key = NULL;
+    size_t record_key_len = 0;
+    const char * p_sealed = NULL;
+    size_t sealed_len = 0;
+    istream_from_buf_t istream_sealed = {0};
+    ostream_to_dynbuf_t plain = {0};
+
+    ostream_to_dynbuf_init(&plain);
+    if (index == p_vault->num_entries) {
+        fprintf(stderr, "Key not found: %s\n", p_key);
+        goto cleanup;
+    }
+    parse_record(p_vault, entry_offset(p_vault, index), &p_record_key, &record_key_len, &p_sealed, &sealed_len);
+    istream_from_buf_init(&istream_sealed, p_sealed, sealed_len);
+    if (!TRACE_BOOL(
+            gta_unseal_data,
+            (h_ctx, (gtaio_istream_t *)&istream_sealed, (gtaio_ostream_t *)&plain, p_errinfo),
+            p_errinfo)) {
+        fprintf(stderr, "gta_unseal_data failed with ERROR_CODE %ld\n", *p_errinfo);
+        goto cleanup;
+    }
+    if ((4 + key_len > plain.buf_pos) || (key_len != get_u32(plain.buf)) ||
+        (0 != memcmp(&plain.buf[4], p_key, key_len))) {
+        fprintf(stderr, "Value of key %s belongs to another key\n", p_key);
+        goto cleanup;
+    }
+    if (!write_full(p_ostream, &plain.buf[4 + key_len], plain.buf_pos - 4 - key_len, p_errinfo) ||
+        !p_ostream->finish(p_ostream, 0, p_errinfo)) {
+        goto cleanup;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    ostream_to_dynbuf_free(&plain);
+    return ret;
+}
+
+int vault_fetch_many(
+    vault_t * p_vault,
+    gta_context_handle_t h_ctx,
+    const char * p_keys,
+    const char * p_out_dir,
+    journal_t * p_journal,
+    gta_errinfo_t * p_errinfo)
+{
+    int ret = EXIT_FAILURE;
+    char * p_copy = strdup(p_keys);
+    char * p_save = NULL;
+    char * p_path = NULL;
+
+    if (NULL == p_copy) {
+        fprintf(stderr, "Memory allocation error\n");
+        return EXIT_FAILURE;
+    }
+    for (char * p_key = strtok_r(p_copy, ",", &p_save); NULL != p_key; p_key = strtok_r(NULL, ",", &p_save)) {
+        myio_ofilestream_t ostream = {0};
+        size_t len = strlen(p_out_dir) + 1 + strlen(p_key) + 1;
+
+        if (!vault_check_key(p_key)) {
+            fprintf(stderr, "Invalid key: %s\n", p_key);
+            goto cleanup;
+        }
+        if (NULL == (p_path = malloc(len))) {
+            fprintf(stderr, "Memory allocation error\n");
+            goto cleanup;
+        }
+        snprintf(p_path, len, "%s/%s", p_out_dir, p_key);
+        if ((NULL != p_journal) && journal_is_complete(p_journal, p_key, p_path)) {
+            free(p_path);
+            p_path = NULL;
+            continue;
+        }
+        if (!myio_open_ofilestream(&ostream, p_path, p_errinfo)) {
+            fprintf(stderr, "Cannot open file %s\n", p_path);
+            goto cleanup;
+        }
+        int result = vault_fetch(p_vault, h_ctx, p_key, (gtaio_ostream_t *)&ostream, p_errinfo);
+        myio_close_ofilestream(&ostream, p_errinfo);
+        if (EXIT_SUCCESS != result) {
+            remove(p_path);
+            goto cleanup;
+        }
+        if ((NULL != p_journal) && (EXIT_SUCCESS != journal_record(p_journal, p_key, p_path))) {
+            goto cleanup;
+        }
+        free(p_path);
+        p_path = NULL;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    free(p_path);
+    free(p_copy);
+    return ret;
+}
+
+typedef struct vault_key {
+    const char * p_key;
+    size_t key_len;
+} vault_key_t;
+
+static int compare_keys(const void * p_a, const void * p_b)
+{
+    const vault_key_t * p_key_a = p_a;
+    const vault_key_t * p_key_b = p_b;
+    size_t len = (p_key_a->key_len < p_key_b->key_len) ? p_key_a->key_len : p_key_b->key_len;
+    int result = memcmp(p_key_a->p_key, p_key_b->p_key, len);
+
+    if (0 != result) {
+        return result;
+    }
+    return (p_key_a->key_len < p_key_b->key_len) ? -1 : (p_key_a->key_len > p_key_b->key_len);
+}
+
+int vault_list_keys(vault_t * p_vault, gtaio_ostream_t * p_ostream, gta_errinfo_t * p_errinfo)
+{
+    int ret = EXIT_FAILURE;
+    vault_key_t * p_keys = calloc((0 == p_vault->num_entries) ? 1 : p_vault->num_entries, sizeof(vault_key_t));
+    size_t num_keys = 0;
+
+    if (NULL == p_keys) {
+        fprintf(stderr, "Memory allocation error\n");
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < p_vault->num_entries; ++i) {
+        const char * p_sealed = NULL;
+        size_t sealed_len = 0;
+        if (parse_record(
+                p_vault,
+                entry_offset(p_vault, i),
+                &p_keys[num_keys].p_key,
+                &p_keys[num_keys].key_len,
+                &p_sealed,
+                &sealed_len)) {
+            ++num_keys;
+        }
+    }
+    qsort(p_keys, num_keys, sizeof(vault_key_t), compare_keys);
+    for (size_t i = 0; i < num_keys; ++i) {
+        if (!write_full(p_ostream, p_keys[i].p_key, p_keys[i].key_len, p_errinfo) ||
+            !write_full(p_ostream, "\n", 1, p_errinfo)) {
+            goto cleanup;
+        }
+    }
+    if (!p_ostream->finish(p_ostream, 0, p_errinfo)) {
+        goto cleanup;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    free(p_keys);
+    return ret;
+}
+
+void vault_close(vault_t * p_vault)
+{
+    free_entries(p_vault);
+    if (NULL != p_vault->p_map) {
+        munmap(p_vault->p_map, p_vault->map_len);
+    }
+    if (0 <= p_vault->fd) {
+        /* Releases the lock */
+        close(p_vault->fd);
+    }
+    free(p_vault->p_path);
+    memset(p_vault, 0, sizeof(vault_t));
+    p_vault->fd = -1;
+}
+
+/*** end of file ***/
@@ -0,0 +1,113 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef GTA_CLI_VAULT_H
+#define GTA_CLI_VAULT_H
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+extern "C" {
+/* *INDENT-ON* */
+#endif
+
+/*---------------------------------------------------------------------*/
+
+#include "journal.h"
+#include <gta_api/gta_api.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Sealed key-value vault. All integers are stored little-endian.
+ *
+ *   vault file:  magic "GTAVAULT", u32 version, u32 reserved, u64 vault id,
+ *                records appended in the order they are written
+ *   record:      u32 key length, u32 reserved, u64 length of the sealed
+ *                value, key, sealed value
+ *   index file:  magic "GTAVIDX1", u64 vault id, u64 size of the vault file
+ *                covered by the index, u64 bytes of live records, u64 number
+ *                of entries, entries (u64 FNV-1a hash of the key, u64 offset
+ *                of the record) sorted by hash
+ *
+ * The sealed value starts with the length of the key (u32) and the key, so
+ * a value cannot be moved to another key without detection. A put appends a
+ * record, rewrites the index "<vault>.idx" atomically and compacts the vault
+ * when more than half of it consists of replaced records. A reader maps the
+ * vault and the index and unseals exactly one record per key. If the index
+ * does not match the vault (other vault id or size, e.g. after a crash), it
+ * is rebuilt by scanning the records.
+ */
+
+#define VAULT_INDEX_SUFFIX ".idx"
+#define VAULT_MAX_KEY_LEN 255
+
+typedef struct vault {
+    int fd;                    /* vault file, locked with flock() */
+    char * p_path;             /* path of the vault file */
+    char * p_map;              /* mapped vault file */
+    size_t map_len;            /* size of the mapped vault file */
+    uint64_t id;               /* vault id from the header */
+    uint64_t data_end;         /* end of the last complete record */
+    uint64_t live_bytes;       /* bytes of the records referenced by the index */
+    char * p_entries;          /* encoded index entries, mapped or allocated */
+    size_t num_entries;        /* number of index entries */
+    size_t entries_size;       /* allocated entries, 0 if p_entries is mapped */
+    char * p_index_map;        /* mapped index file */
+    size_t index_map_len;      /* size of the mapped index file */
+} vault_t;
+
+/* Returns true if the key can be stored: 1 to 255 printable characters except '/' and ',', not "." or ".." */
+bool vault_check_key(const char * p_key);
+
+/* Opens and locks the vault, b_write creates the vault if it does not exist and locks it exclusively */
+int vault_open(vault_t * p_vault, const char * p_path, bool b_write);
+
+/* Seals the data of istream and stores it under the key, replacing a previous value */
+int vault_store(
+    vault_t * p_vault,
+    gta_context_handle_t h_ctx,
+    const char * p_key,
+    gtaio_istream_t * p_istream,
+    gta_errinfo_t * p_errinfo);
+
+/* Unseals the value of the key to ostream */
+int vault_fetch(
+    vault_t * p_vault,
+    gta_context_handle_t h_ctx,
+    const char * p_key,
+    gtaio_ostream_t * p_ostream,
+    gta_errinfo_t * p_errinfo);
+
+/*
+ * Unseals the values of a comma separated list of keys to files with the name of the key in p_out_dir. With a journal
+ * (NULL: none) keys fetched by a previous run are skipped and every fetched key is recorded.
+ */
+int vault_fetch_many(
+    vault_t * p_vault,
+    gta_context_handle_t h_ctx,
+    const char * p_keys,
+    const char * p_out_dir,
+    journal_t * p_journal,
+    gta_errinfo_t * p_errinfo);
+
+/* Writes the sorted keys of the vault, one per line, to ostream */
+int vault_list_keys(vault_t * p_vault, gtaio_ostream_t * p_ostream, gta_errinfo_t * p_errinfo);
+
+/* Unmaps and unlocks the vault */
+void vault_close(vault_t * p_vault);
+
+/*---------------------------------------------------------------------*/
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+}
+/* *INDENT-ON* */
+#endif
+
+#endif /* GTA_CLI_VAULT_H */
+
+/*** end of file ***/
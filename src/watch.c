@@ -0,0 +1,464 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define _GNU_SOURCE
+
+#include "watch.h"
+
+#include "metrics.h"
+#include "streams.h"
+#include "trace.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/signalfd.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define WATCH_EVENT_BUF_SIZE 65536
+#define WATCH_TMP_SUFFIX ".watch.tmp"
+/* Delay before files which could not be processed are retried, doubled on each failed retry */
+#define WATCH_RETRY_MS 1000
+#define WATCH_MAX_RETRY_MS 60000
+
+typedef struct watch_batch {
+    char * p_names[WATCH_MAX_BATCH];
+    bool b_done[WATCH_MAX_BATCH]; /* the output of the file has been written */
+    size_t num_names;
+    uint64_t first_ns; /* arrival of the first file of the batch */
+} watch_batch_t;
+
+typedef struct watch {
+    watch_session_t * p_session;
+    gta_context_handle_t h_ctx; /* context of the batch being processed */
+    enum watch_op op;
+    const char * p_spool_dir;
+    const char * p_done_dir;
+    int done_fd; /* done directory, synced once per batch */
+    unsigned int flush_ms;
+    uint64_t rescan_ns;     /* time of the next scan of the spool directory, 0 if none is due */
+    unsigned int retry_ms;  /* delay of the next retry of failed files */
+    gta_errinfo_t * p_errinfo;
+} watch_t;
+
+int watch_parse_op(const char * p_spec, enum watch_op * p_op)
+{
+    if (0 == strcmp(p_spec, "seal")) {
+        *p_op = WATCH_OP_SEAL;
+    } else if (0 == strcmp(p_spec, "authenticate")) {
+        *p_op = WATCH_OP_AUTHENTICATE;
+    } else {
+        fprintf(stderr, "Invalid input: '%s' is not a valid operation (seal, authenticate)\n", p_spec);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+static char * join_path(const char * p_dir, const char * p_prefix, const char * p_name, const char * p_suffix)
+{
+    size_t len = strlen(p_dir) + 1 + strlen(p_prefix) + strlen(p_name) + strlen(p_suffix) + 1;
+    char * p_path = malloc(len);
+
+    if (NULL != p_path) {
+        snprintf(p_path, len, "%s/%s%s%s", p_dir, p_prefix, p_name, p_suffix);
+    }
+    return p_path;
+}
+
+/* Adds a file to the batch, a file reported several times is processed once */
+static void add_name(watch_batch_t * p_batch, const char * p_name)
+{
+    if (('.' == p_name[0]) || ('\0' == p_name[0])) {
+        return;
+    }
+    for (size_t i = 0; i < p_batch->num_names; ++i) {
+        if (0 == strcmp(p_batch->p_names[i], p_name)) {
+            return;
+        }
+    }
+    char * p_copy = strdup(p_name);
+    if (NULL == p_copy) {
+        fprintf(stderr, "Memory allocation error, %s is processed on the next start\n", p_name);
+        return;
+    }
+    if (0 == p_batch->num_names) {
+        p_batch->first_ns = metrics_now_ns();
+    }
+    p_batch->b_done[p_batch->num_names] = false;
+    p_batch->p_names[p_batch->num_names++] = p_copy;
+}
+
+/* Seals or authenticates a file into a temporary file of the done directory and renames it into place */
+static bool process_file(watch_t * p_watch, const char * p_name)
+{
+    bool b_ret = false;
+    myio_ifilestream_t istream = {0};
+    myio_ofilestream_t ostream = {0};
+    const char * p_suffix = (WATCH_OP_AUTHENTICATE == p_watch->op) ? WATCH_SEAL_SUFFIX : "";
+    char * p_in = join_path(p_watch->p_spool_dir, "", p_name, "");
+    char * p_out = join_path(p_watch->p_done_dir, "", p_name, p_suffix);
+    char * p_tmp = join_path(p_watch->p_done_dir, ".", p_name, WATCH_TMP_SUFFIX);
+    struct stat st = {0};
+
+    if ((NULL == p_in) || (NULL == p_out) || (NULL == p_tmp)) {
+        fprintf(stderr, "Memory allocation error\n");
+        goto cleanup;
+    }
+    /* Files removed in the meantime and directories are not processed */
+    if ((0 != lstat(p_in, &st)) || !S_ISREG(st.st_mode)) {
+        goto cleanup;
+    }
+    if (!myio_open_ifilestream(&istream, p_in, p_watch->p_errinfo)) {
+        fprintf(stderr, "Cannot open file %s\n", p_in);
+        goto cleanup;
+    }
+    if (!myio_open_ofilestream(&ostream, p_tmp, p_watch->p_errinfo)) {
+        fprintf(stderr, "Cannot open file %s\n", p_tmp);
+        goto cleanup;
+    }
+    bool b_ok = false;
+    if (WATCH_OP_SEAL == p_watch->op) {
+        b_ok = TRACE_BOOL(
+            gta_seal_data,
+            (p_watch->h_ctx, (gtaio_istream_t *)&istream, (gtaio_ostream_t *)&ostream, p_watch->p_errinfo),
+            p_watch->p_errinfo);
+    } else {
+        b_ok = TRACE_BOOL(
+            gta_authenticate_data_detached,
+            (p_watch->h_ctx, (gtaio_istream_t *)&istream, (gtaio_ostream_t *)&ostream, p_watch->p_errinfo),
+            p_watch->p_errinfo);
+    }
+    if (!b_ok) {
+        fprintf(stderr, "Processing of %s failed with ERROR_CODE %ld\n", p_in, *p_watch->p_errinfo);
+    }
+    b_ok = b_ok && (0 == fflush(ostream.file)) && (0 == fdatasync(fileno(ostream.file)));
+    myio_close_ofilestream(&ostream, p_watch->p_errinfo);
+    if (!b_ok || (0 != rename(p_tmp, p_out))) {
+        fprintf(stderr, "Cannot write %s\n", p_out);
+        remove(p_tmp);
+        goto cleanup;
+    }
+    b_ret = true;
+
+cleanup:
+    if (NULL != istream.file) {
+        myio_close_ifilestream(&istream, p_watch->p_errinfo);
+    }
+    free(p_in);
+    free(p_out);
+    free(p_tmp);
+    return b_ret;
+}
+
+/* Schedules a scan of the spool directory after delay_ms, an earlier scan is kept */
+static void schedule_rescan(watch_t * p_watch, unsigned int delay_ms)
+{
+    uint64_t rescan_ns = metrics_now_ns() + ((uint64_t)delay_ms * 1000000);
+    if ((0 == p_watch->rescan_ns) || (rescan_ns < p_watch->rescan_ns)) {
+        p_watch->rescan_ns = rescan_ns;
+    }
+}
+
+/* Returns true if the file is in the spool directory */
+static bool is_spooled(watch_t * p_watch, const char * p_name)
+{
+    struct stat st = {0};
+    char * p_in = join_path(p_watch->p_spool_dir, "", p_name, "");
+    bool b_spooled = (NULL != p_in) && (0 == lstat(p_in, &st)) && S_ISREG(st.st_mode);
+    free(p_in);
+    return b_spooled;
+}
+
+/*
+ * Processes a batch, the spool files are released after the outputs of the
+ * batch have been synced. Returns the number of files which failed.
+ */
+static size_t process_batch(watch_t * p_watch, watch_batch_t * p_batch)
+{
+    size_t num_failed = 0;
+
+    /* The session is only open while the files are processed, a failed session fails all files */
+    p_watch->h_ctx = p_watch->p_session->begin(p_watch->p_session, p_watch->p_errinfo);
+    for (size_t i = 0; i < p_batch->num_names; ++i) {
+        p_batch->b_done[i] = (GTA_HANDLE_INVALID != p_watch->h_ctx) && process_file(p_watch, p_batch->p_names[i]);
+    }
+    if (GTA_HANDLE_INVALID != p_watch->h_ctx) {
+        p_watch->p_session->end(p_watch->p_session);
+        p_watch->h_ctx = GTA_HANDLE_INVALID;
+    }
+    if (0 != fsync(p_watch->done_fd)) {
+        fprintf(stderr, "Cannot sync directory %s: %s\n", p_watch->p_done_dir, strerror(errno));
+        for (size_t i = 0; i < p_batch->num_names; ++i) {
+            p_batch->b_done[i] = false;
+        }
+    } else {
+        for (size_t i = 0; i < p_batch->num_names; ++i) {
+            char * p_in = join_path(p_watch->p_spool_dir, "", p_batch->p_names[i], "");
+            char * p_data = join_path(p_watch->p_done_dir, "", p_batch->p_names[i], "");
+            if (!p_batch->b_done[i] || (NULL == p_in) || (NULL == p_data)) {
+                /* left in the spool directory */
+            } else if (WATCH_OP_SEAL == p_watch->op) {
+                unlink(p_in);
+            } else if (0 != rename(p_in, p_data)) {
+                fprintf(stderr, "Cannot move %s to %s: %s\n", p_in, p_data, strerror(errno));
+            }
+            free(p_in);
+            free(p_data);
+        }
+        if ((WATCH_OP_AUTHENTICATE == p_watch->op) && (0 != fsync(p_watch->done_fd))) {
+            fprintf(stderr, "Cannot sync directory %s: %s\n", p_watch->p_done_dir, strerror(errno));
+        }
+    }
+    /* Files removed in the meantime are not counted as failed */
+    for (size_t i = 0; i < p_batch->num_names; ++i) {
+        if (!p_batch->b_done[i] && is_spooled(p_watch, p_batch->p_names[i])) {
+            ++num_failed;
+        }
+        free(p_batch->p_names[i]);
+    }
+    p_batch->num_names = 0;
+
+    /* Failed files stay in the spool directory and are retried with the next scan */
+    if (0 != num_failed) {
+        fprintf(stderr, "%zu files could not be processed, retry in %u ms\n", num_failed, p_watch->retry_ms);
+        schedule_rescan(p_watch, p_watch->retry_ms);
+        p_watch->retry_ms = (WATCH_MAX_RETRY_MS / 2 < p_watch->retry_ms) ? WATCH_MAX_RETRY_MS : (2 * p_watch->retry_ms);
+    }
+    return num_failed;
+}
+
+enum watch_state {
+    WATCH_STATE_SETTLED, /* the file can be processed */
+    WATCH_STATE_OPEN,    /* the file is open for writing, IN_CLOSE_WRITE reports it */
+    WATCH_STATE_RECENT,  /* the file has been modified within the flush interval */
+};
+
+/*
+ * Checks if a file found by a scan is complete. A read lease cannot be taken
+ * on a file which is open for writing. Where leases are not available (file
+ * of another user, file system without leases), a file is taken as complete
+ * if it has not been modified within the flush interval.
+ */
+static enum watch_state file_state(watch_t * p_watch, const char * p_name)
+{
+    struct stat st = {0};
+    struct timespec now = {0};
+    char * p_in = join_path(p_watch->p_spool_dir, "", p_name, "");
+    int fd = (NULL != p_in) ? open(p_in, O_RDONLY | O_NONBLOCK | O_NOFOLLOW | O_CLOEXEC) : -1;
+    bool b_stat = (NULL != p_in) && (0 == lstat(p_in, &st));
+
+    free(p_in);
+    if (0 <= fd) {
+        int lease = fcntl(fd, F_SETLEASE, F_RDLCK);
+        int lease_errno = errno;
+        if (0 == lease) {
+            fcntl(fd, F_SETLEASE, F_UNLCK);
+        }
+        close(fd);
+        if (0 == lease) {
+            return WATCH_STATE_SETTLED;
+        }
+        if (EAGAIN == lease_errno) {
+            return WATCH_STATE_OPEN;
+        }
+    }
+    if (!b_stat || (0 != clock_gettime(CLOCK_REALTIME, &now))) {
+        /* process_file() skips files which are gone */
+        return WATCH_STATE_SETTLED;
+    }
+    int64_t age_ms = (((int64_t)now.tv_sec - (int64_t)st.st_mtim.tv_sec) * 1000) +
+                     (((int64_t)now.tv_nsec - (int64_t)st.st_mtim.tv_nsec) / 1000000);
+    /* A modification time in the future (e.g. a copied timestamp) does not indicate a writer */
+    return ((0 > age_ms) || ((int64_t)p_watch->flush_ms <= age_ms)) ? WATCH_STATE_SETTLED : WATCH_STATE_RECENT;
+}
+
+/*
+ * Processes the files present in the spool directory. Files which are open
+ * for writing are left for IN_CLOSE_WRITE, files modified recently for a
+ * later scan.
+ */
+static int scan_spool(watch_t * p_watch, watch_batch_t * p_batch)
+{
+    DIR * p_d = opendir(p_watch->p_spool_dir);
+    struct dirent * p_dirent = NULL;
+    size_t num_failed = 0;
+
+    p_watch->rescan_ns = 0;
+    if (NULL == p_d) {
+        fprintf(stderr, "Cannot open directory %s\n", p_watch->p_spool_dir);
+        return EXIT_FAILURE;
+    }
+    while (NULL != (p_dirent = readdir(p_d))) {
+        if ('.' == p_dirent->d_name[0]) {
+            continue;
+        }
+        enum watch_state state = file_state(p_watch, p_dirent->d_name);
+        if (WATCH_STATE_RECENT == state) {
+            schedule_rescan(p_watch, p_watch->flush_ms);
+        }
+        if (WATCH_STATE_SETTLED != state) {
+            continue;
+        }
+        add_name(p_batch, p_dirent->d_name);
+        if (WATCH_MAX_BATCH == p_batch->num_names) {
+            num_failed += process_batch(p_watch, p_batch);
+        }
+    }
+    closedir(p_d);
+    if (0 != p_batch->num_names) {
+        num_failed += process_batch(p_watch, p_batch);
+    }
+    /* All files left from earlier failures have been processed */
+    if (0 == num_failed) {
+        p_watch->retry_ms = WATCH_RETRY_MS;
+    }
+    return EXIT_SUCCESS;
+}
+
+int watch_run(
+    watch_session_t * p_session,
+    enum watch_op op,
+    const char * p_spool_dir,
+    const char * p_done_dir,
+    unsigned int flush_ms,
+    gta_errinfo_t * p_errinfo)
+{
+    int ret = EXIT_FAILURE;
+    watch_t watch = {
+        .p_session = p_session,
+        .h_ctx = GTA_HANDLE_INVALID,
+        .op = op,
+        .p_spool_dir = p_spool_dir,
+        .p_done_dir = p_done_dir,
+        .done_fd = -1,
+        .flush_ms = flush_ms,
+        .retry_ms = WATCH_RETRY_MS,
+        .p_errinfo = p_errinfo};
+    watch_batch_t * p_batch = calloc(1, sizeof(watch_batch_t));
+    char * p_events = malloc(WATCH_EVENT_BUF_SIZE);
+    int inotify_fd = -1;
+    int signal_fd = -1;
+    sigset_t signals;
+    sigset_t old_signals;
+    bool b_masked = false;
+    bool b_stop = false;
+
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    if ((NULL == p_batch) || (NULL == p_events)) {
+        fprintf(stderr, "Memory allocation error\n");
+        goto cleanup;
+    }
+    watch.done_fd = open(p_done_dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (0 > watch.done_fd) {
+        fprintf(stderr, "Cannot open directory %s\n", p_done_dir);
+        goto cleanup;
+    }
+    /* SIGINT and SIGTERM are received through the signal fd, a batch is always completed */
+    b_masked = (0 == sigprocmask(SIG_BLOCK, &signals, &old_signals));
+    if (!b_masked || (0 > (signal_fd = signalfd(-1, &signals, SFD_CLOEXEC)))) {
+        fprintf(stderr, "Cannot set up signal handling: %s\n", strerror(errno));
+        goto cleanup;
+    }
+    /* The watch is added before the scan, so no file is missed */
+    inotify_fd = inotify_init1(IN_CLOEXEC);
+    if ((0 > inotify_fd) || (0 > inotify_add_watch(inotify_fd, p_spool_dir, IN_CLOSE_WRITE | IN_MOVED_TO))) {
+        fprintf(stderr, "Cannot watch directory %s: %s\n", p_spool_dir, strerror(errno));
+        goto cleanup;
+    }
+    if (EXIT_SUCCESS != scan_spool(&watch, p_batch)) {
+        goto cleanup;
+    }
+
+    while (!b_stop) {
+        struct pollfd pfds[2] = {{.fd = signal_fd, .events = POLLIN}, {.fd = inotify_fd, .events = POLLIN}};
+        bool b_rescan = false;
+        int timeout_ms = -1; /* idle: wait without a timeout */
+
+        if (0 != p_batch->num_names) {
+            uint64_t elapsed_ms = (metrics_now_ns() - p_batch->first_ns) / 1000000;
+            timeout_ms = (elapsed_ms >= flush_ms) ? 0 : (int)(flush_ms - elapsed_ms);
+        }
+        if (0 != watch.rescan_ns) {
+            uint64_t now_ns = metrics_now_ns();
+            /* rounded up, so the scan is not started before it is due */
+            int rescan_ms = (now_ns >= watch.rescan_ns) ? 0 : (int)((watch.rescan_ns - now_ns + 999999) / 1000000);
+            timeout_ms = ((0 > timeout_ms) || (rescan_ms < timeout_ms)) ? rescan_ms : timeout_ms;
+        }
+        if ((0 > poll(pfds, 2, timeout_ms)) && (EINTR != errno)) {
+            fprintf(stderr, "Cannot wait for events: %s\n", strerror(errno));
+            goto cleanup;
+        }
+        if (0 != (pfds[0].revents & POLLIN)) {
+            /* the signal is consumed, otherwise it would be delivered when the mask is restored */
+            struct signalfd_siginfo siginfo;
+            if (sizeof(siginfo) == read(signal_fd, &siginfo, sizeof(siginfo))) {
+                b_stop = true;
+            }
+        }
+        if (0 != (pfds[1].revents & POLLIN)) {
+            ssize_t len = read(inotify_fd, p_events, WATCH_EVENT_BUF_SIZE);
+            for (ssize_t pos = 0; pos < len;) {
+                const struct inotify_event * p_event = (const struct inotify_event *)&p_events[pos];
+                if (0 != (p_event->mask & IN_Q_OVERFLOW)) {
+                    b_rescan = true;
+                } else if (0 != p_event->len) {
+                    add_name(p_batch, p_event->name);
+                    if (WATCH_MAX_BATCH == p_batch->num_names) {
+                        process_batch(&watch, p_batch);
+                    }
+                }
+                pos += (ssize_t)(sizeof(struct inotify_event) + p_event->len);
+            }
+        }
+
+        bool b_due =
+            (0 != p_batch->num_names) && (((metrics_now_ns() - p_batch->first_ns) / 1000000) >= flush_ms);
+        if ((0 != p_batch->num_names) && (b_due || b_stop)) {
+            process_batch(&watch, p_batch);
+        }
+        /* Events have been lost or files are to be retried, the spool directory is scanned again */
+        b_rescan = b_rescan || ((0 != watch.rescan_ns) && (metrics_now_ns() >= watch.rescan_ns));
+        if (b_rescan && !b_stop && (EXIT_SUCCESS != scan_spool(&watch, p_batch))) {
+            goto cleanup;
+        }
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    if (0 <= inotify_fd) {
+        close(inotify_fd);
+    }
+    if (0 <= signal_fd) {
+        close(signal_fd);
+    }
+    if (b_masked) {
+        sigprocmask(SIG_SETMASK, &old_signals, NULL);
+    }
+    if (0 <= watch.done_fd) {
+        close(watch.done_fd);
+    }
+    if (NULL != p_batch) {
+        for (size_t i = 0; i < p_batch->num_names; ++i) {
+            free(p_batch->p_names[i]);
+        }
+    }
+    free(p_batch);
+    free(p_events);
+    return ret;
+}
+
+/*** end of file ***/
@@ -0,0 +1,91 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2026 Siemens
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef GTA_CLI_WATCH_H
+#define GTA_CLI_WATCH_H
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+extern "C" {
+/* *INDENT-ON* */
+#endif
+
+/*---------------------------------------------------------------------*/
+
+#include <gta_api/gta_api.h>
+
+/*
+ * Watch mode: files dropped into a spool directory are sealed or
+ * authenticated until SIGINT or SIGTERM is received. The context is
+ * provided by a session for each batch, so the state of the provider is only
+ * in use while a batch is processed.
+ * New files are reported by inotify (IN_CLOSE_WRITE, IN_MOVED_TO); files
+ * found at the start are processed first, except if they are still open for
+ * writing (or, where this cannot be checked, modified within the flush
+ * interval). Events arriving within the flush
+ * interval after the first one are collected into one batch. Hidden files
+ * (".NAME") are ignored, so a writer can create ".NAME" and rename it.
+ *
+ * For each file of a batch the output is written to a temporary file in the
+ * done directory, synced and renamed into place:
+ *
+ *   seal:          DONE/NAME is the sealed data, SPOOL/NAME is removed
+ *   authenticate:  DONE/NAME.seal is the detached seal, SPOOL/NAME is moved
+ *                  to DONE/NAME
+ *
+ * The spool file is only removed or moved after the done directory has
+ * been synced, so a crash leads to the file being processed again. A file
+ * which cannot be processed stays in the spool directory and is retried
+ * after WATCH_RETRY_MS, with the delay doubled up to WATCH_MAX_RETRY_MS.
+ */
+
+#define WATCH_DEFAULT_FLUSH_MS 20
+/* A burst is cut into batches of at most this number of files */
+#define WATCH_MAX_BATCH 1024
+#define WATCH_SEAL_SUFFIX ".seal"
+
+enum watch_op {
+    WATCH_OP_SEAL,         /* gta_seal_data */
+    WATCH_OP_AUTHENTICATE, /* gta_authenticate_data_detached */
+};
+
+/* Session providing the context for a batch, implemented by the caller */
+typedef struct watch_session watch_session_t;
+
+/* Opens the context for a batch, returns GTA_HANDLE_INVALID on error */
+typedef gta_context_handle_t (*watch_session_begin_t)(watch_session_t * p_session, gta_errinfo_t * p_errinfo);
+
+/* Releases the context after a batch */
+typedef void (*watch_session_end_t)(watch_session_t * p_session);
+
+struct watch_session {
+    watch_session_begin_t begin;
+    watch_session_end_t end;
+};
+
+/* Parses "seal" or "authenticate" */
+int watch_parse_op(const char * p_spec, enum watch_op * p_op);
+
+/* Processes the files of p_spool_dir until SIGINT or SIGTERM is received */
+int watch_run(
+    watch_session_t * p_session,
+    enum watch_op op,
+    const char * p_spool_dir,
+    const char * p_done_dir,
+    unsigned int flush_ms,
+    gta_errinfo_t * p_errinfo);
+
+/*---------------------------------------------------------------------*/
+
+#if defined(__cplusplus)
+/* *INDENT-OFF* */
+}
+/* *INDENT-ON* */
+#endif
+
+#endif /* GTA_CLI_WATCH_H */
+
+/*** end of file ***/
@@ -0,0 +1,69 @@
+#!/bin/bash
+
+# SPDX-FileCopyrightText: Copyright 2026 Siemens
+#
+# SPDX-License-Identifier: Apache-2.0
+
+# End-to-end throughput and size of seal_data/unseal_data with and without --compress
+
+: "${GTA_CLI_BINARY:="gta-cli"}"
+: "${TEST_DIRECTORY:="./test_tmp"}"
+: "${BENCH_SIZE_MB:=16}"
+
+BENCH_DIRECTORY="${TEST_DIRECTORY}/bench_compress"
+GTA_STATE_DIRECTORY="${BENCH_DIRECTORY}/gta_state"
+export GTA_STATE_DIRECTORY
+
+rm -rf "$BENCH_DIRECTORY"
+mkdir -p "$GTA_STATE_DIRECTORY"
+
+prof=ch.iec.30168.basic.local_data_protection
+h_pol_initial="$("$GTA_CLI_BINARY" access_policy_simple --descr_type=INITIAL)" || exit 1
+"$GTA_CLI_BINARY" identifier_assign --id_type=ch.iec.30168.identifier.mac_addr --id_val=DE-AD-BE-EF-FE-ED || exit 1
+"$GTA_CLI_BINARY" personality_create --id_val=DE-AD-BE-EF-FE-ED --pers=bench_pers --app_name=gta-cli --prof=$prof --acc_pol_use="$h_pol_initial" --acc_pol_admin="$h_pol_initial" || exit 1
+
+# Test data: log-like text (compressible) and random data (incompressible)
+size=$((BENCH_SIZE_MB * 1024 * 1024))
+i=0
+while [ "$(stat -c %s "${BENCH_DIRECTORY}/log.txt" 2>/dev/null || echo 0)" -lt $size ]; do
+  seq -f "2026-01-01T00:00:00Z gta-cli[4711]: seal_data pers=bench_pers request=%g status=ok" $i $((i + 99999)) >> "${BENCH_DIRECTORY}/log.txt"
+  i=$((i + 100000))
+done
+truncate -s $size "${BENCH_DIRECTORY}/log.txt"
+head -c $size /dev/urandom > "${BENCH_DIRECTORY}/random.bin"
+
+now_ns () {
+  date +%s%N
+}
+
+printf "%-12s %-10s %12s %12s %8s %12s %12s\n" "DATA" "COMPRESS" "PLAIN" "SEALED" "RATIO" "SEAL_MIB/S" "UNSEAL_MIB/S"
+fails=0
+for data in log.txt random.bin; do
+  for compress in none zlib zstd; do
+    option=()
+    unseal_option=()
+    if [ "$compress" != "none" ]; then
+      option=(--compress="$compress")
+      unseal_option=(--decompress)
+      if ! "$GTA_CLI_BINARY" seal_data --pers=bench_pers --prof=$prof --data=/dev/null "${option[@]}" > /dev/null 2>&1; then
+        printf "%-12s %-10s not supported by this build\n" "$data" "$compress"
+        continue
+      fi
+    fi
+
+    t0=$(now_ns)
+    "$GTA_CLI_BINARY" seal_data --pers=bench_pers --prof=$prof --data="${BENCH_DIRECTORY}/${data}" "${option[@]}" > "${BENCH_DIRECTORY}/sealed" || fails=$((fails + 1))
+    t1=$(now_ns)
+    "$GTA_CLI_BINARY" unseal_data --pers=bench_pers --prof=$prof --data="${BENCH_DIRECTORY}/sealed" "${unseal_option[@]}" > "${BENCH_DIRECTORY}/unsealed" || fails=$((fails + 1))
+    t2=$(now_ns)
+    cmp -s "${BENCH_DIRECTORY}/${data}" "${BENCH_DIRECTORY}/unsealed" || fails=$((fails + 1))
+
+    sealed=$(stat -c %s "${BENCH_DIRECTORY}/sealed")
+    awk -v d="$data" -v c="$compress" -v p=$size -v s="$sealed" -v ts=$((t1 - t0)) -v tu=$((t2 - t1)) 'BEGIN {
+      printf "%-12s %-10s %12d %12d %8.3f %12.1f %12.1f\n", d, c, p, s, s / p, p / 1048576 / (ts / 1e9), p / 1048576 / (tu / 1e9)
+    }'
+  done
+done
+
+rm -rf "$BENCH_DIRECTORY"
+exit $((fails > 0))
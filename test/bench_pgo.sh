@@ -0,0 +1,63 @@
+#!/bin/bash
+
+# SPDX-FileCopyrightText: Copyright 2026 Siemens
+#
+# SPDX-License-Identifier: Apache-2.0
+
+# Compares the release build with LTO (GTA_CLI_LTO_BINARY) with the same build optimized with a profile
+# (GTA_CLI_PGO_BINARY), both built by pgo_build.sh: wall time of pgo_workload.sh and of invocations dominated by
+# startup and dispatch
+
+: "${GTA_CLI_LTO_BINARY:=""}"
+: "${GTA_CLI_PGO_BINARY:=""}"
+: "${TEST_DIRECTORY:="./test_tmp"}"
+: "${BENCH_ROUNDS:=5}"
+: "${BENCH_STARTUP_CALLS:=200}"
+
+if [ ! -x "$GTA_CLI_LTO_BINARY" ] || [ ! -x "$GTA_CLI_PGO_BINARY" ]; then
+  echo "No PGO build, run 'ninja -C <build_dir> pgo' first"
+  # skipped
+  exit 77
+fi
+
+BENCH_DIRECTORY="${TEST_DIRECTORY}/bench_pgo"
+rm -rf "$BENCH_DIRECTORY"
+mkdir -p "$BENCH_DIRECTORY"
+
+now_ns () {
+  date +%s%N
+}
+
+# Minimum of the rounds, the builds run alternately to spread the noise of the machine evenly
+workload_ns=(0 0)
+startup_ns=(0 0)
+binaries=("$GTA_CLI_LTO_BINARY" "$GTA_CLI_PGO_BINARY")
+for ((round = 0; round < BENCH_ROUNDS; ++round)); do
+  for k in 0 1; do
+    t0=$(now_ns)
+    GTA_CLI_BINARY="${binaries[$k]}" TEST_DIRECTORY="$BENCH_DIRECTORY" PGO_ITERATIONS=5 "$(dirname "$0")/pgo_workload.sh" || exit 1
+    t1=$(now_ns)
+    for ((i = 0; i < BENCH_STARTUP_CALLS; ++i)); do
+      GTA_STATE_DIRECTORY="$BENCH_DIRECTORY" "${binaries[$k]}" access_policy_simple > /dev/null || exit 1
+    done
+    t2=$(now_ns)
+    if [ "${workload_ns[$k]}" -eq 0 ] || [ $((t1 - t0)) -lt "${workload_ns[$k]}" ]; then
+      workload_ns[$k]=$((t1 - t0))
+    fi
+    if [ "${startup_ns[$k]}" -eq 0 ] || [ $((t2 - t1)) -lt "${startup_ns[$k]}" ]; then
+      startup_ns[$k]=$((t2 - t1))
+    fi
+  done
+done
+
+printf "%-10s %14s %18s\n" "BUILD" "WORKLOAD_MS" "STARTUP_US/CALL"
+for k in 0 1; do
+  awk -v b="$([ $k -eq 0 ] && echo lto || echo pgo)" -v w="${workload_ns[$k]}" -v s="${startup_ns[$k]}" -v n="$BENCH_STARTUP_CALLS" 'BEGIN {
+    printf "%-10s %14.1f %18.1f\n", b, w / 1e6, s / 1e3 / n
+  }'
+done
+awk -v w0="${workload_ns[0]}" -v w1="${workload_ns[1]}" -v s0="${startup_ns[0]}" -v s1="${startup_ns[1]}" 'BEGIN {
+  printf "%-10s %13.1f%% %17.1f%%\n", "speedup", (w0 / w1 - 1) * 100, (s0 / s1 - 1) * 100
+}'
+
+rm -rf "$BENCH_DIRECTORY"
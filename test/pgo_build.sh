@@ -0,0 +1,39 @@
+#!/bin/bash
+
+# SPDX-FileCopyrightText: Copyright 2026 Siemens
+#
+# SPDX-License-Identifier: Apache-2.0
+
+# Profile-guided optimization build: builds gta-cli instrumented with LTO, runs pgo_workload.sh through the
+# instrumented binary and rebuilds it with LTO and the recorded profile. The same release build with LTO but without
+# profile is built in BUILD_DIR-lto as reference for bench_pgo.sh.
+# usage: pgo_build.sh SOURCE_DIR BUILD_DIR [MESON_OPTIONS...]
+
+set -e
+
+if [ $# -lt 2 ]; then
+  echo "usage: $0 SOURCE_DIR BUILD_DIR [MESON_OPTIONS...]" >&2
+  exit 1
+fi
+source_dir="$(realpath "$1")"
+build_dir="$(realpath -m "$2")"
+shift 2
+
+rm -rf "${build_dir}-lto"
+meson setup "${build_dir}-lto" "$source_dir" --buildtype=release -Db_lto=true "$@"
+ninja -C "${build_dir}-lto"
+
+rm -rf "$build_dir"
+meson setup "$build_dir" "$source_dir" --buildtype=release -Db_lto=true -Db_pgo=generate "$@"
+ninja -C "$build_dir"
+
+# GCC writes the .gcda files next to the objects, clang writes raw profiles which have to be merged
+export LLVM_PROFILE_FILE="${build_dir}/pgo-%p.profraw"
+GTA_CLI_BINARY="${build_dir}/gta-cli" TEST_DIRECTORY="${build_dir}/pgo_training" "${source_dir}/test/pgo_workload.sh"
+if compgen -G "${build_dir}/pgo-*.profraw" > /dev/null; then
+  llvm-profdata merge --output="${build_dir}/default.profdata" "${build_dir}"/pgo-*.profraw
+fi
+
+meson configure "$build_dir" -Db_pgo=use
+ninja -C "$build_dir"
+echo "PGO build: ${build_dir}/gta-cli, reference build: ${build_dir}-lto/gta-cli"
@@ -0,0 +1,61 @@
+#!/bin/bash
+
+# SPDX-FileCopyrightText: Copyright 2026 Siemens
+#
+# SPDX-License-Identifier: Apache-2.0
+
+# Representative workload for profile-guided optimization and for bench_pgo.sh: the typical calls of a device
+# (seal/unseal of small secrets and larger data, sign, integrity protection and verification, enroll, enumerate)
+# against a scratch state directory
+
+: "${GTA_CLI_BINARY:="gta-cli"}"
+: "${TEST_DIRECTORY:="./test_tmp"}"
+: "${PGO_ITERATIONS:=20}"
+
+WORKLOAD_DIRECTORY="${TEST_DIRECTORY}/pgo_workload"
+GTA_STATE_DIRECTORY="${WORKLOAD_DIRECTORY}/gta_state"
+export GTA_STATE_DIRECTORY
+
+rm -rf "$WORKLOAD_DIRECTORY"
+mkdir -p "$GTA_STATE_DIRECTORY"
+
+run () {
+  if ! "$GTA_CLI_BINARY" "$@" > "${WORKLOAD_DIRECTORY}/out" 2> "${WORKLOAD_DIRECTORY}/err"; then
+    echo "gta-cli $* failed:" >&2
+    cat "${WORKLOAD_DIRECTORY}/err" >&2
+    exit 1
+  fi
+}
+
+# Setup
+prof_seal=ch.iec.30168.basic.local_data_protection
+prof_icv=ch.iec.30168.basic.local_data_integrity_only
+h_pol_initial="$("$GTA_CLI_BINARY" access_policy_simple --descr_type=INITIAL)" || exit 1
+run identifier_assign --id_type=ch.iec.30168.identifier.mac_addr --id_val=DE-AD-BE-EF-FE-ED
+run personality_create --id_val=DE-AD-BE-EF-FE-ED --pers=pgo_seal --app_name=gta-cli --prof=$prof_seal --acc_pol_use="$h_pol_initial" --acc_pol_admin="$h_pol_initial"
+run personality_create --id_val=DE-AD-BE-EF-FE-ED --pers=pgo_icv --app_name=gta-cli --prof=$prof_icv --acc_pol_use="$h_pol_initial" --acc_pol_admin="$h_pol_initial"
+run personality_create --id_val=DE-AD-BE-EF-FE-ED --pers=pgo_ec --app_name=gta-cli --prof=com.github.generic-trust-anchor-api.basic.ec
+
+# Inputs: a small secret and 1 MiB of log-like data
+echo "db-password-0123456789abcdef" > "${WORKLOAD_DIRECTORY}/secret.txt"
+seq -f "2026-01-01T00:00:00Z gta-cli[4711]: request=%g status=ok" 1 20000 | head -c 1048576 > "${WORKLOAD_DIRECTORY}/data.txt"
+
+for ((i = 0; i < PGO_ITERATIONS; ++i)); do
+  for data in secret.txt data.txt; do
+    run seal_data --pers=pgo_seal --prof=$prof_seal --data="${WORKLOAD_DIRECTORY}/${data}"
+    mv "${WORKLOAD_DIRECTORY}/out" "${WORKLOAD_DIRECTORY}/sealed"
+    run unseal_data --pers=pgo_seal --prof=$prof_seal --data="${WORKLOAD_DIRECTORY}/sealed"
+
+    run authenticate_data_detached --pers=pgo_ec --prof=com.github.generic-trust-anchor-api.basic.signature --data="${WORKLOAD_DIRECTORY}/${data}"
+    run authenticate_data_detached --pers=pgo_icv --prof=$prof_icv --data="${WORKLOAD_DIRECTORY}/${data}"
+    mv "${WORKLOAD_DIRECTORY}/out" "${WORKLOAD_DIRECTORY}/seal.icv"
+    run verify_data_detached --pers=pgo_icv --prof=$prof_icv --data="${WORKLOAD_DIRECTORY}/${data}" --seal="${WORKLOAD_DIRECTORY}/seal.icv"
+  done
+
+  run personality_enroll --pers=pgo_ec --prof=com.github.generic-trust-anchor-api.basic.tls
+  run identifier_enumerate
+  run personality_enumerate --id_val=DE-AD-BE-EF-FE-ED
+  run personality_attributes_enumerate --pers=pgo_ec
+done
+
+rm -rf "$WORKLOAD_DIRECTORY"
@@ -136,6 +136,242 @@ echo "gta-cli unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.l
 assert_success "seal_data"
 echo ""
 
+echo "gta-cli unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=${TEST_DIRECTORY}/out2.enc --cache=keyring:60"
+"$GTA_CLI_BINARY" unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/out2.enc" --cache=keyring:60 | cmp - ./test_data/plain.txt
+assert_success "unseal_data"
+# second call is served from the keyring cache
+"$GTA_CLI_BINARY" unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/out2.enc" --cache=keyring:60 | cmp - ./test_data/plain.txt
+assert_success "unseal_data"
+echo "gta-cli unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=./test_data --cache=keyring:60"
+timeout 10 "$GTA_CLI_BINARY" unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=./test_data --cache=keyring:60
+test 1 -eq $?
+assert_success "unseal_data"
+echo "gta-cli unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=${TEST_DIRECTORY}/out2.enc --cache=keyring:0"
+"$GTA_CLI_BINARY" unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/out2.enc" --cache=keyring:0
+assert_error "unseal_data"
+echo "gta-cli cache_flush"
+"$GTA_CLI_BINARY" cache_flush
+assert_success "cache_flush"
+echo ""
+
+echo "gta-cli seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --metrics_file=${TEST_DIRECTORY}/metrics.ndjson > ${TEST_DIRECTORY}/out3.enc"
+rm -f "${TEST_DIRECTORY}/metrics.ndjson"
+"$GTA_CLI_BINARY" seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --metrics_file="${TEST_DIRECTORY}/metrics.ndjson" > "${TEST_DIRECTORY}/out3.enc"
+assert_success "seal_data"
+echo "GTA_CLI_METRICS_FILE=${TEST_DIRECTORY}/metrics.ndjson gta-cli unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=${TEST_DIRECTORY}/out3.enc"
+GTA_CLI_METRICS_FILE="${TEST_DIRECTORY}/metrics.ndjson" "$GTA_CLI_BINARY" unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/out3.enc"
+assert_success "unseal_data"
+test "$(wc -l < "${TEST_DIRECTORY}/metrics.ndjson")" -eq 2
+assert_success "metrics_file"
+echo "gta-cli metrics_summary --metrics_file=${TEST_DIRECTORY}/metrics.ndjson"
+"$GTA_CLI_BINARY" metrics_summary --metrics_file="${TEST_DIRECTORY}/metrics.ndjson" | grep "unseal_data"
+assert_success "metrics_summary"
+echo "gta-cli seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --trace=${TEST_DIRECTORY}/trace.json > ${TEST_DIRECTORY}/out3.enc"
+"$GTA_CLI_BINARY" seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --trace="${TEST_DIRECTORY}/trace.json" > "${TEST_DIRECTORY}/out3.enc"
+assert_success "seal_data"
+grep "\"gta_seal_data\"" "${TEST_DIRECTORY}/trace.json"
+assert_success "trace"
+echo "gta-cli seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --io_stats > ${TEST_DIRECTORY}/out3.enc"
+"$GTA_CLI_BINARY" seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --io_stats 2>&1 > "${TEST_DIRECTORY}/out3.enc" | grep "I/O statistics of input"
+assert_success "io_stats"
+echo "gta-cli seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --perf_counters > ${TEST_DIRECTORY}/out3.enc"
+"$GTA_CLI_BINARY" seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --perf_counters > "${TEST_DIRECTORY}/out3.enc"
+assert_success "perf_counters"
+echo "gta-cli seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --out_digest=sha256:${TEST_DIRECTORY}/out3.sha256 > ${TEST_DIRECTORY}/out3.enc"
+"$GTA_CLI_BINARY" seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --out_digest=sha256:"${TEST_DIRECTORY}/out3.sha256" > "${TEST_DIRECTORY}/out3.enc"
+assert_success "seal_data"
+test "$(cat "${TEST_DIRECTORY}/out3.sha256")" = "$(sha256sum < "${TEST_DIRECTORY}/out3.enc" | cut -d ' ' -f 1)"
+assert_success "out_digest"
+echo "gta-cli seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --record=${TEST_DIRECTORY}/record.ndjson > ${TEST_DIRECTORY}/out3.enc"
+rm -f "${TEST_DIRECTORY}/record.ndjson"
+"$GTA_CLI_BINARY" seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --record="${TEST_DIRECTORY}/record.ndjson" > "${TEST_DIRECTORY}/out3.enc"
+assert_success "seal_data"
+echo "gta-cli unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=${TEST_DIRECTORY}/out3.enc --record=${TEST_DIRECTORY}/record.ndjson"
+"$GTA_CLI_BINARY" unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/out3.enc" --record="${TEST_DIRECTORY}/record.ndjson"
+assert_success "unseal_data"
+test "$(grep -c "\"in0_hash\":\"sha256:$(sha256sum < "${TEST_DIRECTORY}/out3.enc" | cut -d ' ' -f 1)\"" "${TEST_DIRECTORY}/record.ndjson")" -eq 1
+assert_success "record"
+# The replay starts with an empty state, so the workload is recorded with a new state including the personality
+rm -rf "${TEST_DIRECTORY}/record_state" "${TEST_DIRECTORY}/replay.ndjson" "${TEST_DIRECTORY}/record.vault"*
+mkdir -p "${TEST_DIRECTORY}/record_state"
+echo "gta-cli identifier_assign --id_type=ch.iec.30168.identifier.mac_addr --id_val=DE-AD-BE-EF-FE-ED --record=${TEST_DIRECTORY}/replay.ndjson"
+GTA_STATE_DIRECTORY="${TEST_DIRECTORY}/record_state" "$GTA_CLI_BINARY" identifier_assign --id_type=ch.iec.30168.identifier.mac_addr --id_val=DE-AD-BE-EF-FE-ED --record="${TEST_DIRECTORY}/replay.ndjson"
+echo "gta-cli personality_create --id_val=DE-AD-BE-EF-FE-ED --pers=test_pers_record --app_name=gta-cli --prof=ch.iec.30168.basic.local_data_protection --acc_pol_use=$h_pol_initial --acc_pol_admin=$h_pol_initial --record=${TEST_DIRECTORY}/replay.ndjson"
+GTA_STATE_DIRECTORY="${TEST_DIRECTORY}/record_state" "$GTA_CLI_BINARY" personality_create --id_val=DE-AD-BE-EF-FE-ED --pers=test_pers_record --app_name=gta-cli --prof=ch.iec.30168.basic.local_data_protection --acc_pol_use="$h_pol_initial" --acc_pol_admin="$h_pol_initial" --record="${TEST_DIRECTORY}/replay.ndjson"
+echo "gta-cli seal_data --pers=test_pers_record --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --record=${TEST_DIRECTORY}/replay.ndjson > ${TEST_DIRECTORY}/record.enc"
+GTA_STATE_DIRECTORY="${TEST_DIRECTORY}/record_state" "$GTA_CLI_BINARY" seal_data --pers=test_pers_record --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --record="${TEST_DIRECTORY}/replay.ndjson" > "${TEST_DIRECTORY}/record.enc"
+echo "gta-cli unseal_data --pers=test_pers_record --prof=ch.iec.30168.basic.local_data_protection --data=${TEST_DIRECTORY}/record.enc --record=${TEST_DIRECTORY}/replay.ndjson"
+GTA_STATE_DIRECTORY="${TEST_DIRECTORY}/record_state" "$GTA_CLI_BINARY" unseal_data --pers=test_pers_record --prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/record.enc" --record="${TEST_DIRECTORY}/replay.ndjson" > /dev/null
+echo "gta-cli vault_put --pers=test_pers_record --prof=ch.iec.30168.basic.local_data_protection --vault=${TEST_DIRECTORY}/record.vault --key=k --data=./test_data/plain.txt --record=${TEST_DIRECTORY}/replay.ndjson"
+GTA_STATE_DIRECTORY="${TEST_DIRECTORY}/record_state" "$GTA_CLI_BINARY" vault_put --pers=test_pers_record --prof=ch.iec.30168.basic.local_data_protection --vault="${TEST_DIRECTORY}/record.vault" --key=k --data=./test_data/plain.txt --record="${TEST_DIRECTORY}/replay.ndjson"
+echo "gta-cli vault_get --pers=test_pers_record --prof=ch.iec.30168.basic.local_data_protection --vault=${TEST_DIRECTORY}/record.vault --key=k --record=${TEST_DIRECTORY}/replay.ndjson"
+GTA_STATE_DIRECTORY="${TEST_DIRECTORY}/record_state" "$GTA_CLI_BINARY" vault_get --pers=test_pers_record --prof=ch.iec.30168.basic.local_data_protection --vault="${TEST_DIRECTORY}/record.vault" --key=k --record="${TEST_DIRECTORY}/replay.ndjson" > /dev/null
+cp "${TEST_DIRECTORY}/record.vault" "${TEST_DIRECTORY}/record.vault.orig"
+echo "gta-cli replay --record=${TEST_DIRECTORY}/replay.ndjson"
+"$GTA_CLI_BINARY" replay --record="${TEST_DIRECTORY}/replay.ndjson" > "${TEST_DIRECTORY}/replay.txt"
+grep "vault_get" "${TEST_DIRECTORY}/replay.txt" && awk 'NR > 1 && $2 ~ /^[0-9]+$/ && 0 != $3 { failed = 1 } END { exit failed }' "${TEST_DIRECTORY}/replay.txt"
+assert_success "replay"
+# The vault is written in the scratch directory, not at the recorded path
+cmp "${TEST_DIRECTORY}/record.vault" "${TEST_DIRECTORY}/record.vault.orig"
+assert_success "replay"
+echo "gta-cli seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --compress=invalid"
+"$GTA_CLI_BINARY" seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --compress=invalid
+assert_error "seal_data"
+for compress in zlib zstd; do
+  echo "gta-cli seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --compress=$compress > ${TEST_DIRECTORY}/out3.enc"
+  if "$GTA_CLI_BINARY" seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --compress=$compress > "${TEST_DIRECTORY}/out3.enc"; then
+    echo "gta-cli unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=${TEST_DIRECTORY}/out3.enc --decompress"
+    "$GTA_CLI_BINARY" unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/out3.enc" --decompress | cmp - ./test_data/plain.txt
+    assert_success "compress"
+  else
+    echo "$compress is not supported by this build"
+  fi
+done
+# Plaintext starting with the compression magic is not decompressed without --decompress
+printf '\x89GTAZ\r\n\x1a\x01plain' > "${TEST_DIRECTORY}/magic.txt"
+echo "gta-cli seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=${TEST_DIRECTORY}/magic.txt > ${TEST_DIRECTORY}/out3.enc"
+"$GTA_CLI_BINARY" seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/magic.txt" > "${TEST_DIRECTORY}/out3.enc"
+assert_success "seal_data"
+echo "gta-cli unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=${TEST_DIRECTORY}/out3.enc"
+"$GTA_CLI_BINARY" unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/out3.enc" | cmp - "${TEST_DIRECTORY}/magic.txt"
+assert_success "compress"
+# Data following the end of the compressed stream is rejected
+if "$GTA_CLI_BINARY" seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --compress=zlib > /dev/null; then
+  printf '\x89GTAZ\r\n\x1a\x01\x78\x9c\x2b\xc8\x49\xcc\xcc\x03\x00\x06\x48\x02\x15trailing' > "${TEST_DIRECTORY}/trailing.z"
+  "$GTA_CLI_BINARY" seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/trailing.z" > "${TEST_DIRECTORY}/out3.enc"
+  echo "gta-cli unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=${TEST_DIRECTORY}/out3.enc --decompress"
+  "$GTA_CLI_BINARY" unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/out3.enc" --decompress > /dev/null
+  assert_error "compress"
+fi
+seq 1 20000 > "${TEST_DIRECTORY}/chunked.txt"
+echo "gta-cli seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=${TEST_DIRECTORY}/chunked.txt --chunk_size=4K --threads=4 > ${TEST_DIRECTORY}/out3.enc"
+"$GTA_CLI_BINARY" seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/chunked.txt" --chunk_size=4K --threads=4 > "${TEST_DIRECTORY}/out3.enc"
+assert_success "seal_data"
+echo "gta-cli unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=${TEST_DIRECTORY}/out3.enc --threads=4"
+"$GTA_CLI_BINARY" unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/out3.enc" --threads=4 | cmp - "${TEST_DIRECTORY}/chunked.txt"
+assert_success "chunked"
+echo "gta-cli unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=${TEST_DIRECTORY}/out3.enc --range=10000:5000"
+"$GTA_CLI_BINARY" unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/out3.enc" --range=10000:5000 | cmp - <(tail -c +10001 "${TEST_DIRECTORY}/chunked.txt" | head -c 5000)
+assert_success "range"
+# Chunks of another container and a changed header flag are detected
+"$GTA_CLI_BINARY" seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/chunked.txt" --chunk_size=4K > "${TEST_DIRECTORY}/out4.enc"
+{ head -c 32 "${TEST_DIRECTORY}/out3.enc"; tail -c +33 "${TEST_DIRECTORY}/out4.enc"; } > "${TEST_DIRECTORY}/mixed.enc"
+echo "gta-cli unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=${TEST_DIRECTORY}/mixed.enc"
+"$GTA_CLI_BINARY" unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/mixed.enc" > /dev/null
+assert_error "chunked"
+echo "gta-cli unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=${TEST_DIRECTORY}/mixed.enc --range=0:100"
+"$GTA_CLI_BINARY" unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/mixed.enc" --range=0:100 > /dev/null
+assert_error "range"
+cp "${TEST_DIRECTORY}/out3.enc" "${TEST_DIRECTORY}/flipped.enc"
+printf '\x01' | dd of="${TEST_DIRECTORY}/flipped.enc" bs=1 seek=12 conv=notrunc 2> /dev/null
+echo "gta-cli unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=${TEST_DIRECTORY}/flipped.enc"
+"$GTA_CLI_BINARY" unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/flipped.enc" > /dev/null
+assert_error "chunked"
+echo "gta-cli seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --chunk_size=100"
+"$GTA_CLI_BINARY" seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --chunk_size=100
+assert_error "seal_data"
+echo ""
+
+echo "< ./test_data/plain.txt gta-cli seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --log_mode --flush_ms=50 >> ${TEST_DIRECTORY}/sealed.log"
+< ./test_data/plain.txt "$GTA_CLI_BINARY" seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --log_mode --flush_ms=50 >> "${TEST_DIRECTORY}/sealed.log"
+assert_success "seal_data"
+echo "< ./test_data/plain.txt gta-cli seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --log_mode --flush_bytes=4K >> ${TEST_DIRECTORY}/sealed.log"
+< ./test_data/plain.txt "$GTA_CLI_BINARY" seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --log_mode --flush_bytes=4K >> "${TEST_DIRECTORY}/sealed.log"
+assert_success "seal_data"
+echo "gta-cli unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --log_mode --data=${TEST_DIRECTORY}/sealed.log"
+"$GTA_CLI_BINARY" unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --log_mode --data="${TEST_DIRECTORY}/sealed.log" | cmp - <(cat ./test_data/plain.txt ./test_data/plain.txt)
+assert_success "log_mode"
+cat "${TEST_DIRECTORY}/sealed.log" "${TEST_DIRECTORY}/sealed.log" > "${TEST_DIRECTORY}/replayed.log"
+echo "gta-cli unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --log_mode --data=${TEST_DIRECTORY}/replayed.log"
+"$GTA_CLI_BINARY" unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --log_mode --data="${TEST_DIRECTORY}/replayed.log" > /dev/null
+assert_error "log_mode"
+cat "${TEST_DIRECTORY}/sealed.log" > "${TEST_DIRECTORY}/torn.log"
+head -c 20 "${TEST_DIRECTORY}/sealed.log" >> "${TEST_DIRECTORY}/torn.log"
+echo "< ./test_data/plain.txt gta-cli seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --log_mode >> ${TEST_DIRECTORY}/torn.log"
+< ./test_data/plain.txt "$GTA_CLI_BINARY" seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --log_mode >> "${TEST_DIRECTORY}/torn.log"
+assert_success "log_mode"
+echo "gta-cli unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --log_mode --data=${TEST_DIRECTORY}/torn.log"
+"$GTA_CLI_BINARY" unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --log_mode --data="${TEST_DIRECTORY}/torn.log" | cmp - <(cat ./test_data/plain.txt ./test_data/plain.txt ./test_data/plain.txt)
+assert_success "log_mode"
+echo ""
+
+echo "gta-cli reseal --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --to_pers=test_pers_dummy_2 --to_prof=ch.iec.30168.basic.local_data_protection --data=${TEST_DIRECTORY}/out2.enc > ${TEST_DIRECTORY}/resealed.enc"
+"$GTA_CLI_BINARY" reseal --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --to_pers=test_pers_dummy_2 --to_prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/out2.enc" > "${TEST_DIRECTORY}/resealed.enc"
+assert_success "reseal"
+echo "gta-cli unseal_data --pers=test_pers_dummy_2 --prof=ch.iec.30168.basic.local_data_protection --data=${TEST_DIRECTORY}/resealed.enc"
+"$GTA_CLI_BINARY" unseal_data --pers=test_pers_dummy_2 --prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/resealed.enc" | cmp - ./test_data/plain.txt
+assert_success "reseal"
+mkdir -p "${TEST_DIRECTORY}/spool" "${TEST_DIRECTORY}/done"
+echo "gta-cli watch --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --op=seal --dir=${TEST_DIRECTORY}/spool --out_dir=${TEST_DIRECTORY}/done &"
+"$GTA_CLI_BINARY" watch --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --op=seal --dir="${TEST_DIRECTORY}/spool" --out_dir="${TEST_DIRECTORY}/done" &
+watch_pid=$!
+cp ./test_data/plain.txt "${TEST_DIRECTORY}/spool/.plain.txt" && mv "${TEST_DIRECTORY}/spool/.plain.txt" "${TEST_DIRECTORY}/spool/plain.txt"
+for i in $(seq 1 50); do [ -e "${TEST_DIRECTORY}/spool/plain.txt" ] || break; sleep 0.1; done
+# The state directory is only locked while a batch is processed, writers are not blocked by watch
+echo "gta-cli identifier_assign --id_type=ch.iec.30168.identifier.mac_addr --id_val=DE-AD-BE-EF-FE-EE --lock_timeout=5000"
+"$GTA_CLI_BINARY" identifier_assign --id_type=ch.iec.30168.identifier.mac_addr --id_val=DE-AD-BE-EF-FE-EE --lock_timeout=5000
+assert_success "watch"
+cp ./test_data/plain.txt "${TEST_DIRECTORY}/spool/.plain2.txt" && mv "${TEST_DIRECTORY}/spool/.plain2.txt" "${TEST_DIRECTORY}/spool/plain2.txt"
+for i in $(seq 1 50); do [ -e "${TEST_DIRECTORY}/spool/plain2.txt" ] || break; sleep 0.1; done
+kill -TERM $watch_pid
+wait $watch_pid
+assert_success "watch"
+echo "gta-cli unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=${TEST_DIRECTORY}/done/plain.txt"
+"$GTA_CLI_BINARY" unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/done/plain.txt" | cmp - ./test_data/plain.txt
+assert_success "watch"
+echo "gta-cli unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data=${TEST_DIRECTORY}/done/plain2.txt"
+"$GTA_CLI_BINARY" unseal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --data="${TEST_DIRECTORY}/done/plain2.txt" | cmp - ./test_data/plain.txt
+assert_success "watch"
+echo ""
+
+echo "gta-cli vault_put --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --vault=${TEST_DIRECTORY}/secrets.vault --key=db_password --data=./test_data/plain.txt"
+"$GTA_CLI_BINARY" vault_put --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --vault="${TEST_DIRECTORY}/secrets.vault" --key=db_password --data=./test_data/plain.txt
+assert_success "vault_put"
+echo "gta-cli vault_put --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --vault=${TEST_DIRECTORY}/secrets.vault --key=dir --data=${TEST_DIRECTORY}"
+timeout 10 "$GTA_CLI_BINARY" vault_put --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --vault="${TEST_DIRECTORY}/secrets.vault" --key=dir --data="${TEST_DIRECTORY}"
+test 1 -eq $?
+assert_success "vault_put"
+echo "gta-cli vault_get --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --vault=${TEST_DIRECTORY}/secrets.vault --key=db_password"
+"$GTA_CLI_BINARY" vault_get --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --vault="${TEST_DIRECTORY}/secrets.vault" --key=db_password | cmp - ./test_data/plain.txt
+assert_success "vault_get"
+echo "gta-cli vault_list --vault=${TEST_DIRECTORY}/secrets.vault"
+"$GTA_CLI_BINARY" vault_list --vault="${TEST_DIRECTORY}/secrets.vault" | grep -x "db_password"
+assert_success "vault_list"
+echo "gta-cli vault_get --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --vault=${TEST_DIRECTORY}/secrets.vault --key=unknown"
+"$GTA_CLI_BINARY" vault_get --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --vault="${TEST_DIRECTORY}/secrets.vault" --key=unknown
+assert_error "vault_get"
+mkdir -p "${TEST_DIRECTORY}/vault_out"
+echo "gta-cli vault_get --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --vault=${TEST_DIRECTORY}/secrets.vault --key=db_password --out_dir=${TEST_DIRECTORY}/vault_out --journal=${TEST_DIRECTORY}/vault.journal"
+"$GTA_CLI_BINARY" vault_get --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --vault="${TEST_DIRECTORY}/secrets.vault" --key=db_password --out_dir="${TEST_DIRECTORY}/vault_out" --journal="${TEST_DIRECTORY}/vault.journal" && cmp "${TEST_DIRECTORY}/vault_out/db_password" ./test_data/plain.txt
+assert_success "journal"
+echo "gta-cli vault_get --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --vault=${TEST_DIRECTORY}/secrets.vault --key=db_password --out_dir=${TEST_DIRECTORY}/vault_out --journal=${TEST_DIRECTORY}/vault.journal"
+"$GTA_CLI_BINARY" vault_get --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --vault="${TEST_DIRECTORY}/secrets.vault" --key=db_password --out_dir="${TEST_DIRECTORY}/vault_out" --journal="${TEST_DIRECTORY}/vault.journal" && [ "$(wc -l < "${TEST_DIRECTORY}/vault.journal")" -eq 1 ]
+assert_success "journal"
+echo "gta-cli exec --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --secret SECRET_FILE=${TEST_DIRECTORY}/out2.enc -- sh -c 'cmp \"\$SECRET_FILE\" ./test_data/plain.txt'"
+"$GTA_CLI_BINARY" exec --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --secret SECRET_FILE="${TEST_DIRECTORY}/out2.enc" -- sh -c 'cmp "$SECRET_FILE" ./test_data/plain.txt'
+assert_success "exec"
+echo "gta-cli exec --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --secret_env SECRET=${TEST_DIRECTORY}/out2.enc -- sh -c 'printf %s \"\$SECRET\"'"
+"$GTA_CLI_BINARY" exec --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_protection --secret_env SECRET="${TEST_DIRECTORY}/out2.enc" -- sh -c 'printf %s "$SECRET"' | cmp - ./test_data/plain.txt
+assert_success "exec"
+echo ""
+
+echo "gta-cli personality_create --id_val=DE-AD-BE-EF-FE-ED --pers=test_pers_tmpfs --app_name=gta-cli --prof=ch.iec.30168.basic.local_data_protection --acc_pol_use=$h_pol_initial --acc_pol_admin=$h_pol_initial --state_mode=tmpfs"
+"$GTA_CLI_BINARY" personality_create --id_val=DE-AD-BE-EF-FE-ED --pers=test_pers_tmpfs --app_name=gta-cli --prof=ch.iec.30168.basic.local_data_protection --acc_pol_use="$h_pol_initial" --acc_pol_admin="$h_pol_initial" --state_mode=tmpfs
+assert_success "personality_create"
+echo "gta-cli seal_data --pers=test_pers_tmpfs --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt > ${TEST_DIRECTORY}/out4.enc"
+"$GTA_CLI_BINARY" seal_data --pers=test_pers_tmpfs --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt > "${TEST_DIRECTORY}/out4.enc"
+assert_success "seal_data"
+echo "gta-cli seal_data --pers=test_pers_tmpfs --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --state_mode=invalid"
+"$GTA_CLI_BINARY" seal_data --pers=test_pers_tmpfs --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --state_mode=invalid
+assert_error "seal_data"
+echo "flock --shared ${GTA_STATE_DIRECTORY} gta-cli seal_data --pers=test_pers_tmpfs --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --lock_timeout=0"
+flock --shared "$GTA_STATE_DIRECTORY" "$GTA_CLI_BINARY" seal_data --pers=test_pers_tmpfs --prof=ch.iec.30168.basic.local_data_protection --data=./test_data/plain.txt --lock_timeout=0 > /dev/null
+assert_success "lock_timeout"
+echo "flock --shared ${GTA_STATE_DIRECTORY} gta-cli personality_remove --pers=test_pers_tmpfs --prof=ch.iec.30168.basic.local_data_protection --lock_timeout=0"
+flock --shared "$GTA_STATE_DIRECTORY" "$GTA_CLI_BINARY" personality_remove --pers=test_pers_tmpfs --prof=ch.iec.30168.basic.local_data_protection --lock_timeout=0
+assert_error "lock_timeout"
+echo ""
+
 echo "< ./test_data/plain.txt gta-cli seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only > ${TEST_DIRECTORY}/out.enc"
 < ./test_data/plain.txt "$GTA_CLI_BINARY" seal_data --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only > "${TEST_DIRECTORY}/out.enc"
 assert_success "seal_data"
@@ -170,6 +406,51 @@ assert_success "authenticate_data_detached"
 echo "< ./test_data/plain.txt gta-cli verify_data_detached --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --seal=${TEST_DIRECTORY}/out.icv"
 < ./test_data/plain.txt "$GTA_CLI_BINARY" verify_data_detached --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --seal="${TEST_DIRECTORY}/out.icv"
 assert_success "verify_data_detached"
+echo "gta-cli authenticate_data_detached --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --data=${TEST_DIRECTORY}/chunked.txt --tree_hash=sha256:4K --threads=4 > ${TEST_DIRECTORY}/out.icv"
+"$GTA_CLI_BINARY" authenticate_data_detached --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --data="${TEST_DIRECTORY}/chunked.txt" --tree_hash=sha256:4K --threads=4 > "${TEST_DIRECTORY}/out.icv"
+assert_success "authenticate_data_detached"
+echo "gta-cli verify_data_detached --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --data=${TEST_DIRECTORY}/chunked.txt --seal=${TEST_DIRECTORY}/out.icv --tree_hash=sha256:4K"
+"$GTA_CLI_BINARY" verify_data_detached --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --data="${TEST_DIRECTORY}/chunked.txt" --seal="${TEST_DIRECTORY}/out.icv" --tree_hash=sha256:4K
+assert_success "tree_hash"
+# A read error is not taken for the end of the data
+echo "gta-cli authenticate_data_detached --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --data=${TEST_DIRECTORY} --tree_hash=sha256:4K"
+"$GTA_CLI_BINARY" authenticate_data_detached --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --data="${TEST_DIRECTORY}" --tree_hash=sha256:4K > /dev/null
+assert_error "tree_hash"
+echo "gta-cli verify_data_detached --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --data=${TEST_DIRECTORY}/chunked.txt --seal=${TEST_DIRECTORY}/out.icv"
+"$GTA_CLI_BINARY" verify_data_detached --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --data="${TEST_DIRECTORY}/chunked.txt" --seal="${TEST_DIRECTORY}/out.icv"
+assert_error "verify_data_detached"
+echo "gta-cli authenticate_data_detached --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --data=./test_data/plain.txt,${TEST_DIRECTORY}/chunked.txt > ${TEST_DIRECTORY}/out.icv"
+"$GTA_CLI_BINARY" authenticate_data_detached --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --data=./test_data/plain.txt,"${TEST_DIRECTORY}/chunked.txt" > "${TEST_DIRECTORY}/out.icv"
+assert_success "authenticate_data_detached"
+echo "cat ./test_data/plain.txt ${TEST_DIRECTORY}/chunked.txt | gta-cli verify_data_detached --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --seal=${TEST_DIRECTORY}/out.icv"
+cat ./test_data/plain.txt "${TEST_DIRECTORY}/chunked.txt" | "$GTA_CLI_BINARY" verify_data_detached --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --seal="${TEST_DIRECTORY}/out.icv"
+assert_success "data_list"
+mkdir -p "${TEST_DIRECTORY}/batch"
+for i in 1 2 3 4 5; do
+  echo "telemetry record $i" > "${TEST_DIRECTORY}/batch/item$i"
+  echo "${TEST_DIRECTORY}/batch/item$i"
+done > "${TEST_DIRECTORY}/batch/list"
+echo "gta-cli authenticate_batch --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --data_list=${TEST_DIRECTORY}/batch/list > ${TEST_DIRECTORY}/batch/root.icv"
+"$GTA_CLI_BINARY" authenticate_batch --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --data_list="${TEST_DIRECTORY}/batch/list" > "${TEST_DIRECTORY}/batch/root.icv"
+assert_success "authenticate_batch"
+echo "gta-cli verify_batch --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --data=${TEST_DIRECTORY}/batch/item5 --seal=${TEST_DIRECTORY}/batch/root.icv"
+"$GTA_CLI_BINARY" verify_batch --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --data="${TEST_DIRECTORY}/batch/item5" --seal="${TEST_DIRECTORY}/batch/root.icv"
+assert_success "verify_batch"
+echo "gta-cli verify_batch --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --data=${TEST_DIRECTORY}/batch/item2 --proof=${TEST_DIRECTORY}/batch/item3.proof --seal=${TEST_DIRECTORY}/batch/root.icv"
+"$GTA_CLI_BINARY" verify_batch --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --data="${TEST_DIRECTORY}/batch/item2" --proof="${TEST_DIRECTORY}/batch/item3.proof" --seal="${TEST_DIRECTORY}/batch/root.icv"
+assert_error "verify_batch"
+mkdir -p "${TEST_DIRECTORY}/incremental/sub"
+cp ./test_data/plain.txt "${TEST_DIRECTORY}/incremental/"
+cp ./test_data/plain.txt "${TEST_DIRECTORY}/incremental/sub/"
+echo "gta-cli authenticate_data_detached --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --incremental --dir=${TEST_DIRECTORY}/incremental --index=${TEST_DIRECTORY}/incremental.idx"
+"$GTA_CLI_BINARY" authenticate_data_detached --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --incremental --dir="${TEST_DIRECTORY}/incremental" --index="${TEST_DIRECTORY}/incremental.idx" | grep -x "sub/plain.txt"
+assert_success "incremental"
+echo "gta-cli verify_data_detached --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --data=${TEST_DIRECTORY}/incremental/sub/plain.txt --seal=${TEST_DIRECTORY}/incremental/sub/plain.txt.seal"
+"$GTA_CLI_BINARY" verify_data_detached --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --data="${TEST_DIRECTORY}/incremental/sub/plain.txt" --seal="${TEST_DIRECTORY}/incremental/sub/plain.txt.seal"
+assert_success "incremental"
+echo "gta-cli authenticate_data_detached --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --incremental --dir=${TEST_DIRECTORY}/incremental --index=${TEST_DIRECTORY}/incremental.idx"
+[ -z "$("$GTA_CLI_BINARY" authenticate_data_detached --pers=test_pers_seal_data --prof=ch.iec.30168.basic.local_data_integrity_only --incremental --dir="${TEST_DIRECTORY}/incremental" --index="${TEST_DIRECTORY}/incremental.idx")" ]
+assert_success "incremental"
 echo ""
 
 echo "gta-cli personality_enumerate --id_val=DE-AD-BE-EF-FE-ED"